@@ -2,30 +2,59 @@
 #define BUTTON_MANAGER_H
 
 #include <Arduino.h>
+#include "driver/gpio.h"
+#include "relay_judge.h"
+#include "hot_path.h"
 
 // Hardware Pin Definitions for LilyGO T-Display S3
 #define BUTTON_LAP_PIN 2   // GPIO2 - Lap button (active HIGH, external pulldown required)
+#define BUTTON_UNDO_PIN 14 // GPIO14 - Onboard key, undo the last split (active LOW)
+#define BUTTON_SETUP_PIN 0 // GPIO0 - BUTTON1, held to open the setup portal (active LOW)
+#define RELAY_BLOCK_PIN 1  // GPIO1 - relay block switch, closed to GND while a swimmer stands on it
 
 // Button timing
 #define DEBOUNCE_TIME_MS 300  // Extended debounce for GPIO2 split button
+#define SETUP_HOLD_MS 3000    // BUTTON1 hold before the setup portal opens
 
 // Button states
 enum ButtonEvent {
     BUTTON_NONE,
-    BUTTON_LAP_PRESSED
+    BUTTON_LAP_PRESSED,
+    BUTTON_UNDO_PRESSED,
+    BUTTON_SETUP_HELD
 };
 
 class ButtonManager {
 private:
     // Interrupt flags
     volatile bool lapInterrupt;
+    volatile bool undoInterrupt;
     
-    // Debounce timing
+    // Debounce timing (micros())
     volatile uint32_t lastLapInterrupt;
+    volatile uint32_t lastUndoInterrupt;
+    volatile uint32_t lapPressedUs;   // micros() of the accepted lap edge
     
-    // Static interrupt handlers (required for attachInterrupt)
-    static ButtonManager* instance;
-    static void IRAM_ATTR handleLapInterrupt();
+    // Relay mode: raw touch and block edges with their micros(), in the
+    // order the interrupts saw them (single producer: both ISRs run on one core)
+    static const uint8_t EDGE_RING = 16;
+    bool relayInputs;
+    volatile uint32_t edgeUs[EDGE_RING];
+    volatile uint8_t edgeKind[EDGE_RING];
+    volatile uint8_t edgeHead;
+    volatile uint8_t edgeTail;
+    volatile uint32_t edgeOverflows;
+    
+    // BUTTON1 long press (polled)
+    uint32_t setupPressedSince;
+    bool setupReported;
+    
+    // Static interrupt handlers for the IRAM GPIO ISR service (see hot_path.h)
+    static void handleLapInterrupt(void* arg);
+    static void handleUndoInterrupt(void* arg);
+    static void handleBlockInterrupt(void* arg);
+    void pushEdge(uint32_t us, RelayEdgeKind kind);
+    bool attachPin(uint8_t pin, gpio_int_type_t edge, void (*handler)(void*));
     
 public:
     ButtonManager();
@@ -40,8 +69,19 @@ public:
     // Button state reading (for polling if needed)
     bool isLapPressed();
     
-    // Interrupt handlers (called by static handlers)
+    // When the last lap press happened (micros()), for split latency
+    uint32_t getLapPressedUs() const { return lapPressedUs; }
+    
+    // Relay mode: block switch interrupt, and GPIO2 edges for the judge
+    void enableRelayInputs();
+    bool popRelayEdge(RelayEdge& edge);     // Oldest queued edge
+    bool isBlockOccupied();
+    uint32_t getEdgeOverflows() const { return edgeOverflows; }
+    
+    // Interrupt handlers (called by static handlers, all in IRAM)
     void handleLapISR();
+    void handleUndoISR();
+    void handleBlockISR();
 };
 
 #endif // BUTTON_MANAGER_H
@@ -6,6 +6,9 @@
 #include <WebServer.h>
 #include <Preferences.h>
 
+// Largest /status, /metrics or /settings response
+#define PORTAL_RESPONSE_SIZE 4608
+
 class CaptivePortalManager {
 private:
     DNSServer dnsServer;
@@ -13,23 +16,57 @@ private:
     Preferences preferences;
     
     bool configComplete;
+    char response[PORTAL_RESPONSE_SIZE];
+    IPAddress apAddress;
+    String redirectLocation;    // Built once in begin()
+    
+    // Network list for the SSID field, from a scan started with the portal
+    bool scanRunning;
+    bool scanDone;
+    String scanJson;
     String configuredSSID;
     String configuredPassword;
     String configuredWsServer;
     String configuredWsPort;
     String configuredLane;
+    String configuredPosition;    // "start" or "turn": pool end of a lane device
+    String configuredUndoSeconds; // How long after a touch the undo key retracts it (0 = off)
+    String configuredTrainSwimmers; // Swimmers per lane in training mode (0 = off)
+    String configuredTrainGapS;   // Training send-off gap
+    String configuredTrainLapS;   // Training expected lap time
+    String configuredDistanceM;   // Distance event lap counter when the heat program has none (0 = off)
+    String configuredPoolM;       // "25" or "50"
+    String configuredRelay;       // "on"/"off": relay takeoff judging
+    String configuredRelayTolMs;  // Takeoff this much before the touch is not flagged
     String configuredRole;        // "lane" or "starter"
+    String configuredFastPathKey; // Shared key for signed UDP start/reset (empty = off)
+    String configuredStartGate;   // "off", "warn" or "block" (starter only)
+    String configuredGateMs;      // Lane sync error bound the start gate accepts
+    String configuredDormantMinutes; // Inactivity before deep sleep (0 = never)
+    String configuredPortalAfter; // Failed WiFi attempts before the portal opens alongside (0 = never)
+    String configuredPeerLink;    // "on" or "off": ESP-NOW fallback via the starter
+    String configuredUsbLink;     // "on" or "off": frames to the PC bridge on the USB port
+    String configuredMaintPortal; // "on" or "off": open the maintenance portal once WiFi is up
     
     void setupWebServer();
     void handleRoot();
     void handleConfig();
+    void handleStatus();
+    void handleMetrics();
+    void handleSettings();
+    void handleScan();
     void handleNotFound();
+    void sendPage(const uint8_t* page, size_t length, const char* etag);
+    void startScan();
+    void pollScan();
+    bool timingActive() const { return isTimingActive && isTimingActive(); }
     
 public:
     CaptivePortalManager();
     ~CaptivePortalManager();
     
-    bool begin();
+    // keepStation: AP+STA, so the station link stays up (or keeps retrying)
+    bool begin(bool keepStation = false, const char* apName = "T-Display-S3-Setup");
     void loop();
     bool isConfigComplete() const { return configComplete; }
     
@@ -46,9 +83,18 @@ public:
     
     // Check if WiFi credentials exist
     static bool hasStoredCredentials();
-    static bool connectWithStoredCredentials();
+    // Starts one connection attempt and returns at once (WifiConnector
+    // times it). With a channel and BSSID (from before DORMANT) the scan is
+    // skipped. False if no credentials are stored
+    static bool beginStoredConnection(int32_t channel = 0, const uint8_t* bssid = nullptr);
     
     void stop();
+    
+    // Maintenance callbacks (set by main; unset in setup mode). The
+    // builders write a response into the buffer and return its length
+    size_t (*onStatus)(char* buffer, size_t size);     // /status, JSON
+    size_t (*onMetrics)(char* buffer, size_t size);    // /metrics, Prometheus text
+    bool (*isTimingActive)();   // Heat running: only small pages are served
 };
 
 #endif // CAPTIVE_PORTAL_H
@@ -0,0 +1,124 @@
+/**
+ * Clock Sync for T-Display S3 Stopwatch
+ *
+ * Maps the local millisecond clock onto server time from ping/pong samples,
+ * and keeps doing so when samples stop arriving (holdover).
+ *
+ * The crystal's frequency error is learned by fitting a line through the
+ * best (lowest round-trip) sample of each minute. Once the fit spans ten
+ * minutes its slope is used as the drift correction, and the caller can
+ * persist it so the next boot starts out calibrated.
+ *
+ * Every converted time comes with a quality and an uncertainty bound:
+ * half the round trip of the anchoring sample plus the worst-case drift
+ * accumulated since.
+ *
+ * The state can be captured as a Prior and restored after a reboot or deep
+ * sleep, with the bound widened by how well the gap itself was measured.
+ * New samples replace the restored anchor as soon as they are better.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/holdover_sim.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum SyncQuality : uint8_t {
+    SYNC_NONE,      // Never synchronized: local clock only
+    SYNC_LOCKED,    // Recent server sample over a live link
+    SYNC_HOLDOVER   // Link lost or samples stale: drift-corrected extrapolation
+};
+
+class ClockSync {
+public:
+    static const uint32_t HOLDOVER_AFTER_MS = 15000;    // Three missed 5 s pings
+    static const uint32_t WINDOW_MS = 60000;            // One drift point per minute
+    static const uint8_t MAX_POINTS = 32;               // Fit over the last ~30 minutes
+    static const uint8_t MIN_FIT_POINTS = 6;
+    static const uint32_t MIN_FIT_SPAN_MS = 600000;     // 10 minutes before the slope is trusted
+    static const uint32_t UNKNOWN_UNCERTAINTY = 0xFFFFFFFF;
+
+    // Server time and drift captured for a later restore
+    struct Prior {
+        uint64_t serverMs;      // Server time at capture
+        uint32_t errorMs;       // Bound on serverMs
+        float driftPpm;
+        float driftBoundPpm;
+        bool calibrated;
+    };
+
+    ClockSync();
+
+    // Forget all samples and the calibration
+    void reset();
+
+    // Drift estimate from a previous session (ppm, see getDriftPpm)
+    void setCalibration(float ppm);
+
+    // One ping/pong exchange: local time when the pong arrived, the server
+    // time it carried and the measured round trip
+    void addSample(uint32_t localMs, uint64_t serverMs, uint32_t rttMs);
+
+    // Link state from the transport; losing it forces holdover at once
+    void setLinkUp(bool up);
+
+    // Capture the current estimate; false when not synchronized
+    bool capture(uint32_t localMs, Prior& prior) const;
+
+    // Continue from a captured estimate, gapMs after it was taken, where the
+    // gap was measured by a clock good to gapBoundPpm. Starts in holdover
+    void restore(const Prior& prior, uint32_t localMs, uint32_t gapMs, float gapBoundPpm);
+
+    bool isSynced() const { return synced; }
+    uint64_t toServerTime(uint32_t localMs) const;
+    int64_t getOffsetMs(uint32_t localMs) const;
+    SyncQuality getQuality(uint32_t localMs) const;
+    uint32_t getUncertaintyMs(uint32_t localMs) const;
+
+    // Server ms gained per local ms, in ppm: positive when the local clock is slow
+    float getDriftPpm() const { return driftPpm; }
+    float getDriftBoundPpm() const { return driftBoundPpm; }
+    bool isCalibrated() const { return calibrated; }
+
+    // True once per drift estimate that moved far enough from the last
+    // persisted value to be worth a flash write
+    bool consumeCalibrationUpdate(float& ppm);
+
+    static const char* qualityName(SyncQuality quality);
+    static SyncQuality qualityFromName(const char* name);
+
+private:
+    struct Point {
+        uint32_t localMs;
+        int64_t offsetMs;
+        uint32_t errorMs;   // Bound on offsetMs when taken (rtt/2 for a sample)
+    };
+
+    bool synced;
+    bool linkUp;
+    uint32_t lastSampleMs;
+
+    // Sample currently used for conversion
+    Point anchor;
+
+    // Best sample of the current window, and one point per closed window
+    Point windowBest;
+    uint32_t windowStartMs;
+    bool windowOpen;
+    Point points[MAX_POINTS];
+    uint8_t pointCount;
+    uint8_t pointNext;
+
+    float driftPpm;
+    float driftBoundPpm;
+    bool calibrated;
+    bool calibrationDirty;
+    float persistedPpm;
+    bool persisted;
+
+    uint32_t anchorUncertaintyAt(uint32_t localMs) const;
+    void closeWindow();
+    void fitDrift();
+};
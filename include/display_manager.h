@@ -31,6 +31,10 @@
 
 #include <TFT_eSPI.h>
 #include <SPI.h>
+#include "lane_readiness.h"
+#include "split_board.h"
+#include "lap_sparkline.h"
+#include "time_format.h"
 
 // ===========================================
 // Hardware Configuration for T-Display S3
@@ -81,6 +85,11 @@
 #define AREA_LAP2_HEIGHT 30
 #define AREA_LAP3_Y 140
 #define AREA_LAP3_HEIGHT 30
+#define READINESS_CELLS 10     // Starter's lane roster over the three lap lines: two rows of five
+
+// Lane devices: lap pace sparkline in the bottom strip (the starter's event/heat line)
+#define AREA_SPARKLINE_Y 142
+#define AREA_SPARKLINE_HEIGHT 26
 
 // Status area dimensions (right side - system information)
 #define STATUS_AREA_WIDTH 80
@@ -95,6 +104,18 @@
 #define AREA_BATTERY_STATUS_Y 125
 #define AREA_BATTERY_STATUS_HEIGHT 45
 
+// Sparkline output on the TFT
+class TftSparkCanvas : public SparkCanvas {
+public:
+    explicit TftSparkCanvas(TFT_eSPI& tft) : tft(tft) {}
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+        tft.fillRect(x, y, w, h, color);
+    }
+
+private:
+    TFT_eSPI& tft;
+};
+
 /**
  * @class DisplayManager
  * @brief Manages the TFT display for the swimming stopwatch application
@@ -114,8 +135,8 @@
  * │   Split 3: xx:xx:xx     │ Lane Number  │
  * │      (240x90px)         │   (80x45px)  │
  * │                         ├──────────────┤
- * │                         │ Battery      │
- * │                         │   (80x45px)  │
+ * │  ▂▃▃▂▃▄▃ lap pace       │ Battery      │
+ * │  (lane, bottom 30px)    │   (80x45px)  │
  * └─────────────────────────┴──────────────┘
  * 
  * Key Features:
@@ -133,6 +154,8 @@ private:
     // ===================================
     
     TFT_eSPI tft;
+    TftSparkCanvas sparkCanvas;
+    LapSparkline lapSparkline;
     
     // Display state tracking for efficient updates
     String lastTimeString;
@@ -145,6 +168,9 @@ private:
     String lastLap3;
     String lastStartupMessage;
     String lastEventHeat;
+    uint32_t readinessCells[READINESS_CELLS]; // Lane, state and battery each cell was drawn with
+    bool readinessGridValid;   // false: every cell redraws
+    String stopwatchLabel;     // Whose time the stopwatch shows (training), or empty
     
     // Dirty flags for selective area updates
     bool stopwatchAreaDirty;
@@ -206,6 +232,10 @@ public:
     // Show Event/Heat under the stopwatch time (left side)
     void setEventHeat(const String& event, const String& heat);
     
+    // Small tag at the top left of the stopwatch time, e.g. "S2" for the
+    // swimmer whose time it is (empty = none)
+    void setStopwatchLabel(const String& label);
+    
     // ===================================
     // Split Time Management
     // ===================================
@@ -214,6 +244,17 @@ public:
     void updateLapTime(uint8_t lapNumber, const String& time);
     void clearLapTimes();
     
+    // Lane devices: one bar per lap of the heat, drawn incrementally from the
+    // stopwatch's lap history (LapData); count 0 clears it
+    template <typename Lap>
+    void updateLapSparkline(const Lap* laps, uint8_t count) { lapSparkline.update(sparkCanvas, laps, count); }
+    
+    // Starter: lane roster in the split area (two rows of five), sync state
+    // as the cell colour and the battery below the lane number. Only cells
+    // that changed are redrawn
+    void updateReadinessGrid(const uint8_t* lanes, const LaneState* states, const uint8_t* batteryPercent,
+                             uint8_t laneCount);
+    
     // ===================================
     // Status Information Display  
     // ===================================
@@ -221,7 +262,7 @@ public:
     // Status displays (right side)
     void updateWiFiStatus(const String& status, bool isConnected = false, int rssi = 0);
     void updateWebSocketStatus(const String& status, bool isConnected = false, int pingMs = -1);
-    void updateLaneInfo(uint8_t laneNumber);
+    void updateLaneInfo(uint8_t laneNumber, SplitPosition position = POSITION_START);
     void updateRoleInfo(const String& role, const String& event, const String& heat, uint8_t laneNumber);
     void updateBatteryDisplay(float voltage, uint8_t percentage);
     
@@ -0,0 +1,78 @@
+/**
+ * Distance Event Lap Counter for T-Display S3 Stopwatch
+ *
+ * For distance races (800 m, 1500 m) the lane device counts the lengths,
+ * as a lap counter does, and projects the finish from the swimmer's pace.
+ * Each split is a touch at this device's end of the pool: the start end
+ * sees every second length from the second, the turn end every second
+ * length from the first. A "lap" here is the time between two touches at
+ * this end (two lengths).
+ *
+ * - Lengths done and to go follow from the split count, the pool length
+ *   and the device's end. The bell lap is the last two lengths.
+ * - Pace is taken over the last WINDOW laps: the mean, and the trend as a
+ *   least-squares slope. Both are kept as running sums, so a split costs
+ *   the same at lap 30 as at lap 2. The first split (with the dive) only
+ *   anchors the first lap.
+ * - The projected finish adds the remaining lengths at the window's pace.
+ *   The trend only counts when it is larger than its own standard error
+ *   (the laps' scatter would produce it otherwise), and is carried for at
+ *   most TREND_LAPS laps ahead: a swimmer who slows down for four laps does
+ *   not keep slowing for twenty.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/distance_sim.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class DistanceEvent {
+public:
+    static const uint8_t WINDOW = 12;
+    static const uint8_t TREND_LAPS = 4;
+
+    DistanceEvent();
+
+    // Distance 0 turns the counter off; atStartEnd is the device's end
+    void begin(uint16_t distanceM, uint8_t poolM, bool atStartEnd);
+    bool isActive() const { return totalLengths > 0; }
+
+    // Forget the splits, keep the event (undo replays what is left)
+    void clearSplits();
+    void addSplit(uint32_t totalMs);
+
+    uint16_t getSplitCount() const { return splitCount; }
+    uint16_t getTotalLengths() const { return totalLengths; }
+    uint16_t getLengthsDone() const;
+    uint16_t getLengthsToGo() const;
+    bool isBellLap() const;     // Two lengths or fewer to go
+    bool isFinished() const { return isActive() && getLengthsToGo() == 0; }
+
+    // Pace over the last WINDOW laps; only valid with hasPace()
+    bool hasPace() const { return lapCount > 0; }
+    uint32_t getMeanLapMs() const;
+    int32_t getTrendMsPerLap() const;       // Positive: slowing down
+
+    // Projected total time at the finish (the last split once finished);
+    // 0 until there is a pace
+    uint32_t getProjectedFinishMs() const;
+
+private:
+    uint16_t totalLengths;
+    bool atStartEnd;
+
+    uint16_t splitCount;
+    uint32_t lastTotalMs;
+
+    // Laps in the window; lap k (0-based over the heat) is at k % WINDOW
+    uint32_t laps[WINDOW];
+    uint16_t lapCount;          // Laps so far (the window holds the last WINDOW)
+    int64_t sumY;               // Sum of lap times in the window
+    int64_t sumXY;              // Sum of lap index times lap time
+    int64_t sumYY;              // Sum of squared lap times
+
+    uint8_t windowSize() const { return lapCount < WINDOW ? lapCount : WINDOW; }
+    bool trendBeyondScatter(int64_t slope) const;
+};
@@ -0,0 +1,29 @@
+#ifndef DORMANT_STATE_H
+#define DORMANT_STATE_H
+
+#include <Arduino.h>
+
+// What a device needs to pick up where it left off after DORMANT (deep
+// sleep after long inactivity). Time sync and the split journal are
+// retained on their own (sync_retention.h, split_journal.h); the
+// configuration is in NVS, which is read in a few ms.
+struct DormantSession {
+    uint32_t lastSeq;       // Resume point: the server replays what came after
+    uint32_t serverEpoch;
+    char event[16];
+    char heat[16];
+    uint8_t wifiChannel;    // Access point we were on, so the wake skips the scan
+    uint8_t wifiBssid[6];
+    uint32_t idleMs;        // Inactivity that led to the sleep, for the log
+};
+
+// Keep the session in RTC slow memory, which survives deep sleep
+void dormantSave(const DormantSession& session);
+
+// The session saved before the last deep sleep, if intact. Cleared once
+// read, so a later reset without sleeping boots normally
+bool dormantRestore(DormantSession& session);
+
+void dormantClear();
+
+#endif // DORMANT_STATE_H
@@ -31,12 +31,19 @@ public:
     
     // Activity tracking
     void updateActivityTimer();
+    void keepAwake();       // Same, without the log line: for conditions checked every loop pass
     bool checkSleepTimeout() const;
     void setSleepEnabled(bool enabled);
     bool isSleepEnabled() const;
     
     // Sleep management
     void enterLightSleep();
+    void setSleepTimeout(uint32_t ms);
+    
+    // DORMANT: deep sleep until GPIO2 (split button) or BUTTON1 is pressed.
+    // Does not return; the wake is a reset that goes through setup() again
+    void enterDormant();
+    static bool wokeFromDormant(); // This boot is a button wake from deep sleep
     
     // Power management
     void setLowPowerMode(bool enabled);
@@ -74,6 +81,5 @@ private:
     static constexpr float BATTERY_MAX_VOLTAGE = 4.2f;
     
     // Helper methods
-    // Deep sleep helpers removed; only light sleep path retained
     uint32_t getCurrentSleepTimeout() const;
 };
\ No newline at end of file
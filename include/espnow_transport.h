@@ -0,0 +1,66 @@
+#ifndef ESPNOW_TRANSPORT_H
+#define ESPNOW_TRANSPORT_H
+
+#include <Arduino.h>
+#include <esp_now.h>
+#include "transport.h"
+
+/**
+ * ESP-NOW peer link between lane devices and the starter (gateway).
+ *
+ * Used when the access point is unreachable: lanes send their messages to
+ * the starter, which forwards them to the server over its own WebSocket
+ * and repeats the server's start/reset/event traffic to the lanes.
+ *
+ * The gateway broadcasts an empty beacon frame every BEACON_INTERVAL ms and
+ * relays by broadcast. Lanes learn the gateway's MAC from any frame it sends
+ * and then unicast to it, so their frames get the radio's ACK and retries.
+ * Retries can deliver a frame twice; the frame seq filters those copies.
+ *
+ * ESP-NOW shares the radio with the station interface and needs both ends
+ * on the same channel: the AP's channel when the link was configured.
+ */
+class EspNowTransport : public FrameTransport {
+public:
+    static const unsigned long BEACON_INTERVAL = 2000;
+    static const unsigned long GATEWAY_TIMEOUT = 6000;   // Three missed beacons
+    static const uint8_t QUEUE_FRAMES = 8;
+
+    EspNowTransport();
+
+    // node: lane number, or FRAME_NODE_GATEWAY on the starter
+    bool begin(uint8_t node, uint8_t channel);
+    void stop();
+
+    const char* name() const override { return "espnow"; }
+    bool isUp() const override;
+    bool send(const uint8_t* json, size_t length) override;
+    size_t receive(uint8_t* buffer, size_t size, uint8_t& source) override;
+    void loop(uint32_t nowMs) override;
+
+private:
+    struct Slot {
+        uint8_t mac[6];
+        uint8_t length;
+        uint8_t frame[MAX_FRAME];
+    };
+
+    bool active;
+    uint8_t channel;
+    uint8_t gatewayMac[6];
+    bool gatewayKnown;
+    unsigned long lastGatewayMs;
+    unsigned long lastBeaconMs;
+
+    // Filled from the Wi-Fi task, drained from loop()
+    Slot queue[QUEUE_FRAMES];
+    volatile uint8_t head;
+    volatile uint8_t count;
+    uint32_t overflows;
+
+    bool transmit(const uint8_t* mac, const uint8_t* frame, size_t length);
+    bool ensurePeer(const uint8_t* mac);
+    static void onReceive(const uint8_t* mac, const uint8_t* data, int length);
+};
+
+#endif // ESPNOW_TRANSPORT_H
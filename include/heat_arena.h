@@ -0,0 +1,142 @@
+/**
+ * Heat Arena for T-Display S3 Stopwatch
+ *
+ * Bump allocator for data that lives exactly as long as a heat: other
+ * devices' splits, the event/heat names, the scoreboard feed. Allocation
+ * moves a pointer forward in one fixed region, and reset() releases
+ * everything at once in O(1) when the heat ends. Nothing is freed on its
+ * own, so the general heap never sees the per-heat churn that fragments it
+ * over a long gala.
+ *
+ * Every reset() starts a new generation. Containers remember the
+ * generation they were carved from and read as empty once it has passed,
+ * so a stale pointer into the previous heat is never followed.
+ *
+ * ArenaVector<T> grows by doubling into a new block and leaving the old one
+ * behind until the reset, at most as much again as its final size. It is
+ * meant for trivially copyable records (SplitRecord and the like): elements
+ * are moved with memcpy and never destroyed.
+ *
+ * Pure logic, no Arduino dependencies; the region comes from the caller
+ * (see tools/arena_soak.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class HeatArena {
+public:
+    HeatArena();
+
+    // Region to carve from; the arena does not own or free it
+    void begin(void* region, size_t size);
+
+    // nullptr when the region is exhausted (counted in getFailedCount())
+    void* allocate(size_t size, size_t align = sizeof(void*));
+
+    // Copy of text (nullptr: empty string) that lives until reset();
+    // nullptr if it does not fit
+    const char* copyString(const char* text);
+
+    // Release everything allocated since begin() or the last reset()
+    void reset();
+
+    uint32_t generation() const { return gen; }
+    size_t used() const { return offset; }
+    size_t capacity() const { return size; }
+    size_t getHighWater() const { return highWater; }   // Most used in any heat
+    uint32_t getFailedCount() const { return failed; }
+
+private:
+    uint8_t* base;
+    size_t size;
+    size_t offset;
+    size_t highWater;
+    uint32_t gen;
+    uint32_t failed;
+};
+
+template <typename T>
+class ArenaVector {
+public:
+    ArenaVector()
+        : arena(nullptr)
+        , items(nullptr)
+        , count(0)
+        , cap(0)
+        , gen(0) {
+    }
+
+    // Attach to the current heat; any previous contents are dropped
+    void begin(HeatArena& heatArena, uint16_t initialCapacity = 8) {
+        arena = &heatArena;
+        gen = heatArena.generation();
+        count = 0;
+        cap = 0;
+        items = nullptr;
+        reserve(initialCapacity);
+    }
+
+    // False if the arena is exhausted (the vector keeps what it has)
+    bool reserve(uint16_t capacity) {
+        if (!live()) {
+            return false;
+        }
+        if (capacity <= cap) {
+            return true;
+        }
+        T* larger = (T*)arena->allocate(capacity * sizeof(T), alignof(T));
+        if (!larger) {
+            return false;
+        }
+        if (count) {
+            memcpy(larger, items, count * sizeof(T));
+        }
+        items = larger;
+        cap = capacity;
+        return true;
+    }
+
+    // Slot for a new element at index (shifting later ones up); nullptr if full
+    T* insert(uint16_t index) {
+        if (!live() || (count == cap && !reserve(cap ? cap * 2 : 8))) {
+            return nullptr;
+        }
+        memmove(&items[index + 1], &items[index], (count - index) * sizeof(T));
+        count++;
+        return &items[index];
+    }
+
+    T* push_back(const T& value) {
+        T* slot = insert(size());
+        if (slot) {
+            *slot = value;
+        }
+        return slot;
+    }
+
+    void erase(uint16_t index) {
+        memmove(&items[index], &items[index + 1], (count - index - 1) * sizeof(T));
+        count--;
+    }
+
+    uint16_t size() const { return live() ? count : 0; }
+    uint16_t capacity() const { return live() ? cap : 0; }
+    T& operator[](uint16_t index) { return items[index]; }
+    const T& operator[](uint16_t index) const { return items[index]; }
+
+    // Keeps the storage for reuse within the same heat
+    void clear() { count = 0; }
+
+private:
+    HeatArena* arena;
+    T* items;
+    uint16_t count;
+    uint16_t cap;
+    uint32_t gen;
+
+    bool live() const { return arena && arena->generation() == gen; }
+};
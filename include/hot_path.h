@@ -0,0 +1,89 @@
+/**
+ * Hot Path Placement for T-Display S3 Stopwatch
+ *
+ * The touch is timed in the GPIO interrupt, from internal RAM, so it is
+ * taken at the same speed after a long idle (cold flash cache) and during
+ * a flash write (NVS, where the cache is off and flash code cannot run):
+ * - HOT_PATH_ATTR places a function in IRAM, in a section of its own
+ *   (.iram1.hot.*) so tools/check_hot_path.py can find it. After the link
+ *   the check fails the build if such a function calls or loads anything
+ *   in flash; IRAM and ROM code is fine.
+ * - Hot code reads the time and the pins through the inline helpers below:
+ *   Arduino's micros() and digitalRead() are only in IRAM when the core is
+ *   built with CONFIG_ARDUINO_ISR_IRAM.
+ * - ButtonManager installs the GPIO ISR service with ESP_INTR_FLAG_IRAM.
+ *   Every GPIO handler must then be in IRAM, so nothing else may use
+ *   attachInterrupt(), whose dispatcher is in flash.
+ *
+ * What the loop does with a split (journal, JSON, WebSocket) runs from
+ * flash, but no longer decides its time: the split is timed at the touch.
+ * HotPathProbe measures both sides with the CPU cycle counter. A run
+ * STALL_FACTOR times slower than the fastest one so far, and at least
+ * STALL_MIN_CYCLES slower, counts as a stall: a cache miss, a flash
+ * operation or an interrupt in between. The first run is the baseline
+ * until a faster one comes.
+ */
+
+#ifndef HOT_PATH_H
+#define HOT_PATH_H
+
+#include <Arduino.h>
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+
+#define HOT_PATH_ATTR _SECTION_ATTR_IMPL(".iram1.hot", __COUNTER__)
+
+enum HotPath : uint8_t {
+    HOT_PATH_TOUCH_ISR,         // GPIO2 interrupt
+    HOT_PATH_UNDO_ISR,          // GPIO14 interrupt
+    HOT_PATH_BLOCK_ISR,         // Relay block switch interrupt
+    HOT_PATH_SPLIT_RECORD,      // Loop: split time, lap table and journal
+    HOT_PATH_SPLIT_SEND,        // Loop: split JSON onto the link
+    HOT_PATH_COUNT
+};
+
+class HotPathProbe {
+public:
+    static const uint32_t STALL_FACTOR = 2;
+    static const uint32_t STALL_MIN_CYCLES = 2400;  // 10 µs at 240 MHz
+
+    HotPathProbe();
+
+    void record(uint32_t cycles);   // In IRAM: ISRs call it
+
+    uint32_t getRuns() const { return runs; }
+    uint32_t getStalls() const { return stalls; }
+    uint32_t getBestCycles() const { return bestCycles; }
+    uint32_t getWorstCycles() const { return worstCycles; }
+
+private:
+    volatile uint32_t runs;
+    volatile uint32_t stalls;
+    volatile uint32_t bestCycles;
+    volatile uint32_t worstCycles;
+};
+
+extern HotPathProbe hotPathProbes[HOT_PATH_COUNT];
+
+const char* hotPathName(HotPath path);  // "touch_isr", ... (metric labels)
+
+// CPU cycle counter (240 per µs)
+static inline __attribute__((always_inline)) uint32_t hotPathCycles() {
+    uint32_t cycles;
+    __asm__ __volatile__("rsr %0, ccount" : "=a"(cycles));
+    return cycles;
+}
+
+// micros(): the same esp_timer count, which ESP-IDF keeps in IRAM
+static inline __attribute__((always_inline)) uint32_t hotPathMicros() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+// digitalRead() for GPIO0-31: the input register itself
+static inline __attribute__((always_inline)) bool hotPathPinHigh(uint8_t pin) {
+    return (REG_READ(GPIO_IN_REG) >> pin) & 1;
+}
+
+#endif // HOT_PATH_H
@@ -0,0 +1,82 @@
+/**
+ * Lane Readiness for T-Display S3 Stopwatch
+ *
+ * The starter's view of every lane device's time sync, built from the
+ * periodic {"type":"status"} reports. Decides which lanes would hold up a
+ * start under the sync gate: a lane is ready while it keeps reporting and
+ * its self-reported error bound is within the threshold.
+ *
+ * Lanes that never reported are not waited for. Lanes that stop reporting
+ * first count as stale (not ready); after FORGET_AFTER_MS they are assumed
+ * switched off and dropped again, so a dead lane cannot block all starts.
+ *
+ * A server that keeps the roster itself sends {"type":"presence"} deltas
+ * instead of relaying every report: one lane per message, with only the
+ * fields that changed (applyPresence()). Those lanes do not age here; the
+ * server says when one goes offline, which counts as stale from then on.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "clock_sync.h"
+#include "ws_protocol.h"
+
+enum LaneState : uint8_t {
+    LANE_ABSENT,    // Never reported, or forgotten
+    LANE_READY,     // Reporting, error bound within the threshold
+    LANE_DEGRADED,  // Reporting, but unsynchronized or bound above the threshold
+    LANE_STALE      // Stopped reporting
+};
+
+// Fields present in a presence delta
+enum PresenceField : uint8_t {
+    PRESENCE_ONLINE = 1,
+    PRESENCE_SYNC = 2,
+    PRESENCE_UNCERTAINTY = 4,
+    PRESENCE_BATTERY = 8
+};
+
+struct PresenceDelta {
+    uint8_t lane;
+    uint8_t fields;             // PresenceField bits; the others are unchanged
+    bool online;
+    SyncQuality quality;
+    uint32_t uncertaintyMs;
+    uint8_t batteryPercent;
+};
+
+class LaneReadiness {
+public:
+    static const uint8_t MAX_LANES = WS_MAX_LANES;
+    static const uint32_t STALE_AFTER_MS = 25000;    // Two and a half missed 10 s reports
+    static const uint32_t FORGET_AFTER_MS = 120000;
+    static const uint8_t BATTERY_UNKNOWN = 0xFF;
+
+    LaneReadiness();
+
+    void update(uint8_t lane, SyncQuality quality, uint32_t uncertaintyMs, uint32_t nowMs);
+    void applyPresence(const PresenceDelta& delta, uint32_t nowMs);
+    void clear();
+
+    LaneState getState(uint8_t lane, uint32_t nowMs, uint32_t thresholdMs) const;
+    uint32_t getUncertaintyMs(uint8_t lane) const;
+    uint8_t getBatteryPercent(uint8_t lane) const;     // BATTERY_UNKNOWN if not reported
+
+    // One bit per lane that is not ready; 0 when every present lane is
+    uint64_t notReadyMask(uint32_t nowMs, uint32_t thresholdMs) const;
+
+    static const char* stateName(LaneState state);
+
+private:
+    struct Entry {
+        uint32_t lastReportMs;      // Presence lanes: when they went offline
+        uint32_t uncertaintyMs;
+        SyncQuality quality;
+        uint8_t batteryPercent;
+        bool seen;
+        bool pushed;                // Kept by server presence deltas
+        bool online;
+    };
+    Entry lanes[MAX_LANES];
+};
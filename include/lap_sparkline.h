@@ -0,0 +1,97 @@
+/**
+ * Lap Pace Sparkline for T-Display S3 Stopwatch
+ *
+ * One bar per lap of the current heat, so a coach sees the shape of the
+ * race (even, fading, negative split) and not only the last split totals.
+ * A slower lap is a taller bar; the newest lap is highlighted and the
+ * first (with the dive) is grey and left out of the scale.
+ *
+ * Drawing is incremental, straight from the stopwatch's lap history:
+ * - A new lap adds one column, and recolours the one before it.
+ * - The scale only changes when a lap falls outside it, and then widens
+ *   with some headroom so the next few outliers fit too. On a rescale each
+ *   column only draws the difference between its old and new height.
+ * - An undo erases the last column. Only when the widget is full does it
+ *   redraw, with the newest half of the laps.
+ * The widget keeps one byte per column (its drawn height) and reads the
+ * lap times in place (update() takes the LapData array and its stride).
+ *
+ * Output is fillRect() on a SparkCanvas: TFT_eSPI on the device, a plain
+ * framebuffer in the host benchmark.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/sparkline_bench.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+class SparkCanvas {
+public:
+    virtual ~SparkCanvas() {}
+
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) = 0;
+};
+
+class LapSparkline {
+public:
+    static const uint8_t COLUMN_PITCH = 4;      // 3 px bar, 1 px gap
+    static const uint8_t MAX_COLUMNS = 60;
+    static const uint8_t MIN_BAR = 2;           // Fastest lap in the scale
+    static const uint32_t MIN_HEADROOM_MS = 500;
+
+    // RGB565, as the display's COLOR_BACKGROUND, COLOR_STATUS and COLOR_LAP_INFO
+    static const uint16_t COLOR_EMPTY = 0x0000;
+    static const uint16_t COLOR_BAR = 0x07FF;
+    static const uint16_t COLOR_NEWEST = 0xFFE0;
+    static const uint16_t COLOR_DIVE = 0x7BEF;
+
+    LapSparkline();
+
+    // Widget area; the canvas there is assumed blank
+    void begin(int16_t x, int16_t y, int16_t width, int16_t height);
+
+    // Forget what is drawn, after something else cleared the screen
+    void reset();
+
+    // Bring the widget up to date with laps[0..count) (LapData on the device).
+    // count 0 clears it
+    template <typename Lap>
+    void update(SparkCanvas& canvas, const Lap* laps, uint8_t count) {
+        update(canvas, &laps->lapTimeMs, sizeof(Lap), count);
+    }
+    void update(SparkCanvas& canvas, const uint32_t* lapMs, size_t stride, uint8_t count);
+
+    uint8_t getColumns() const { return shown - first; }
+    uint16_t getRescales() const { return rescales; }
+    uint32_t getLowMs() const { return lowMs; }
+    uint32_t getHighMs() const { return highMs; }
+
+    // Bar height for a lap in the current scale (also used by the benchmark's reference render)
+    uint8_t barHeight(uint32_t lapMs) const;
+
+private:
+    int16_t x;
+    int16_t y;
+    int16_t width;
+    int16_t height;
+    uint8_t capacity;           // Columns that fit
+
+    uint8_t first;              // Lap index in column 0
+    uint8_t shown;              // Laps drawn (first..shown-1)
+    uint8_t heights[MAX_COLUMNS];
+    bool ranged;                // lowMs/highMs set (needs a lap after the dive)
+    uint32_t lowMs;
+    uint32_t highMs;
+    uint16_t rescales;
+
+    uint32_t lapAt(const uint32_t* lapMs, size_t stride, uint8_t index) const {
+        return *(const uint32_t*)((const uint8_t*)lapMs + index * stride);
+    }
+    uint16_t colorOf(uint8_t lap, uint8_t count) const;
+    bool widen(uint32_t lapMs);
+    void drawColumn(SparkCanvas& canvas, uint8_t column, uint8_t newHeight, uint16_t color);
+    void fillBar(SparkCanvas& canvas, uint8_t column, uint8_t top, uint8_t bottom, uint16_t color);
+};
@@ -0,0 +1,86 @@
+/**
+ * Loopback Transport for T-Display S3 Stopwatch
+ *
+ * In-memory stand-in for the ESP-NOW peer link, so the framing, failover
+ * and de-duplication logic can be exercised on the host without radios.
+ *
+ * Endpoints attach to a LoopbackMedium with a node id. Frames follow the
+ * same star rule as the radio (lanes reach the gateway, the gateway reaches
+ * every lane) and pass through the medium's fault model: fixed latency plus
+ * jitter, loss, duplication (a lost ACK makes the sender retry) and bit
+ * errors. Time is whatever the caller's clock says, so simulations run
+ * faster than real time.
+ *
+ * Pure logic, no Arduino dependencies (see tools/link_sim.cpp).
+ */
+
+#pragma once
+
+#include "transport.h"
+
+class LoopbackTransport;
+
+class LoopbackMedium {
+public:
+    static const uint8_t MAX_ENDPOINTS = 16;
+
+    struct Faults {
+        uint32_t latencyMs;
+        uint32_t jitterMs;
+        uint8_t lossPercent;
+        uint8_t duplicatePercent;
+        uint8_t corruptPercent;
+    };
+
+    LoopbackMedium(const uint32_t* clockMs, uint32_t seed = 1);
+
+    void setFaults(const Faults& faults) { this->faults = faults; }
+    void setUp(bool up) { this->up = up; }
+    bool isUp() const { return up; }
+    uint32_t now() const { return *clockMs; }
+
+private:
+    friend class LoopbackTransport;
+
+    const uint32_t* clockMs;
+    uint32_t rng;
+    Faults faults;
+    bool up;
+    LoopbackTransport* endpoints[MAX_ENDPOINTS];
+    uint8_t endpointCount;
+
+    void attach(LoopbackTransport* endpoint);
+    void transmit(const LoopbackTransport* from, const uint8_t* frame, size_t length);
+    uint32_t random(uint32_t range);
+};
+
+class LoopbackTransport : public FrameTransport {
+public:
+    static const uint8_t QUEUE_FRAMES = 32;
+
+    LoopbackTransport(LoopbackMedium& medium, uint8_t node);
+
+    const char* name() const override { return "loopback"; }
+    bool isUp() const override { return medium.isUp(); }
+    bool send(const uint8_t* json, size_t length) override;
+    size_t receive(uint8_t* buffer, size_t size, uint8_t& source) override;
+
+    uint32_t getOverflowCount() const { return overflows; }
+
+private:
+    friend class LoopbackMedium;
+
+    struct Slot {
+        uint32_t deliverAtMs;
+        uint16_t length;
+        uint8_t frame[MAX_FRAME];
+    };
+
+    LoopbackMedium& medium;
+    Slot queue[QUEUE_FRAMES];
+    uint8_t head;
+    uint8_t count;
+    uint32_t overflows;
+
+    void enqueue(const uint8_t* frame, size_t length, uint32_t deliverAtMs);
+};
@@ -0,0 +1,91 @@
+#ifndef MEMORY_POLICY_H
+#define MEMORY_POLICY_H
+
+/**
+ * Memory Placement Policy for T-Display S3 Stopwatch
+ *
+ * The S3 has about 320 KB of internal SRAM, which the Wi-Fi driver, TLS and
+ * DMA transfers all need, next to 8 MB of PSRAM that is slower and not
+ * DMA-capable. Subsystems ask for their buffers by class instead of by
+ * heap_caps flags:
+ *
+ * - MEM_DMA:  internal and DMA-capable (peripheral transfer buffers)
+ * - MEM_FAST: internal, for data touched on the timing path
+ * - MEM_BULK: PSRAM, for large buffers touched rarely (trace log, heat
+ *   arena). Without PSRAM it falls back to internal memory, counted as a
+ *   fallback.
+ *
+ * Every class has a budget. An allocation that would exceed it, or leave
+ * less than INTERNAL_RESERVE of internal memory for Wi-Fi, fails with
+ * nullptr and is counted. The buffers are long-lived and taken at startup;
+ * each is tracked with its owner for the boot report.
+ *
+ * Library buffers (mbedTLS records, WebSocket frames) come from malloc.
+ * begin() sets the size above which malloc prefers PSRAM, so the large
+ * ones stay out of internal SRAM too.
+ */
+
+#include <Arduino.h>
+
+enum MemoryClass : uint8_t {
+    MEM_DMA,
+    MEM_FAST,
+    MEM_BULK,
+    MEM_CLASS_COUNT
+};
+
+class MemoryPolicy {
+public:
+    static const size_t INTERNAL_RESERVE = 48 * 1024;   // Kept free for Wi-Fi and DMA
+    static const size_t EXTMEM_THRESHOLD = 4096;        // Larger mallocs prefer PSRAM
+    static const uint8_t MAX_BLOCKS = 24;
+
+    struct ClassStats {
+        size_t budget;
+        size_t used;
+        size_t peak;
+        uint16_t blocks;
+        uint16_t failures;      // Over budget, over the reserve or out of memory
+        uint16_t fallbacks;     // MEM_BULK served from internal memory
+    };
+
+    MemoryPolicy();
+
+    // Detect PSRAM and route large library mallocs to it
+    void begin();
+
+    void setBudget(MemoryClass memoryClass, size_t bytes);
+
+    // nullptr if the class budget, the internal reserve or the heap says no
+    void* allocate(MemoryClass memoryClass, size_t size, const char* owner);
+    void release(void* block);
+
+    const ClassStats& getStats(MemoryClass memoryClass) const { return stats[memoryClass]; }
+    bool hasPsram() const { return psram; }
+
+    // Classes, owners and heap state
+    void printReport(Print& out) const;
+
+    // Sequential and random access costs per class (takes a few hundred ms)
+    void runBenchmark(Print& out);
+
+    static const char* className(MemoryClass memoryClass);
+
+private:
+    struct Block {
+        void* ptr;
+        size_t size;
+        MemoryClass memoryClass;
+        bool internal;
+        const char* owner;
+    };
+
+    Block blocks[MAX_BLOCKS];
+    ClassStats stats[MEM_CLASS_COUNT];
+    bool psram;
+};
+
+// Global policy shared by all modules
+extern MemoryPolicy memoryPolicy;
+
+#endif // MEMORY_POLICY_H
@@ -0,0 +1,117 @@
+/**
+ * Message Frame for T-Display S3 Stopwatch
+ *
+ * Binary envelope for JSON protocol messages on links that are not a
+ * WebSocket (ESP-NOW peer link, USB serial to the PC bridge, host loopback):
+ *
+ *   SOF 0xA5 | version | source node | seq (u16 LE) | length (u16 LE) | JSON | CRC16 (LE)
+ *
+ * The CRC (CCITT, init 0xFFFF) covers everything after SOF up to the end of
+ * the JSON. The source is the sending node (lane number, FRAME_NODE_GATEWAY
+ * for the starter, FRAME_NODE_HOST for the PC bridge) and seq counts that
+ * node's frames, so copies repeated by the radio's own retries can be
+ * dropped with a FrameDuplicateFilter. The JSON is exactly what would have gone over the
+ * WebSocket, so the receiving side dispatches it the same way.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/link_sim.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FRAME_SOF 0xA5
+#define FRAME_VERSION 1
+#define FRAME_HEADER_SIZE 7
+#define FRAME_TRAILER_SIZE 2
+#define FRAME_OVERHEAD (FRAME_HEADER_SIZE + FRAME_TRAILER_SIZE)
+
+// Source ids: lanes use their lane number
+#define FRAME_NODE_GATEWAY 0xFE     // Starter relaying for lanes on the peer link
+#define FRAME_NODE_HOST 0xFD        // PC bridge on the USB link (tools/usb_bridge.py)
+#define FRAME_NODE_ANY 0xFF         // Upstream wildcard: accept every node but our own
+
+struct FrameHeader {
+    uint8_t source;
+    uint16_t seq;
+    uint16_t length;    // JSON payload bytes
+};
+
+uint16_t frameCrc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+// Encode one frame into out; returns the frame size, 0 if it does not fit
+size_t frameEncode(uint8_t source, uint16_t seq, const uint8_t* payload, size_t length,
+                   uint8_t* out, size_t outSize);
+
+// Decode one complete frame (a datagram). On success header is filled and
+// payload points into frame. False on bad SOF/version/length/CRC
+bool frameDecode(const uint8_t* frame, size_t length, FrameHeader& header, const uint8_t** payload);
+
+/**
+ * Finds frames in a byte stream shared with other traffic: log text on the
+ * USB serial port, console commands typed into a terminal. Bytes outside a
+ * frame are handed back as passthrough. A candidate with a bad version or an
+ * impossible length is discarded and the scan resumes at the next SOF; the
+ * CRC is left to frameDecode().
+ *
+ * Log text is ASCII, so it never contains the SOF byte.
+ */
+class FrameStreamDecoder {
+public:
+    enum Result : uint8_t {
+        PENDING,        // Byte consumed, frame not complete
+        COMPLETE,       // frame()/length() hold a candidate until the next push
+        PASSTHROUGH     // Byte is not part of a frame
+    };
+
+    FrameStreamDecoder(uint8_t* buffer, size_t size);
+
+    Result push(uint8_t byte);
+    const uint8_t* frame() const { return buffer; }
+    size_t length() const { return frameLength; }
+    uint32_t getDiscardedCount() const { return discarded; }
+
+private:
+    uint8_t* buffer;
+    size_t size;
+    size_t filled;
+    size_t expected;
+    size_t frameLength;
+    uint32_t discarded;
+};
+
+/**
+ * Per-source sliding window over the last 32 frame sequence numbers.
+ * A frame is new if its seq is ahead of the newest seen, or behind it but
+ * within the window and not seen yet. Sources restart at seq 0 on reboot, so
+ * a seq far behind the window is taken as a restart, not a duplicate.
+ */
+class FrameDuplicateFilter {
+public:
+    static const uint8_t MAX_SOURCES = 16;
+
+    FrameDuplicateFilter();
+
+    void clear();
+
+    // True the first time (source, seq) is offered
+    bool accept(uint8_t source, uint16_t seq);
+
+    uint32_t getDuplicateCount() const { return duplicates; }
+
+private:
+    struct Window {
+        uint8_t source;
+        bool used;
+        uint16_t newest;
+        uint32_t seen;  // Bit n: newest - n was seen
+    };
+
+    Window windows[MAX_SOURCES];
+    uint8_t nextEvict;
+    uint32_t duplicates;
+
+    Window& windowFor(uint8_t source, bool& fresh);
+};
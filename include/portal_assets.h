@@ -0,0 +1,214 @@
+// Generated by tools/portal_assets.py from portal/*.html. Do not edit;
+// edit the page and rebuild (or run the script).
+
+#pragma once
+
+#include <pgmspace.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// portal/config.html: 8662 bytes, 2241 gzipped
+#define CONFIG_HTML_ETAG "\"3ab8ab0f7e4e\""
+const size_t CONFIG_HTML_GZ_LEN = 2241;
+const uint8_t CONFIG_HTML_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xc5, 0x59, 0x69, 0x6f, 0xe3, 0x38,
+    0x12, 0xfd, 0xee, 0x5f, 0x51, 0xe3, 0xc1, 0xc2, 0x32, 0x36, 0xbe, 0x72, 0x0c, 0x7a, 0x7c, 0x2d,
+    0x3a, 0x47, 0xcf, 0xf6, 0x6e, 0xa6, 0x13, 0x8c, 0xdd, 0x08, 0x16, 0x83, 0x41, 0xc0, 0x48, 0xb4,
+    0xcd, 0x31, 0x45, 0x69, 0x29, 0x2a, 0xc7, 0x34, 0xf2, 0xdf, 0xb7, 0x8a, 0xa4, 0x2c, 0x59, 0x89,
+    0xbb, 0x9d, 0xfe, 0xb2, 0x68, 0x20, 0x16, 0x29, 0xb2, 0xf8, 0xea, 0xd5, 0x49, 0xf5, 0xf8, 0x87,
+    0xf3, 0xab, 0xb3, 0xf9, 0x7f, 0xae, 0x2f, 0xe0, 0x9f, 0xf3, 0x5f, 0x2f, 0xa7, 0x8d, 0xf1, 0xca,
+    0xc4, 0x92, 0x7e, 0x38, 0x8b, 0xf0, 0xc7, 0x08, 0x23, 0xf9, 0x74, 0xde, 0x39, 0x17, 0x59, 0x2a,
+    0xd9, 0x13, 0xcc, 0x8e, 0x60, 0xc6, 0x4d, 0x9e, 0x8e, 0x7b, 0xee, 0x4d, 0x63, 0x1c, 0x73, 0xc3,
+    0x40, 0xb1, 0x98, 0x4f, 0x9a, 0xf7, 0x82, 0x3f, 0xa4, 0x89, 0x36, 0x4d, 0x08, 0x13, 0x65, 0xb8,
+    0x32, 0x93, 0xe6, 0x83, 0x88, 0xcc, 0x6a, 0x12, 0xf1, 0x7b, 0x11, 0xf2, 0x8e, 0x1d, 0x1c, 0x80,
+    0x50, 0xc2, 0x08, 0x26, 0x3b, 0x59, 0xc8, 0x24, 0x9f, 0x0c, 0x9a, 0x28, 0x24, 0x33, 0x4f, 0x24,
+    0xec, 0x2e, 0x89, 0x9e, 0xe0, 0x0b, 0x2c, 0x70, 0x77, 0x67, 0xc1, 0x62, 0x21, 0x9f, 0x86, 0xf0,
+    0x5e, 0xe3, 0xda, 0x03, 0xc8, 0x98, 0xca, 0x3a, 0x19, 0xd7, 0x62, 0x31, 0x82, 0x98, 0xe9, 0xa5,
+    0x50, 0x43, 0x38, 0xee, 0xa7, 0x8f, 0x23, 0xb8, 0x63, 0xe1, 0x7a, 0xa9, 0x93, 0x5c, 0x45, 0x43,
+    0xf8, 0x71, 0xd1, 0xa7, 0x7f, 0x23, 0x78, 0x6e, 0x74, 0x09, 0x03, 0x13, 0x8a, 0x6b, 0x94, 0x58,
+    0x5d, 0xf3, 0xb0, 0x12, 0x86, 0x8f, 0x20, 0x65, 0x51, 0x24, 0xd4, 0x72, 0x08, 0x47, 0x4e, 0x4a,
+    0xa2, 0x23, 0xae, 0x3b, 0x9a, 0x45, 0x22, 0xcf, 0x86, 0x30, 0xf0, 0x93, 0x8f, 0x9d, 0x6c, 0xc5,
+    0xa2, 0xe4, 0x61, 0x08, 0x7d, 0x38, 0x4c, 0x1f, 0xed, 0x3c, 0xe8, 0xe5, 0x1d, 0x0b, 0xfa, 0x07,
+    0xf6, 0x5f, 0x77, 0xd0, 0xa6, 0xd3, 0x56, 0x03, 0x3c, 0x25, 0x4c, 0x64, 0xa2, 0x11, 0xc4, 0xd1,
+    0xd1, 0xd1, 0x08, 0x0c, 0x7f, 0x34, 0x1d, 0x26, 0xc5, 0x12, 0x81, 0x86, 0xc8, 0x05, 0xd7, 0xb4,
+    0x4e, 0xa8, 0x34, 0x37, 0xa8, 0x0d, 0x97, 0x3c, 0x34, 0xb8, 0xc5, 0x52, 0x42, 0xc7, 0xf5, 0xff,
+    0x56, 0x81, 0x34, 0x38, 0xa4, 0xd3, 0x0b, 0x35, 0xdf, 0xe1, 0x91, 0xfd, 0x02, 0x21, 0xbe, 0xc4,
+    0x61, 0x96, 0x48, 0x11, 0xc1, 0x8f, 0x51, 0x14, 0xbd, 0x40, 0x7e, 0xbc, 0x01, 0x2e, 0xfe, 0xb2,
+    0xc2, 0xfc, 0x7b, 0x9c, 0xda, 0x00, 0xf8, 0xdd, 0x3c, 0xa5, 0x68, 0xaf, 0x2c, 0xbf, 0x8b, 0x85,
+    0x69, 0xfe, 0xb1, 0x45, 0x50, 0xa7, 0xd0, 0xe2, 0xf8, 0xec, 0xfd, 0x87, 0x13, 0x3c, 0xd7, 0x8f,
+    0x3d, 0x6d, 0x61, 0xae, 0x33, 0x1a, 0xa6, 0x89, 0xd8, 0xd2, 0xa9, 0x26, 0x72, 0xb8, 0x4a, 0xee,
+    0x6b, 0xcc, 0x97, 0x82, 0x4f, 0x58, 0xff, 0xf8, 0x67, 0x6b, 0xa3, 0x45, 0xa2, 0xe3, 0x0e, 0xbd,
+    0x4e, 0x71, 0xa9, 0xd3, 0x17, 0x81, 0x1a, 0x93, 0xc4, 0xa8, 0xe7, 0x49, 0x6a, 0x11, 0x4b, 0x76,
+    0xc7, 0x25, 0xbe, 0x8e, 0x9c, 0x0b, 0xa2, 0x42, 0x32, 0x09, 0xd7, 0xa3, 0xfa, 0x72, 0xbb, 0xda,
+    0x7a, 0xce, 0x03, 0x17, 0xcb, 0x95, 0x21, 0xc5, 0x65, 0x64, 0x4f, 0x11, 0x4a, 0xa2, 0x1f, 0x54,
+    0x44, 0x2c, 0x24, 0xc7, 0xc5, 0x4b, 0x96, 0x0e, 0x1d, 0xd3, 0xd6, 0x4c, 0x1d, 0xd4, 0x2f, 0xce,
+    0x86, 0xa5, 0xad, 0xba, 0x2b, 0x26, 0x17, 0xa5, 0x8d, 0x4e, 0xc8, 0x44, 0xcf, 0x8d, 0x71, 0xcf,
+    0x3b, 0xeb, 0xb8, 0xe7, 0x63, 0x84, 0xbc, 0x16, 0x7f, 0x22, 0x71, 0x0f, 0xa1, 0x64, 0x59, 0x36,
+    0x69, 0x6e, 0x5c, 0x8f, 0x7c, 0x7b, 0x35, 0xa8, 0xc5, 0x8f, 0x49, 0xd2, 0x07, 0x66, 0xc2, 0x55,
+    0x11, 0x49, 0xb8, 0xa0, 0x31, 0x26, 0x26, 0x80, 0x85, 0x46, 0x24, 0x6a, 0xd2, 0xec, 0xa1, 0x80,
+    0x85, 0x58, 0x36, 0x01, 0x83, 0x6b, 0x95, 0x44, 0x93, 0xe6, 0xf5, 0xd5, 0x6c, 0xde, 0xdc, 0x3e,
+    0xa3, 0xa4, 0x8e, 0x5e, 0x38, 0x92, 0x70, 0x0e, 0x4d, 0x90, 0x89, 0xa8, 0x39, 0xbd, 0x11, 0x1f,
+    0x04, 0x7c, 0xe2, 0xe6, 0x21, 0xd1, 0xeb, 0xe1, 0xb8, 0x67, 0xdf, 0xe3, 0x3a, 0x6b, 0x2b, 0x70,
+    0xb6, 0x22, 0x0f, 0x6d, 0x82, 0x88, 0xfc, 0x16, 0x1f, 0xc4, 0xee, 0x59, 0x8a, 0xcc, 0xb8, 0xe7,
+    0xac, 0x09, 0x88, 0x3c, 0xe4, 0x2b, 0x64, 0x93, 0xa3, 0xf8, 0x0b, 0xa2, 0x07, 0xac, 0xf8, 0xd9,
+    0xec, 0xe3, 0x79, 0x13, 0x34, 0xff, 0x6f, 0x2e, 0x34, 0x8f, 0x80, 0xe5, 0x26, 0x09, 0x93, 0x38,
+    0x95, 0xdc, 0xa0, 0x9c, 0x64, 0xb1, 0xb0, 0x88, 0x99, 0x61, 0x24, 0x6c, 0x73, 0x4e, 0xd6, 0x9c,
+    0x8e, 0x7b, 0xc5, 0x2c, 0xb1, 0x88, 0x3a, 0xed, 0xa9, 0x59, 0x8a, 0xaf, 0x51, 0x9f, 0x42, 0xbb,
+    0x6b, 0x3f, 0xdc, 0xa1, 0xde, 0x66, 0xb5, 0x3d, 0xba, 0x1c, 0x39, 0x35, 0xcb, 0xf1, 0xb6, 0x76,
+    0x71, 0x6a, 0x9e, 0x60, 0xcd, 0x79, 0x9a, 0x81, 0x59, 0x71, 0xc8, 0x4c, 0x42, 0xaa, 0x95, 0x27,
+    0xbf, 0x09, 0x30, 0xe6, 0xab, 0x7b, 0x72, 0x82, 0x1b, 0x7e, 0x37, 0x43, 0x9f, 0xe5, 0x06, 0x4d,
+    0x4e, 0x33, 0xdf, 0x36, 0x88, 0xdb, 0x58, 0x98, 0xc4, 0x8f, 0xee, 0x99, 0xcc, 0x69, 0x18, 0xae,
+    0xb8, 0x8e, 0xbb, 0xec, 0xaf, 0x70, 0xcd, 0xe2, 0xb4, 0xab, 0x64, 0x4d, 0x07, 0x77, 0x06, 0x60,
+    0x32, 0xd1, 0x3c, 0xcb, 0xde, 0x08, 0xd9, 0xe6, 0xef, 0xa9, 0x17, 0x71, 0x8d, 0x83, 0x1d, 0x58,
+    0x55, 0x1e, 0xdf, 0x11, 0x26, 0xcb, 0xad, 0xcd, 0xf9, 0x9e, 0x57, 0xfb, 0xec, 0x91, 0x1e, 0x1f,
+    0x1f, 0xd5, 0xb0, 0xd1, 0xcc, 0xdb, 0x00, 0xe9, 0x44, 0xf2, 0xe6, 0xf4, 0xdc, 0x56, 0x10, 0xf8,
+    0x0d, 0x07, 0x15, 0x40, 0x3e, 0x8d, 0x12, 0x06, 0xbb, 0xcc, 0x63, 0x70, 0x5b, 0x1a, 0xe3, 0x24,
+    0xa5, 0x70, 0x2a, 0xc0, 0x48, 0xa6, 0x70, 0x85, 0xdb, 0xc2, 0xa3, 0xe9, 0x25, 0x0e, 0xc7, 0x3d,
+    0xb7, 0xe4, 0xc5, 0xda, 0xcc, 0x30, 0x6d, 0xc8, 0x72, 0x33, 0xf7, 0x50, 0x59, 0xd8, 0x73, 0x12,
+    0xb6, 0x95, 0x20, 0x04, 0x24, 0xff, 0x83, 0xe0, 0x92, 0x22, 0xe6, 0x5b, 0x4a, 0x59, 0x2c, 0x16,
+    0x02, 0x7c, 0xb2, 0x44, 0xee, 0xc1, 0xb2, 0xc3, 0xef, 0x34, 0x74, 0xcf, 0x1e, 0xec, 0xcf, 0x98,
+    0x27, 0x04, 0x66, 0x8d, 0x3e, 0xfe, 0xb2, 0xc7, 0x49, 0xf3, 0xa7, 0x3a, 0xe9, 0xf6, 0x1c, 0x2f,
+    0xaa, 0x6e, 0xed, 0x4c, 0x90, 0x5e, 0xcd, 0xe9, 0x75, 0x92, 0x48, 0xb8, 0x50, 0xd1, 0xeb, 0xec,
+    0x6e, 0xd6, 0x6d, 0xac, 0x5c, 0xec, 0x7b, 0x95, 0xb9, 0x0a, 0xcd, 0x96, 0x40, 0xe0, 0x2a, 0xda,
+    0xc9, 0xb5, 0xc9, 0x35, 0xca, 0x99, 0xe3, 0xdf, 0xda, 0xb2, 0x92, 0xe9, 0x0a, 0x62, 0x2c, 0x24,
+    0xc9, 0x2d, 0x3a, 0xf5, 0x2c, 0x95, 0xc2, 0xc0, 0x67, 0x1c, 0x61, 0x2e, 0xc2, 0xbf, 0x0f, 0x10,
+    0x64, 0x07, 0x58, 0xa4, 0x27, 0x80, 0x89, 0xa7, 0xbd, 0x07, 0x9d, 0x5e, 0x90, 0x57, 0xa8, 0x18,
+    0x79, 0x4c, 0x83, 0x7e, 0x8d, 0xd3, 0xc1, 0x61, 0xbf, 0x46, 0x9d, 0xd1, 0x98, 0xe1, 0x6f, 0xb3,
+    0x07, 0x11, 0xc7, 0x5c, 0x23, 0xa0, 0x39, 0x8d, 0x6d, 0xc1, 0x9d, 0xf9, 0x39, 0x48, 0x31, 0x84,
+    0x2c, 0xf7, 0x81, 0xc7, 0x75, 0x00, 0x87, 0x9d, 0x77, 0xfb, 0x80, 0xab, 0x09, 0xf7, 0x20, 0xeb,
+    0xb3, 0x1e, 0x6c, 0x1d, 0xeb, 0xbb, 0x57, 0x91, 0x62, 0xb5, 0xbb, 0xdd, 0x86, 0x89, 0x6c, 0x77,
+    0x10, 0x14, 0xfc, 0xc2, 0x52, 0x24, 0x6f, 0x7f, 0x58, 0x4e, 0xd2, 0x16, 0x26, 0x3f, 0x55, 0x67,
+    0x6f, 0x50, 0x78, 0xe4, 0xeb, 0xe4, 0xc9, 0x3a, 0xa4, 0x8b, 0xc7, 0xd4, 0x7a, 0x0d, 0xb2, 0xf6,
+    0x36, 0x48, 0xf2, 0x25, 0x24, 0xb9, 0x05, 0xe9, 0xa8, 0x80, 0x74, 0xb2, 0x81, 0x54, 0xc7, 0x84,
+    0xcd, 0x81, 0x61, 0x2a, 0xe4, 0xb7, 0x31, 0xa6, 0x1b, 0xff, 0x0c, 0x17, 0xf7, 0xd8, 0x0e, 0x40,
+    0x10, 0x7b, 0xd7, 0x52, 0xf2, 0x09, 0x16, 0x3a, 0x89, 0x6d, 0x6d, 0xc0, 0xf2, 0x6f, 0x20, 0xd5,
+    0xc9, 0x52, 0xb3, 0x78, 0x1f, 0xa8, 0x95, 0x03, 0x3c, 0xd2, 0xea, 0xcc, 0x0e, 0x63, 0x62, 0x67,
+    0x88, 0x48, 0xb1, 0x0e, 0xf1, 0x14, 0xc1, 0xf7, 0x5f, 0xc4, 0x6f, 0x22, 0x09, 0xaf, 0x8d, 0xde,
+    0x4b, 0xae, 0x96, 0xd8, 0xa8, 0xec, 0x08, 0x60, 0xbb, 0x70, 0x13, 0xbe, 0x6e, 0x5b, 0x3d, 0x14,
+    0x0f, 0x4f, 0x2a, 0x91, 0x7b, 0x78, 0x02, 0xf1, 0xce, 0xa0, 0x25, 0x24, 0x27, 0xfd, 0xad, 0x05,
+    0xaf, 0x86, 0xab, 0xe6, 0xd8, 0xf5, 0x34, 0xa7, 0xbf, 0xd1, 0x0f, 0xcc, 0xd9, 0x9a, 0x93, 0xc3,
+    0xfd, 0x2b, 0x8f, 0xb0, 0x73, 0x5b, 0xa2, 0x85, 0x8b, 0xe4, 0x70, 0xe0, 0x9a, 0x3a, 0x40, 0xdf,
+    0xa6, 0xc6, 0x08, 0xcf, 0xf9, 0xe5, 0xfa, 0xe3, 0xd5, 0xa0, 0xbd, 0x23, 0xd7, 0x5b, 0xa1, 0x45,
+    0xb2, 0x77, 0x27, 0xd4, 0x01, 0x52, 0xfb, 0x51, 0xea, 0x72, 0xb5, 0x58, 0xec, 0x54, 0x85, 0xb2,
+    0xd8, 0x95, 0xda, 0x4b, 0x91, 0x5b, 0x43, 0xbc, 0x65, 0x5e, 0x9f, 0xe1, 0x46, 0xa1, 0x39, 0x16,
+    0x1c, 0x6d, 0xfd, 0x25, 0x88, 0x33, 0xb8, 0xe3, 0xb8, 0x83, 0x5b, 0x17, 0x31, 0x49, 0x1e, 0xae,
+    0xf6, 0xf1, 0x8d, 0x2d, 0xf1, 0x55, 0xcd, 0x36, 0x73, 0x75, 0x47, 0x2e, 0x1c, 0xe4, 0xd0, 0x39,
+    0x72, 0xad, 0x18, 0xf9, 0x02, 0xb6, 0x6f, 0x3d, 0xb2, 0xcb, 0x31, 0x8a, 0x0d, 0xf7, 0x25, 0x0f,
+    0x93, 0x82, 0x41, 0x6d, 0xa8, 0xce, 0x40, 0xf6, 0xa4, 0xc2, 0x1d, 0x96, 0xa8, 0xec, 0x2b, 0x7a,
+    0x95, 0x8a, 0xa4, 0x3a, 0xd3, 0x0f, 0x0c, 0x33, 0x7d, 0x69, 0x94, 0x1b, 0x1c, 0x1e, 0x60, 0x00,
+    0x61, 0x93, 0x02, 0x6c, 0x89, 0x31, 0x8b, 0x74, 0x81, 0xdd, 0xbf, 0xd3, 0x56, 0xd6, 0x4b, 0x9a,
+    0xd3, 0x53, 0xeb, 0x2c, 0xb9, 0x32, 0x42, 0x62, 0xef, 0x2e, 0x81, 0x60, 0x66, 0x16, 0x27, 0xdf,
+    0x5d, 0x67, 0x6c, 0x43, 0xba, 0xed, 0x08, 0xaf, 0x5a, 0x9a, 0xb0, 0x5b, 0x23, 0xff, 0xca, 0x1e,
+    0x5d, 0xfa, 0x9e, 0xa1, 0x60, 0xb8, 0xd0, 0x3a, 0xd1, 0x64, 0xdf, 0x7d, 0xcc, 0x59, 0xc8, 0xf0,
+    0xa4, 0x6c, 0x86, 0x45, 0x9c, 0xd5, 0x13, 0x24, 0x45, 0xf9, 0x5b, 0x1b, 0x35, 0xce, 0xf5, 0x2d,
+    0xde, 0x6b, 0x90, 0x8e, 0x0f, 0xc8, 0x01, 0xdd, 0xb3, 0xe0, 0x12, 0x87, 0x70, 0x2f, 0x18, 0xf8,
+    0xb6, 0x05, 0x82, 0x8b, 0xd9, 0x75, 0xe7, 0xd3, 0xd5, 0xcd, 0x0e, 0xf3, 0x95, 0x32, 0x8a, 0xc4,
+    0x50, 0x0a, 0x7d, 0x25, 0x4c, 0x2a, 0xf1, 0xa4, 0xbe, 0x8f, 0xe6, 0x37, 0xe8, 0x97, 0x67, 0x77,
+    0x1e, 0xc9, 0x8d, 0xbd, 0x5d, 0x58, 0xdd, 0xd0, 0x41, 0xae, 0xcf, 0xe0, 0x54, 0x8b, 0x68, 0x89,
+    0xde, 0xf9, 0x79, 0x76, 0xba, 0x43, 0xb1, 0xcd, 0xe6, 0xa2, 0xbc, 0x6f, 0x84, 0xfd, 0xbf, 0xd5,
+    0x8a, 0xf0, 0x05, 0x53, 0xe6, 0x16, 0xcd, 0x4f, 0x5d, 0x2d, 0x4f, 0x61, 0x26, 0xe9, 0xef, 0xfb,
+    0x05, 0xd9, 0xeb, 0xa3, 0xa2, 0x2b, 0xe0, 0xbd, 0xc0, 0x3b, 0x48, 0x80, 0x2b, 0x5c, 0xd5, 0x51,
+    0x1c, 0x7b, 0xf1, 0xbd, 0x0a, 0x4c, 0x45, 0x76, 0x51, 0x61, 0xaa, 0x53, 0x45, 0x79, 0x3e, 0x7c,
+    0x51, 0x64, 0x8e, 0x8f, 0xfb, 0xdf, 0x71, 0x4f, 0x60, 0xf2, 0x96, 0x2d, 0x6c, 0x9b, 0x7c, 0x95,
+    0x72, 0xe5, 0xae, 0xb3, 0xf6, 0xce, 0xc0, 0xa4, 0xd7, 0xe7, 0x03, 0x13, 0x12, 0x6d, 0x67, 0xaf,
+    0x6b, 0xef, 0x0d, 0xde, 0xaf, 0x53, 0x93, 0xb9, 0x6e, 0x68, 0x6f, 0xa5, 0xb6, 0x0e, 0xaa, 0x5c,
+    0x32, 0xca, 0x39, 0xaf, 0xd6, 0x4f, 0x35, 0xa5, 0x4e, 0xde, 0xaa, 0x52, 0x8c, 0x29, 0xc8, 0xdc,
+    0x3a, 0xd9, 0x14, 0xfd, 0xf4, 0x81, 0x43, 0xd9, 0xac, 0xee, 0x75, 0xba, 0x59, 0xa1, 0x36, 0x70,
+    0x96, 0x28, 0x65, 0xdd, 0xe5, 0x75, 0xd7, 0xdb, 0x92, 0xe2, 0xf1, 0x6e, 0x4b, 0xfe, 0x66, 0xa9,
+    0x82, 0x80, 0x3a, 0x77, 0x38, 0xfd, 0x3c, 0x9f, 0x5f, 0x7d, 0x1a, 0x90, 0xd3, 0x27, 0xc8, 0x6f,
+    0xfb, 0x7b, 0x2a, 0xd8, 0x5b, 0x02, 0x2e, 0x4a, 0x6f, 0xd7, 0xfc, 0x89, 0xd2, 0x09, 0x5e, 0xd7,
+    0x5d, 0x15, 0xf8, 0x37, 0x47, 0x47, 0x74, 0x62, 0x99, 0x6c, 0xef, 0x75, 0xd1, 0x2e, 0xc4, 0x14,
+    0x91, 0x57, 0x0c, 0xb7, 0xaf, 0xa8, 0x2b, 0x46, 0x31, 0x8d, 0x2f, 0xe8, 0x6c, 0xf8, 0x7c, 0x7e,
+    0xed, 0x12, 0x7f, 0x0f, 0x8b, 0x01, 0xde, 0x92, 0x03, 0xfe, 0xfa, 0x35, 0x1c, 0xd7, 0xb7, 0x2b,
+    0x46, 0xad, 0x82, 0xf0, 0x1f, 0x9e, 0x0a, 0x4a, 0x66, 0xec, 0xde, 0x5a, 0x6a, 0x21, 0x96, 0xb9,
+    0x66, 0xc5, 0x55, 0xa5, 0x47, 0xca, 0x97, 0xfb, 0xb3, 0x50, 0x8b, 0x14, 0x59, 0x0a, 0x13, 0x85,
+    0x1a, 0xd3, 0xad, 0x71, 0x86, 0x64, 0x4c, 0x20, 0x4a, 0xc2, 0x3c, 0xc6, 0xbe, 0xaf, 0xbb, 0xe4,
+    0xe6, 0x42, 0x72, 0x7a, 0x3c, 0x7d, 0xfa, 0x18, 0x05, 0x2d, 0x5a, 0xd2, 0x6a, 0x8f, 0xfc, 0x06,
+    0xaa, 0x3a, 0xe7, 0x48, 0xec, 0x57, 0x36, 0x94, 0x77, 0xc2, 0x72, 0x9b, 0x2f, 0xcd, 0xdf, 0xd8,
+    0xb9, 0x55, 0xc0, 0x69, 0xf3, 0x22, 0x57, 0xf6, 0xeb, 0x10, 0xe4, 0x69, 0x84, 0xe5, 0x84, 0x6e,
+    0xc2, 0x9f, 0x3f, 0x06, 0xed, 0x2f, 0x0d, 0x0f, 0xa3, 0x6b, 0x3f, 0x4b, 0x75, 0xfd, 0x27, 0x2e,
+    0x14, 0x1d, 0x78, 0x85, 0xba, 0x96, 0x12, 0x98, 0x4c, 0x26, 0x50, 0x48, 0x6d, 0xb5, 0xe1, 0x1f,
+    0xd0, 0x52, 0x89, 0xe2, 0x2d, 0x18, 0x42, 0xcb, 0x56, 0xd5, 0xd6, 0xa8, 0x51, 0x22, 0x7b, 0xbb,
+    0x30, 0x27, 0x83, 0xa4, 0x59, 0xb1, 0xa3, 0xc6, 0x73, 0xa3, 0xd8, 0xc2, 0xa2, 0xc8, 0xb6, 0xd1,
+    0x97, 0xd8, 0xed, 0x72, 0xc5, 0x75, 0xd0, 0x0a, 0x57, 0x4c, 0x2d, 0x79, 0xeb, 0x60, 0x4b, 0x17,
+    0xd4, 0x71, 0x5b, 0xb5, 0x51, 0xa3, 0xd7, 0x83, 0x4a, 0x18, 0x0e, 0x1d, 0x75, 0x65, 0x03, 0xee,
+    0xbd, 0x02, 0x3d, 0xc6, 0x60, 0x3b, 0x89, 0x89, 0x25, 0xe3, 0xa1, 0xe6, 0x98, 0x61, 0xd0, 0xb9,
+    0x40, 0x25, 0x48, 0x35, 0x9e, 0xda, 0x6e, 0x2c, 0x38, 0xf6, 0x94, 0x41, 0xab, 0x57, 0xac, 0x6b,
+    0xb5, 0xbb, 0xb8, 0x5b, 0x05, 0x1a, 0x26, 0x53, 0xd0, 0xdd, 0x64, 0x8d, 0xf8, 0x75, 0xf7, 0xcf,
+    0x2c, 0x51, 0x41, 0x1b, 0x15, 0xf8, 0xf2, 0xec, 0xdf, 0x67, 0xf4, 0xfe, 0x4b, 0x83, 0x1c, 0x34,
+    0x70, 0xa6, 0x5b, 0x03, 0x36, 0x29, 0x59, 0x1b, 0x27, 0xdd, 0xf8, 0xab, 0xde, 0xb2, 0x46, 0x05,
+    0x04, 0xc6, 0x32, 0x97, 0x6d, 0x28, 0x89, 0x83, 0xec, 0xf7, 0xf5, 0x1f, 0xc4, 0x4e, 0x5d, 0x57,
+    0x3c, 0x35, 0xa4, 0xaf, 0x82, 0x01, 0x82, 0xa0, 0x73, 0x9f, 0x9d, 0xfe, 0xfe, 0x13, 0x5e, 0x56,
+    0xd1, 0x3a, 0x64, 0xca, 0x3e, 0xb8, 0xaf, 0xea, 0xde, 0x9f, 0x22, 0xc0, 0xd6, 0x79, 0x65, 0xe7,
+    0x5d, 0x9e, 0x29, 0x1d, 0x46, 0x26, 0x2c, 0x2a, 0xc4, 0x90, 0xc3, 0x6c, 0xf8, 0x40, 0x41, 0x35,
+    0x2e, 0x1c, 0x09, 0xdb, 0xfa, 0x7b, 0x67, 0xa7, 0x6f, 0x78, 0x5f, 0xf3, 0x57, 0xfa, 0xb4, 0x47,
+    0x7e, 0x4a, 0x0b, 0xbb, 0x02, 0x53, 0xa4, 0xa6, 0xff, 0x50, 0xc0, 0x2d, 0x2d, 0x74, 0x86, 0x0a,
+    0x87, 0x0a, 0x2f, 0xc2, 0x90, 0x75, 0x95, 0x07, 0x54, 0x92, 0x89, 0x69, 0xa6, 0x7a, 0x00, 0x5a,
+    0x12, 0xf9, 0xf1, 0x67, 0x04, 0x2d, 0x97, 0x84, 0xe8, 0x00, 0x7c, 0xda, 0x90, 0xa9, 0xba, 0x74,
+    0xae, 0x9b, 0x73, 0xa9, 0x8c, 0xe6, 0x34, 0x4e, 0xc2, 0xdf, 0xa1, 0x05, 0xd1, 0x69, 0xdc, 0xc2,
+    0x87, 0x00, 0x97, 0xf1, 0x30, 0x47, 0xa7, 0x40, 0x47, 0xb5, 0x3e, 0x7a, 0x60, 0x33, 0xea, 0x06,
+    0x2e, 0x4b, 0x71, 0x14, 0x9d, 0x61, 0x7a, 0x8f, 0x28, 0xdb, 0x91, 0x35, 0xac, 0xe9, 0x7e, 0xc8,
+    0xba, 0x11, 0x7a, 0x73, 0x9b, 0x5c, 0x6c, 0x2e, 0x62, 0x9e, 0xe4, 0x26, 0xa8, 0xb2, 0x79, 0x40,
+    0x1f, 0xee, 0xfb, 0x3b, 0x8c, 0xf7, 0xdc, 0xd8, 0x26, 0x7e, 0x44, 0x79, 0xd9, 0x67, 0x9c, 0x71,
+    0xcf, 0x7f, 0x34, 0xee, 0xb9, 0xff, 0x6e, 0xf9, 0x1f, 0xb4, 0x23, 0x79, 0xd4, 0x86, 0x19, 0x00,
+    0x00,
+};
+
+// portal/success.html: 808 bytes, 475 gzipped
+#define SUCCESS_HTML_ETAG "\"e9238d0d80f8\""
+const size_t SUCCESS_HTML_GZ_LEN = 475;
+const uint8_t SUCCESS_HTML_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x6d, 0x52, 0xc1, 0x6e, 0xdb, 0x30,
+    0x0c, 0xbd, 0xe7, 0x2b, 0xd8, 0xec, 0xb2, 0x01, 0x71, 0x1c, 0xaf, 0xdd, 0xc5, 0x71, 0x02, 0x14,
+    0xe9, 0x8a, 0x0d, 0xd8, 0xb0, 0x01, 0x0d, 0x30, 0xf4, 0xc8, 0x58, 0xb4, 0x4d, 0x54, 0x91, 0x0c,
+    0x89, 0x89, 0x13, 0x0c, 0xfb, 0xf7, 0x51, 0x4e, 0x5a, 0xec, 0x30, 0xe8, 0x40, 0x91, 0x22, 0x1f,
+    0x1f, 0x1f, 0x55, 0xdd, 0x3c, 0xfc, 0xd8, 0x6c, 0x9f, 0x7f, 0x7e, 0x86, 0x2f, 0xdb, 0xef, 0xdf,
+    0xd6, 0x93, 0xaa, 0x93, 0xbd, 0x4d, 0x86, 0xd0, 0xa8, 0x11, 0x16, 0x4b, 0xeb, 0x8d, 0x77, 0x0d,
+    0xb7, 0x87, 0x80, 0xc2, 0xde, 0xc1, 0x13, 0x1e, 0xc9, 0x54, 0xf9, 0xe5, 0x69, 0x52, 0xed, 0x49,
+    0x10, 0x1c, 0xee, 0x69, 0x35, 0x3d, 0x32, 0x0d, 0xbd, 0x0f, 0x32, 0x85, 0xda, 0x3b, 0x21, 0x27,
+    0xab, 0xe9, 0xc0, 0x46, 0xba, 0x95, 0xa1, 0x23, 0xd7, 0x94, 0x8d, 0xce, 0x0c, 0xd8, 0xb1, 0x30,
+    0xda, 0x2c, 0xd6, 0x68, 0x69, 0x55, 0x4c, 0x15, 0x24, 0xca, 0x39, 0x81, 0xed, 0xbc, 0x39, 0xc3,
+    0x6f, 0x68, 0xb4, 0x3a, 0x6b, 0x70, 0xcf, 0xf6, 0x5c, 0xc2, 0x7d, 0xd0, 0xdc, 0x19, 0x44, 0x74,
+    0x31, 0x8b, 0x14, 0xb8, 0x59, 0xc2, 0x1e, 0x43, 0xcb, 0xae, 0x84, 0xbb, 0x45, 0x7f, 0x5a, 0xc2,
+    0x0e, 0xeb, 0x97, 0x36, 0xf8, 0x83, 0x33, 0x25, 0xbc, 0x6b, 0x16, 0xe9, 0x2c, 0x41, 0xe8, 0x24,
+    0x19, 0x5a, 0x6e, 0x35, 0xad, 0x56, 0x26, 0x14, 0x96, 0xf0, 0x67, 0x32, 0x4f, 0xbc, 0x90, 0x1d,
+    0x05, 0xed, 0xf2, 0x6f, 0xdd, 0xd0, 0xb1, 0xd0, 0x12, 0x7a, 0x34, 0x86, 0x5d, 0x5b, 0xc2, 0xed,
+    0x05, 0xd9, 0x07, 0x43, 0x21, 0x0b, 0x68, 0xf8, 0x10, 0x4b, 0x28, 0xae, 0xc1, 0x53, 0x16, 0x3b,
+    0x34, 0x7e, 0x28, 0x61, 0x01, 0x1f, 0xfb, 0xd3, 0x18, 0x87, 0xd0, 0xee, 0xf0, 0xfd, 0x62, 0x36,
+    0x9e, 0x79, 0xf1, 0x21, 0x75, 0xeb, 0x0a, 0xed, 0x52, 0x7b, 0xeb, 0x83, 0x12, 0xbb, 0xdb, 0xdc,
+    0x3f, 0x7e, 0x5a, 0xa4, 0x70, 0x95, 0x5f, 0xa7, 0xad, 0xf2, 0xab, 0xca, 0x69, 0x6c, 0x35, 0x86,
+    0x8f, 0x50, 0x5b, 0x8c, 0x71, 0x35, 0x7d, 0xe3, 0x99, 0xc4, 0xe9, 0x8a, 0xff, 0x6d, 0xe0, 0x46,
+    0xcb, 0x0b, 0x7d, 0xed, 0xd7, 0xcf, 0xfe, 0x10, 0x60, 0x9b, 0x3d, 0x70, 0xec, 0x2d, 0x9e, 0xe1,
+    0xe9, 0x16, 0x06, 0xb6, 0x16, 0x9c, 0x1f, 0x20, 0x50, 0x14, 0x0c, 0x02, 0xe8, 0x4c, 0xda, 0x89,
+    0xa3, 0x5a, 0x40, 0x3c, 0x48, 0x47, 0xc9, 0x1d, 0x21, 0xc9, 0xc0, 0x2f, 0x7e, 0x64, 0x70, 0x24,
+    0x83, 0x0f, 0x2f, 0xf3, 0x2a, 0xef, 0x47, 0xd4, 0xaf, 0x0d, 0x20, 0x28, 0x41, 0x01, 0x8e, 0x10,
+    0x0e, 0xce, 0xa9, 0x30, 0xba, 0x3b, 0x79, 0xc5, 0x8c, 0xe0, 0x5d, 0x4d, 0x23, 0xd4, 0x6b, 0x96,
+    0x3f, 0xaa, 0xb0, 0xa9, 0x15, 0xe9, 0xe5, 0x0c, 0x4a, 0x87, 0xc7, 0xb8, 0x0a, 0xad, 0x64, 0x2c,
+    0x99, 0x96, 0xcc, 0x1b, 0xfe, 0x56, 0x0b, 0x2f, 0xff, 0xe2, 0x42, 0x77, 0x47, 0x8a, 0x8c, 0xba,
+    0xff, 0xc6, 0x07, 0x88, 0xe2, 0xfb, 0x01, 0xa5, 0xee, 0xc0, 0xf7, 0x74, 0x9d, 0x9a, 0x9d, 0x12,
+    0x6a, 0x68, 0x80, 0x48, 0xca, 0xdd, 0xc4, 0x2b, 0x52, 0xae, 0xb2, 0x25, 0x73, 0x15, 0x31, 0xbf,
+    0x7c, 0xe0, 0xbf, 0xfd, 0x21, 0x3f, 0x2c, 0xd8, 0x02, 0x00, 0x00,
+};
+
+// portal/busy.html: 377 bytes, 266 gzipped
+#define BUSY_HTML_ETAG "\"66706e2bc218\""
+const size_t BUSY_HTML_GZ_LEN = 266;
+const uint8_t BUSY_HTML_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x45, 0x50, 0x4d, 0x4f, 0xc3, 0x30,
+    0x0c, 0xbd, 0xef, 0x57, 0x98, 0x9c, 0x57, 0xc2, 0x24, 0x4e, 0x5b, 0x5a, 0x69, 0x02, 0xa4, 0x1d,
+    0x98, 0x40, 0x6c, 0x17, 0x8e, 0x5e, 0xea, 0x36, 0x96, 0xda, 0xb4, 0x4a, 0xbc, 0x8e, 0x4a, 0xfc,
+    0x78, 0xd2, 0x16, 0xc4, 0xe9, 0xd9, 0xcf, 0x7e, 0xcf, 0x1f, 0xe6, 0xee, 0xf9, 0xed, 0xe9, 0xfc,
+    0xf9, 0xfe, 0x02, 0x87, 0xf3, 0xf1, 0xb5, 0x58, 0x19, 0x27, 0x6d, 0x33, 0x01, 0x61, 0x99, 0x40,
+    0x58, 0x1a, 0x2a, 0x0e, 0x84, 0x02, 0x1f, 0x57, 0xef, 0xd9, 0xd7, 0x46, 0x2f, 0xdc, 0xca, 0xb4,
+    0x24, 0x08, 0x1e, 0x5b, 0xca, 0xd5, 0xc0, 0x74, 0xeb, 0xbb, 0x20, 0x0a, 0x6c, 0xe7, 0x85, 0xbc,
+    0xe4, 0xea, 0xc6, 0xa5, 0xb8, 0xbc, 0xa4, 0x81, 0x2d, 0x65, 0x73, 0xb2, 0x06, 0xf6, 0x2c, 0x8c,
+    0x4d, 0x16, 0x2d, 0x36, 0x94, 0x6f, 0x54, 0x32, 0xd1, 0xbf, 0x83, 0x2e, 0x5d, 0x39, 0x42, 0x94,
+    0x31, 0xf1, 0xaa, 0x4a, 0x1e, 0x59, 0x85, 0x2d, 0x37, 0xe3, 0x16, 0xf6, 0x21, 0x29, 0xd6, 0x10,
+    0xd1, 0xc7, 0x2c, 0x52, 0xe0, 0x6a, 0x07, 0x2d, 0x86, 0x9a, 0xfd, 0x16, 0x1e, 0x1f, 0xfa, 0xaf,
+    0xdd, 0x64, 0xe2, 0x36, 0xcb, 0x8a, 0xe1, 0x6f, 0xc5, 0x44, 0xac, 0x4c, 0x5f, 0x9c, 0x48, 0x24,
+    0xe5, 0x11, 0x2c, 0x7a, 0xb8, 0x10, 0x58, 0x87, 0xbe, 0xa6, 0x12, 0x3a, 0x6f, 0x09, 0xc4, 0x11,
+    0xb8, 0x49, 0xc5, 0x11, 0xba, 0x81, 0xc2, 0xbd, 0xd1, 0xfd, 0xac, 0x32, 0x08, 0x2e, 0x50, 0x95,
+    0x2b, 0x1d, 0x05, 0xe5, 0x1a, 0x55, 0x71, 0x9a, 0xd1, 0x68, 0x2c, 0xe0, 0x1b, 0xfe, 0xcb, 0xe9,
+    0x01, 0x81, 0x6d, 0xaa, 0x1f, 0x97, 0x60, 0x6a, 0x58, 0x4c, 0xf4, 0x74, 0xce, 0x7c, 0xdd, 0xfc,
+    0xcd, 0x1f, 0xad, 0x38, 0x63, 0x1f, 0x65, 0x01, 0x00, 0x00,
+};
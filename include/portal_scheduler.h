@@ -0,0 +1,78 @@
+/**
+ * Portal Scheduler for T-Display S3 Stopwatch
+ *
+ * The maintenance portal runs inside the main loop, next to the timing path.
+ * A split is stamped when the loop gets to the button event, so any time
+ * spent in WebServer::handleClient() while the button is pressed is added
+ * to the split. PortalScheduler keeps that bounded:
+ *
+ * - The portal is serviced at most every IDLE_INTERVAL_US between heats,
+ *   and every RUNNING_INTERVAL_US while a heat is running.
+ * - A service that overruns SLICE_BUDGET_US pushes the next one out in
+ *   proportion. A slow client then gets fewer turns instead of more loop
+ *   time, and the portal's duty cycle stays bounded.
+ *
+ * LatencyHistogram counts durations (loop gaps, button to split) in
+ * power-of-two µs buckets for the portal's /metrics page.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/portal_slice_sim.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class PortalScheduler {
+public:
+    static const uint32_t IDLE_INTERVAL_US = 20000;
+    static const uint32_t RUNNING_INTERVAL_US = 50000;
+    static const uint32_t SLICE_BUDGET_US = 3000;
+
+    PortalScheduler();
+
+    // Whether the portal may run now
+    bool due(uint32_t nowUs) const { return (int32_t)(nowUs - nextUs) >= 0; }
+
+    // One service ran from startUs to endUs
+    void serviced(uint32_t startUs, uint32_t endUs, bool timingActive);
+
+    uint32_t getServices() const { return services; }
+    uint32_t getOverruns() const { return overruns; }
+    uint32_t getMaxServiceUs() const { return maxServiceUs; }
+    uint64_t getTotalServiceUs() const { return totalServiceUs; }
+
+private:
+    uint32_t nextUs;
+    uint32_t services;
+    uint32_t overruns;
+    uint32_t maxServiceUs;
+    uint64_t totalServiceUs;
+};
+
+class LatencyHistogram {
+public:
+    static const uint8_t BUCKETS = 16;      // <= 1 µs ... <= 32.8 ms, then overflow
+
+    LatencyHistogram();
+
+    void add(uint32_t us);
+    void clear();
+
+    uint32_t getCount() const { return count; }
+    uint32_t getMaxUs() const { return maxUs; }
+    uint64_t getTotalUs() const { return totalUs; }
+
+    // Upper bound of bucket i in µs (2^i); the last bucket has no bound
+    static uint32_t bucketLimitUs(uint8_t index) { return 1UL << index; }
+    uint32_t getBucket(uint8_t index) const { return buckets[index]; }
+
+    // Smallest bucket limit at or above the given fraction of samples
+    uint32_t quantileUs(float fraction) const;
+
+private:
+    uint32_t buckets[BUCKETS + 1];
+    uint32_t count;
+    uint32_t maxUs;
+    uint64_t totalUs;
+};
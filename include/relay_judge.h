@@ -0,0 +1,110 @@
+/**
+ * Relay Takeoff Judge for T-Display S3 Stopwatch
+ *
+ * At a relay exchange the outgoing swimmer may leave the block only once
+ * the incoming swimmer has touched. The lane device at the start end sees
+ * both: the touch on GPIO2, and a block switch that is closed while the
+ * outgoing swimmer stands on it. Both interrupts take micros() on entry
+ * and queue the raw edges in time order; this class pairs them up.
+ *
+ * - A block release counts once the block has been occupied for
+ *   ARM_SETTLE_US. Switch bounce after a release, or while a swimmer steps
+ *   up, never lasts that long. Touches within TOUCH_DEBOUNCE_US of the
+ *   previous one are pad chatter.
+ * - A release pairs with a touch up to LATE_WINDOW_US before it (a legal
+ *   exchange) or, if there is none, with the first touch up to
+ *   EARLY_WINDOW_US after it (an early takeoff). Turn touches at this end
+ *   are a whole length away from either.
+ * - The margin is release minus touch. A takeoff more than the tolerance
+ *   before the touch is flagged early. A release that no touch follows is
+ *   reported as such once the early window has passed (poll()), except
+ *   the lead-off swimmer's start within LEAD_OFF_US of the heat start.
+ *
+ * Times are micros() and wrap after 71 minutes; only differences are used.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/relay_sim.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum RelayEdgeKind : uint8_t {
+    RELAY_TOUCH,            // Touch pad (GPIO2)
+    RELAY_BLOCK_OFF,        // Block switch opened: nobody on the block
+    RELAY_BLOCK_ON          // Block switch closed
+};
+
+struct RelayEdge {
+    uint32_t us;            // micros() at the interrupt
+    RelayEdgeKind kind;
+};
+
+enum RelayVerdict : uint8_t {
+    RELAY_OK,
+    RELAY_EARLY,
+    RELAY_NO_TOUCH          // Release with no touch to pair it with
+};
+
+const char* relayVerdictName(RelayVerdict verdict);    // "ok" / "early" / "no-touch"
+
+struct RelayExchange {
+    uint8_t number;         // 1 = first exchange (the second swimmer leaves)
+    RelayVerdict verdict;
+    uint32_t touchUs;       // Raw edges (touchUs is 0 with RELAY_NO_TOUCH)
+    uint32_t releaseUs;
+    int32_t marginUs;       // Release minus touch: negative = left before the touch
+};
+
+class RelayJudge {
+public:
+    static const uint32_t ARM_SETTLE_US = 200000;
+    static const uint32_t TOUCH_DEBOUNCE_US = 300000;
+    static const uint32_t LATE_WINDOW_US = 3000000;
+    static const uint32_t EARLY_WINDOW_US = 1000000;
+    static const uint32_t LEAD_OFF_US = 5000000;
+    static const uint8_t HISTORY = 8;
+
+    RelayJudge();
+
+    // Heat start (micros()); blockOccupied is the switch now, as no edge
+    // will say so. Clears the exchanges
+    void begin(uint32_t startUs, uint32_t toleranceUs, bool blockOccupied);
+    void end();
+    bool isRunning() const { return running; }
+
+    // Edges in the order they happened
+    void addEdge(const RelayEdge& edge);
+
+    // Close a release whose touch never came (call every loop)
+    void poll(uint32_t nowUs);
+
+    // Exchanges so far; the last HISTORY are kept (newest: count - 1)
+    uint8_t getExchangeCount() const { return exchangeCount; }
+    const RelayExchange& getExchange(uint8_t number) const { return exchanges[(number - 1) % HISTORY]; }
+    uint32_t getIgnoredEdges() const { return ignoredEdges; }
+
+private:
+    bool running;
+    uint32_t startUs;
+    uint32_t toleranceUs;
+
+    bool occupied;
+    uint32_t occupiedSinceUs;
+
+    bool touchWaiting;          // A touch no release has taken yet
+    bool touchSeen;
+    uint32_t lastTouchUs;
+
+    bool releaseWaiting;        // A release waiting for its touch
+    uint32_t releaseUs;
+
+    RelayExchange exchanges[HISTORY];
+    uint8_t exchangeCount;
+    uint32_t ignoredEdges;
+
+    void touch(uint32_t us);
+    void release(uint32_t us);
+    void record(RelayVerdict verdict, uint32_t touchUs, uint32_t releaseUs);
+};
@@ -0,0 +1,30 @@
+/**
+ * RTC Retention for T-Display S3 Stopwatch
+ *
+ * Checksum shared by the records kept in RTC memory across a warm reboot
+ * or deep sleep: the time sync prior (sync_retention.cpp), the DORMANT
+ * session (dormant_state.cpp) and the split journal (split_journal.h).
+ * That memory is not cleared at power-on, so each record is only trusted
+ * if its magic number and its checksum over the bytes before the checksum
+ * field both match. Records are zeroed before they are filled, as their
+ * padding is part of the checksum.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/journal_sim.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// FNV-1a over the first length bytes of a record, usually
+// offsetof(Record, checksum)
+inline uint32_t rtcChecksum(const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,120 @@
+/**
+ * Split Board for T-Display S3 Stopwatch
+ *
+ * What a device knows about other devices' splits. Each lane can have a
+ * timing device at the start end and one at the turn end of a 50 m pool,
+ * so splits are addressed by (lane, position).
+ *
+ * SplitRegistry keeps the latest split per (lane, position) in an array
+ * sorted by that key. It grows as new devices show up, up to MAX_ENTRIES,
+ * so the lane count is no longer fixed at build time. Lookups use binary
+ * search.
+ *
+ * Both live in the heat arena (heat_arena.h): begin() carves them from the
+ * current heat, and the arena's reset at the end of the heat releases them.
+ *
+ * SplitFeed is the scoreboard's merged view: the most recent splits from
+ * both ends in time order. The two ends deliver splits in two separate
+ * streams, so a split can arrive after a later one from the other end. The
+ * insert point is found by binary search. Only entries that are newer in
+ * time are moved, which is none when splits arrive in order (the usual
+ * case). The oldest entry drops out when the feed is full.
+ *
+ * A split undone at its device is taken out of both: the feed drops it, and
+ * the registry goes back to that device's previous split still in the feed.
+ *
+ * Pure logic, no Arduino dependencies.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "heat_arena.h"
+#include "ws_protocol.h"
+
+enum SplitPosition : uint8_t {
+    POSITION_START,     // Start end (and finish of even-length races)
+    POSITION_TURN       // Turn end of a 50 m pool
+};
+
+const char* splitPositionName(SplitPosition position);      // "start" / "turn"
+SplitPosition splitPositionFromName(const char* name);      // Unknown or missing: start
+
+struct SplitRecord {
+    uint64_t timestamp;     // Server time of the touch
+    uint8_t lane;
+    SplitPosition position;
+    uint16_t count;         // Splits from this device in the current heat (registry only)
+    char time[12];          // Server-formatted race time ("mm:ss:cc")
+};
+
+class SplitRegistry {
+public:
+    static const uint16_t INITIAL_ENTRIES = 8;
+    static const uint16_t MAX_ENTRIES = WS_MAX_LANES * 2;   // Every lane, both ends
+
+    // Empty registry in the current heat
+    void begin(HeatArena& arena);
+
+    // Latest split for (lane, position). Adds the device if it is new.
+    // Returns nullptr only if the registry is full or out of memory
+    const SplitRecord* record(uint8_t lane, SplitPosition position, uint64_t timestamp, const char* time);
+
+    const SplitRecord* find(uint8_t lane, SplitPosition position) const;
+
+    // Split at timestamp was undone. If it is the latest one for (lane,
+    // position), previous (nullptr: none known) takes its place
+    void retract(uint8_t lane, SplitPosition position, uint64_t timestamp, const SplitRecord* previous);
+
+    // Entries in (lane, position) order
+    uint16_t size() const { return entries.size(); }
+    const SplitRecord& at(uint16_t index) const { return entries[index]; }
+
+    // Forget all splits; the storage is kept for the rest of the heat
+    void clear() { entries.clear(); }
+
+private:
+    ArenaVector<SplitRecord> entries;
+
+    uint16_t lowerBound(uint16_t key) const;
+
+    static uint16_t keyOf(uint8_t lane, SplitPosition position) { return (uint16_t)(lane << 1 | position); }
+};
+
+class SplitFeed {
+public:
+    static const uint16_t DEFAULT_CAPACITY = 32;
+
+    SplitFeed();
+
+    // Empty feed in the current heat; false if the arena is exhausted
+    bool begin(HeatArena& arena, uint16_t capacity = DEFAULT_CAPACITY);
+
+    void insert(const SplitRecord& split);
+
+    // Takes out the split of (lane, position) at timestamp; false if not kept
+    bool remove(uint8_t lane, SplitPosition position, uint64_t timestamp);
+
+    // Latest kept split of (lane, position), nullptr if none
+    const SplitRecord* latestOf(uint8_t lane, SplitPosition position) const;
+
+    uint16_t size() const { return live() ? count : 0; }
+    // 0 = earliest kept split
+    const SplitRecord& at(uint16_t index) const { return ring[(head + index) % capacity]; }
+    // 0 = latest split
+    const SplitRecord& latest(uint16_t index) const { return at(count - 1 - index); }
+
+    void clear() { head = 0; count = 0; }
+
+private:
+    const HeatArena* arena;
+    uint32_t gen;
+    SplitRecord* ring;
+    uint16_t capacity;
+    uint16_t head;
+    uint16_t count;
+
+    bool live() const { return arena && arena->generation() == gen; }
+    SplitRecord& slot(uint16_t index) { return ring[(head + index) % capacity]; }
+};
@@ -0,0 +1,110 @@
+/**
+ * Split Journal for T-Display S3 Stopwatch
+ *
+ * Every split this device records, until the server has acknowledged it.
+ * Splits get an id that is never reused, even after an undo, so the server
+ * can de-duplicate retransmits and apply corrections by (device, heat, id).
+ *
+ * An undo does not remove the split. It marks the entry as retracted, and
+ * the entry then waits for the server to acknowledge the tombstone instead
+ * of the split. A retransmit of the split that was already in flight can
+ * still reach the server after the tombstone. The server keeps the
+ * tombstone, so the split stays retracted.
+ *
+ * Entries live in a ring indexed by id, so append, retract and acknowledge
+ * are O(1). Retransmit walks the unsettled entries from the oldest one.
+ * The unsettled count is kept as entries change and rebuilt once from the
+ * ring when retained storage is attached, so checking it is O(1).
+ * The ring is kept in caller-provided storage, which the firmware places
+ * in RTC memory to survive a warm reboot or deep sleep. Each entry carries
+ * its own checksum, so an update rewrites one entry and never the whole
+ * journal.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/journal_sim.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+class SplitJournal {
+public:
+    static const uint16_t CAPACITY = 64;            // Unacknowledged splits kept
+    static const uint32_t RETRANSMIT_MS = 2000;
+
+    enum Flags : uint8_t {
+        SPLIT_ACKED = 0x01,     // Server has the split
+        RETRACTED = 0x02,       // Undone on the device
+        UNDO_ACKED = 0x04       // Server has the tombstone
+    };
+
+    struct Entry {
+        uint64_t timestamp;     // Server time of the touch
+        uint64_t heatStart;     // Server start time of the heat it belongs to
+        uint32_t id;
+        uint32_t sentMs;        // Last (re)transmission, local ms; 0 = due now
+        uint32_t createdMs;     // Local ms of the touch, for the undo window
+        uint16_t uncertaintyMs;
+        uint8_t quality;        // SyncQuality
+        uint8_t flags;
+        uint32_t check;         // rtcChecksum() over the fields above
+
+        bool isRetracted() const { return flags & RETRACTED; }
+        bool isSettled() const {
+            return (flags & RETRACTED) ? (flags & UNDO_ACKED) != 0 : (flags & SPLIT_ACKED) != 0;
+        }
+    };
+
+    struct Storage {
+        uint32_t magic;
+        uint32_t nextId;
+        uint32_t oldestId;      // Nothing before this is unsettled
+        uint32_t check;
+        Entry entries[CAPACITY];
+    };
+
+    SplitJournal();
+
+    // Use storage retained across a reboot if it is intact, else start
+    // empty with ids from firstId (random, so a cold boot in the middle
+    // of a heat cannot reuse ids the server has already seen).
+    // Returns the number of unsettled entries recovered
+    uint16_t attach(Storage* storage, uint32_t firstId);
+
+    // New split; the oldest entry is overwritten if all CAPACITY are unsettled
+    const Entry* append(uint64_t timestamp, uint64_t heatStart, uint16_t uncertaintyMs, uint8_t quality,
+                        uint32_t nowMs);
+
+    // Entry for id if it is still in the ring
+    const Entry* find(uint32_t id) const;
+
+    // Most recent split that is not retracted, nullptr if none
+    const Entry* latest() const;
+
+    // Undo: true if id was live and is now retracted
+    bool retract(uint32_t id);
+
+    // Server acknowledged the split (undo = false) or its tombstone
+    void acknowledge(uint32_t id, bool undo);
+
+    // Next entry whose split or tombstone is due for (re)transmission, in
+    // id order. Call markSent() after sending it; nullptr when none is due
+    const Entry* nextDue(uint32_t nowMs);
+    void markSent(uint32_t id, uint32_t nowMs);
+
+    uint16_t getUnsettledCount() const { return unsettled; }
+    uint32_t getOverwrittenCount() const { return overwritten; }
+
+private:
+    Storage* store;
+    uint32_t overwritten;
+    uint16_t unsettled;
+
+    Entry* slot(uint32_t id) const { return &store->entries[id % CAPACITY]; }
+    Entry* live(uint32_t id) const;
+    void seal(Entry& entry);
+    void sealHeader();
+    void advanceOldest();
+};
@@ -0,0 +1,26 @@
+#ifndef SYNC_RETENTION_H
+#define SYNC_RETENTION_H
+
+#include <Arduino.h>
+#include "clock_sync.h"
+
+// Longest reboot or sleep gap a retained estimate is trusted across
+#define SYNC_RETENTION_MAX_GAP_MS (6UL * 60 * 60 * 1000)
+
+// Bound on the gap measurement. The RTC timer runs from the internal RC slow
+// clock (there is no 32 kHz crystal); it is calibrated against the main
+// crystal at boot, but temperature still moves it by a few hundred ppm
+#define SYNC_RETENTION_GAP_BOUND_PPM 500.0f
+
+// Keep the time sync estimate in RTC slow memory, which survives warm
+// reboots and deep sleep (not a power cycle). The gap is measured with the
+// RTC timer behind gettimeofday(), which keeps running through both.
+void syncRetentionSave(const ClockSync& sync, uint32_t localMs);
+
+// Restore a saved estimate into sync with the uncertainty widened by the
+// gap. Returns false when nothing valid was retained
+bool syncRetentionRestore(ClockSync& sync, uint32_t localMs);
+
+void syncRetentionClear();
+
+#endif // SYNC_RETENTION_H
@@ -0,0 +1,24 @@
+/**
+ * Time Formatting for T-Display S3 Stopwatch
+ *
+ * Elapsed times as the display and the serial log show them, written into
+ * the caller's buffer (no heap). Minutes do not wrap: from 100 minutes on
+ * they take three digits.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/firmware_bench.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Longest result for any uint32_t, with the NUL ("71582:47:29")
+#define TIME_FORMAT_SIZE 12
+
+// "MM:SS:CC", hundredths: splits, and the stopwatch once stopped
+void formatCentiseconds(uint32_t milliseconds, char* buffer, size_t size);
+
+// "MM:SS:T", tenths: the running stopwatch
+void formatTenths(uint32_t milliseconds, char* buffer, size_t size);
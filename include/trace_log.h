@@ -0,0 +1,79 @@
+/**
+ * Trace Log for T-Display S3 Stopwatch
+ *
+ * Fixed-size ring buffer of timing events (connect, sync, start, split).
+ * Every record carries both the local timestamp (esp_timer, µs since boot)
+ * and the synchronized server time, plus the offset estimate in effect, so
+ * traces from several devices can be merged onto one timeline on the host
+ * (see tools/trace_merge.py).
+ *
+ * The records are bulk memory (PSRAM): they are written once per event and
+ * only read back for a dump. Nothing is recorded before begin().
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+// Trace event identifiers
+enum TraceEvent : uint8_t {
+    TRACE_WS_CONNECTED,
+    TRACE_WS_DISCONNECTED,
+    TRACE_SYNC_SAMPLE,      // arg: round-trip time in ms
+    TRACE_START_SENT,       // Starter pressed start
+    TRACE_START_RECEIVED,   // Start message arrived from server
+    TRACE_LANE_START,       // Local stopwatch switched to running
+    TRACE_SPLIT_BUTTON,     // arg: lap number
+    TRACE_SPLIT_SENT,       // arg: lap number
+    TRACE_RESET_RECEIVED,
+    TRACE_SPLIT_UNDONE,     // arg: lap number
+    TRACE_RELAY_TOUCH,      // arg: micros() of the exchange's touch edge
+    TRACE_RELAY_RELEASE     // arg: micros() of the block release edge
+};
+
+struct TraceRecord {
+    uint64_t localUs;       // esp_timer_get_time() when recorded
+    uint64_t syncMs;        // Synchronized (server) time when recorded
+    uint64_t startTs;       // Server start timestamp of the current heat (chain id), 0 if none
+    int64_t offsetMs;       // Server time offset estimate in effect (epoch ms - local ms)
+    uint32_t arg;           // Event specific argument
+    TraceEvent event;
+    bool synced;            // Whether syncMs came from an active time sync
+};
+
+class TraceLog {
+public:
+    static const uint16_t CAPACITY = 256;
+
+    TraceLog();
+
+    // Allocates the ring; false if the memory policy refused it
+    bool begin();
+
+    void setDeviceName(const String& name);
+    const String& getDeviceName() const { return deviceName; }
+
+    // Recording
+    void record(TraceEvent event, uint64_t syncMs, int64_t offsetMs, bool synced,
+                uint64_t startTs, uint32_t arg = 0);
+    void clear();
+
+    // Access (index 0 is the oldest retained record)
+    uint16_t count() const { return recordCount; }
+    const TraceRecord& at(uint16_t index) const;
+
+    // Export: one "TRACE {json}" line per record
+    void dump(Print& out) const;
+    size_t formatRecord(const TraceRecord& rec, char* buffer, size_t size) const;
+
+    static const char* eventName(TraceEvent event);
+
+private:
+    TraceRecord* records;
+    uint16_t head;          // Next write position
+    uint16_t recordCount;
+    String deviceName;
+};
+
+// Global trace log shared by all modules
+extern TraceLog traceLog;
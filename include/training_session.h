@@ -0,0 +1,105 @@
+/**
+ * Training Session for T-Display S3 Stopwatch
+ *
+ * In training a lane holds several swimmers on staggered send-offs: the
+ * first goes at the start, the next one gapMs later, and so on. Each has
+ * their own clock from their own send-off. Touches do not say whose they
+ * are, so each is given to the swimmer who best explains it:
+ *
+ * - A swimmer's next arrival is predicted from a smoothed track of their
+ *   touches plus their lap estimate (an alpha-beta filter). The estimate
+ *   starts at the expected lap time and follows their measured laps.
+ * - Touches come round in send-off order, as swimmers do not pass at the
+ *   wall. The touch goes to the swimmer nearest their prediction, with
+ *   three quarters of a gap added for each place past the one expected
+ *   next, by a linear scan over at most MAX_SWIMMERS. A swimmer who touched
+ *   less than half a lap ago is skipped.
+ * - If a touch was missed, the prediction moves on by whole laps. The next
+ *   touch then still matches, and its split number counts the missed lap.
+ * - The session's first touch is the first swimmer's first lap, however
+ *   far it is from the expected lap. The others then start from that pace.
+ *
+ * All state is in fixed arrays, with no allocation. The last HISTORY splits
+ * are kept for the display and for undo.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/training_sim.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+struct TrainingSplit {
+    uint8_t swimmer;        // 0-based, in send-off order
+    uint8_t number;         // That swimmer's split number (1-based)
+    uint32_t elapsedMs;     // Since the swimmer's send-off
+    int32_t marginMs;       // Touch minus prediction
+};
+
+class TrainingSession {
+public:
+    static const uint8_t MAX_SWIMMERS = 8;
+    static const uint8_t HISTORY = 32;
+
+    TrainingSession();
+
+    // First send-off at startMs, the others gapMs apart
+    void begin(uint32_t startMs, uint8_t swimmers, uint32_t gapMs, uint32_t expectedLapMs);
+    void end();
+    bool isRunning() const { return swimmerCount > 0; }
+    uint8_t getSwimmerCount() const { return swimmerCount; }
+
+    // Assign a touch; nullptr if no swimmer can take it (not running, or
+    // nobody has been sent off yet)
+    const TrainingSplit* recordSplit(uint32_t nowMs);
+
+    // Retract the latest split and restore its swimmer's prediction
+    bool undoLast();
+
+    // Swimmer to watch: the earliest arrival still to come (or only just
+    // overdue); -1 if not running
+    int8_t nextExpected(uint32_t nowMs) const;
+
+    // Predicted arrival, with missed touches skipped up to nowMs
+    uint32_t predictedArrivalMs(uint8_t swimmer, uint32_t nowMs) const;
+
+    // Swimmer's own time (0 before their send-off)
+    uint32_t elapsedMs(uint8_t swimmer, uint32_t nowMs) const;
+    uint8_t getSplitCount(uint8_t swimmer) const { return swimmers[swimmer].splits; }
+    uint32_t getLastTouchMs() const { return lastTouchMs; }
+
+    // Newest first (age 0); only getHistorySize() are valid
+    uint8_t getHistorySize() const { return historySize; }
+    const TrainingSplit& latest(uint8_t age) const;
+
+private:
+    struct Swimmer {
+        uint32_t startMs;
+        uint32_t lastTouchMs;   // Send-off until the first touch
+        uint32_t trackMs;       // Smoothed time of the last touch
+        uint32_t lapMs;         // Lap estimate
+        uint8_t splits;
+    };
+
+    // What undo needs to put the swimmer back
+    struct Entry {
+        TrainingSplit split;
+        uint32_t previousTouchMs;
+        uint32_t previousTrackMs;
+        uint32_t previousLapMs;
+        uint8_t previousSplits;
+    };
+
+    Swimmer swimmers[MAX_SWIMMERS];
+    uint8_t swimmerCount;
+    uint32_t skipMs;            // Cost of each place out of order
+    uint32_t lastTouchMs;
+
+    Entry history[HISTORY];
+    uint8_t historyHead;    // Next slot to write
+    uint8_t historySize;
+
+    // Laps since the last touch that best explain a touch at nowMs (at least 1)
+    uint8_t lapsSince(const Swimmer& swimmer, uint32_t nowMs) const;
+};
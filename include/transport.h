@@ -0,0 +1,124 @@
+/**
+ * Message Transports for T-Display S3 Stopwatch
+ *
+ * The WebSocket to the server is the primary path. A Transport is any other
+ * link that carries the same JSON messages: the ESP-NOW peer link to the
+ * starter (src/espnow_transport.cpp), the USB serial link to the PC bridge
+ * (src/usb_transport.cpp) or the host loopback used to exercise the protocol
+ * without radios (src/loopback_transport.cpp).
+ *
+ * Links are star shaped. A lane sends to its upstream node (the starter,
+ * FRAME_NODE_GATEWAY, or the PC bridge, FRAME_NODE_HOST) and only accepts
+ * frames from it; the gateway sends to every lane and accepts frames from
+ * any lane. FrameTransport implements that rule together with the framing
+ * (message_frame.h), CRC check and duplicate filter, so a concrete transport
+ * only moves raw frames.
+ *
+ * LinkSelector decides per message whether the primary path or the fallback
+ * is used, with hysteresis so a flapping Wi-Fi link does not bounce traffic.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/link_sim.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "message_frame.h"
+
+class Transport {
+public:
+    virtual ~Transport() {}
+
+    virtual const char* name() const = 0;
+
+    // True while a message sent now can reach the peer
+    virtual bool isUp() const = 0;
+
+    // Send one JSON message (not NUL-terminated)
+    virtual bool send(const uint8_t* json, size_t length) = 0;
+
+    // Copy the next received JSON message into buffer (NUL-terminated).
+    // Returns its length and the sending node, or 0 when nothing is pending
+    virtual size_t receive(uint8_t* buffer, size_t size, uint8_t& source) = 0;
+
+    // Periodic housekeeping (beacons, timeouts)
+    virtual void loop(uint32_t /* nowMs */) {}
+};
+
+// Framing, star addressing and duplicate filtering shared by the peer links
+class FrameTransport : public Transport {
+public:
+    static const size_t MAX_FRAME = 250;    // ESP-NOW payload limit
+    static const size_t MAX_PAYLOAD = MAX_FRAME - FRAME_OVERHEAD;
+
+    explicit FrameTransport(uint8_t node = 0);
+
+    uint8_t getNode() const { return node; }
+    bool isGateway() const { return node == FRAME_NODE_GATEWAY; }
+    uint8_t getUpstream() const { return upstream; }
+
+    uint32_t getSentCount() const { return sent; }
+    uint32_t getReceivedCount() const { return received; }
+    uint32_t getRejectedCount() const { return rejected; }
+    uint32_t getDuplicateCount() const { return duplicates.getDuplicateCount(); }
+
+protected:
+    // Also resets the upstream: any lane for the gateway, the gateway for a lane
+    void setNode(uint8_t node);
+    void setUpstream(uint8_t node) { upstream = node; }
+
+    // Wrap a JSON message in the next frame; 0 if it does not fit frameSize
+    size_t encode(const uint8_t* json, size_t length, uint8_t* frame, size_t frameSize);
+
+    // Unwrap a received frame into buffer (NUL-terminated). 0 for corrupt
+    // frames, frames not addressed to this node, empty frames and duplicates
+    size_t accept(const uint8_t* frame, size_t length, uint8_t* buffer, size_t size, uint8_t& source);
+
+private:
+    uint8_t node;
+    uint8_t upstream;
+    uint16_t nextSeq;
+    uint32_t sent;
+    uint32_t received;
+    uint32_t rejected;
+    FrameDuplicateFilter duplicates;
+};
+
+enum LinkRoute : uint8_t {
+    ROUTE_NONE,     // Nothing up: message is dropped
+    ROUTE_PRIMARY,  // WebSocket to the server
+    ROUTE_FALLBACK, // Peer link via the gateway
+    ROUTE_WIRED     // USB to the PC bridge: preferred whenever it is up
+};
+
+class LinkSelector {
+public:
+    static const uint32_t SILENCE_MS = 8000;    // Pings go out every 5 s: a missed pong plus margin
+    static const uint32_t RECOVER_MS = 3000;    // Primary healthy this long before traffic moves back
+
+    LinkSelector();
+
+    // WebSocket (dis)connected; a fresh connection counts as heard
+    void setPrimaryUp(bool up, uint32_t nowMs);
+
+    // Any frame from the server
+    void primaryHeard(uint32_t nowMs);
+
+    // Route for a message sent now
+    LinkRoute route(uint32_t nowMs, bool fallbackUp);
+
+    bool onFallback() const { return usingFallback; }
+    uint32_t getFailoverCount() const { return failovers; }
+
+    static const char* routeName(LinkRoute route);
+
+private:
+    bool primaryUp;
+    uint32_t lastHeardMs;
+    bool healthy;
+    uint32_t healthySinceMs;
+    bool usingFallback;
+    uint32_t failovers;
+};
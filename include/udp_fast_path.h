@@ -0,0 +1,49 @@
+#ifndef UDP_FAST_PATH_H
+#define UDP_FAST_PATH_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+
+// Multicast group and port for start/reset datagrams
+#define FAST_PATH_GROUP IPAddress(239, 255, 47, 1)
+#define FAST_PATH_PORT 47000
+
+/**
+ * Receiver for signed start/reset datagrams sent by the server to the LAN.
+ *
+ * One multicast frame reaches every lane in the same Wi-Fi transmission,
+ * instead of N sequential TLS records over the WebSockets. Datagrams are only
+ * a fast path: the same message (same "seq") still arrives over the WebSocket
+ * as the reliable confirmation, and whichever copy comes second is dropped.
+ *
+ * Datagram layout: "SWF1" | HMAC-SHA256(key, json) truncated to 16 bytes | json
+ */
+class UdpFastPath {
+public:
+    static const size_t MAX_DATAGRAM = 512;
+    static const size_t TAG_LENGTH = 16;
+
+    UdpFastPath();
+
+    bool begin(const String& sharedKey, uint16_t port = FAST_PATH_PORT);
+    void stop();
+    bool isActive() const { return active; }
+
+    // Copy the next verified JSON body into buffer (NUL-terminated).
+    // Returns its length, or 0 when no valid datagram is pending.
+    size_t receive(uint8_t* buffer, size_t size);
+
+    uint32_t getAcceptedCount() const { return accepted; }
+    uint32_t getRejectedCount() const { return rejected; }
+
+private:
+    WiFiUDP udp;
+    String key;
+    bool active;
+    uint32_t accepted;
+    uint32_t rejected;
+
+    bool verify(const uint8_t* datagram, size_t length);
+};
+
+#endif // UDP_FAST_PATH_H
@@ -0,0 +1,57 @@
+#ifndef USB_TRANSPORT_H
+#define USB_TRANSPORT_H
+
+#include <Arduino.h>
+#include "transport.h"
+#include "ws_protocol.h"
+
+/**
+ * Wired link to the timing PC over the USB serial port (USB-CDC).
+ *
+ * The PC runs tools/usb_bridge.py, which opens one WebSocket to the server
+ * per device and moves the same JSON messages over this port in frames
+ * (message_frame.h). The port keeps carrying the log output: frames start
+ * with a byte that never occurs in the ASCII logs, and the bridge shows
+ * everything between frames as log text. Bytes typed into a terminal go the
+ * other way and come out of readConsole().
+ *
+ * The bridge sends an empty frame every second while its WebSocket is
+ * connected. The link is up while those keep coming, so pulling the cable
+ * or stopping the bridge hands traffic back to Wi-Fi within BRIDGE_TIMEOUT.
+ */
+class UsbTransport : public FrameTransport {
+public:
+    static const size_t MAX_FRAME_SIZE = WS_MAX_FRAME_SIZE + FRAME_OVERHEAD;
+    static const unsigned long BRIDGE_TIMEOUT = 3000;  // Three missed bridge beacons
+    static const uint8_t CONSOLE_BUFFER = 32;
+
+    UsbTransport(Stream& stream);
+
+    // node: lane number, or FRAME_NODE_GATEWAY on the starter
+    void begin(uint8_t node);
+
+    const char* name() const override { return "usb"; }
+    bool isUp() const override;
+    bool send(const uint8_t* json, size_t length) override;
+    size_t receive(uint8_t* buffer, size_t size, uint8_t& source) override;
+
+    // Next byte that was not part of a frame, -1 if none
+    int readConsole();
+
+    uint32_t getDiscardedCount() const { return decoder.getDiscardedCount(); }
+
+private:
+    Stream& stream;
+    bool active;
+    unsigned long lastBridgeMs;
+    bool bridgeHeard;
+
+    uint8_t rxBuffer[MAX_FRAME_SIZE];
+    FrameStreamDecoder decoder;
+
+    uint8_t console[CONSOLE_BUFFER];
+    uint8_t consoleHead;
+    uint8_t consoleCount;
+};
+
+#endif // USB_TRANSPORT_H
@@ -3,16 +3,18 @@
 
 #include <WebSocketsClient.h>
 #include <ArduinoJson.h>
-
-// WebSocket message types
-#define WS_MSG_PING "ping"
-#define WS_MSG_PONG "pong"
-#define WS_MSG_START "start"
-#define WS_MSG_RESET "reset"
-#define WS_MSG_SPLIT "split"
-#define WS_MSG_EVENT_HEAT "event-heat"
-#define WS_MSG_SELECT_EVENT "select-event"
-#define WS_MSG_CLEAR "clear"
+#include "trace_log.h"
+#include "ws_protocol.h"
+#include "udp_fast_path.h"
+#include "clock_sync.h"
+#include "transport.h"
+#include "split_board.h"
+#include "split_journal.h"
+#include "heat_arena.h"
+#include "relay_judge.h"
+#include "lane_readiness.h"
+#include "hot_path.h"
+#include "time_format.h"
 
 // Stopwatch states
 enum StopwatchState {
@@ -21,11 +23,22 @@ enum StopwatchState {
     STOPWATCH_PAUSED
 };
 
+// Where an incoming text frame came from
+enum FrameSource : uint8_t {
+    FROM_WEBSOCKET,
+    FROM_FAST_PATH,     // Signed UDP multicast datagram
+    FROM_PEER_LINK,     // Peer link: server traffic relayed by the starter, or a lane's uplink
+    FROM_WIRED          // USB link: the PC bridge's own WebSocket to the server
+};
+
 // Lap data structure
 struct LapData {
     uint32_t lapTimeMs;
     uint32_t totalTimeMs;
     uint64_t serverTimestamp;
+    uint16_t uncertaintyMs;     // Bound on serverTimestamp error (0xFFFF: unknown)
+    SyncQuality syncQuality;
+    uint32_t splitId;           // SplitJournal id, as sent to the server
 };
 
 class WebSocketStopwatch {
@@ -46,12 +59,17 @@ private:
     int pingMs;
     int bestPingMs; // Track best (lowest) ping time for more accurate lag compensation
     uint8_t pingSampleCount; // Number of ping samples collected
-    int64_t serverTimeOffset; // Client time offset from server time
-    bool timeSync; // Whether time synchronization is active
+    ClockSync clockSync; // Server time offset, crystal drift and holdover
     static const unsigned long RECONNECT_INTERVAL = 5000;
     static const unsigned long PING_INTERVAL = 5000; // Send ping every 5 seconds (per new spec)
     static const uint8_t MAX_PING_SAMPLES = 10; // Number of samples to consider for best ping
     
+    // Periodic sync status report (and on every sync quality change)
+    unsigned long lastStatusTime;
+    SyncQuality lastReportedQuality;
+    uint8_t batteryPercent;         // LaneReadiness::BATTERY_UNKNOWN until set
+    static const unsigned long STATUS_INTERVAL = 10000;
+    
     // Stopwatch state
     StopwatchState currentState;
     uint32_t startTimeMs;           // Local start time (for fallback)
@@ -59,25 +77,71 @@ private:
     uint64_t syncStartTime;         // Synchronized start time from server
     bool startLocked;               // Prevent multiple starts until server reset
     
-    // Event and Heat information
-    String currentEvent;
-    String currentHeat;
+    // Everything scoped to a heat comes from one arena that reset/clear
+    // releases at once, so a long gala does not fragment the heap
+    HeatArena heatArena;
     
-    // Lane and split time information
-    struct SplitTimeInfo {
-        uint8_t lane;
-        uint64_t timestamp;
-        String formattedTime;
-        bool isValid;
-    };
-    static const uint8_t MAX_LANES = 10;
-    SplitTimeInfo splitTimes[MAX_LANES];
+    // Event and Heat information (in the heat arena)
+    const char* currentEvent;
+    const char* currentHeat;
+    uint16_t eventDistanceM;        // From the heat program (0 = not given)
+    
+    // Other devices' splits: latest per (lane, position), and the
+    // time-ordered merge of both pool ends for the scoreboard view
+    SplitRegistry splitRegistry;
+    SplitFeed splitFeed;
     
     // Lap management
     static const uint8_t MAX_LAPS = 90;
     LapData laps[MAX_LAPS];
     uint8_t lapCount;
     uint8_t laneNumber;
+    SplitPosition position;         // Pool end this device times
+    
+    // Own splits until the server acknowledges them (or their undo), in RTC
+    // memory so a warm reboot or deep sleep loses none. Unacknowledged ones
+    // are resent; the server ignores copies it already has
+    SplitJournal journal;
+    uint32_t undoWindowMs;          // How long after a touch it can be undone
+    uint32_t splitRetransmits;
+    
+    // Ingress filtering
+    uint32_t subscribedTypes;       // WS_TYPE_BIT mask of message types to parse
+    bool subscribeAllLanes;         // false: lane-addressed messages only for our own lane
+    uint32_t droppedFrames;         // Oversized, malformed or unsubscribed frames
+    StaticJsonDocument<384> ingressFilter; // Fields kept when parsing a wanted frame
+    
+    // Resume state: server->device messages carry "seq"; the last one seen is
+    // presented in the subscribe on reconnect so the server can replay what we missed
+    uint32_t lastSeq;
+    uint32_t serverEpoch;           // Server instance id from the last snapshot (0 = none)
+    uint32_t duplicateFrames;
+    
+    // Signed multicast start/reset, de-duplicated against the WebSocket copy by seq.
+    // Datagrams and peer link relays can overtake earlier WebSocket messages,
+    // so their seqs are kept aside instead of advancing lastSeq. Sized for a
+    // few heats on the peer link; longer gaps resume with a snapshot anyway
+    UdpFastPath fastPath;
+    static const uint8_t OUT_OF_BAND_SEQ_SLOTS = 16;
+    uint32_t outOfBandSeqs[OUT_OF_BAND_SEQ_SLOTS];
+    uint8_t outOfBandSeqNext;
+    
+    // Fallback when the WebSocket is down or silent: lanes send splits and
+    // status to the starter over the peer link; the starter (gateway)
+    // forwards them to the server and repeats server traffic to the lanes
+    Transport* peerLink;
+    bool peerGateway;
+    LinkSelector linkSelector;
+    LinkRoute lastRoute;
+    unsigned long lastPeerUplinkTime;   // Gateway: a lane last used the peer link
+    uint32_t peerForwarded;
+    static const unsigned long PEER_RELAY_WINDOW = 30000; // Relay downlink while lanes used us this recently
+    
+    // USB to a PC running the bridge: a second in-band path to the server.
+    // While it is up all traffic (pings included, so sync is measured over
+    // the cable) goes this way; Wi-Fi stays connected as the standby
+    Transport* wiredLink;
+    bool wiredActive;
     
     // Timing
     unsigned long lastDisplayUpdate;
@@ -86,6 +150,10 @@ private:
     // WebSocket event handlers
     static void webSocketEventWrapper(WStype_t type, uint8_t* payload, size_t length);
     void handleWebSocketEvent(WStype_t type, uint8_t* payload, size_t length);
+    void handleTextFrame(uint8_t* payload, size_t length, FrameSource source);
+    void handlePeerFrame(uint8_t* payload, size_t length);
+    LinkRoute updateRoute(); // Re-evaluate primary/fallback, logging changes
+    void updateWiredLink(); // Bridge attached/detached
     void handleStartMessage(JsonDocument& doc);
     void handleResetMessage(JsonDocument& doc);
     void handleSplitMessage(JsonDocument& doc);
@@ -93,11 +161,34 @@ private:
     void handleClearMessage(JsonDocument& doc);
     void handlePingMessage(JsonDocument& doc);
     void handlePongMessage(JsonDocument& doc);
+    void handleTraceDumpMessage(JsonDocument& doc);
+    void handleSnapshotMessage(JsonDocument& doc);
+    void handleStatusMessage(JsonDocument& doc);
+    void handlePresenceMessage(JsonDocument& doc);
+    void handleProbeMessage(JsonDocument& doc);
+    void handleSplitAckMessage(JsonDocument& doc);
+    void handleSplitUndoMessage(JsonDocument& doc);
+    bool acceptSequence(JsonDocument& doc, bool outOfBand);
+    bool appliedOutOfBand(uint32_t seq);
     
     // Network and timing
-    void sendSplitTime(uint32_t elapsedTime);
+    bool sendSplitTime(const SplitJournal::Entry& split);
+    bool sendSplitUndo(const SplitJournal::Entry& split); // Tombstone for an undone split
+    void flushSplitJournal(uint32_t now); // Send what is due: new, unacknowledged or undone splits
     void sendMessage(const String& message);
+    bool sendUpstream(const uint8_t* payload, size_t length); // USB if up, else WebSocket
+    bool sendRouted(const String& message); // USB, WebSocket, or the peer link when failed over
     void sendJsonPing(); // Send JSON-based ping message
+    void sendTraceDump(); // Upload the trace log in chunks of at most one frame
+    void sendSubscribe(); // Declare wanted types/lanes and the last seen sequence number (every live link)
+    void sendStatus(); // Sync quality and error bound, for the starter's readiness gate
+    
+    // Tracing (chainTs 0 = current heat start time)
+    void recordTrace(TraceEvent event, uint32_t arg = 0, uint64_t chainTs = 0);
+    
+    // Heat arena
+    void beginHeat(); // Release the last heat's data, keeping the event/heat names
+    void setEventHeat(const char* event, const char* heat);
     
     // Time synchronization
     uint64_t getServerTime();
@@ -106,9 +197,23 @@ private:
 public:
     WebSocketStopwatch();
     
+    // Takes the heat arena's region from the memory policy
+    bool begin();
+    
     // Configuration
     void setServerConfig(const String& host, uint16_t port, const String& path = "/ws", bool ssl = true);
     void setLaneNumber(uint8_t lane);
+    void setPosition(SplitPosition position);   // Start end (default) or turn end
+    void setSubscribedTypes(uint32_t typeMask); // WS_TYPE_BIT mask, default WS_TYPES_ALL
+    void setSubscribedLanes(bool allLanes);     // Lane devices: own lane only; starter/scoreboard: all
+    void enableFastPath(const String& sharedKey); // UDP start/reset; empty key leaves it off
+    void setPeerLink(Transport* link, bool gateway); // Fallback link (gateway: the starter's end)
+    void setWiredLink(Transport* link);           // USB to the PC bridge
+    void setDriftCalibration(float ppm);          // Crystal drift learned in an earlier session
+    bool restoreSyncState();                      // Time sync retained across reboot/deep sleep
+    void setUndoWindow(uint32_t ms);              // 0: splits cannot be undone
+    void setBatteryPercent(uint8_t percent);      // Reported with the status, for the starter's roster
+    void restoreSession(uint32_t seq, uint32_t epoch, const String& event, const String& heat); // Wake from DORMANT, before connect()
     
     // Connection management
     bool connect();
@@ -121,6 +226,9 @@ public:
     void stop();
     void reset();
     void addLap();
+    void addLap(uint32_t touchUs);   // Split at the touch (micros() from the interrupt)
+    bool undoLastSplit();   // Retract the latest split of this heat if within the undo window
+    void sendRelayExchange(const RelayExchange& exchange); // Trace both raw edges, report the verdict
     
     // Starter control (client -> server)
     void sendStart(const String& event, const String& heat);
@@ -131,10 +239,22 @@ public:
     uint8_t getLapCount();
     const LapData* getLaps();
     bool hasServerTime();
+    SyncQuality getSyncQuality();
+    uint32_t getSyncUncertaintyMs();
     String getCurrentEvent();
     String getCurrentHeat();
-    const SplitTimeInfo* getSplitTimes();
+    uint16_t getEventDistance(); // Metres, when the server's heat program gives it (else 0)
+    const SplitRegistry& getSplitRegistry();
+    const SplitFeed& getSplitFeed();
+    const HeatArena& getHeatArena();
     int getPingMs(); // Get current ping time in milliseconds
+    uint32_t getDroppedFrameCount();
+    uint32_t getLastSequence();
+    uint32_t getServerEpoch();
+    bool isOnPeerLink();            // Lane: messages currently go via the starter
+    bool isOnWiredLink();           // Messages currently go over USB
+    bool isAwaitingStart();         // Session up and subscribed to start/reset: a start can come any time
+    uint16_t getUnsettledSplitCount(); // Own splits (or undos) the server has not acknowledged
     
     // Display control
     void clearSplitTimes();
@@ -146,14 +266,19 @@ public:
     
     // Time formatting
     String formatTime(uint32_t milliseconds);
+    void formatTime(uint32_t milliseconds, char* buffer, size_t size); // No heap
     
     // Callbacks (to be set by main application)
     void (*onStateChanged)(StopwatchState newState);
     void (*onLapAdded)(uint8_t lapNumber, uint32_t lapTime, uint32_t totalTime);
+    void (*onLapUndone)(uint8_t lapNumber);
     void (*onConnectionChanged)(bool connected);
     void (*onTimeSync)(bool synced);
+    void (*onDriftCalibrated)(float ppm); // New drift estimate worth persisting
     void (*onEventHeatChanged)(const String& event, const String& heat);
-    void (*onSplitTimeReceived)(uint8_t lane, const String& time);
+    void (*onSplitTimeReceived)(uint8_t lane, SplitPosition position, const String& time);
+    void (*onLaneStatus)(uint8_t lane, SyncQuality quality, uint32_t uncertaintyMs);
+    void (*onLanePresence)(const PresenceDelta& delta);
     void (*onDisplayClear)();
 };
 
@@ -0,0 +1,91 @@
+/**
+ * Wi-Fi Connector for T-Display S3 Stopwatch
+ *
+ * Brings the station link up without blocking the main loop. Each attempt
+ * gets ATTEMPT_MS to associate. After a failed attempt the connector backs
+ * off for 1, 2, 4 ... up to 30 s, with up to a quarter added as jitter so a
+ * pool of lanes does not retry in step after a power blip. Meanwhile the
+ * timing UI keeps running. A link lost while connected first gets one
+ * attempt's worth of the driver's own reconnect before backoff starts.
+ *
+ * The first attempt after a DORMANT wake goes to the known AP and channel.
+ * Later attempts scan, in case the AP has moved.
+ *
+ * After portalAfter consecutive failures (0 = never), portalDue() becomes
+ * true. The firmware then opens the setup portal in AP+STA mode, and the
+ * station keeps retrying alongside it.
+ *
+ * The connector only decides. update() returns the radio action for the
+ * caller to carry out.
+ *
+ * Pure logic, no Arduino dependencies, so it also builds on the host
+ * (see tools/wifi_recovery_sim.cpp).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+enum WifiState : uint8_t {
+    WIFI_IDLE,          // begin() not called
+    WIFI_CONNECTING,    // Attempt in progress
+    WIFI_BACKOFF,       // Waiting before the next attempt
+    WIFI_CONNECTED
+};
+
+enum WifiAction : uint8_t {
+    WIFI_ACTION_NONE,
+    WIFI_ACTION_CONNECT,            // Start an attempt (with scan)
+    WIFI_ACTION_CONNECT_KNOWN_AP,   // Start an attempt on the remembered channel/BSSID
+    WIFI_ACTION_ABORT               // Stop the failed attempt (disconnect)
+};
+
+class WifiConnector {
+public:
+    static const uint32_t ATTEMPT_MS = 10000;
+    static const uint32_t BACKOFF_MIN_MS = 1000;
+    static const uint32_t BACKOFF_MAX_MS = 30000;
+
+    WifiConnector();
+
+    // Start connecting; the first update() returns the first attempt.
+    // seed varies the jitter between devices
+    void begin(uint32_t nowMs, bool knownAp, uint8_t portalAfter, uint32_t seed);
+
+    // Call every loop with the driver's link state
+    WifiAction update(uint32_t nowMs, bool linkUp);
+
+    WifiState getState() const { return state; }
+    bool isConnected() const { return state == WIFI_CONNECTED; }
+
+    // Consecutive failed attempts; reset once connected
+    uint8_t getFailures() const { return failures; }
+    uint32_t getAttempts() const { return attempts; }
+
+    // Latches once portalAfter attempts in a row have failed
+    bool portalDue() const { return portalLatched; }
+
+    // Time to the next attempt while backing off
+    uint32_t getRetryInMs(uint32_t nowMs) const;
+
+    // Length of the last outage (begin() or link loss until connected)
+    uint32_t getLastOutageMs() const { return lastOutageMs; }
+
+    static const char* stateName(WifiState state);
+
+private:
+    WifiState state;
+    bool startPending;
+    bool useKnownAp;
+    uint8_t portalAfter;
+    uint8_t failures;
+    bool portalLatched;
+    uint32_t attempts;
+    uint32_t attemptStartMs;
+    uint32_t retryAtMs;
+    uint32_t downSinceMs;
+    uint32_t lastOutageMs;
+    uint32_t rng;
+
+    uint32_t backoffMs();
+};
@@ -0,0 +1,99 @@
+#ifndef WS_PROTOCOL_H
+#define WS_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// WebSocket message types
+#define WS_MSG_PING "ping"
+#define WS_MSG_PONG "pong"
+#define WS_MSG_START "start"
+#define WS_MSG_RESET "reset"
+#define WS_MSG_SPLIT "split"
+#define WS_MSG_EVENT_HEAT "event-heat"
+#define WS_MSG_SELECT_EVENT "select-event"
+#define WS_MSG_CLEAR "clear"
+#define WS_MSG_TRACE_DUMP "trace-dump"
+#define WS_MSG_TRACE "trace"
+#define WS_MSG_SUBSCRIBE "subscribe"
+#define WS_MSG_SNAPSHOT "snapshot"
+#define WS_MSG_STATUS "status"
+#define WS_MSG_PROBE "probe"
+#define WS_MSG_PROBE_REPLY "probe-reply"
+#define WS_MSG_SPLIT_UNDO "split-undo"
+#define WS_MSG_SPLIT_ACK "split-ack"
+#define WS_MSG_RELAY "relay"    // Device -> server only: a judged relay exchange
+#define WS_MSG_PRESENCE "presence"  // Server -> starter: changed fields of one lane
+
+// Ingress limits: frames above WS_MAX_FRAME_SIZE are dropped unparsed
+#define WS_MAX_FRAME_SIZE 1024
+#define WS_MAX_TYPE_LENGTH 24
+
+// Lane numbers run 0 to WS_MAX_LANES - 1; frames for other lanes are dropped
+#define WS_MAX_LANES 64
+
+// Numeric ids for incoming message types (used for dispatch and subscriptions)
+enum WsMessageType : uint8_t {
+    WS_TYPE_UNKNOWN = 0,
+    WS_TYPE_PING,
+    WS_TYPE_PONG,
+    WS_TYPE_START,
+    WS_TYPE_RESET,
+    WS_TYPE_SPLIT,
+    WS_TYPE_EVENT_HEAT,
+    WS_TYPE_SELECT_EVENT,
+    WS_TYPE_CLEAR,
+    WS_TYPE_TRACE_DUMP,
+    WS_TYPE_SNAPSHOT,
+    WS_TYPE_STATUS,
+    WS_TYPE_PROBE,
+    WS_TYPE_SPLIT_UNDO,
+    WS_TYPE_SPLIT_ACK,
+    WS_TYPE_PRESENCE,
+    WS_TYPE_COUNT
+};
+
+#define WS_TYPE_BIT(type) (1UL << (type))
+// Every known type; WS_TYPE_UNKNOWN is never subscribed
+#define WS_TYPES_ALL (((1UL << WS_TYPE_COUNT) - 1) & ~WS_TYPE_BIT(WS_TYPE_UNKNOWN))
+
+/**
+ * Find the top-level "type" string of a JSON frame without parsing it.
+ *
+ * Single forward pass, no allocation: cost is bounded by the frame length.
+ * Nested objects/arrays and string contents are skipped, so a "type" key
+ * inside a payload field is never mistaken for the message type.
+ *
+ * @return true and a NUL-terminated copy in typeOut, false if the frame has
+ *         no usable top-level "type" (missing, not a plain string, too long)
+ */
+bool wsPeekType(const uint8_t* payload, size_t length, char* typeOut, size_t typeSize);
+
+// Map a type string to its id (WS_TYPE_UNKNOWN if not recognised)
+WsMessageType wsClassifyType(const char* type);
+
+// Type string for an id (nullptr for WS_TYPE_UNKNOWN)
+const char* wsTypeName(WsMessageType type);
+
+// Outcome of the pre-parse stage of an incoming frame
+enum WsIngressResult : uint8_t {
+    WS_INGRESS_OK = 0,      // Type peeked; it may still be WS_TYPE_UNKNOWN
+    WS_INGRESS_TOO_LARGE,   // Over WS_MAX_FRAME_SIZE, not looked at
+    WS_INGRESS_NO_TYPE      // No usable top-level "type"
+};
+
+/**
+ * Pre-parse stage run on every frame before any JSON work: the size limit,
+ * then wsPeekType() and wsClassifyType().
+ *
+ * @return WS_INGRESS_OK with the type string in typeOut and its id in type
+ */
+WsIngressResult wsScreenFrame(const uint8_t* payload, size_t length, char* typeOut, size_t typeSize,
+                              WsMessageType& type);
+
+// Top-level fields kept by the ingress filter when a wanted frame is parsed;
+// anything else the server adds (results tables etc.) is skipped
+extern const char* const WS_INGRESS_FIELDS[];
+extern const size_t WS_INGRESS_FIELD_COUNT;
+
+#endif // WS_PROTOCOL_H
@@ -1,14 +1,17 @@
 #include "button_manager.h"
 
-// Static instance pointer for interrupt handlers
-ButtonManager* ButtonManager::instance = nullptr;
-
 ButtonManager::ButtonManager() 
     : lapInterrupt(false)
-    , lastLapInterrupt(0) {
-    
-    // Set the static instance pointer
-    instance = this;
+    , undoInterrupt(false)
+    , lastLapInterrupt(0)
+    , lastUndoInterrupt(0)
+    , lapPressedUs(0)
+    , relayInputs(false)
+    , edgeHead(0)
+    , edgeTail(0)
+    , edgeOverflows(0)
+    , setupPressedSince(0)
+    , setupReported(false) {
 }
 
 bool ButtonManager::init() {
@@ -16,14 +19,26 @@ bool ButtonManager::init() {
     
     // Configure GPIO pins
     pinMode(BUTTON_LAP_PIN, INPUT_PULLDOWN);  // GPIO2 - internal pulldown (button connects to 3.3V)
+    pinMode(BUTTON_UNDO_PIN, INPUT_PULLUP);   // GPIO14 - onboard key (button connects to GND)
+    pinMode(BUTTON_SETUP_PIN, INPUT_PULLUP);  // GPIO0 - BUTTON1 (button connects to GND)
     
     Serial.println("Button pins configured");
     
-    // Attach interrupts
-    attachInterrupt(digitalPinToInterrupt(BUTTON_LAP_PIN), handleLapInterrupt, RISING);
+    // Interrupts through the IRAM GPIO ISR service, not attachInterrupt():
+    // its dispatcher runs from flash, and a touch during a flash write (NVS)
+    // or on a cold cache would wait for it
+    esp_err_t err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        Serial.printf("GPIO ISR service failed: %d\n", err);
+        return false;
+    }
+    if (!attachPin(BUTTON_LAP_PIN, GPIO_INTR_POSEDGE, handleLapInterrupt) ||
+        !attachPin(BUTTON_UNDO_PIN, GPIO_INTR_NEGEDGE, handleUndoInterrupt)) {
+        return false;
+    }
     
-    Serial.println("Button interrupts attached");
-    Serial.printf("Button pin - Lap: %d\n", BUTTON_LAP_PIN);
+    Serial.println("Button interrupts attached (IRAM)");
+    Serial.printf("Button pins - Lap: %d, Undo: %d\n", BUTTON_LAP_PIN, BUTTON_UNDO_PIN);
     Serial.printf("Debounce time: %dms\n", DEBOUNCE_TIME_MS);
     
     return true;
@@ -37,32 +52,133 @@ ButtonEvent ButtonManager::getButtonEvent() {
         return BUTTON_LAP_PRESSED;
     }
     
+    if (undoInterrupt) {
+        undoInterrupt = false;
+        Serial.println("Undo button event");
+        return BUTTON_UNDO_PRESSED;
+    }
+    
+    // A long press needs no interrupt: poll BUTTON1
+    if (digitalRead(BUTTON_SETUP_PIN) == LOW) {
+        uint32_t now = millis();
+        if (setupPressedSince == 0) {
+            setupPressedSince = now | 1;
+        } else if (!setupReported && now - setupPressedSince >= SETUP_HOLD_MS) {
+            setupReported = true;
+            Serial.println("Setup button held");
+            return BUTTON_SETUP_HELD;
+        }
+    } else {
+        setupPressedSince = 0;
+        setupReported = false;
+    }
+    
     return BUTTON_NONE;
 }
 
 void ButtonManager::clearEvents() {
     lapInterrupt = false;
+    undoInterrupt = false;
 }
 
 bool ButtonManager::isLapPressed() {
     return digitalRead(BUTTON_LAP_PIN) == HIGH;
 }
 
-// Static interrupt handlers
-void IRAM_ATTR ButtonManager::handleLapInterrupt() {
-    if (instance) {
-        instance->handleLapISR();
+void ButtonManager::enableRelayInputs() {
+    if (relayInputs) {
+        return;
     }
+    pinMode(RELAY_BLOCK_PIN, INPUT_PULLUP);
+    edgeHead = edgeTail = 0;
+    relayInputs = true;
+    attachPin(RELAY_BLOCK_PIN, GPIO_INTR_ANYEDGE, handleBlockInterrupt);
+    Serial.printf("Relay block switch on GPIO%d\n", RELAY_BLOCK_PIN);
 }
 
-// Instance interrupt handlers
-void ButtonManager::handleLapISR() {
-    uint32_t now = millis();
+bool ButtonManager::popRelayEdge(RelayEdge& edge) {
+    if (edgeTail == edgeHead) {
+        return false;
+    }
+    uint8_t tail = edgeTail;
+    edge.us = edgeUs[tail];
+    edge.kind = (RelayEdgeKind)edgeKind[tail];
+    edgeTail = (tail + 1) % EDGE_RING;
+    return true;
+}
+
+bool ButtonManager::isBlockOccupied() {
+    return relayInputs && digitalRead(RELAY_BLOCK_PIN) == LOW;
+}
+
+bool ButtonManager::attachPin(uint8_t pin, gpio_int_type_t edge, void (*handler)(void*)) {
+    gpio_num_t gpio = (gpio_num_t)pin;
+    if (gpio_set_intr_type(gpio, edge) != ESP_OK ||
+        gpio_isr_handler_add(gpio, handler, this) != ESP_OK ||
+        gpio_intr_enable(gpio) != ESP_OK) {
+        Serial.printf("GPIO%d interrupt not attached\n", pin);
+        return false;
+    }
+    return true;
+}
+
+// Static interrupt handlers
+void HOT_PATH_ATTR ButtonManager::handleLapInterrupt(void* arg) {
+    ((ButtonManager*)arg)->handleLapISR();
+}
+
+void HOT_PATH_ATTR ButtonManager::handleUndoInterrupt(void* arg) {
+    ((ButtonManager*)arg)->handleUndoISR();
+}
+
+void HOT_PATH_ATTR ButtonManager::handleBlockInterrupt(void* arg) {
+    ((ButtonManager*)arg)->handleBlockISR();
+}
+
+// Instance interrupt handlers: IRAM only, see hot_path.h
+void HOT_PATH_ATTR ButtonManager::handleLapISR() {
+    uint32_t start = hotPathCycles();
+    uint32_t us = hotPathMicros(); // First, so the relay judge sees the edge itself
+    if (relayInputs) {
+        pushEdge(us, RELAY_TOUCH); // Raw: the judge has its own debounce
+    }
     // Additional check for HIGH state to filter noise
     // Use extended debounce time for GPIO2 split button
-    if (digitalRead(BUTTON_LAP_PIN) == HIGH && 
-        now - lastLapInterrupt > DEBOUNCE_TIME_MS) {
+    if (hotPathPinHigh(BUTTON_LAP_PIN) &&
+        us - lastLapInterrupt > DEBOUNCE_TIME_MS * 1000UL) {
         lapInterrupt = true;
-        lastLapInterrupt = now;
+        lastLapInterrupt = us;
+        lapPressedUs = us;
+    }
+    hotPathProbes[HOT_PATH_TOUCH_ISR].record(hotPathCycles() - start);
+}
+
+void HOT_PATH_ATTR ButtonManager::handleUndoISR() {
+    uint32_t start = hotPathCycles();
+    uint32_t us = hotPathMicros();
+    if (!hotPathPinHigh(BUTTON_UNDO_PIN) &&
+        us - lastUndoInterrupt > DEBOUNCE_TIME_MS * 1000UL) {
+        undoInterrupt = true;
+        lastUndoInterrupt = us;
+    }
+    hotPathProbes[HOT_PATH_UNDO_ISR].record(hotPathCycles() - start);
+}
+
+void HOT_PATH_ATTR ButtonManager::handleBlockISR() {
+    uint32_t start = hotPathCycles();
+    uint32_t us = hotPathMicros();
+    pushEdge(us, hotPathPinHigh(RELAY_BLOCK_PIN) ? RELAY_BLOCK_OFF : RELAY_BLOCK_ON);
+    hotPathProbes[HOT_PATH_BLOCK_ISR].record(hotPathCycles() - start);
+}
+
+void HOT_PATH_ATTR ButtonManager::pushEdge(uint32_t us, RelayEdgeKind kind) {
+    uint8_t head = edgeHead;
+    uint8_t next = (head + 1) % EDGE_RING;
+    if (next == edgeTail) {
+        edgeOverflows++; // The loop drains every pass; only a stall gets here
+        return;
     }
+    edgeUs[head] = us;
+    edgeKind[head] = kind;
+    edgeHead = next;
 }
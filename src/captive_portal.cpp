@@ -1,120 +1,70 @@
 #include "captive_portal.h"
 
-// HTML for the configuration page
-const char CONFIG_HTML[] PROGMEM = R"rawliteral(
-<!DOCTYPE HTML>
-<html>
-<head>
-    <title>T-Display S3 Setup</title>
-    <meta name="viewport" content="width=device-width, initial-scale=1">
-    <style>
-        body { font-family: Arial, sans-serif; margin: 40px; background: #f0f0f0; }
-        .container { background: white; padding: 30px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }
-        h1 { color: #333; text-align: center; }
-        input, select { width: 100%; padding: 12px; margin: 8px 0; border: 1px solid #ddd; border-radius: 4px; box-sizing: border-box; }
-        input[type="submit"] { background-color: #4CAF50; color: white; cursor: pointer; }
-        input[type="submit"]:hover { background-color: #45a049; }
-        .form-group { margin-bottom: 15px; }
-        label { display: block; margin-bottom: 5px; font-weight: bold; }
-        .inline { display:flex; gap:12px; align-items:center; }
-        .half { width: 50%; }
-    </style>
-</head>
-<body>
-    <div class="container">
-        <h1>T-Display S3 Stopwatch Setup</h1>
-        <form action="/config" method="POST">
-            <div class="form-group">
-                <label for="ssid">WiFi Network:</label>
-                <input type="text" id="ssid" name="ssid" placeholder="Enter WiFi SSID" required>
-            </div>
-            
-            <div class="form-group">
-                <label for="password">WiFi Password:</label>
-                <input type="password" id="password" name="password" placeholder="Enter WiFi Password">
-            </div>
-            
-            <div class="form-group">
-                <label for="server">WebSocket Server:</label>
-                <input type="text" id="server" name="server" value="scherm.azckamp.nl" placeholder="Server address">
-            </div>
-            
-            <div class="form-group">
-                <label for="port">Server Port:</label>
-                <input type="number" id="port" name="port" value="443" placeholder="443">
-            </div>
-            
-            <div class="form-group">
-                <label for="role">Device Role:</label>
-                <select id="role" name="role">
-                    <option value="lane" selected>Lane</option>
-                    <option value="starter">Starter</option>
-                </select>
-            </div>
-
-            <div id="laneFields" class="form-group">
-                <label for="lane">Lane Number:</label>
-                <input type="number" id="lane" name="lane" value="9" min="0" max="9" placeholder="Lane number">
-            </div>
-            <input type="submit" value="Save Configuration">
-        </form>
-    </div>
-    <script>
-        const roleSel = document.getElementById('role');
-        const laneDiv = document.getElementById('laneFields');
-        function updateRoleUI(){
-            laneDiv.style.display = (roleSel.value === 'starter') ? 'none' : 'block';
-        }
-        roleSel.addEventListener('change', updateRoleUI);
-        updateRoleUI();
-    </script>
-</body>
-</html>)rawliteral";
-
-const char SUCCESS_HTML[] PROGMEM = R"rawliteral(
-<!DOCTYPE HTML>
-<html>
-<head>
-    <title>Configuration Saved</title>
-    <meta name="viewport" content="width=device-width, initial-scale=1">
-    <style>
-        body { font-family: Arial, sans-serif; margin: 40px; background: #f0f0f0; text-align: center; }
-        .container { background: white; padding: 30px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }
-        h1 { color: #4CAF50; }
-    </style>
-</head>
-<body>
-    <div class="container">
-        <h1>Configuration Saved!</h1>
-        <p>Your T-Display S3 will now restart and connect to the configured WiFi network.</p>
-        <p>The device will be ready for stopwatch operation in a few seconds.</p>
-    </div>
-</body>
-</html>)rawliteral";
-
-CaptivePortalManager::CaptivePortalManager() : server(80), configComplete(false) {
+// Pages: portal/*.html, gzipped at build time (tools/portal_assets.py)
+#include "portal_assets.h"
+#include "ws_protocol.h"
+
+// Most networks the /scan list offers, out of the first results of the scan
+#define SCAN_MAX_NETWORKS 20
+#define SCAN_MAX_RESULTS 64
+
+CaptivePortalManager::CaptivePortalManager()
+    : server(80)
+    , configComplete(false)
+    , scanRunning(false)
+    , scanDone(false)
+    , onStatus(nullptr)
+    , onMetrics(nullptr)
+    , isTimingActive(nullptr) {
+}
+
+// Quote a value for the /settings and /scan JSON
+static String jsonString(const String& value) {
+    String quoted = "\"";
+    for (size_t i = 0; i < value.length(); i++) {
+        char c = value[i];
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if ((uint8_t)c >= 0x20) {
+            quoted += c;
+        }
+    }
+    quoted += '"';
+    return quoted;
 }
 
 CaptivePortalManager::~CaptivePortalManager() {
     stop();
 }
 
-bool CaptivePortalManager::begin() {
-    Serial.println("Starting captive portal...");
+bool CaptivePortalManager::begin(bool keepStation, const char* apName) {
+    Serial.printf("Starting captive portal %s%s...\n", apName, keepStation ? " (AP+STA, station keeps retrying)" : "");
     
-    // Start WiFi in AP mode
-    WiFi.mode(WIFI_AP);
-    WiFi.softAP("T-Display-S3-Setup", "stopwatch123");
+    // Start WiFi in AP mode; alongside the station, on its channel
+    if (keepStation) {
+        WiFi.mode(WIFI_AP_STA);
+        WiFi.softAP(apName, "stopwatch123", WiFi.channel());
+    } else {
+        WiFi.mode(WIFI_AP);
+        WiFi.softAP(apName, "stopwatch123");
+    }
     
+    // Every probe URL a phone tries is redirected here: built once
+    apAddress = WiFi.softAPIP();
+    redirectLocation = "http://" + apAddress.toString() + "/";
     Serial.print("AP IP address: ");
-    Serial.println(WiFi.softAPIP());
+    Serial.println(apAddress);
     
     // Start DNS server for captive portal
-    dnsServer.start(53, "*", WiFi.softAPIP());
+    dnsServer.start(53, "*", apAddress);
     
     // Setup web server routes
     setupWebServer();
     
+    // The network list fills in while the form is already being served
+    startScan();
+    
     // Start web server
     server.begin();
     
@@ -125,11 +75,147 @@ bool CaptivePortalManager::begin() {
 void CaptivePortalManager::setupWebServer() {
     server.on("/", [this]() { handleRoot(); });
     server.on("/config", HTTP_POST, [this]() { handleConfig(); });
+    server.on("/status", [this]() { handleStatus(); });
+    server.on("/metrics", [this]() { handleMetrics(); });
+    server.on("/settings", [this]() { handleSettings(); });
+    server.on("/scan", [this]() { handleScan(); });
     server.onNotFound([this]() { handleNotFound(); });
+    
+    // Only the header the revalidation needs is kept from each request
+    static const char* collected[] = {"If-None-Match"};
+    server.collectHeaders(collected, 1);
+}
+
+void CaptivePortalManager::sendPage(const uint8_t* page, size_t length, const char* etag) {
+    // Revalidation: the browser has this build's page, so no body
+    if (server.header("If-None-Match") == etag) {
+        server.sendHeader("ETag", etag);
+        server.send(304);
+        return;
+    }
+    server.sendHeader("Content-Encoding", "gzip");
+    server.sendHeader("Cache-Control", "no-cache");
+    server.sendHeader("ETag", etag);
+    server.send_P(200, "text/html", (PGM_P)page, length);
 }
 
 void CaptivePortalManager::handleRoot() {
-    server.send_P(200, "text/html", CONFIG_HTML);
+    if (timingActive()) {
+        sendPage(BUSY_HTML_GZ, BUSY_HTML_GZ_LEN, BUSY_HTML_ETAG);
+        return;
+    }
+    sendPage(CONFIG_HTML_GZ, CONFIG_HTML_GZ_LEN, CONFIG_HTML_ETAG);
+}
+
+void CaptivePortalManager::startScan() {
+    // A scan hops channels: not while the station carries timing traffic
+    if (WiFi.status() == WL_CONNECTED) {
+        scanJson = "[{\"ssid\":" + jsonString(WiFi.SSID()) + ",\"rssi\":" + String(WiFi.RSSI()) + ",\"secure\":true}]";
+        scanDone = true;
+        return;
+    }
+    scanRunning = WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING;
+    scanDone = !scanRunning;
+    Serial.printf("WiFi scan %s\n", scanRunning ? "started" : "failed");
+}
+
+void CaptivePortalManager::pollScan() {
+    if (!scanRunning) {
+        return;
+    }
+    int16_t found = WiFi.scanComplete();
+    if (found == WIFI_SCAN_RUNNING) {
+        return;
+    }
+    if (found > SCAN_MAX_RESULTS) {
+        found = SCAN_MAX_RESULTS;
+    }
+    scanRunning = false;
+    scanDone = true;
+    
+    // Strongest first, each name once (several APs can share one)
+    scanJson = "[";
+    uint8_t listed = 0;
+    bool used[SCAN_MAX_RESULTS];
+    for (int16_t i = 0; i < found; i++) {
+        used[i] = WiFi.SSID(i).length() == 0;
+    }
+    while (listed < SCAN_MAX_NETWORKS) {
+        int16_t best = -1;
+        for (int16_t i = 0; i < found; i++) {
+            if (!used[i] && (best < 0 || WiFi.RSSI(i) > WiFi.RSSI(best))) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        String ssid = WiFi.SSID(best);
+        for (int16_t i = 0; i < found; i++) {
+            if (!used[i] && WiFi.SSID(i) == ssid) {
+                used[i] = true;
+            }
+        }
+        scanJson += String(listed ? "," : "") + "{\"ssid\":" + jsonString(ssid) + ",\"rssi\":" + String(WiFi.RSSI(best)) +
+                    ",\"secure\":" + (WiFi.encryptionType(best) == WIFI_AUTH_OPEN ? "false" : "true") + "}";
+        listed++;
+    }
+    scanJson += "]";
+    WiFi.scanDelete();
+    Serial.printf("WiFi scan: %d networks, %u listed\n", found, listed);
+}
+
+void CaptivePortalManager::handleScan() {
+    String json = String("{\"done\":") + (scanDone ? "true" : "false") + ",\"networks\":" +
+                  (scanJson.length() ? scanJson : String("[]")) + "}";
+    server.send(200, "application/json", json);
+}
+
+void CaptivePortalManager::handleStatus() {
+    if (!onStatus) {
+        server.send(404, "text/plain", "Not available in setup mode");
+        return;
+    }
+    size_t length = onStatus(response, sizeof(response));
+    server.send_P(200, "application/json", response, length);
+}
+
+void CaptivePortalManager::handleMetrics() {
+    if (!onMetrics) {
+        server.send(404, "text/plain", "Not available in setup mode");
+        return;
+    }
+    size_t length = onMetrics(response, sizeof(response));
+    server.send_P(200, "text/plain; version=0.0.4", response, length);
+}
+
+void CaptivePortalManager::handleSettings() {
+    // Stored values for the form; the WiFi password and the fast start key stay on the device
+    Preferences prefs;
+    prefs.begin("stopwatch", true);
+    String json = "{\"ssid\":" + jsonString(prefs.getString("wifi_ssid", "")) +
+                  ",\"server\":" + jsonString(prefs.getString("ws_server", "scherm.azckamp.nl")) +
+                  ",\"port\":" + String(prefs.getUInt("ws_port", 443)) +
+                  ",\"role\":" + jsonString(prefs.getString("role", "lane")) +
+                  ",\"lane\":" + String(prefs.getUInt("lane", 9)) +
+                  ",\"position\":" + jsonString(prefs.getString("position", "start")) +
+                  ",\"undo_s\":" + String(prefs.getUInt("undo_s", 10)) +
+                  ",\"train_swimmers\":" + String(prefs.getUInt("train_swimmers", 0)) +
+                  ",\"train_gap_s\":" + String(prefs.getUInt("train_gap_s", 10)) +
+                  ",\"train_lap_s\":" + String(prefs.getUInt("train_lap_s", 30)) +
+                  ",\"distance_m\":" + String(prefs.getUInt("distance_m", 0)) +
+                  ",\"pool_m\":" + String(prefs.getUInt("pool_m", 25)) +
+                  ",\"relay\":\"" + (prefs.getBool("relay", false) ? "on" : "off") +
+                  "\",\"relay_tol_ms\":" + String(prefs.getUInt("relay_tol_ms", 30)) +
+                  ",\"start_gate\":" + jsonString(prefs.getString("start_gate", "warn")) +
+                  ",\"gate_ms\":" + String(prefs.getUInt("gate_ms", 20)) +
+                  ",\"peer_link\":\"" + (prefs.getBool("peer_link", true) ? "on" : "off") +
+                  "\",\"usb_link\":\"" + (prefs.getBool("usb_link", true) ? "on" : "off") +
+                  "\",\"dormant_min\":" + String(prefs.getUInt("dormant_min", 120)) +
+                  ",\"portal_after\":" + String(prefs.getUInt("portal_after", 6)) +
+                  ",\"maint_portal\":\"" + (prefs.getBool("maint_portal", false) ? "on" : "off") + "\"}";
+    prefs.end();
+    server.send(200, "application/json", json);
 }
 
 void CaptivePortalManager::handleConfig() {
@@ -140,26 +226,96 @@ void CaptivePortalManager::handleConfig() {
         configuredWsPort = server.hasArg("port") ? server.arg("port") : "443";
     configuredRole = server.hasArg("role") ? server.arg("role") : "lane";
     configuredLane = server.hasArg("lane") ? server.arg("lane") : "9";
+    configuredPosition = server.hasArg("position") ? server.arg("position") : "start";
+        configuredUndoSeconds = server.hasArg("undo_s") ? server.arg("undo_s") : "10";
+        configuredTrainSwimmers = server.hasArg("train_swimmers") ? server.arg("train_swimmers") : "0";
+        configuredTrainGapS = server.hasArg("train_gap_s") ? server.arg("train_gap_s") : "10";
+        configuredTrainLapS = server.hasArg("train_lap_s") ? server.arg("train_lap_s") : "30";
+        configuredDistanceM = server.hasArg("distance_m") ? server.arg("distance_m") : "0";
+        configuredPoolM = server.hasArg("pool_m") ? server.arg("pool_m") : "25";
+        configuredRelay = server.hasArg("relay") ? server.arg("relay") : "off";
+        configuredRelayTolMs = server.hasArg("relay_tol_ms") ? server.arg("relay_tol_ms") : "30";
+        configuredFastPathKey = server.hasArg("udp_key") ? server.arg("udp_key") : "";
+        configuredStartGate = server.hasArg("start_gate") ? server.arg("start_gate") : "warn";
+        configuredGateMs = server.hasArg("gate_ms") ? server.arg("gate_ms") : "20";
+        configuredDormantMinutes = server.hasArg("dormant_min") ? server.arg("dormant_min") : "120";
+        configuredPortalAfter = server.hasArg("portal_after") ? server.arg("portal_after") : "6";
+        configuredPeerLink = server.hasArg("peer_link") ? server.arg("peer_link") : "on";
+        configuredUsbLink = server.hasArg("usb_link") ? server.arg("usb_link") : "on";
+        configuredMaintPortal = server.hasArg("maint_portal") ? server.arg("maint_portal") : "off";
 
         // Validate role parameter
         if (configuredRole != "lane" && configuredRole != "starter") {
             server.send(400, "text/plain", "Invalid role parameter");
             return;
         }
+        if (configuredRole == "lane" &&
+            (configuredLane.toInt() < 0 || configuredLane.toInt() >= WS_MAX_LANES || !isDigit(configuredLane.charAt(0)))) {
+            server.send(400, "text/plain", "Invalid lane parameter");
+            return;
+        }
+        if (configuredPosition != "turn") {
+            configuredPosition = "start";
+        }
+        if (configuredStartGate != "off" && configuredStartGate != "warn" && configuredStartGate != "block") {
+            configuredStartGate = "warn";
+        }
+        if (configuredUndoSeconds.toInt() < 0) {
+            configuredUndoSeconds = "0";
+        }
+        if (configuredTrainSwimmers.toInt() < 2 || configuredTrainSwimmers.toInt() > 8) {
+            configuredTrainSwimmers = "0"; // One swimmer is a normal heat
+        }
+        if (configuredTrainGapS.toInt() <= 0) {
+            configuredTrainGapS = "10";
+        }
+        if (configuredTrainLapS.toInt() <= 0) {
+            configuredTrainLapS = "30";
+        }
+        if (configuredDistanceM.toInt() < 0 || configuredDistanceM.toInt() > 10000) {
+            configuredDistanceM = "0";
+        }
+        if (configuredPoolM != "50") {
+            configuredPoolM = "25";
+        }
+        if (configuredRelayTolMs.toInt() < 0 || configuredRelayTolMs.toInt() > 200) {
+            configuredRelayTolMs = "30";
+        }
+        if (configuredDormantMinutes.toInt() < 0) {
+            configuredDormantMinutes = "0";
+        }
+        if (configuredPortalAfter.toInt() < 0 || configuredPortalAfter.toInt() > 255) {
+            configuredPortalAfter = "6";
+        }
+        if (configuredGateMs.toInt() <= 0) {
+            configuredGateMs = "20";
+        }
+        
+        // The form never shows the stored secrets: empty keeps them (the
+        // password only while the network is the same)
+        Preferences stored;
+        stored.begin("stopwatch", true);
+        if (configuredPassword.length() == 0 && configuredSSID == stored.getString("wifi_ssid", "")) {
+            configuredPassword = stored.getString("wifi_pass", "");
+        }
+        if (configuredFastPathKey.length() == 0) {
+            configuredFastPathKey = stored.getString("udp_key", "");
+        }
+        stored.end();
 
         Serial.println("Configuration received:");
         Serial.println("SSID: " + configuredSSID);
         Serial.println("Server: " + configuredWsServer + ":" + configuredWsPort);
         Serial.println("Role: " + configuredRole);
         if (configuredRole == "lane") {
-            Serial.println("Lane: " + configuredLane);
+            Serial.println("Lane: " + configuredLane + " (" + configuredPosition + " end)");
         }
         
         // Save configuration
         saveConfiguration();
         
         // Send success response
-        server.send_P(200, "text/html", SUCCESS_HTML);
+        sendPage(SUCCESS_HTML_GZ, SUCCESS_HTML_GZ_LEN, SUCCESS_HTML_ETAG);
         
         // Mark configuration as complete
         configComplete = true;
@@ -169,14 +325,20 @@ void CaptivePortalManager::handleConfig() {
 }
 
 void CaptivePortalManager::handleNotFound() {
-    // Redirect all unknown requests to the config page (captive portal behavior)
-    server.sendHeader("Location", "http://" + WiFi.softAPIP().toString() + "/", true);
-    server.send(302, "text/plain", "Redirecting to setup page");
+    // Redirect all unknown requests to the config page (captive portal behavior);
+    // from the station side, the AP address is not reachable
+    if (server.client().localIP() == apAddress) {
+        server.sendHeader("Location", redirectLocation, true);
+    } else {
+        server.sendHeader("Location", "/", true);
+    }
+    server.send(302);
 }
 
 void CaptivePortalManager::loop() {
     dnsServer.processNextRequest();
     server.handleClient();
+    pollScan();
 }
 
 void CaptivePortalManager::saveConfiguration() {
@@ -186,7 +348,24 @@ void CaptivePortalManager::saveConfiguration() {
     preferences.putString("ws_server", configuredWsServer);
     preferences.putUInt("ws_port", configuredWsPort.toInt());
     preferences.putUInt("lane", configuredLane.toInt());
+    preferences.putString("position", configuredPosition);
+    preferences.putUInt("undo_s", configuredUndoSeconds.toInt());
+    preferences.putUInt("train_swimmers", configuredTrainSwimmers.toInt());
+    preferences.putUInt("train_gap_s", configuredTrainGapS.toInt());
+    preferences.putUInt("train_lap_s", configuredTrainLapS.toInt());
+    preferences.putUInt("distance_m", configuredDistanceM.toInt());
+    preferences.putUInt("pool_m", configuredPoolM.toInt());
+    preferences.putBool("relay", configuredRelay == "on");
+    preferences.putUInt("relay_tol_ms", configuredRelayTolMs.toInt());
     preferences.putString("role", configuredRole.length() ? configuredRole : String("lane"));
+    preferences.putString("udp_key", configuredFastPathKey);
+    preferences.putString("start_gate", configuredStartGate);
+    preferences.putUInt("gate_ms", configuredGateMs.toInt());
+    preferences.putUInt("dormant_min", configuredDormantMinutes.toInt());
+    preferences.putUInt("portal_after", configuredPortalAfter.toInt());
+    preferences.putBool("peer_link", configuredPeerLink != "off");
+    preferences.putBool("usb_link", configuredUsbLink != "off");
+    preferences.putBool("maint_portal", configuredMaintPortal == "on");
     preferences.end();
     
     Serial.println("Configuration saved to preferences");
@@ -200,7 +379,7 @@ bool CaptivePortalManager::hasStoredCredentials() {
     return ssid.length() > 0;
 }
 
-bool CaptivePortalManager::connectWithStoredCredentials() {
+bool CaptivePortalManager::beginStoredConnection(int32_t channel, const uint8_t* bssid) {
     Preferences prefs;
     prefs.begin("stopwatch", true);
     String ssid = prefs.getString("wifi_ssid", "");
@@ -211,28 +390,12 @@ bool CaptivePortalManager::connectWithStoredCredentials() {
         return false;
     }
     
-    Serial.println("Connecting to: " + ssid);
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid.c_str(), password.c_str());
-    
-    // Wait up to 10 seconds for connection
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
-        Serial.print(".");
-        attempts++;
-    }
-    Serial.println();
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("WiFi connected!");
-        Serial.print("IP address: ");
-        Serial.println(WiFi.localIP());
-        return true;
-    } else {
-        Serial.println("WiFi connection failed");
-        return false;
+    Serial.println("Connecting to: " + ssid + (channel ? " (known AP, channel " + String(channel) + ")" : ""));
+    if (!(WiFi.getMode() & WIFI_MODE_STA)) {
+        WiFi.mode(WIFI_STA);
     }
+    WiFi.begin(ssid.c_str(), password.c_str(), channel, channel ? bssid : nullptr);
+    return true;
 }
 
 void CaptivePortalManager::stop() {
@@ -0,0 +1,225 @@
+#include "clock_sync.h"
+#include <math.h>
+#include <string.h>
+
+// Worst-case frequency error assumed before any calibration: the crystal's
+// tolerance plus temperature and ageing, with margin
+static const float UNCALIBRATED_BOUND_PPM = 50.0f;
+
+// Calibration restored from a previous session, not yet confirmed by a fit
+static const float STORED_BOUND_PPM = 5.0f;
+
+// Floor for a fitted estimate; residuals alone understate slow wander
+static const float MIN_FIT_BOUND_PPM = 1.0f;
+
+// Smaller changes are not worth a flash write
+static const float PERSIST_DELTA_PPM = 0.5f;
+
+ClockSync::ClockSync() {
+    reset();
+}
+
+void ClockSync::reset() {
+    synced = false;
+    linkUp = false;
+    lastSampleMs = 0;
+    anchor = {0, 0, 0};
+    windowBest = {0, 0, 0};
+    windowStartMs = 0;
+    windowOpen = false;
+    pointCount = 0;
+    pointNext = 0;
+    driftPpm = 0.0f;
+    driftBoundPpm = UNCALIBRATED_BOUND_PPM;
+    calibrated = false;
+    calibrationDirty = false;
+    persistedPpm = 0.0f;
+    persisted = false;
+}
+
+void ClockSync::setCalibration(float ppm) {
+    driftPpm = ppm;
+    driftBoundPpm = STORED_BOUND_PPM;
+    calibrated = true;
+    persistedPpm = ppm;
+    persisted = true;
+}
+
+void ClockSync::addSample(uint32_t localMs, uint64_t serverMs, uint32_t rttMs) {
+    // The server stamped its reply about rtt/2 before it arrived here:
+    // offset = server_time - (client_time - rtt/2), exact to within rtt/2
+    // (plus one tick of millis() resolution)
+    Point sample = {localMs, (int64_t)serverMs - (int64_t)localMs + (int64_t)(rttMs / 2), rttMs / 2 + 1};
+
+    // Keep converting from the older anchor while its projected error is
+    // still smaller than this sample's (a slow round trip is a poor anchor)
+    if (!synced || sample.errorMs <= anchorUncertaintyAt(localMs)) {
+        anchor = sample;
+    }
+    synced = true;
+    linkUp = true;
+    lastSampleMs = localMs;
+
+    if (!windowOpen) {
+        windowBest = sample;
+        windowStartMs = localMs;
+        windowOpen = true;
+    } else if (localMs - windowStartMs >= WINDOW_MS) {
+        closeWindow();
+        windowBest = sample;
+        windowStartMs = localMs;
+    } else if (sample.errorMs < windowBest.errorMs) {
+        windowBest = sample;
+    }
+}
+
+void ClockSync::setLinkUp(bool up) {
+    linkUp = up;
+}
+
+bool ClockSync::capture(uint32_t localMs, Prior& prior) const {
+    if (!synced) {
+        return false;
+    }
+    prior.serverMs = toServerTime(localMs);
+    prior.errorMs = anchorUncertaintyAt(localMs);
+    prior.driftPpm = driftPpm;
+    prior.driftBoundPpm = driftBoundPpm;
+    prior.calibrated = calibrated;
+    return true;
+}
+
+void ClockSync::restore(const Prior& prior, uint32_t localMs, uint32_t gapMs, float gapBoundPpm) {
+    uint32_t gapError = (uint32_t)ceilf((float)gapMs * gapBoundPpm * 1e-6f) + 1;
+    anchor.localMs = localMs;
+    anchor.offsetMs = (int64_t)(prior.serverMs + gapMs) - (int64_t)localMs;
+    anchor.errorMs = prior.errorMs + gapError;
+    synced = true;
+    linkUp = false;
+    lastSampleMs = localMs;
+
+    if (prior.calibrated) {
+        driftPpm = prior.driftPpm;
+        driftBoundPpm = prior.driftBoundPpm;
+        calibrated = true;
+    }
+}
+
+int64_t ClockSync::getOffsetMs(uint32_t localMs) const {
+    int32_t age = (int32_t)(localMs - anchor.localMs);
+    return anchor.offsetMs + (int64_t)lroundf((float)age * driftPpm * 1e-6f);
+}
+
+uint64_t ClockSync::toServerTime(uint32_t localMs) const {
+    if (!synced) {
+        return localMs;
+    }
+    return (uint64_t)((int64_t)localMs + getOffsetMs(localMs));
+}
+
+SyncQuality ClockSync::getQuality(uint32_t localMs) const {
+    if (!synced) {
+        return SYNC_NONE;
+    }
+    if (linkUp && localMs - lastSampleMs < HOLDOVER_AFTER_MS) {
+        return SYNC_LOCKED;
+    }
+    return SYNC_HOLDOVER;
+}
+
+uint32_t ClockSync::getUncertaintyMs(uint32_t localMs) const {
+    return synced ? anchorUncertaintyAt(localMs) : UNKNOWN_UNCERTAINTY;
+}
+
+uint32_t ClockSync::anchorUncertaintyAt(uint32_t localMs) const {
+    // The anchor's own bound plus the drift that may have accumulated
+    // since beyond what is corrected
+    uint32_t age = localMs - anchor.localMs;
+    uint32_t drift = (uint32_t)ceilf((float)age * driftBoundPpm * 1e-6f);
+    return anchor.errorMs + drift;
+}
+
+bool ClockSync::consumeCalibrationUpdate(float& ppm) {
+    if (!calibrationDirty) {
+        return false;
+    }
+    calibrationDirty = false;
+    persisted = true;
+    persistedPpm = driftPpm;
+    ppm = driftPpm;
+    return true;
+}
+
+void ClockSync::closeWindow() {
+    points[pointNext] = windowBest;
+    pointNext = (pointNext + 1) % MAX_POINTS;
+    if (pointCount < MAX_POINTS) {
+        pointCount++;
+    }
+    fitDrift();
+}
+
+void ClockSync::fitDrift() {
+    if (pointCount < MIN_FIT_POINTS) {
+        return;
+    }
+    const Point& oldest = points[(pointNext + MAX_POINTS - pointCount) % MAX_POINTS];
+    const Point& newest = points[(pointNext + MAX_POINTS - 1) % MAX_POINTS];
+    if (newest.localMs - oldest.localMs < MIN_FIT_SPAN_MS) {
+        return;
+    }
+
+    // Least squares of offset against local time, relative to the oldest
+    // point so the sums stay small
+    double sumX = 0, sumY = 0;
+    for (uint8_t i = 0; i < pointCount; i++) {
+        const Point& p = points[(pointNext + MAX_POINTS - pointCount + i) % MAX_POINTS];
+        sumX += (double)(p.localMs - oldest.localMs);
+        sumY += (double)(p.offsetMs - oldest.offsetMs);
+    }
+    double meanX = sumX / pointCount;
+    double meanY = sumY / pointCount;
+    double sxx = 0, sxy = 0;
+    for (uint8_t i = 0; i < pointCount; i++) {
+        const Point& p = points[(pointNext + MAX_POINTS - pointCount + i) % MAX_POINTS];
+        double dx = (double)(p.localMs - oldest.localMs) - meanX;
+        double dy = (double)(p.offsetMs - oldest.offsetMs) - meanY;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+    double slope = sxy / sxx;
+    double residuals = 0;
+    for (uint8_t i = 0; i < pointCount; i++) {
+        const Point& p = points[(pointNext + MAX_POINTS - pointCount + i) % MAX_POINTS];
+        double dx = (double)(p.localMs - oldest.localMs) - meanX;
+        double dy = (double)(p.offsetMs - oldest.offsetMs) - meanY;
+        double r = dy - slope * dx;
+        residuals += r * r;
+    }
+    double slopeError = sqrt(residuals / (pointCount - 2) / sxx);
+
+    driftPpm = (float)(slope * 1e6);
+    driftBoundPpm = fmaxf(MIN_FIT_BOUND_PPM, (float)(3.0 * slopeError * 1e6));
+    calibrated = true;
+    if (!persisted || fabsf(driftPpm - persistedPpm) >= PERSIST_DELTA_PPM) {
+        calibrationDirty = true;
+    }
+}
+
+const char* ClockSync::qualityName(SyncQuality quality) {
+    switch (quality) {
+        case SYNC_LOCKED:   return "locked";
+        case SYNC_HOLDOVER: return "holdover";
+        default:            return "none";
+    }
+}
+
+SyncQuality ClockSync::qualityFromName(const char* name) {
+    if (name != nullptr && strcmp(name, "locked") == 0) {
+        return SYNC_LOCKED;
+    }
+    if (name != nullptr && strcmp(name, "holdover") == 0) {
+        return SYNC_HOLDOVER;
+    }
+    return SYNC_NONE;
+}
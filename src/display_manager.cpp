@@ -49,7 +49,9 @@ void DisplayManager::sendTFTCommand(uint8_t cmd) {
 // ================================
 
 DisplayManager::DisplayManager() 
-    : stopwatchAreaDirty(true)
+    : sparkCanvas(tft)
+    , readinessGridValid(false)
+    , stopwatchAreaDirty(true)
     , wifiAreaDirty(true) 
     , websocketAreaDirty(true)
     , laneAreaDirty(true)
@@ -65,6 +67,7 @@ bool DisplayManager::init() {
     
     tft.init();
     tft.setRotation(1); // Landscape orientation
+    lapSparkline.begin(MAIN_AREA_X, AREA_SPARKLINE_Y, MAIN_AREA_WIDTH, AREA_SPARKLINE_HEIGHT);
     
     // Set default colors and fonts
     clearScreen();
@@ -98,6 +101,9 @@ void DisplayManager::clearScreen() {
     // Draw swimming pool colored sidebar background
     drawSidebarBackground();
     
+    // Blank now; the next lap redraws the sparkline from the history
+    lapSparkline.reset();
+    
     // Reset all cached display strings
     lastTimeString = "";
     lastWiFiStatus = "";
@@ -109,6 +115,7 @@ void DisplayManager::clearScreen() {
     lastLap3 = "";
     lastStartupMessage = "";
     lastEventHeat = "";
+    readinessGridValid = false;
     
     // Mark all display areas as needing refresh
     stopwatchAreaDirty = true;
@@ -140,39 +147,18 @@ void DisplayManager::clearArea(int16_t x, int16_t y, int16_t w, int16_t h) {
 }
 
 String DisplayManager::formatTimeDisplay(uint32_t milliseconds, bool showCentiseconds) {
-    uint16_t minutes = milliseconds / 60000;
-    uint8_t seconds = (milliseconds / 1000) % 60;
-    
-    char buffer[16];
-    
+    char buffer[TIME_FORMAT_SIZE];
     if (showCentiseconds) {
-        uint8_t centiseconds = (milliseconds % 1000) / 10;
-        sprintf(buffer, "%02d:%02d:%02d", minutes, seconds, centiseconds);
+        formatCentiseconds(milliseconds, buffer, sizeof(buffer));
     } else {
-        uint8_t millisec = (milliseconds % 1000) / 100; // Single digit milliseconds
-        sprintf(buffer, "%02d:%02d:%d", minutes, seconds, millisec);
+        formatTenths(milliseconds, buffer, sizeof(buffer));
     }
-    
     return String(buffer);
 }
 
 String DisplayManager::formatStopwatchTime(uint32_t milliseconds, bool isRunning) {
-    uint16_t minutes = milliseconds / 60000;
-    uint8_t seconds = (milliseconds / 1000) % 60;
-    
-    char buffer[16];
-    
-    if (isRunning) {
-        // When running: show 1 digit for milliseconds
-        uint8_t millisec = (milliseconds % 1000) / 100;
-        sprintf(buffer, "%02d:%02d:%01d", minutes, seconds, millisec);
-    } else {
-        // When stopped: show 2 digits for milliseconds  
-        uint8_t centiseconds = (milliseconds % 1000) / 10;
-        sprintf(buffer, "%02d:%02d:%02d", minutes, seconds, centiseconds);
-    }
-    
-    return String(buffer);
+    // Running: tenths; stopped: hundredths
+    return formatTimeDisplay(milliseconds, !isRunning);
 }
 
 void DisplayManager::showGeneralStatus(const String& message, uint16_t color) {
@@ -213,6 +199,7 @@ void DisplayManager::showConfigPortalInfo(const String& apName, const String& ap
 // ===========================
 
 void DisplayManager::forceRefresh() {
+    readinessGridValid = false;
     stopwatchAreaDirty = true;
     wifiAreaDirty = true;
     websocketAreaDirty = true;
@@ -302,6 +289,13 @@ void DisplayManager::updateStopwatchDisplay(uint32_t elapsedMs, bool isRunning)
         int centerY = AREA_STOPWATCH_Y + (AREA_STOPWATCH_HEIGHT / 2);
         tft.drawString(timeString, centerX, centerY);
         
+        if (!stopwatchLabel.isEmpty()) {
+            tft.setTextFont(2);
+            tft.setTextColor(COLOR_LAP_INFO, COLOR_BACKGROUND);
+            tft.setTextDatum(TL_DATUM);
+            tft.drawString(stopwatchLabel, MAIN_AREA_X + 4, AREA_STOPWATCH_Y + 2);
+        }
+        
         lastTimeString = timeString;
         stopwatchAreaDirty = false;
     }
@@ -369,6 +363,13 @@ void DisplayManager::setEventHeat(const String& event, const String& heat) {
     }
 }
 
+void DisplayManager::setStopwatchLabel(const String& label) {
+    if (label != stopwatchLabel) {
+        stopwatchLabel = label;
+        stopwatchAreaDirty = true;
+    }
+}
+
 // ===========================
 // Split Time and Lap Management
 // ===========================
@@ -423,9 +424,54 @@ void DisplayManager::clearLapTimes() {
     lastLap1 = "";
     lastLap2 = "";
     lastLap3 = "";
+    readinessGridValid = false;
     lapAreaDirty = false;
 }
 
+void DisplayManager::updateReadinessGrid(const uint8_t* lanes, const LaneState* states, const uint8_t* batteryPercent,
+                                         uint8_t laneCount) {
+    static const uint8_t COLUMNS = READINESS_CELLS / 2;
+    static const uint8_t LOW_BATTERY_PERCENT = 20;
+    if (laneCount > READINESS_CELLS) {
+        laneCount = READINESS_CELLS;
+    }
+    
+    int cellWidth = MAIN_AREA_WIDTH / COLUMNS;
+    for (uint8_t i = 0; i < laneCount; i++) {
+        uint32_t cell = (uint32_t)lanes[i] << 16 | states[i] << 8 | batteryPercent[i];
+        if (readinessGridValid && cell == readinessCells[i]) {
+            continue;
+        }
+        readinessCells[i] = cell;
+        
+        uint16_t color;
+        switch (states[i]) {
+            case LANE_READY:    color = TFT_GREEN; break;
+            case LANE_DEGRADED: color = COLOR_WARNING; break;
+            case LANE_STALE:    color = COLOR_ERROR; break;
+            default:            color = TFT_DARKGREY; break;
+        }
+        int x = MAIN_AREA_X + (i % COLUMNS) * cellWidth;
+        int y = AREA_LAP1_Y + (i / COLUMNS) * AREA_LAP1_HEIGHT;
+        tft.fillRect(x, y, cellWidth, AREA_LAP1_HEIGHT, COLOR_BACKGROUND);
+        tft.fillRoundRect(x + 2, y + 2, cellWidth - 4, AREA_LAP1_HEIGHT - 4, 4, color);
+        tft.setTextDatum(MC_DATUM);
+        tft.setTextFont(2);
+        tft.setTextColor(TFT_BLACK, color);
+        tft.drawString(String(lanes[i]), x + cellWidth / 2, y + AREA_LAP1_HEIGHT / 2 - 5);
+        
+        if (batteryPercent[i] != LaneReadiness::BATTERY_UNKNOWN) {
+            tft.setTextFont(1);
+            if (batteryPercent[i] <= LOW_BATTERY_PERCENT) {
+                tft.fillRect(x + 6, y + AREA_LAP1_HEIGHT - 15, cellWidth - 12, 10, TFT_BLACK);
+                tft.setTextColor(COLOR_ERROR, TFT_BLACK);
+            }
+            tft.drawString(String(batteryPercent[i]) + "%", x + cellWidth / 2, y + AREA_LAP1_HEIGHT - 10);
+        }
+    }
+    readinessGridValid = true;
+}
+
 // ===========================
 // Status Area Updates
 // ===========================
@@ -500,8 +546,10 @@ void DisplayManager::updateWebSocketStatus(const String& status, bool isConnecte
     }
 }
 
-void DisplayManager::updateLaneInfo(uint8_t laneNumber) {
-    String laneText = "Lane\n" + String(laneNumber);
+void DisplayManager::updateLaneInfo(uint8_t laneNumber, SplitPosition position) {
+    // Turn-end devices say so: the same lane has a second device at the start end
+    String laneText = position == POSITION_TURN ? "Lane " + String(laneNumber) + "\nTurn"
+                                                : "Lane\n" + String(laneNumber);
     
     if (laneText != lastLaneInfo || laneAreaDirty) {
         // Clear with sidebar background  
@@ -0,0 +1,120 @@
+#include "distance_event.h"
+
+DistanceEvent::DistanceEvent()
+    : totalLengths(0)
+    , atStartEnd(true)
+    , splitCount(0)
+    , lastTotalMs(0)
+    , lapCount(0)
+    , sumY(0)
+    , sumXY(0)
+    , sumYY(0) {
+}
+
+void DistanceEvent::begin(uint16_t distanceM, uint8_t poolM, bool startEnd) {
+    totalLengths = poolM ? distanceM / poolM : 0;
+    atStartEnd = startEnd;
+    clearSplits();
+}
+
+void DistanceEvent::clearSplits() {
+    splitCount = 0;
+    lastTotalMs = 0;
+    lapCount = 0;
+    sumY = 0;
+    sumXY = 0;
+    sumYY = 0;
+}
+
+void DistanceEvent::addSplit(uint32_t totalMs) {
+    if (splitCount > 0) {
+        // Slide the window: the lap leaving it takes its share of the sums
+        uint32_t lap = totalMs - lastTotalMs;
+        uint8_t slot = lapCount % WINDOW;
+        if (lapCount >= WINDOW) {
+            sumY -= laps[slot];
+            sumXY -= (int64_t)(lapCount - WINDOW) * laps[slot];
+            sumYY -= (int64_t)laps[slot] * laps[slot];
+        }
+        laps[slot] = lap;
+        sumY += lap;
+        sumXY += (int64_t)lapCount * lap;
+        sumYY += (int64_t)lap * lap;
+        lapCount++;
+    }
+    splitCount++;
+    lastTotalMs = totalMs;
+}
+
+uint16_t DistanceEvent::getLengthsDone() const {
+    if (splitCount == 0) {
+        return 0;
+    }
+    uint32_t done = atStartEnd ? 2 * splitCount : 2 * splitCount - 1;
+    return done < totalLengths ? done : totalLengths;
+}
+
+uint16_t DistanceEvent::getLengthsToGo() const {
+    return totalLengths - getLengthsDone();
+}
+
+bool DistanceEvent::isBellLap() const {
+    uint16_t toGo = getLengthsToGo();
+    return isActive() && splitCount > 0 && toGo > 0 && toGo <= 2;
+}
+
+uint32_t DistanceEvent::getMeanLapMs() const {
+    uint8_t n = windowSize();
+    return n ? (uint32_t)(sumY / n) : 0;
+}
+
+int32_t DistanceEvent::getTrendMsPerLap() const {
+    int64_t n = windowSize();
+    if (n < 2) {
+        return 0;
+    }
+    // Least-squares slope over x = first..first+n-1, with the mean of x
+    // doubled to stay in integers
+    int64_t first = lapCount - n;
+    int64_t centred2 = 2 * sumXY - (2 * first + n - 1) * sumY;
+    return (int32_t)(6 * centred2 / (n * (n * n - 1)));
+}
+
+bool DistanceEvent::trendBeyondScatter(int64_t slope) const {
+    // |slope| > its standard error. With Sxx = n(n^2-1)/12 and the laps'
+    // spread Syy, that is slope^2 * Sxx * (n-1) > Syy; both sides times n
+    // to stay in integers.
+    int64_t n = windowSize();
+    if (n < 3) {
+        return false;
+    }
+    int64_t spread = n * sumYY - sumY * sumY;
+    return slope * slope * (n * n * (n * n - 1) * (n - 1) / 12) > spread;
+}
+
+uint32_t DistanceEvent::getProjectedFinishMs() const {
+    uint16_t toGo = getLengthsToGo();
+    if (splitCount > 0 && toGo == 0) {
+        return lastTotalMs;
+    }
+    if (!hasPace()) {
+        return 0;
+    }
+    // The window's fitted value at its newest lap, then the trend for at
+    // most TREND_LAPS laps ahead. An odd length left is half a lap.
+    int64_t slope = getTrendMsPerLap();
+    if (!trendBeyondScatter(slope)) {
+        slope = 0;
+    }
+    int64_t fit = getMeanLapMs() + slope * (windowSize() - 1) / 2;
+    int64_t full = toGo / 2;
+    int64_t trendLaps = full <= TREND_LAPS ? full * (full + 1) / 2
+                                           : TREND_LAPS * (TREND_LAPS + 1) / 2 + (full - TREND_LAPS) * TREND_LAPS;
+    int64_t ahead = full * fit + slope * trendLaps;
+    if (toGo % 2) {
+        int64_t last = full + 1 < TREND_LAPS ? full + 1 : TREND_LAPS;
+        ahead += (fit + slope * last) / 2;
+    }
+    int64_t projected = lastTotalMs + ahead;
+    return projected > lastTotalMs ? (uint32_t)projected : lastTotalMs;
+}
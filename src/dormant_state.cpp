@@ -0,0 +1,43 @@
+#include "dormant_state.h"
+#include "rtc_retention.h"
+#include <esp_attr.h>
+#include <stddef.h>
+
+#define DORMANT_MAGIC 0x444F524D // "DORM"
+
+struct RetainedDormant {
+    uint32_t magic;
+    DormantSession session;
+    uint32_t checksum;
+};
+
+// Not zeroed at boot; validated by magic and checksum instead
+static RTC_NOINIT_ATTR RetainedDormant retained;
+
+static uint32_t retainedChecksum(const RetainedDormant& r) {
+    return rtcChecksum(&r, offsetof(RetainedDormant, checksum));
+}
+
+void dormantSave(const DormantSession& session) {
+    RetainedDormant r;
+    memset(&r, 0, sizeof(r)); // Padding is part of the checksum
+    r.magic = DORMANT_MAGIC;
+    r.session = session;
+    r.session.event[sizeof(r.session.event) - 1] = '\0';
+    r.session.heat[sizeof(r.session.heat) - 1] = '\0';
+    r.checksum = retainedChecksum(r);
+    memcpy(&retained, &r, sizeof(r));
+}
+
+bool dormantRestore(DormantSession& session) {
+    if (retained.magic != DORMANT_MAGIC || retained.checksum != retainedChecksum(retained)) {
+        return false; // Power-on reset, or not woken from DORMANT
+    }
+    session = retained.session;
+    dormantClear();
+    return true;
+}
+
+void dormantClear() {
+    retained.magic = 0;
+}
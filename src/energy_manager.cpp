@@ -34,20 +34,28 @@ bool EnergyManager::init(bool testMode) {
     analogReadResolution(12); // Set ADC resolution to 12 bits (0-4095)
     analogSetAttenuation(ADC_11db); // Set attenuation to 11dB (allows reading up to ~3.3V input)
     
-    Serial.printf("EnergyManager initialized - Test mode: %s, Sleep timeout: %d seconds (light sleep only)\n", 
+    // Wake pins stay RTC IOs after a deep sleep until released
+    if (wokeFromDormant()) {
+        rtc_gpio_deinit(WAKEUP_PIN_EXTERNAL);
+        rtc_gpio_deinit(WAKEUP_PIN_BUTTON1);
+    }
+    
+    Serial.printf("EnergyManager initialized - Test mode: %s, Sleep timeout: %d seconds\n", 
                   testMode ? "ON" : "OFF", sleepTimeoutMs / 1000);
     Serial.println("ADC configured for battery voltage reading (12-bit, 11dB attenuation)");
     updateActivityTimer();
     return true;
 }
 
-// Deep sleep configuration functions removed (light sleep path only)
-
 void EnergyManager::updateActivityTimer() {
     lastActivityTime = millis();
     Serial.println("Activity timer updated");
 }
 
+void EnergyManager::keepAwake() {
+    lastActivityTime = millis();
+}
+
 bool EnergyManager::checkSleepTimeout() const {
     if (!sleepEnabled) {
         return false;
@@ -97,6 +105,42 @@ void EnergyManager::enterLightSleep() {
     Serial.println("Display restored successfully");
 }
 
+void EnergyManager::setSleepTimeout(uint32_t ms) {
+    sleepTimeoutMs = ms;
+    Serial.printf("Sleep timeout: %lu seconds\n", (unsigned long)(ms / 1000));
+}
+
+void EnergyManager::enterDormant() {
+    Serial.println("Entering DORMANT (deep sleep, GPIO2/BUTTON1 wake)...");
+    Serial.flush();
+    
+    disableUnusedPeripherals();
+    
+    // Panel off and into its sleep mode; its supply (GPIO15) is not held,
+    // so it drops with the rest of the digital pads
+    pinMode(BACKLIGHT_PIN, OUTPUT);
+    digitalWrite(BACKLIGHT_PIN, LOW);
+    display.sendTFTCommand(0x28); // DISPOFF
+    display.sendTFTCommand(0x10); // SLPIN
+    
+    // GPIO2 is active HIGH: the RTC pulldown keeps it low through the sleep
+    rtc_gpio_pullup_dis(WAKEUP_PIN_EXTERNAL);
+    rtc_gpio_pulldown_en(WAKEUP_PIN_EXTERNAL);
+    esp_sleep_enable_ext0_wakeup(WAKEUP_PIN_EXTERNAL, 1);
+    
+    // BUTTON1 is active LOW (ALL_LOW on a single pin: any press)
+    rtc_gpio_pulldown_dis(WAKEUP_PIN_BUTTON1);
+    rtc_gpio_pullup_en(WAKEUP_PIN_BUTTON1);
+    esp_sleep_enable_ext1_wakeup(1ULL << WAKEUP_PIN_BUTTON1, ESP_EXT1_WAKEUP_ALL_LOW);
+    
+    esp_deep_sleep_start();
+}
+
+bool EnergyManager::wokeFromDormant() {
+    esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+    return cause == ESP_SLEEP_WAKEUP_EXT0 || cause == ESP_SLEEP_WAKEUP_EXT1;
+}
+
 void EnergyManager::setLowPowerMode(bool enabled) {
     lowPowerMode = enabled;
     Serial.printf("Low power mode %s\n", enabled ? "enabled" : "disabled");
@@ -0,0 +1,164 @@
+#include "espnow_transport.h"
+#include <WiFi.h>
+#include <esp_wifi.h>
+
+static const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// Static instance and queue lock for the receive callback
+static EspNowTransport* espNowInstance = nullptr;
+static portMUX_TYPE espNowQueueLock = portMUX_INITIALIZER_UNLOCKED;
+
+EspNowTransport::EspNowTransport()
+    : active(false)
+    , channel(0)
+    , gatewayKnown(false)
+    , lastGatewayMs(0)
+    , lastBeaconMs(0)
+    , head(0)
+    , count(0)
+    , overflows(0) {
+    memset(gatewayMac, 0, sizeof(gatewayMac));
+}
+
+bool EspNowTransport::begin(uint8_t node, uint8_t channel) {
+    setNode(node);
+    this->channel = channel;
+    if (esp_now_init() != ESP_OK) {
+        Serial.println("ESP-NOW: init failed");
+        return false;
+    }
+    espNowInstance = this;
+    esp_now_register_recv_cb(onReceive);
+    if (!ensurePeer(BROADCAST_MAC)) {
+        Serial.println("ESP-NOW: failed to add broadcast peer");
+        esp_now_deinit();
+        return false;
+    }
+    active = true;
+    Serial.printf("ESP-NOW peer link up as %s on channel %d\n",
+                  isGateway() ? "gateway" : "lane", channel);
+    return true;
+}
+
+void EspNowTransport::stop() {
+    if (active) {
+        esp_now_unregister_recv_cb();
+        esp_now_deinit();
+        active = false;
+        gatewayKnown = false;
+    }
+}
+
+bool EspNowTransport::isUp() const {
+    if (!active) {
+        return false;
+    }
+    return isGateway() || (gatewayKnown && millis() - lastGatewayMs < GATEWAY_TIMEOUT);
+}
+
+bool EspNowTransport::send(const uint8_t* json, size_t length) {
+    if (!isUp()) {
+        return false;
+    }
+    uint8_t frame[MAX_FRAME];
+    size_t size = encode(json, length, frame, sizeof(frame));
+    if (size == 0) {
+        Serial.printf("ESP-NOW: message too large (%u bytes)\n", (unsigned)length);
+        return false;
+    }
+    return transmit(isGateway() ? BROADCAST_MAC : gatewayMac, frame, size);
+}
+
+size_t EspNowTransport::receive(uint8_t* buffer, size_t size, uint8_t& source) {
+    Slot slot;
+    while (true) {
+        portENTER_CRITICAL(&espNowQueueLock);
+        if (count == 0) {
+            portEXIT_CRITICAL(&espNowQueueLock);
+            return 0;
+        }
+        slot = queue[head];
+        head = (head + 1) % QUEUE_FRAMES;
+        count--;
+        portEXIT_CRITICAL(&espNowQueueLock);
+
+        // Any intact gateway frame, beacons included, tells a lane where to send
+        FrameHeader header;
+        const uint8_t* payload;
+        if (!isGateway() && frameDecode(slot.frame, slot.length, header, &payload) &&
+            header.source == FRAME_NODE_GATEWAY) {
+            if (!gatewayKnown || memcmp(gatewayMac, slot.mac, sizeof(gatewayMac)) != 0) {
+                memcpy(gatewayMac, slot.mac, sizeof(gatewayMac));
+                ensurePeer(gatewayMac);
+                Serial.printf("ESP-NOW: gateway %02X:%02X:%02X:%02X:%02X:%02X\n", slot.mac[0], slot.mac[1],
+                              slot.mac[2], slot.mac[3], slot.mac[4], slot.mac[5]);
+            }
+            gatewayKnown = true;
+            lastGatewayMs = millis();
+        }
+
+        size_t length = accept(slot.frame, slot.length, buffer, size, source);
+        if (length > 0) {
+            return length;
+        }
+    }
+}
+
+void EspNowTransport::loop(uint32_t nowMs) {
+    if (!active) {
+        return;
+    }
+    if (nowMs - lastBeaconMs < BEACON_INTERVAL) {
+        return;
+    }
+    lastBeaconMs = nowMs;
+
+    // Without an AP the station's reconnect scan wanders off; come back to
+    // the peer channel between attempts so beacons are heard
+    if (WiFi.status() != WL_CONNECTED && channel != 0) {
+        esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+    }
+    if (isGateway()) {
+        uint8_t frame[FRAME_OVERHEAD];
+        size_t size = encode(nullptr, 0, frame, sizeof(frame));
+        transmit(BROADCAST_MAC, frame, size);
+    }
+}
+
+bool EspNowTransport::transmit(const uint8_t* mac, const uint8_t* frame, size_t length) {
+    if (WiFi.status() != WL_CONNECTED && channel != 0) {
+        esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+    }
+    return esp_now_send(mac, frame, length) == ESP_OK;
+}
+
+bool EspNowTransport::ensurePeer(const uint8_t* mac) {
+    if (esp_now_is_peer_exist(mac)) {
+        return true;
+    }
+    esp_now_peer_info_t peer = {};
+    memcpy(peer.peer_addr, mac, sizeof(peer.peer_addr));
+    peer.channel = 0;   // Follow the station's current channel
+    peer.ifidx = WIFI_IF_STA;
+    peer.encrypt = false;
+    return esp_now_add_peer(&peer) == ESP_OK;
+}
+
+void EspNowTransport::onReceive(const uint8_t* mac, const uint8_t* data, int length) {
+    // Wi-Fi task context: copy and leave, everything else happens in receive()
+    EspNowTransport* self = espNowInstance;
+    if (self == nullptr || length <= 0 || (size_t)length > MAX_FRAME) {
+        return;
+    }
+    portENTER_CRITICAL(&espNowQueueLock);
+    if (self->count == QUEUE_FRAMES) {
+        self->overflows++;
+    } else {
+        Slot& slot = self->queue[(self->head + self->count) % QUEUE_FRAMES];
+        memcpy(slot.mac, mac, sizeof(slot.mac));
+        memcpy(slot.frame, data, length);
+        slot.length = length;
+        self->count++;
+    }
+    portEXIT_CRITICAL(&espNowQueueLock);
+}
@@ -0,0 +1,48 @@
+#include "heat_arena.h"
+
+HeatArena::HeatArena()
+    : base(nullptr)
+    , size(0)
+    , offset(0)
+    , highWater(0)
+    , gen(1)
+    , failed(0) {
+}
+
+void HeatArena::begin(void* region, size_t regionSize) {
+    base = (uint8_t*)region;
+    size = base ? regionSize : 0;
+    reset();
+}
+
+void* HeatArena::allocate(size_t bytes, size_t align) {
+    // Align the absolute address, so any region start works
+    uintptr_t start = ((uintptr_t)base + offset + align - 1) & ~(uintptr_t)(align - 1);
+    size_t next = start - (uintptr_t)base + bytes;
+    if (!base || next > size) {
+        failed++;
+        return nullptr;
+    }
+    offset = next;
+    if (offset > highWater) {
+        highWater = offset;
+    }
+    return (void*)start;
+}
+
+const char* HeatArena::copyString(const char* text) {
+    if (!text) {
+        text = "";
+    }
+    size_t length = strlen(text) + 1;
+    char* copy = (char*)allocate(length, 1);
+    if (copy) {
+        memcpy(copy, text, length);
+    }
+    return copy;
+}
+
+void HeatArena::reset() {
+    offset = 0;
+    gen++;
+}
@@ -0,0 +1,34 @@
+#include "hot_path.h"
+
+HotPathProbe hotPathProbes[HOT_PATH_COUNT];
+
+static const char* const HOT_PATH_NAMES[HOT_PATH_COUNT] = {
+    "touch_isr",
+    "undo_isr",
+    "block_isr",
+    "split_record",
+    "split_send"
+};
+
+HotPathProbe::HotPathProbe()
+    : runs(0)
+    , stalls(0)
+    , bestCycles(0)
+    , worstCycles(0) {
+}
+
+void HOT_PATH_ATTR HotPathProbe::record(uint32_t cycles) {
+    runs++;
+    if (bestCycles == 0 || cycles < bestCycles) {
+        bestCycles = cycles;
+    } else if (cycles > bestCycles * STALL_FACTOR && cycles - bestCycles > STALL_MIN_CYCLES) {
+        stalls++;
+    }
+    if (cycles > worstCycles) {
+        worstCycles = cycles;
+    }
+}
+
+const char* hotPathName(HotPath path) {
+    return path < HOT_PATH_COUNT ? HOT_PATH_NAMES[path] : "unknown";
+}
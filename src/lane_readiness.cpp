@@ -0,0 +1,102 @@
+#include "lane_readiness.h"
+
+LaneReadiness::LaneReadiness() {
+    clear();
+}
+
+void LaneReadiness::clear() {
+    for (uint8_t i = 0; i < MAX_LANES; i++) {
+        lanes[i] = {0, ClockSync::UNKNOWN_UNCERTAINTY, SYNC_NONE, BATTERY_UNKNOWN, false, false, false};
+    }
+}
+
+void LaneReadiness::update(uint8_t lane, SyncQuality quality, uint32_t uncertaintyMs, uint32_t nowMs) {
+    if (lane >= MAX_LANES) {
+        return;
+    }
+    lanes[lane].lastReportMs = nowMs;
+    lanes[lane].uncertaintyMs = quality == SYNC_NONE ? ClockSync::UNKNOWN_UNCERTAINTY : uncertaintyMs;
+    lanes[lane].quality = quality;
+    lanes[lane].seen = true;
+    lanes[lane].pushed = false;
+}
+
+void LaneReadiness::applyPresence(const PresenceDelta& delta, uint32_t nowMs) {
+    if (delta.lane >= MAX_LANES) {
+        return;
+    }
+    Entry& entry = lanes[delta.lane];
+    if (!entry.seen || !entry.pushed) {
+        // First delta for this lane: the server sends every field
+        entry = {nowMs, ClockSync::UNKNOWN_UNCERTAINTY, SYNC_NONE, BATTERY_UNKNOWN, true, true, true};
+    }
+    if (delta.fields & PRESENCE_ONLINE) {
+        if (entry.online && !delta.online) {
+            entry.lastReportMs = nowMs;
+        }
+        entry.online = delta.online;
+    }
+    if (delta.fields & PRESENCE_SYNC) {
+        entry.quality = delta.quality;
+        if (delta.quality == SYNC_NONE) {
+            entry.uncertaintyMs = ClockSync::UNKNOWN_UNCERTAINTY;
+        }
+    }
+    if ((delta.fields & PRESENCE_UNCERTAINTY) && entry.quality != SYNC_NONE) {
+        entry.uncertaintyMs = delta.uncertaintyMs;
+    }
+    if (delta.fields & PRESENCE_BATTERY) {
+        entry.batteryPercent = delta.batteryPercent;
+    }
+}
+
+LaneState LaneReadiness::getState(uint8_t lane, uint32_t nowMs, uint32_t thresholdMs) const {
+    if (lane >= MAX_LANES || !lanes[lane].seen) {
+        return LANE_ABSENT;
+    }
+    const Entry& entry = lanes[lane];
+    uint32_t age = nowMs - entry.lastReportMs;
+    if (entry.pushed) {
+        // The server tracks liveness; an offline lane ages from when it went
+        if (!entry.online) {
+            return age >= FORGET_AFTER_MS ? LANE_ABSENT : LANE_STALE;
+        }
+    } else if (age >= FORGET_AFTER_MS) {
+        return LANE_ABSENT;
+    } else if (age >= STALE_AFTER_MS) {
+        return LANE_STALE;
+    }
+    // The bound is what matters: holdover with a small bound is still fine
+    if (entry.quality == SYNC_NONE || entry.uncertaintyMs > thresholdMs) {
+        return LANE_DEGRADED;
+    }
+    return LANE_READY;
+}
+
+uint32_t LaneReadiness::getUncertaintyMs(uint8_t lane) const {
+    return lane < MAX_LANES ? lanes[lane].uncertaintyMs : ClockSync::UNKNOWN_UNCERTAINTY;
+}
+
+uint8_t LaneReadiness::getBatteryPercent(uint8_t lane) const {
+    return lane < MAX_LANES ? lanes[lane].batteryPercent : BATTERY_UNKNOWN;
+}
+
+uint64_t LaneReadiness::notReadyMask(uint32_t nowMs, uint32_t thresholdMs) const {
+    uint64_t mask = 0;
+    for (uint8_t i = 0; i < MAX_LANES; i++) {
+        LaneState state = getState(i, nowMs, thresholdMs);
+        if (state == LANE_DEGRADED || state == LANE_STALE) {
+            mask |= 1ULL << i;
+        }
+    }
+    return mask;
+}
+
+const char* LaneReadiness::stateName(LaneState state) {
+    switch (state) {
+        case LANE_READY:    return "ready";
+        case LANE_DEGRADED: return "degraded";
+        case LANE_STALE:    return "stale";
+        default:            return "absent";
+    }
+}
@@ -0,0 +1,150 @@
+#include "lap_sparkline.h"
+
+#include <string.h>
+
+LapSparkline::LapSparkline()
+    : x(0)
+    , y(0)
+    , width(0)
+    , height(0)
+    , capacity(0)
+    , first(0)
+    , shown(0)
+    , ranged(false)
+    , lowMs(0)
+    , highMs(0)
+    , rescales(0) {
+    memset(heights, 0, sizeof(heights));
+}
+
+void LapSparkline::begin(int16_t left, int16_t top, int16_t w, int16_t h) {
+    x = left;
+    y = top;
+    width = w;
+    height = h;
+    int16_t columns = w / COLUMN_PITCH;
+    capacity = columns < MAX_COLUMNS ? columns : MAX_COLUMNS;
+    reset();
+}
+
+void LapSparkline::reset() {
+    first = 0;
+    shown = 0;
+    ranged = false;
+    memset(heights, 0, sizeof(heights));
+}
+
+uint8_t LapSparkline::barHeight(uint32_t lapMs) const {
+    if (!ranged) {
+        return height / 2;
+    }
+    if (lapMs <= lowMs) {
+        return MIN_BAR;
+    }
+    if (lapMs >= highMs) {
+        return height;
+    }
+    return MIN_BAR + (uint8_t)((uint64_t)(lapMs - lowMs) * (height - MIN_BAR) / (highMs - lowMs));
+}
+
+void LapSparkline::update(SparkCanvas& canvas, const uint32_t* lapMs, size_t stride, uint8_t count) {
+    if (capacity == 0) {
+        return;
+    }
+    if (count < shown) {
+        if (count > first) {
+            // Undo: erase the columns that went, the one before is the newest again
+            for (uint8_t i = count; i < shown; i++) {
+                drawColumn(canvas, i - first, 0, COLOR_EMPTY);
+            }
+            shown = count;
+            uint8_t last = shown - 1 - first;
+            fillBar(canvas, last, 0, heights[last], colorOf(shown - 1, count));
+            return;
+        }
+        // A new heat, or an undo back past the first column
+        canvas.fillRect(x, y, width, height, COLOR_EMPTY);
+        reset();
+    }
+    if (count - first > capacity) {
+        // Full: start again with the newest half
+        canvas.fillRect(x, y, width, height, COLOR_EMPTY);
+        reset();
+        first = shown = count - capacity / 2;
+    }
+    if (count == shown) {
+        return;
+    }
+
+    // Widen the scale for the new laps (not the dive); a rescale moves
+    // every drawn column by the difference only
+    bool rescale = false;
+    for (uint8_t i = shown; i < count; i++) {
+        if (i > 0 && widen(lapAt(lapMs, stride, i))) {
+            rescale = true;
+        }
+    }
+    if (rescale && shown > first) {
+        rescales++;
+        for (uint8_t i = first; i < shown; i++) {
+            drawColumn(canvas, i - first, barHeight(lapAt(lapMs, stride, i)), colorOf(i, shown));
+        }
+    }
+
+    // The previous newest goes back to the normal colour, then the new columns
+    if (shown > first && colorOf(shown - 1, shown) != colorOf(shown - 1, count)) {
+        uint8_t last = shown - 1 - first;
+        fillBar(canvas, last, 0, heights[last], colorOf(shown - 1, count));
+    }
+    for (uint8_t i = shown; i < count; i++) {
+        drawColumn(canvas, i - first, barHeight(lapAt(lapMs, stride, i)), colorOf(i, count));
+    }
+    shown = count;
+}
+
+uint16_t LapSparkline::colorOf(uint8_t lap, uint8_t count) const {
+    if (lap == 0) {
+        return COLOR_DIVE;
+    }
+    return lap == count - 1 ? COLOR_NEWEST : COLOR_BAR;
+}
+
+bool LapSparkline::widen(uint32_t lapMs) {
+    if (!ranged) {
+        ranged = true;
+        lowMs = lapMs > MIN_HEADROOM_MS ? lapMs - MIN_HEADROOM_MS : 0;
+        highMs = lapMs + MIN_HEADROOM_MS;
+        return true;
+    }
+    uint32_t headroom = (highMs - lowMs) / 4;
+    if (headroom < MIN_HEADROOM_MS) {
+        headroom = MIN_HEADROOM_MS;
+    }
+    if (lapMs < lowMs) {
+        lowMs = lapMs > headroom ? lapMs - headroom : 0;
+        return true;
+    }
+    if (lapMs > highMs) {
+        highMs = lapMs + headroom;
+        return true;
+    }
+    return false;
+}
+
+void LapSparkline::drawColumn(SparkCanvas& canvas, uint8_t column, uint8_t newHeight, uint16_t color) {
+    // Only the part that changes: grow in the bar's colour, shrink to empty
+    uint8_t old = heights[column];
+    if (newHeight > old) {
+        fillBar(canvas, column, old, newHeight, color);
+    } else if (newHeight < old) {
+        fillBar(canvas, column, newHeight, old, COLOR_EMPTY);
+    }
+    heights[column] = newHeight;
+}
+
+void LapSparkline::fillBar(SparkCanvas& canvas, uint8_t column, uint8_t from, uint8_t to, uint16_t color) {
+    // from/to in pixels above the bottom edge
+    if (to > from) {
+        canvas.fillRect(x + column * COLUMN_PITCH, y + height - to, COLUMN_PITCH - 1, to - from, color);
+    }
+}
@@ -0,0 +1,99 @@
+#include "loopback_transport.h"
+#include <string.h>
+
+LoopbackMedium::LoopbackMedium(const uint32_t* clockMs, uint32_t seed)
+    : clockMs(clockMs)
+    , rng(seed)
+    , faults({0, 0, 0, 0, 0})
+    , up(true)
+    , endpointCount(0) {
+}
+
+void LoopbackMedium::attach(LoopbackTransport* endpoint) {
+    if (endpointCount < MAX_ENDPOINTS) {
+        endpoints[endpointCount++] = endpoint;
+    }
+}
+
+uint32_t LoopbackMedium::random(uint32_t range) {
+    rng = rng * 1664525u + 1013904223u;
+    return range ? (rng >> 8) % range : 0;
+}
+
+void LoopbackMedium::transmit(const LoopbackTransport* from, const uint8_t* frame, size_t length) {
+    for (uint8_t i = 0; i < endpointCount; i++) {
+        LoopbackTransport* to = endpoints[i];
+        if (to == from || (!from->isGateway() && !to->isGateway())) {
+            continue;
+        }
+        if (random(100) < faults.lossPercent) {
+            continue;
+        }
+
+        uint8_t copy[FrameTransport::MAX_FRAME];
+        memcpy(copy, frame, length);
+        if (random(100) < faults.corruptPercent) {
+            copy[random(length)] ^= 1 << random(8);
+        }
+        uint32_t deliverAt = now() + faults.latencyMs + random(faults.jitterMs + 1);
+        to->enqueue(copy, length, deliverAt);
+        if (random(100) < faults.duplicatePercent) {
+            to->enqueue(copy, length, deliverAt + 1);
+        }
+    }
+}
+
+LoopbackTransport::LoopbackTransport(LoopbackMedium& medium, uint8_t node)
+    : FrameTransport(node)
+    , medium(medium)
+    , head(0)
+    , count(0)
+    , overflows(0) {
+    medium.attach(this);
+}
+
+bool LoopbackTransport::send(const uint8_t* json, size_t length) {
+    if (!medium.isUp()) {
+        return false;
+    }
+    uint8_t frame[MAX_FRAME];
+    size_t size = encode(json, length, frame, sizeof(frame));
+    if (size == 0) {
+        return false;
+    }
+    medium.transmit(this, frame, size);
+    return true;
+}
+
+size_t LoopbackTransport::receive(uint8_t* buffer, size_t size, uint8_t& source) {
+    // FIFO: jitter delays a frame but never reorders, as on the radio
+    while (count > 0 && (int32_t)(medium.now() - queue[head].deliverAtMs) >= 0) {
+        Slot& slot = queue[head];
+        head = (head + 1) % QUEUE_FRAMES;
+        count--;
+        size_t length = accept(slot.frame, slot.length, buffer, size, source);
+        if (length > 0) {
+            return length;
+        }
+    }
+    return 0;
+}
+
+void LoopbackTransport::enqueue(const uint8_t* frame, size_t length, uint32_t deliverAtMs) {
+    if (count == QUEUE_FRAMES) {
+        overflows++;
+        return;
+    }
+    // Never deliver before the frame ahead of it
+    if (count > 0) {
+        uint32_t previous = queue[(head + count - 1) % QUEUE_FRAMES].deliverAtMs;
+        if ((int32_t)(deliverAtMs - previous) < 0) {
+            deliverAtMs = previous;
+        }
+    }
+    Slot& slot = queue[(head + count) % QUEUE_FRAMES];
+    slot.deliverAtMs = deliverAtMs;
+    slot.length = length;
+    memcpy(slot.frame, frame, length);
+    count++;
+}
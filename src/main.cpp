@@ -3,6 +3,8 @@
  * 
  * Hardware:
  * - BUTTON3 (GPIO2): Create split time when running (lane mode) or send start (starter mode)
+ * - GPIO14 key: Undo the last split (lane mode)
+ * - GPIO1: Relay block switch to GND, closed while a swimmer stands on it (relay mode)
  * - Display: ST7789V 320x170 via TFT_eSPI
  * 
  * Functionality:
@@ -10,34 +12,149 @@
  * - GPIO2 button creates split times and sends to server (lane mode)
  * - GPIO2 button sends start command to server (starter mode)
  * - Display shows last 3 split times in rolling fashion
+ * - Lane devices: lap pace sparkline (one bar per lap of the heat) along the bottom
  * - Uses internal ESP32 timer (millis()) for accurate timing
  * 
  * WebSocket Messages:
  * - Receives: {"type":"start","event":1,"heat":2,"timestamp":...} - Start stopwatch
+ *   - Optional "distance" (metres) here and in event-heat/snapshot: the event's distance
  * - Receives: {"type":"reset","timestamp":...} - Reset stopwatch  
  * - Receives: {"type":"time_sync","server_time":...} - Time sync
  * - Receives: {"type":"pong","client_ping_time":...,"server_time":...} - Ping response
  * - Sends: {"type":"ping","time":...} - Time sync ping
- * - Sends: {"type":"split","lane":X,"timestamp":...} - Split time
+ * - Sends: {"type":"split","device":..,"id":N,"start_timestamp":...,"lane":X,"position":"start"|"turn","timestamp":...,"sync":"locked"|"holdover"|"none","uncertainty_ms":N} - Split time
+ *   - "position": pool end of the device ("position" preference); a lane can have one at each end
+ *   - "id": never reused; resent every 2 s until the server acknowledges (device, start_timestamp, id)
+ * - Sends: {"type":"split-undo","device":..,"id":N,"start_timestamp":...,"lane":X,"position":..,"timestamp":...}
+ *   - GPIO14 key within "undo_s" seconds (10) of the touch; the server keeps the tombstone,
+ *     so a late copy of the split stays retracted
+ * - Receives: {"type":"split-ack","device":..,"id":N,"undo":b} - Server has the split or its undo
+ *   - "holdover": link lost, timestamp extrapolated with the learned crystal drift
+ * - Sends: {"type":"subscribe","types":[...],"lanes":[X]|"all","last_seq":N,"epoch":E}
+ *   - On connect: limits server fan-out and asks for a replay of missed messages
+ * - Receives: {"type":"snapshot","seq":N,"epoch":E,"running":b,"start_timestamp":...,"event":..,"heat":..}
+ *   - Sent instead of a replay of missed messages when the gap is too large
+ * - Server->device messages carry "seq"; already-applied sequence numbers are ignored
+ * - UDP 239.255.47.1:47000: "SWF1" + HMAC tag + {"type":"start"|"reset","seq":N,"epoch":E,...}
+ *   - Optional fast path; the WebSocket copy with the same seq confirms it
+ * - Receives: {"type":"trace-dump"} - Upload the trace log as {"type":"trace",...} chunks
+ * - Sends: {"type":"status","device":..,"lane":X,"position":..,"sync":..,"uncertainty_ms":N,"rtt":..,"drift_ppm":..,"split_retransmits":N,"battery":N}
+ *   - Every 10 s and on sync quality changes; the starter builds its readiness grid from these
+ * - Receives (starter): {"type":"presence","lane":X,"online":b,"sync":..,"uncertainty_ms":N,"battery":N}
+ *   - The server's lane roster instead of the status relay: one lane per message, only the
+ *     fields that changed (all of them after subscribing)
+ * - Sends: {"type":"relay","device":..,"start_timestamp":...,"lane":X,"exchange":N,"verdict":"ok"|"early"|"no-touch",
+ *          "margin_us":N,"touch_us":N,"release_us":N,"timestamp":...,"sync":..} - Judged relay exchange
+ * - Receives: {"type":"probe","id":N} - Server sync audit
+ * - Sends: {"type":"probe-reply","id":N,"device":..,"time":...,"sync":..,"uncertainty_ms":N}
+ * 
+ * Peer link (ESP-NOW, "peer_link" preference, on by default):
+ * - Same JSON messages in a binary frame (src/message_frame.cpp: SOF, node, seq, length, CRC16)
+ * - Lane: splits and status go to the starter while the WebSocket is down or silent
+ * - Starter (gateway): forwards them to the server and repeats start/reset/event/clear
+ *   to the lanes; lanes drop the copies they also got over the WebSocket by seq
+ * 
+ * USB link ("usb_link" preference, on by default):
+ * - The same frames over the USB serial port, between the log lines, to
+ *   tools/usb_bridge.py on the timing PC, which holds a WebSocket per device
+ * - While the bridge is attached all traffic and time sync use the cable;
+ *   Wi-Fi stays connected and takes over when the bridge goes quiet
+ * 
+ * Serial commands:
+ * - 't': Dump the trace log as "TRACE {...}" lines (merge with tools/trace_merge.py)
+ * - 'm': Memory report (classes, owners, heap) and the access cost benchmark
+ * 
+ * DORMANT ("dormant_min" preference, 120 min; 0 = off):
+ * - After that long with the stopwatch stopped, no button press, no
+ *   unacknowledged split and no server session that could send a start,
+ *   the device deep-sleeps until GPIO2 or BUTTON1 is pressed
+ * - Resume point, event/heat and the access point are kept in RTC memory
+ *   (src/dormant_state.cpp); the wake skips the splash and the Wi-Fi scan
+ *   and logs the time from wake to connected and locked ("Ready ... ms")
+ * 
+ * Start gate (starter, "start_gate" preference):
+ * - "off": start always sent
+ * - "warn" (default): lanes with a sync bound above "gate_ms" (20 ms) or silent are
+ *   shown; pressing start again within 3 s sends it anyway
+ * - "block": no start until every reporting lane is within "gate_ms"
+ * 
+ * Wi-Fi (src/wifi_connector.cpp):
+ * - Connecting never blocks: the timing UI runs while attempts of 10 s are
+ *   retried with a backoff of 1 s doubling to 30 s
+ * - The setup portal opens alongside (AP+STA, the station keeps retrying)
+ *   after "portal_after" failed attempts in a row (6; 0 = never), or when
+ *   BUTTON1 is held for 3 s
+ * 
+ * Training mode ("train_swimmers" preference, 2-8; 0 = off), lane devices between heats:
+ * - GPIO2 sends the lane off: swimmer 1 now, the others "train_gap_s" (10) apart
+ * - Each press after that is a touch, given to the swimmer it fits best
+ *   (src/training_session.cpp, from "train_lap_s" (30) and their measured laps)
+ * - The stopwatch shows the time of the swimmer due next, the split lines
+ *   "S<swimmer> #<split>: time"; GPIO14 undoes the last touch (or cancels
+ *   a set with none), splits stay on the device
+ * - Ends with a heat start, or 5 minutes after the last touch
+ * 
+ * Distance events (lane devices; "distance" from the server's heat program,
+ * else the "distance_m" preference, 0 = off; "pool_m" 25 or 50):
+ * - The label above the stopwatch counts the lengths to go, "BELL" on the last two
+ * - The top split line shows the projected finish, the lap (two lengths) over
+ *   the last 12 and its trend per lap (src/distance_event.cpp)
+ * 
+ * Relay takeoff judging ("relay" preference, lane devices at the start end):
+ * - GPIO2 touch and GPIO1 block edges are stamped with micros() in their
+ *   interrupts and paired by src/relay_judge.cpp; margin = release - touch
+ * - A takeoff more than "relay_tol_ms" (30) before the touch is EARLY; a
+ *   release no touch follows within 1 s is "no touch". The top split line
+ *   shows the latest exchange, the server gets a "relay" message and the
+ *   trace log both raw edges
+ * 
+ * Hot path (include/hot_path.h):
+ * - The button interrupts run from IRAM through the GPIO ISR service, so a
+ *   touch is timed at once during a flash write or on a cold cache; the
+ *   split is timed at the touch, not when the loop records it
+ * - tools/check_hot_path.py fails the build if IRAM hot code reaches flash
+ * - Cycle counts per path (ISRs, split record, split send) with stalls
+ *   (runs far slower than the best) go to /metrics
+ * 
+ * Maintenance portal (same portal, AP "Stopwatch-<device>", also on the station IP):
+ * - Opens once Wi-Fi is up with "maint_portal" on, or with BUTTON1 held
+ * - /status (JSON diagnostics), /metrics (Prometheus text: split latency and
+ *   loop pass histograms, portal cost, hot path cycles), /settings (stored config, no secrets)
+ * - Serviced at most every 20 ms, every 50 ms while a heat is running, and
+ *   an overrun of the 3 ms slice pushes the next turn out (src/portal_scheduler.cpp);
+ *   during a heat "/" is a short page instead of the form
+ * - A saved config restarts the device only once no heat is running and
+ *   every split is acknowledged
  * 
  * Flow:
  * 1. Check if WiFi credentials exist in preferences
- * 2. If yes, try to connect to WiFi
- * 3. If no credentials or connection fails, start captive portal
- * 4. After successful WiFi setup, restart device
- * 5. On restart, proceed with normal stopwatch operation
- * 6. Wait for WebSocket start command to begin timing
- * 7. Use GPIO2 to create split times during operation
+ * 2. If no credentials, start captive portal
+ * 3. After successful WiFi setup, restart device
+ * 4. With credentials, start normal stopwatch operation and connect in the background
+ * 5. Wait for WebSocket start command to begin timing
+ * 6. Use GPIO2 to create split times during operation
  */
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include <stdarg.h>
 #include "captive_portal.h"
 #include "connectivity.h"
 #include "display_manager.h"
 #include "button_manager.h"
 #include "websocket_stopwatch.h"
 #include "energy_manager.h"
+#include "trace_log.h"
+#include "memory_policy.h"
+#include "lane_readiness.h"
+#include "espnow_transport.h"
+#include "usb_transport.h"
+#include "dormant_state.h"
+#include "wifi_connector.h"
+#include "portal_scheduler.h"
+#include "training_session.h"
+#include "distance_event.h"
+#include "relay_judge.h"
 
 // Pin definitions for T-Display S3
 #define PIN_POWER_ON                 15  // Power control pin - MUST be HIGH for battery operation
@@ -48,6 +165,29 @@ DisplayManager display;
 ButtonManager buttons;
 WebSocketStopwatch stopwatch;
 EnergyManager energyManager(display);
+LaneReadiness laneReadiness;
+EspNowTransport peerLink;
+UsbTransport usbLink(Serial);
+WifiConnector wifiConnector;
+PortalScheduler portalScheduler;
+TrainingSession training;
+DistanceEvent distanceEvent;
+RelayJudge relayJudge;
+uint8_t relayReported = 0;      // Exchanges of this heat already shown and sent
+
+// Timing path measurements for the portal's /metrics page
+LatencyHistogram splitLatency;  // Lap press (ISR) to split recorded
+LatencyHistogram loopBusy;      // One normal-mode loop pass, without its delay
+
+// Start gate: second press within this window overrides a warning
+const unsigned long START_GATE_CONFIRM_MS = 3000;
+unsigned long startGateWarnedAt = 0;
+
+// Starter's split area: readiness grid between heats, merged splits during one
+bool starterShowsSplitFeed = false;
+
+// Training set ends by itself this long after the last touch
+const unsigned long TRAINING_IDLE_END_MS = 300000;
 
 // Application state
 enum AppMode {
@@ -57,12 +197,16 @@ enum AppMode {
 
 AppMode currentMode = MODE_SETUP;
 bool systemInitialized = false;
+bool wokeFromDormant = false;
+DormantSession dormant;         // Retained session after a DORMANT wake
+bool readyReported = false;     // Wake/boot-to-ready time logged
+bool networkServicesStarted = false; // Fast path and peer link, once Wi-Fi first came up
 
 // Split time tracking for display (last 3 splits)
 struct SplitTimeDisplay {
     uint8_t splitNumber;
     uint32_t totalTime;
-    String formattedTime;
+    char formattedTime[12];    // Fixed, so split display does not churn the heap
     bool valid;
 };
 
@@ -75,17 +219,54 @@ struct AppConfig {
     uint8_t laneNumber;
     bool useSSL;
     String role;         // "lane" or "starter"
+    SplitPosition position; // Lane devices: start end or turn end of the pool
+    uint32_t undoSeconds;   // Undo window after a touch (0 = undo off)
+    String fastPathKey;  // Shared key for UDP start/reset datagrams (empty = disabled)
+    bool peerLink;       // ESP-NOW fallback via the starter
+    bool usbLink;        // Framed messages to the PC bridge on the USB port
+    float driftPpm;      // Learned crystal drift (NAN until calibrated)
+    String startGate;    // "off", "warn" or "block"
+    uint32_t gateMs;     // Largest lane sync error bound the gate accepts
+    uint32_t dormantMinutes; // Inactivity before DORMANT (0 = never)
+    uint8_t portalAfter;     // Failed Wi-Fi attempts before the portal opens alongside (0 = never)
+    bool maintPortal;        // Open the maintenance portal once Wi-Fi is up
+    uint8_t trainSwimmers;   // Training mode: swimmers per lane (0 = off)
+    uint32_t trainGapS;      // Training send-off gap
+    uint32_t trainLapS;      // Training expected lap time
+    uint16_t distanceM;      // Distance event when the heat program gives none (0 = off)
+    uint8_t poolM;           // Pool length for the lap counter (25 or 50)
+    bool relay;              // Relay takeoff judging (lane devices at the start end)
+    uint32_t relayTolMs;     // Takeoff this much before the touch is not yet early
 } config;
 
 // Forward declarations
 void loadConfiguration();
 void setupMode();
 void normalMode();
-void initializeNormalOperation();
+void initializeNormalOperation(const DormantSession* resume);
+void enterDormant();
 void handleButtonEvents();
+void handleTrainingTouch();
+void updateTrainingLines();
+void startDistanceEvent();
+void updateDistanceLine();
+String distanceLabel();
+void serviceRelayJudge();
+bool startGateAllows();
+void updateReadinessDisplay();
+void updateSplitFeedDisplay();
 void updateDisplay();
 void checkConnections();
+void handleSerialCommands();
 void clearSplitDisplay();
+void updateLapSparkline();
+void serviceWifi(unsigned long now);
+void startNetworkServices();
+void startSetupPortal(const char* reason);
+void servicePortal();
+bool timingActive();
+size_t buildPortalStatus(char* buffer, size_t size);
+size_t buildPortalMetrics(char* buffer, size_t size);
 
 // Normal mode timing variables
 unsigned long lastDisplayUpdate = 0;
@@ -96,10 +277,14 @@ const unsigned long STATUS_UPDATE_INTERVAL = 1000;    // Update status every sec
 // Callback functions for stopwatch events
 void onStopwatchStateChanged(StopwatchState newState);
 void onLapAdded(uint8_t lapNumber, uint32_t lapTime, uint32_t totalTime);
+void onLapUndone(uint8_t lapNumber);
 void onConnectionChanged(bool connected);
 void onTimeSync(bool synced);
+void onDriftCalibrated(float ppm);
 void onEventHeatChanged(const String& event, const String& heat);
-void onSplitTimeReceived(uint8_t lane, const String& time);
+void onSplitTimeReceived(uint8_t lane, SplitPosition position, const String& time);
+void onLaneStatus(uint8_t lane, SyncQuality quality, uint32_t uncertaintyMs);
+void onLanePresence(const PresenceDelta& delta);
 void onDisplayClear();
 
 void setup() {
@@ -110,6 +295,10 @@ void setup() {
     Serial.begin(115200);
     Serial.println("\n=== T-Display S3 Stopwatch Starting ===");
     
+    // Placement policy before anything allocates its buffers
+    memoryPolicy.begin();
+    traceLog.begin();
+    
     // Initialize display first for user feedback
     if (!display.init()) {
         Serial.println("FATAL: Display initialization failed!");
@@ -122,23 +311,27 @@ void setup() {
         Serial.println("ERROR: Energy manager initialization failed!");
     }
     
+    // Woken from DORMANT by a button: no splash, straight back to the same AP
+    wokeFromDormant = EnergyManager::wokeFromDormant() && dormantRestore(dormant);
+    
     // Check if we have stored WiFi credentials
     if (CaptivePortalManager::hasStoredCredentials()) {
         Serial.println("Found stored WiFi credentials, attempting connection...");
-        display.showSplashScreen();
-        display.showStartupMessage("Connecting to WiFi...");
-        
-        // Try to connect with stored credentials
-        if (CaptivePortalManager::connectWithStoredCredentials()) {
-            Serial.println("WiFi connected with stored credentials!");
-            currentMode = MODE_NORMAL;
-            loadConfiguration();
-            initializeNormalOperation();
+        if (wokeFromDormant) {
+            Serial.printf("Woke from DORMANT after %lu min idle\n", (unsigned long)(dormant.idleMs / 60000));
+            display.showStartupMessage("Waking up...");
         } else {
-            Serial.println("Failed to connect with stored credentials, starting captive portal...");
-            currentMode = MODE_SETUP;
-            setupMode();
+            display.showSplashScreen();
+            display.showStartupMessage("Connecting to WiFi...");
         }
+        
+        // Connect in the background (the known AP first after a wake); an AP
+        // that is down at boot no longer sends the device into setup mode
+        currentMode = MODE_NORMAL;
+        loadConfiguration();
+        wifiConnector.begin(millis(), wokeFromDormant && dormant.wifiChannel != 0, config.portalAfter, esp_random());
+        serviceWifi(millis());
+        initializeNormalOperation(wokeFromDormant ? &dormant : nullptr);
     } else {
         Serial.println("No stored WiFi credentials found, starting captive portal...");
         currentMode = MODE_SETUP;
@@ -180,6 +373,24 @@ void loadConfiguration() {
     config.laneNumber = prefs.getUInt("lane", 9);
     config.useSSL = (config.wsPort == 443);
     config.role = prefs.getString("role", "lane");
+    config.position = splitPositionFromName(prefs.getString("position", "start").c_str());
+    config.undoSeconds = prefs.getUInt("undo_s", 10);
+    config.fastPathKey = prefs.getString("udp_key", "");
+    config.peerLink = prefs.getBool("peer_link", true);
+    config.usbLink = prefs.getBool("usb_link", true);
+    config.driftPpm = prefs.getFloat("drift_ppm", NAN);
+    config.startGate = prefs.getString("start_gate", "warn");
+    config.gateMs = prefs.getUInt("gate_ms", 20);
+    config.dormantMinutes = prefs.getUInt("dormant_min", 120);
+    config.portalAfter = prefs.getUInt("portal_after", 6);
+    config.maintPortal = prefs.getBool("maint_portal", false);
+    config.trainSwimmers = prefs.getUInt("train_swimmers", 0);
+    config.trainGapS = prefs.getUInt("train_gap_s", 10);
+    config.trainLapS = prefs.getUInt("train_lap_s", 30);
+    config.distanceM = prefs.getUInt("distance_m", 0);
+    config.poolM = prefs.getUInt("pool_m", 25);
+    config.relay = prefs.getBool("relay", false);
+    config.relayTolMs = prefs.getUInt("relay_tol_ms", 30);
     
     prefs.end();
     
@@ -208,7 +419,7 @@ void setupMode() {
     Serial.println("Connect to WiFi: T-Display-S3-Setup (Password: stopwatch123)");
 }
 
-void initializeNormalOperation() {
+void initializeNormalOperation(const DormantSession* resume) {
     Serial.println("Initializing normal stopwatch operation...");
     
     // Initialize button manager
@@ -217,6 +428,11 @@ void initializeNormalOperation() {
         display.showGeneralStatus("Button init failed!", COLOR_ERROR);
         delay(3000);
     }
+    // Exchanges happen at the start end; the block switch is only wired there
+    config.relay = config.relay && config.role != "starter" && config.position != POSITION_TURN;
+    if (config.relay) {
+        buttons.enableRelayInputs();
+    }
     
     // Setup display
     display.clearScreen();
@@ -225,10 +441,13 @@ void initializeNormalOperation() {
         display.setEventHeat("1", "1");
         display.updateRoleInfo(config.role, String(""), String(""), config.laneNumber);
     } else {
-        display.updateLaneInfo(config.laneNumber);
+        display.updateLaneInfo(config.laneNumber, config.position);
+    }
+    if (WiFi.status() == WL_CONNECTED) {
+        display.updateWiFiStatus("Connected", true, WiFi.RSSI());
+    } else {
+        display.updateWiFiStatus("Connecting...", false);
     }
-    int rssi = WiFi.RSSI();
-    display.updateWiFiStatus("Connected", true, rssi);
     
     // Show initial battery status using EnergyManager
     float batteryVoltage = energyManager.getBatteryVoltage();
@@ -238,16 +457,56 @@ void initializeNormalOperation() {
     // Setup stopwatch callbacks
     stopwatch.onStateChanged = onStopwatchStateChanged;
     stopwatch.onLapAdded = onLapAdded;
+    stopwatch.onLapUndone = onLapUndone;
     stopwatch.onConnectionChanged = onConnectionChanged;
     stopwatch.onTimeSync = onTimeSync;
+    stopwatch.onDriftCalibrated = onDriftCalibrated;
     stopwatch.onEventHeatChanged = onEventHeatChanged;
     stopwatch.onSplitTimeReceived = onSplitTimeReceived;
+    stopwatch.onLaneStatus = onLaneStatus;
+    stopwatch.onLanePresence = onLanePresence;
     stopwatch.onDisplayClear = onDisplayClear;
     
     // Initialize WebSocket connection
     display.showStartupMessage("Connecting to server...");
+    stopwatch.begin();
     stopwatch.setServerConfig(config.wsServer, config.wsPort, "/ws", config.useSSL);
     stopwatch.setLaneNumber(config.laneNumber);
+    stopwatch.setPosition(config.position);
+    stopwatch.setUndoWindow(config.undoSeconds * 1000);
+    if (config.role != "starter") {
+        // Lane devices only need their own lane plus start/reset/event traffic;
+        // the subscription lets the server skip the other lanes' split fan-out
+        stopwatch.setSubscribedTypes(WS_TYPES_ALL & ~(WS_TYPE_BIT(WS_TYPE_SPLIT) | WS_TYPE_BIT(WS_TYPE_SPLIT_UNDO) |
+                                                      WS_TYPE_BIT(WS_TYPE_STATUS) | WS_TYPE_BIT(WS_TYPE_PRESENCE)));
+        stopwatch.setSubscribedLanes(false);
+    }
+    String deviceName = "lane" + String(config.laneNumber);
+    if (config.position == POSITION_TURN) {
+        deviceName += "-turn";
+    }
+    traceLog.setDeviceName(config.role == "starter" ? String("starter") : deviceName);
+    
+    // Fast path and peer link need the AP (multicast, channel): started by
+    // serviceWifi() when it first comes up
+    bool gateway = config.role == "starter";
+    if (config.usbLink) {
+        usbLink.begin(gateway ? FRAME_NODE_GATEWAY : config.laneNumber);
+        stopwatch.setWiredLink(&usbLink);
+    }
+    if (!isnan(config.driftPpm)) {
+        stopwatch.setDriftCalibration(config.driftPpm);
+    }
+    stopwatch.restoreSyncState(); // Warm reboot / deep sleep wake: continue from the retained estimate
+    if (resume) {
+        stopwatch.restoreSession(resume->lastSeq, resume->serverEpoch, String(resume->event), String(resume->heat));
+    }
+    energyManager.setSleepTimeout(config.dormantMinutes * 60000UL);
+    energyManager.setSleepEnabled(config.dormantMinutes > 0);
+    if (stopwatch.getUnsettledSplitCount() > 0) {
+        Serial.printf("%u splits from before the reboot not yet acknowledged, resending\n",
+                      stopwatch.getUnsettledSplitCount());
+    }
     
     if (stopwatch.connect()) {
         Serial.println("WebSocket connection initiated");
@@ -262,18 +521,26 @@ void initializeNormalOperation() {
     display.updateStopwatchDisplay(0, false);
     
     systemInitialized = true;
+    memoryPolicy.printReport(Serial);
     Serial.println("Normal operation initialized successfully");
 }
 
 void normalMode() {
     unsigned long now = millis();
+    uint32_t passStartUs = micros();
     
     // Handle hardware buttons (highest priority)
     handleButtonEvents();
+    serviceRelayJudge();
     
     // Process WebSocket communication (high priority)
     stopwatch.loop();
     
+    serviceWifi(now);
+    servicePortal();
+    
+    handleSerialCommands();
+    
     // Update display at 10Hz (every 100ms)
     if (now - lastDisplayUpdate >= DISPLAY_UPDATE_INTERVAL) {
         updateDisplay();
@@ -286,17 +553,53 @@ void normalMode() {
         lastStatusUpdate = now;
     }
     
-    // Check for sleep timeout when idle
-    // if (energyManager.isSleepEnabled() && 
-    //     stopwatch.getState() == STOPWATCH_STOPPED && 
-    //     energyManager.checkSleepTimeout()) {
-    //     Serial.println("Sleep timeout reached, entering light sleep...");
-    //     energyManager.enterLightSleep();
-    // }
+    // Wake/boot-to-ready: server link up and clock locked
+    if (!readyReported && (stopwatch.isConnected() || stopwatch.isOnWiredLink()) &&
+        stopwatch.getSyncQuality() == SYNC_LOCKED) {
+        readyReported = true;
+        Serial.printf("Ready %lu ms after %s\n", now, wokeFromDormant ? "DORMANT wake" : "boot");
+    }
+    
+    // A server session that could send a start counts as use: a lane
+    // waiting through a meet break must be awake for the next start. Idle
+    // time runs from when the session ends, so a short drop is not enough
+    if (stopwatch.isAwaitingStart()) {
+        energyManager.keepAwake();
+    }
     
+    // DORMANT when idle between sessions: nothing running and the server
+    // has every split (the journal would survive, but the ack would wait)
+    if (energyManager.isSleepEnabled() &&
+        stopwatch.getState() == STOPWATCH_STOPPED &&
+        !training.isRunning() &&
+        stopwatch.getUnsettledSplitCount() == 0 &&
+        energyManager.checkSleepTimeout()) {
+        Serial.println("Inactivity timeout reached, entering DORMANT...");
+        enterDormant();
+    }
+    
+    loopBusy.add(micros() - passStartUs);
     delay(10);
 }
 
+void enterDormant() {
+    DormantSession session;
+    memset(&session, 0, sizeof(session));
+    session.lastSeq = stopwatch.getLastSequence();
+    session.serverEpoch = stopwatch.getServerEpoch();
+    strncpy(session.event, stopwatch.getCurrentEvent().c_str(), sizeof(session.event) - 1);
+    strncpy(session.heat, stopwatch.getCurrentHeat().c_str(), sizeof(session.heat) - 1);
+    if (WiFi.status() == WL_CONNECTED) {
+        session.wifiChannel = WiFi.channel();
+        memcpy(session.wifiBssid, WiFi.BSSID(), sizeof(session.wifiBssid));
+    }
+    session.idleMs = energyManager.getTimeSinceLastActivity();
+    dormantSave(session);
+    
+    stopwatch.disconnect();
+    energyManager.enterDormant(); // Does not return
+}
+
 void handleButtonEvents() {
     if (!systemInitialized) return;
     
@@ -311,22 +614,278 @@ void handleButtonEvents() {
             String ht = stopwatch.getCurrentHeat();
             if (ev.length() == 0) ev = "1";
             if (ht.length() == 0) ht = "1";
-            stopwatch.sendStart(ev, ht);
+            if (startGateAllows()) {
+                stopwatch.sendStart(ev, ht);
+            }
         } else {
             // Lane device creates a split if running
             if (stopwatch.getState() == STOPWATCH_RUNNING) {
-                stopwatch.addLap();
+                stopwatch.addLap(buttons.getLapPressedUs());
+                splitLatency.add(micros() - buttons.getLapPressedUs());
                 Serial.println("Split time created via button");
+            } else if (config.trainSwimmers > 0) {
+                handleTrainingTouch();
             } else {
                 Serial.println("Button pressed - stopwatch not running (lane mode)");
             }
         }
+    } else if (event == BUTTON_UNDO_PRESSED && config.role != "starter") {
+        energyManager.updateActivityTimer();
+        if (training.isRunning() && stopwatch.getState() != STOPWATCH_RUNNING) {
+            // Undo with no split left cancels a set started by mistake
+            if (training.undoLast()) {
+                updateTrainingLines();
+            } else {
+                training.end();
+                display.setStopwatchLabel("");
+                Serial.println("Training set cancelled");
+            }
+        } else if (!stopwatch.undoLastSplit()) {
+            display.showStartupMessage("Nothing to undo");
+        }
+    } else if (event == BUTTON_SETUP_HELD) {
+        energyManager.updateActivityTimer();
+        startSetupPortal("BUTTON1 held");
+    }
+}
+
+// Training mode, between heats: the first press sends the lane off, each
+// press after that is a touch for whichever swimmer it fits best. Splits
+// stay on the device.
+void handleTrainingTouch() {
+    unsigned long now = millis();
+    if (!training.isRunning()) {
+        training.begin(now, config.trainSwimmers, config.trainGapS * 1000, config.trainLapS * 1000);
+        clearSplitDisplay();
+        Serial.printf("Training set: %u swimmers, %lu s apart\n", config.trainSwimmers,
+                      (unsigned long)config.trainGapS);
+        return;
+    }
+    const TrainingSplit* split = training.recordSplit(now);
+    if (!split) {
+        Serial.println("Training touch before anyone was sent off");
+        return;
+    }
+    splitLatency.add(micros() - buttons.getLapPressedUs());
+    Serial.printf("Training S%u split %u: %s (%+ld ms)\n", split->swimmer + 1, split->number,
+                  stopwatch.formatTime(split->elapsedMs).c_str(), (long)split->marginMs);
+    updateTrainingLines();
+}
+
+// Lap counter for a distance event: the heat program's distance, else the
+// configured one. Lane devices only; the turn end sees odd lengths
+void startDistanceEvent() {
+    if (config.role == "starter") {
+        return;
+    }
+    uint16_t distance = stopwatch.getEventDistance() ? stopwatch.getEventDistance() : config.distanceM;
+    distanceEvent.begin(distance, config.poolM, config.position != POSITION_TURN);
+    if (distanceEvent.isActive()) {
+        Serial.printf("Distance event: %u m, %u lengths\n", distance, distanceEvent.getTotalLengths());
+    }
+}
+
+// Projected finish, lap and trend in the top split line (once there is a pace)
+void updateDistanceLine() {
+    if (relayJudge.isRunning()) {
+        return; // The line shows the relay exchanges
+    }
+    char finish[12];
+    char line[40];
+    if (distanceEvent.isFinished()) {
+        stopwatch.formatTime(distanceEvent.getProjectedFinishMs(), finish, sizeof(finish));
+        snprintf(line, sizeof(line), "Finish %s", finish);
+    } else if (distanceEvent.hasPace()) {
+        char lap[12];
+        stopwatch.formatTime(distanceEvent.getMeanLapMs(), lap, sizeof(lap));
+        stopwatch.formatTime(distanceEvent.getProjectedFinishMs(), finish, sizeof(finish));
+        snprintf(line, sizeof(line), "Fin %s %s %+.1f", finish, lap, distanceEvent.getTrendMsPerLap() / 1000.0f);
+    } else {
+        return;
+    }
+    display.updateLapTime(1, line);
+}
+
+// Stopwatch label during a distance event
+String distanceLabel() {
+    if (!distanceEvent.isActive() || stopwatch.getState() != STOPWATCH_RUNNING) {
+        return "";
+    }
+    uint16_t toGo = distanceEvent.getLengthsToGo();
+    if (toGo == 0) {
+        return "Finished";
+    }
+    return (distanceEvent.isBellLap() ? "BELL " : "") + String(toGo) + " to go";
+}
+
+// Relay mode: feed the interrupt edges to the judge in order, then show and
+// report each new exchange
+void serviceRelayJudge() {
+    if (!config.relay) {
+        return;
+    }
+    RelayEdge edge;
+    while (buttons.popRelayEdge(edge)) {
+        relayJudge.addEdge(edge);
+    }
+    if (!relayJudge.isRunning()) {
+        return;
+    }
+    relayJudge.poll(micros());
+    while (relayReported < relayJudge.getExchangeCount()) {
+        const RelayExchange& exchange = relayJudge.getExchange(++relayReported);
+        char line[40];
+        if (exchange.verdict == RELAY_NO_TOUCH) {
+            snprintf(line, sizeof(line), "Relay %u: no touch", exchange.number);
+        } else {
+            snprintf(line, sizeof(line), "Relay %u: %+.3f %s", exchange.number, exchange.marginUs / 1e6f,
+                     exchange.verdict == RELAY_EARLY ? "EARLY" : "OK");
+        }
+        display.updateLapTime(1, line);
+        stopwatch.sendRelayExchange(exchange);
+    }
+}
+
+// Latest three training splits, newest at the bottom
+void updateTrainingLines() {
+    char time[12];
+    for (uint8_t row = 0; row < 3; row++) {
+        uint8_t age = 2 - row;
+        if (age < training.getHistorySize()) {
+            const TrainingSplit& split = training.latest(age);
+            stopwatch.formatTime(split.elapsedMs, time, sizeof(time));
+            display.updateLapTime(row + 1, "S" + String(split.swimmer + 1) + " #" + String(split.number) + ": " + time);
+        } else {
+            display.updateLapTime(row + 1, "");
+        }
+    }
+}
+
+bool startGateAllows() {
+    if (config.startGate == "off" || stopwatch.getState() == STOPWATCH_RUNNING) {
+        return true; // Nothing to gate (sendStart refuses a second start itself)
+    }
+    
+    uint64_t notReady = laneReadiness.notReadyMask(millis(), config.gateMs);
+    if (notReady == 0) {
+        startGateWarnedAt = 0;
+        return true;
+    }
+    
+    String lanes;
+    for (uint8_t i = 0; i < LaneReadiness::MAX_LANES; i++) {
+        if (notReady & (1ULL << i)) {
+            if (lanes.length()) lanes += ",";
+            lanes += String(i);
+        }
+    }
+    
+    if (config.startGate == "warn" && startGateWarnedAt != 0 &&
+        millis() - startGateWarnedAt < START_GATE_CONFIRM_MS) {
+        Serial.printf("Start gate overridden, lanes not ready: %s\n", lanes.c_str());
+        startGateWarnedAt = 0;
+        return true;
+    }
+    
+    if (config.startGate == "block") {
+        Serial.printf("Start blocked, lanes not ready: %s\n", lanes.c_str());
+        display.showStartupMessage("Blocked: lanes " + lanes + " not synced");
+    } else {
+        Serial.printf("Start held, lanes not ready: %s (press again to start)\n", lanes.c_str());
+        display.showStartupMessage("Lanes " + lanes + " not synced - press again");
+        startGateWarnedAt = millis();
+    }
+    return false;
+}
+
+void updateReadinessDisplay() {
+    if (starterShowsSplitFeed) {
+        display.clearLapTimes(); // Also makes the grid redraw
+        starterShowsSplitFeed = false;
+    }
+    
+    // The grid has ten cells for up to 64 lanes: every lane that reports
+    // (the lowest ten), topped up with the lowest absent lanes, in lane order
+    LaneState all[LaneReadiness::MAX_LANES];
+    uint8_t present = 0;
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < LaneReadiness::MAX_LANES; i++) {
+        all[i] = laneReadiness.getState(i, now, config.gateMs);
+        present += all[i] != LANE_ABSENT;
+    }
+    uint8_t absentCells = present < READINESS_CELLS ? READINESS_CELLS - present : 0;
+    
+    uint8_t lanes[READINESS_CELLS];
+    LaneState states[READINESS_CELLS];
+    uint8_t battery[READINESS_CELLS];
+    uint8_t cells = 0;
+    for (uint8_t i = 0; i < LaneReadiness::MAX_LANES && cells < READINESS_CELLS; i++) {
+        if (all[i] == LANE_ABSENT) {
+            if (absentCells == 0) {
+                continue;
+            }
+            absentCells--;
+        }
+        lanes[cells] = i;
+        states[cells] = all[i];
+        battery[cells] = all[i] == LANE_ABSENT ? LaneReadiness::BATTERY_UNKNOWN : laneReadiness.getBatteryPercent(i);
+        cells++;
+    }
+    display.updateReadinessGrid(lanes, states, battery, cells);
+}
+
+void updateSplitFeedDisplay() {
+    if (!starterShowsSplitFeed) {
+        display.clearLapTimes();
+        starterShowsSplitFeed = true;
+    }
+    
+    // Latest three splits from both pool ends in time order, newest at the bottom
+    const SplitFeed& feed = stopwatch.getSplitFeed();
+    for (uint8_t row = 0; row < 3; row++) {
+        uint8_t age = 2 - row;
+        String line;
+        if (age < feed.size()) {
+            const SplitRecord& split = feed.latest(age);
+            line = "L" + String(split.lane) + (split.position == POSITION_TURN ? " turn " : " ") + split.time;
+        }
+        display.updateLapTime(row + 1, line);
+    }
+}
+
+void handleSerialCommands() {
+    // With the USB link on, the stopwatch reads the port and hands back
+    // whatever was not part of a frame
+    int command;
+    while ((command = config.usbLink ? usbLink.readConsole() : Serial.read()) >= 0) {
+        if (command == 't') {
+            traceLog.dump(Serial);
+        } else if (command == 'm') {
+            memoryPolicy.printReport(Serial);
+            memoryPolicy.runBenchmark(Serial);
+        }
     }
 }
 
 void updateDisplay() {
     if (!systemInitialized) return;
     
+    // Training set: the time of the swimmer due at the wall next
+    if (training.isRunning() && stopwatch.getState() != STOPWATCH_RUNNING) {
+        unsigned long now = millis();
+        if (now - training.getLastTouchMs() >= TRAINING_IDLE_END_MS) {
+            Serial.println("Training set ended (no touch for 5 min)");
+            training.end();
+        } else {
+            int8_t next = training.nextExpected(now);
+            display.clearStartupMessage();
+            display.setStopwatchLabel("S" + String(next + 1));
+            display.updateStopwatchDisplay(training.elapsedMs(next, now), true);
+            return;
+        }
+    }
+    display.setStopwatchLabel(distanceLabel());
+    
     // Update main stopwatch time display
     uint32_t elapsedTime = stopwatch.getElapsedTime();
     bool isRunning = (stopwatch.getState() == STOPWATCH_RUNNING);
@@ -354,30 +913,241 @@ void updateDisplay() {
 }
 
 void checkConnections() {
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("WiFi connection lost");
-        display.updateWiFiStatus("Disconnected", false);
-    } else {
+    if (wifiConnector.isConnected()) {
         display.updateWiFiStatus("Connected", true, WiFi.RSSI());
+    } else if (wifiConnector.getState() == WIFI_BACKOFF) {
+        display.updateWiFiStatus("Retry " + String((wifiConnector.getRetryInMs(millis()) + 999) / 1000) + "s", false);
+    } else {
+        display.updateWiFiStatus("Connecting...", false);
     }
     
-    if (!stopwatch.isConnected()) {
+    if (stopwatch.isOnWiredLink()) {
+        display.updateWebSocketStatus("USB", true, stopwatch.getPingMs());
+    } else if (stopwatch.isOnPeerLink()) {
+        display.updateWebSocketStatus("Via starter", true);
+    } else if (!stopwatch.isConnected()) {
         display.updateWebSocketStatus("Disconnected", false);
     } else {
         display.updateWebSocketStatus("Connected", true, stopwatch.getPingMs());
     }
     
-    display.updateBatteryDisplay(
-        energyManager.getBatteryVoltage(), 
-        energyManager.getBatteryPercentage()
-    );
+    uint8_t batteryPercent = energyManager.getBatteryPercentage();
+    display.updateBatteryDisplay(energyManager.getBatteryVoltage(), batteryPercent);
+    stopwatch.setBatteryPercent(batteryPercent); // Lane devices report it to the starter's roster
+    
+    if (config.role == "starter") {
+        if (stopwatch.getState() == STOPWATCH_RUNNING) {
+            updateSplitFeedDisplay();
+        } else {
+            updateReadinessDisplay();
+        }
+    }
+}
+
+void serviceWifi(unsigned long now) {
+    bool wasConnected = wifiConnector.isConnected();
+    switch (wifiConnector.update(now, WiFi.status() == WL_CONNECTED)) {
+        case WIFI_ACTION_CONNECT_KNOWN_AP:
+            CaptivePortalManager::beginStoredConnection(dormant.wifiChannel, dormant.wifiBssid);
+            break;
+        case WIFI_ACTION_CONNECT:
+            CaptivePortalManager::beginStoredConnection();
+            break;
+        case WIFI_ACTION_ABORT:
+            Serial.printf("WiFi attempt %lu failed (%u in a row), retry in %lu ms\n",
+                          (unsigned long)wifiConnector.getAttempts(), wifiConnector.getFailures(),
+                          (unsigned long)wifiConnector.getRetryInMs(now));
+            WiFi.disconnect();
+            break;
+        default:
+            break;
+    }
+    
+    if (wifiConnector.isConnected() != wasConnected) {
+        if (wasConnected) {
+            Serial.println("WiFi connection lost, reconnecting");
+        } else {
+            Serial.printf("WiFi up after %lu ms outage (%lu attempts), IP %s\n",
+                          (unsigned long)wifiConnector.getLastOutageMs(), (unsigned long)wifiConnector.getAttempts(),
+                          WiFi.localIP().toString().c_str());
+            startNetworkServices();
+            if (config.maintPortal) {
+                startSetupPortal("maintenance portal on");
+            }
+        }
+        lastStatusUpdate = 0; // Show it on the next status pass
+    }
+    
+    if (wifiConnector.portalDue() && !captivePortal) {
+        startSetupPortal("WiFi attempts keep failing");
+    }
+}
+
+void startNetworkServices() {
+    if (networkServicesStarted) {
+        return;
+    }
+    networkServicesStarted = true;
+    
+    stopwatch.enableFastPath(config.fastPathKey);
+    
+    // Peer link on the AP's channel, which the starter and the lanes share
+    bool gateway = config.role == "starter";
+    if (config.peerLink && peerLink.begin(gateway ? FRAME_NODE_GATEWAY : config.laneNumber, WiFi.channel())) {
+        stopwatch.setPeerLink(&peerLink, gateway);
+    }
+}
+
+void startSetupPortal(const char* reason) {
+    if (captivePortal) {
+        return;
+    }
+    // Alongside timing: the station stays up, or keeps retrying. Named per
+    // device, as several lanes may have theirs open at once
+    String apName = "Stopwatch-" + traceLog.getDeviceName();
+    Serial.printf("Opening setup portal (%s)\n", reason);
+    captivePortal = new CaptivePortalManager();
+    captivePortal->onStatus = buildPortalStatus;
+    captivePortal->onMetrics = buildPortalMetrics;
+    captivePortal->isTimingActive = timingActive;
+    captivePortal->begin(true, apName.c_str());
+    display.showGeneralStatus("Setup: " + apName, COLOR_WARNING);
+}
+
+void servicePortal() {
+    if (!captivePortal) {
+        return;
+    }
+    
+    // Rate-limited: one bounded turn per interval, longer apart during a heat
+    uint32_t startUs = micros();
+    if (portalScheduler.due(startUs)) {
+        captivePortal->loop();
+        portalScheduler.serviced(startUs, micros(), timingActive());
+    }
+    
+    // A saved configuration restarts the device, but not in the middle of a heat
+    if (captivePortal->isConfigComplete() && !timingActive()) {
+        Serial.println("Configuration complete, restarting...");
+        delay(1000);
+        ESP.restart();
+    }
+}
+
+bool timingActive() {
+    return stopwatch.getState() == STOPWATCH_RUNNING || stopwatch.getUnsettledSplitCount() > 0 ||
+           training.isRunning();
+}
+
+// snprintf onto the end of a response, never past its end
+static size_t appendf(char* buffer, size_t size, size_t length, const char* format, ...) {
+    if (length >= size) {
+        return length;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + length, size - length, format, args);
+    va_end(args);
+    if (written < 0) {
+        return length;
+    }
+    return length + written < size ? length + written : size - 1;
+}
+
+size_t buildPortalStatus(char* buffer, size_t size) {
+    const char* link = stopwatch.isOnWiredLink() ? "usb" : stopwatch.isOnPeerLink() ? "peer" :
+                       stopwatch.isConnected() ? "websocket" : "none";
+    const char* state = stopwatch.getState() == STOPWATCH_RUNNING ? "running" : "stopped";
+    return appendf(buffer, size, 0,
+                   "{\"device\":\"%s\",\"role\":\"%s\",\"uptime_ms\":%lu,\"state\":\"%s\",\"splits\":%u,"
+                   "\"unsettled_splits\":%u,\"sync\":\"%s\",\"uncertainty_ms\":%lu,\"ping_ms\":%d,\"link\":\"%s\","
+                   "\"wifi\":\"%s\",\"rssi\":%d,\"ip\":\"%s\",\"wifi_attempts\":%lu,\"dropped_frames\":%lu,"
+                   "\"heap_free\":%lu,\"arena_high_water\":%u,\"portal_services\":%lu,\"portal_overruns\":%lu}",
+                   traceLog.getDeviceName().c_str(), config.role.c_str(), millis(), state, stopwatch.getLapCount(),
+                   stopwatch.getUnsettledSplitCount(), ClockSync::qualityName(stopwatch.getSyncQuality()),
+                   (unsigned long)stopwatch.getSyncUncertaintyMs(), stopwatch.getPingMs(), link,
+                   WifiConnector::stateName(wifiConnector.getState()), WiFi.RSSI(), WiFi.localIP().toString().c_str(),
+                   (unsigned long)wifiConnector.getAttempts(), (unsigned long)stopwatch.getDroppedFrameCount(),
+                   (unsigned long)ESP.getFreeHeap(), (unsigned)stopwatch.getHeatArena().getHighWater(),
+                   (unsigned long)portalScheduler.getServices(), (unsigned long)portalScheduler.getOverruns());
+}
+
+static size_t appendHistogram(char* buffer, size_t size, size_t length, const char* name, const char* help,
+                              const LatencyHistogram& histogram) {
+    length = appendf(buffer, size, length, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < LatencyHistogram::BUCKETS; i++) {
+        cumulative += histogram.getBucket(i);
+        length = appendf(buffer, size, length, "%s_bucket{le=\"%lu\"} %lu\n", name,
+                         (unsigned long)LatencyHistogram::bucketLimitUs(i), (unsigned long)cumulative);
+    }
+    return appendf(buffer, size, length, "%s_bucket{le=\"+Inf\"} %lu\n%s_sum %llu\n%s_count %lu\n", name,
+                   (unsigned long)histogram.getCount(), name, (unsigned long long)histogram.getTotalUs(), name,
+                   (unsigned long)histogram.getCount());
+}
+
+size_t buildPortalMetrics(char* buffer, size_t size) {
+    size_t length = appendHistogram(buffer, size, 0, "stopwatch_split_latency_us",
+                                    "Lap press to split recorded", splitLatency);
+    length = appendHistogram(buffer, size, length, "stopwatch_loop_busy_us",
+                             "Main loop pass, without its delay", loopBusy);
+    length = appendf(buffer, size, length,
+                     "# HELP stopwatch_hot_path_stalls_total Runs over twice the best, as after a cache miss\n"
+                     "# TYPE stopwatch_hot_path_stalls_total counter\n");
+    for (uint8_t path = 0; path < HOT_PATH_COUNT; path++) {
+        const HotPathProbe& probe = hotPathProbes[path];
+        const char* name = hotPathName((HotPath)path);
+        length = appendf(buffer, size, length,
+                         "stopwatch_hot_path_runs_total{path=\"%s\"} %lu\n"
+                         "stopwatch_hot_path_stalls_total{path=\"%s\"} %lu\n"
+                         "stopwatch_hot_path_best_cycles{path=\"%s\"} %lu\n"
+                         "stopwatch_hot_path_worst_cycles{path=\"%s\"} %lu\n",
+                         name, (unsigned long)probe.getRuns(), name, (unsigned long)probe.getStalls(),
+                         name, (unsigned long)probe.getBestCycles(), name, (unsigned long)probe.getWorstCycles());
+    }
+    return appendf(buffer, size, length,
+                   "stopwatch_loop_busy_max_us %lu\n"
+                   "stopwatch_portal_services_total %lu\n"
+                   "stopwatch_portal_overruns_total %lu\n"
+                   "stopwatch_portal_service_max_us %lu\n"
+                   "stopwatch_portal_service_us_total %llu\n"
+                   "stopwatch_timing_active %d\n"
+                   "stopwatch_unsettled_splits %u\n"
+                   "stopwatch_heap_free_bytes %lu\n",
+                   (unsigned long)loopBusy.getMaxUs(), (unsigned long)portalScheduler.getServices(),
+                   (unsigned long)portalScheduler.getOverruns(), (unsigned long)portalScheduler.getMaxServiceUs(),
+                   (unsigned long long)portalScheduler.getTotalServiceUs(), timingActive() ? 1 : 0,
+                   stopwatch.getUnsettledSplitCount(), (unsigned long)ESP.getFreeHeap());
 }
 
 // Callback functions
 void onStopwatchStateChanged(StopwatchState newState) {
-    if (newState == STOPWATCH_STOPPED) {
+    energyManager.updateActivityTimer(); // Start/reset from the server count as use
+    if (newState == STOPWATCH_RUNNING && training.isRunning()) {
+        // A heat takes the lane over
+        training.end();
+        display.setStopwatchLabel("");
+        clearSplitDisplay();
+        Serial.println("Training set ended by a heat start");
+    }
+    if (newState == STOPWATCH_STOPPED && !training.isRunning()) {
         clearSplitDisplay();
     }
+    if (newState == STOPWATCH_RUNNING) {
+        startDistanceEvent();
+    } else if (newState == STOPWATCH_STOPPED) {
+        distanceEvent.begin(0, config.poolM, true);
+    }
+    if (config.relay && newState == STOPWATCH_RUNNING) {
+        // From the heat's own start, which may be before the start message arrived
+        RelayEdge edge;
+        while (buttons.popRelayEdge(edge)) {}
+        relayJudge.begin(micros() - stopwatch.getElapsedTime() * 1000, config.relayTolMs * 1000,
+                         buttons.isBlockOccupied());
+        relayReported = 0;
+    } else if (newState == STOPWATCH_STOPPED) {
+        relayJudge.end();
+    }
     Serial.printf("Stopwatch state: %d\n", newState);
 }
 
@@ -386,7 +1156,8 @@ void onLapAdded(uint8_t lapNumber, uint32_t /* lapTime */, uint32_t totalTime) {
     
     lastSplits[0] = lastSplits[1];
     lastSplits[1] = lastSplits[2];
-    lastSplits[2] = {lapNumber, totalTime, stopwatch.formatTime(totalTime), true};
+    lastSplits[2] = {lapNumber, totalTime, "", true};
+    stopwatch.formatTime(totalTime, lastSplits[2].formattedTime, sizeof(lastSplits[2].formattedTime));
     
     for (int i = 0; i < 3; i++) {
         if (lastSplits[i].valid) {
@@ -395,6 +1166,39 @@ void onLapAdded(uint8_t lapNumber, uint32_t /* lapTime */, uint32_t totalTime) {
             display.updateLapTime(i + 1, "");
         }
     }
+    updateLapSparkline();
+    if (distanceEvent.isActive()) {
+        distanceEvent.addSplit(totalTime);
+        updateDistanceLine();
+    }
+}
+
+void onLapUndone(uint8_t lapNumber) {
+    Serial.printf("Split %d undone\n", lapNumber);
+    
+    // Rebuild the last three from what is left
+    const LapData* laps = stopwatch.getLaps();
+    uint8_t count = stopwatch.getLapCount();
+    for (int i = 0; i < 3; i++) {
+        int lap = count - 3 + i;
+        if (lap >= 0) {
+            lastSplits[i] = {(uint8_t)(lap + 1), laps[lap].totalTimeMs, "", true};
+            stopwatch.formatTime(laps[lap].totalTimeMs, lastSplits[i].formattedTime, sizeof(lastSplits[i].formattedTime));
+            display.updateLapTime(i + 1, "Split - " + String(lastSplits[i].splitNumber) + ": " + lastSplits[i].formattedTime);
+        } else {
+            lastSplits[i] = {0, 0, "", false};
+            display.updateLapTime(i + 1, "");
+        }
+    }
+    updateLapSparkline();
+    if (distanceEvent.isActive()) {
+        // Replay what is left; a heat is at most a few dozen splits
+        distanceEvent.clearSplits();
+        for (uint8_t i = 0; i < count; i++) {
+            distanceEvent.addSplit(laps[i].totalTimeMs);
+        }
+        updateDistanceLine();
+    }
 }
 
 void onConnectionChanged(bool connected) {
@@ -407,15 +1211,42 @@ void onTimeSync(bool synced) {
     Serial.printf("Time sync %s\n", synced ? "active" : "lost");
 }
 
+void onDriftCalibrated(float ppm) {
+    // Rate-limited by the estimator: only written when it moved noticeably
+    Preferences prefs;
+    prefs.begin("stopwatch", false);
+    prefs.putFloat("drift_ppm", ppm);
+    prefs.end();
+    config.driftPpm = ppm;
+    Serial.printf("Drift calibration saved: %.2f ppm\n", ppm);
+}
+
 void onEventHeatChanged(const String& event, const String& heat) {
     Serial.printf("Event/Heat: %s/%s\n", event.c_str(), heat.c_str());
     if (config.role == "starter") {
         display.setEventHeat(event, heat);
+    } else if (stopwatch.getState() == STOPWATCH_RUNNING && stopwatch.getLapCount() == 0) {
+        // The heat program can arrive just after the start (or with a resume snapshot)
+        startDistanceEvent();
+    }
+}
+
+void onSplitTimeReceived(uint8_t lane, SplitPosition position, const String& time) {
+    Serial.printf("Lane %d %s split: %s\n", lane, splitPositionName(position), time.c_str());
+    if (config.role == "starter" && stopwatch.getState() == STOPWATCH_RUNNING) {
+        updateSplitFeedDisplay();
     }
 }
 
-void onSplitTimeReceived(uint8_t lane, const String& time) {
-    Serial.printf("Lane %d split: %s\n", lane, time.c_str());
+void onLaneStatus(uint8_t lane, SyncQuality quality, uint32_t uncertaintyMs) {
+    laneReadiness.update(lane, quality, uncertaintyMs, millis());
+}
+
+void onLanePresence(const PresenceDelta& delta) {
+    laneReadiness.applyPresence(delta, millis());
+    if (stopwatch.getState() != STOPWATCH_RUNNING) {
+        updateReadinessDisplay(); // Redraws only the cells that changed
+    }
 }
 
 void onDisplayClear() {
@@ -429,4 +1260,12 @@ void clearSplitDisplay() {
         lastSplits[i] = {0, 0, "", false};
         display.updateLapTime(i + 1, "");
     }
+    updateLapSparkline();
+}
+
+// The bottom strip is the starter's event line; lanes show the heat's pace there
+void updateLapSparkline() {
+    if (config.role != "starter") {
+        display.updateLapSparkline(stopwatch.getLaps(), stopwatch.getLapCount());
+    }
 }
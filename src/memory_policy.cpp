@@ -0,0 +1,205 @@
+/**
+ * Memory Placement Policy Implementation for T-Display S3 Stopwatch
+ */
+
+#include "memory_policy.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+MemoryPolicy memoryPolicy;
+
+static const uint32_t CLASS_CAPS[MEM_CLASS_COUNT] = {
+    MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT
+};
+
+static const size_t DEFAULT_BUDGETS[MEM_CLASS_COUNT] = {
+    16 * 1024,      // DMA
+    32 * 1024,      // Fast internal
+    512 * 1024      // Bulk PSRAM
+};
+
+MemoryPolicy::MemoryPolicy()
+    : psram(false) {
+    for (uint8_t i = 0; i < MAX_BLOCKS; i++) {
+        blocks[i].ptr = nullptr;
+    }
+    for (uint8_t i = 0; i < MEM_CLASS_COUNT; i++) {
+        stats[i] = {DEFAULT_BUDGETS[i], 0, 0, 0, 0, 0};
+    }
+}
+
+void MemoryPolicy::begin() {
+    psram = psramFound();
+    if (psram) {
+        // mbedTLS record buffers and WebSocket frames are plain mallocs
+        heap_caps_malloc_extmem_enable(EXTMEM_THRESHOLD);
+    }
+    Serial.printf("Memory policy: PSRAM %s, internal free %u bytes\n",
+                  psram ? "found" : "not found (bulk falls back to internal)",
+                  (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+}
+
+void MemoryPolicy::setBudget(MemoryClass memoryClass, size_t bytes) {
+    stats[memoryClass].budget = bytes;
+}
+
+const char* MemoryPolicy::className(MemoryClass memoryClass) {
+    switch (memoryClass) {
+        case MEM_DMA:  return "dma";
+        case MEM_FAST: return "fast";
+        case MEM_BULK: return "bulk";
+        default:       return "?";
+    }
+}
+
+void* MemoryPolicy::allocate(MemoryClass memoryClass, size_t size, const char* owner) {
+    ClassStats& cls = stats[memoryClass];
+    Block* slot = nullptr;
+    for (uint8_t i = 0; i < MAX_BLOCKS && !slot; i++) {
+        if (!blocks[i].ptr) {
+            slot = &blocks[i];
+        }
+    }
+
+    bool internal = memoryClass != MEM_BULK || !psram;
+    bool allowed = slot && cls.used + size <= cls.budget &&
+                   (!internal || heap_caps_get_free_size(MALLOC_CAP_INTERNAL) >= size + INTERNAL_RESERVE);
+    void* block = allowed ? heap_caps_malloc(size, internal && memoryClass == MEM_BULK ? CLASS_CAPS[MEM_FAST]
+                                                                                         : CLASS_CAPS[memoryClass])
+                          : nullptr;
+    if (!block) {
+        cls.failures++;
+        Serial.printf("Memory policy: %u bytes of %s for %s refused\n", (unsigned)size, className(memoryClass), owner);
+        return nullptr;
+    }
+
+    *slot = {block, size, memoryClass, internal, owner};
+    cls.used += size;
+    cls.blocks++;
+    if (cls.used > cls.peak) {
+        cls.peak = cls.used;
+    }
+    if (memoryClass == MEM_BULK && internal) {
+        cls.fallbacks++;
+    }
+    return block;
+}
+
+void MemoryPolicy::release(void* block) {
+    if (!block) {
+        return;
+    }
+    for (uint8_t i = 0; i < MAX_BLOCKS; i++) {
+        if (blocks[i].ptr == block) {
+            ClassStats& cls = stats[blocks[i].memoryClass];
+            cls.used -= blocks[i].size;
+            cls.blocks--;
+            blocks[i].ptr = nullptr;
+            heap_caps_free(block);
+            return;
+        }
+    }
+    Serial.println("Memory policy: release of an unknown block ignored");
+}
+
+void MemoryPolicy::printReport(Print& out) const {
+    out.println("Memory classes:  budget    used    peak  blocks  failed  fallback");
+    for (uint8_t i = 0; i < MEM_CLASS_COUNT; i++) {
+        const ClassStats& cls = stats[i];
+        out.printf("  %-6s %9u %7u %7u %7u %7u %9u\n", className((MemoryClass)i),
+                   (unsigned)cls.budget, (unsigned)cls.used, (unsigned)cls.peak,
+                   (unsigned)cls.blocks, (unsigned)cls.failures, (unsigned)cls.fallbacks);
+    }
+    for (uint8_t i = 0; i < MAX_BLOCKS; i++) {
+        if (blocks[i].ptr) {
+            out.printf("  %-16s %-4s %7u bytes %s\n", blocks[i].owner, className(blocks[i].memoryClass),
+                       (unsigned)blocks[i].size, blocks[i].internal ? "internal" : "psram");
+        }
+    }
+    out.printf("Internal: %u free, largest block %u, lowest free %u\n",
+               (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+               (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL),
+               (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    out.printf("DMA-capable: %u free, largest block %u\n",
+               (unsigned)heap_caps_get_free_size(MALLOC_CAP_DMA),
+               (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_DMA));
+    if (psram) {
+        out.printf("PSRAM: %u free, largest block %u (mallocs over %u bytes go here)\n",
+                   (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+                   (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM),
+                   (unsigned)EXTMEM_THRESHOLD);
+    }
+}
+
+// Access costs of one buffer: streaming write and read, random 32-bit
+// reads (cache misses once the buffer outgrows the data cache) and
+// 40-byte record writes as the trace log does them
+static void measureBuffer(Print& out, const char* label, uint8_t* buffer, size_t size) {
+    static const uint32_t STREAM_BYTES = 1024 * 1024;
+    static const uint32_t RANDOM_READS = 16384;
+    static const uint32_t RECORD_SIZE = 40;
+    static const uint32_t RECORD_WRITES = 4096;
+
+    uint32_t passes = STREAM_BYTES / size ? STREAM_BYTES / size : 1;
+    const uint32_t* words = (const uint32_t*)buffer;
+    uint32_t wordCount = size / sizeof(uint32_t);
+    uint32_t sum = 0;
+
+    int64_t t0 = esp_timer_get_time();
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        memset(buffer, (int)pass, size);
+    }
+    int64_t t1 = esp_timer_get_time();
+    for (uint32_t pass = 0; pass < passes; pass++) {
+        for (uint32_t i = 0; i < wordCount; i++) {
+            sum += words[i];
+        }
+    }
+    int64_t t2 = esp_timer_get_time();
+    uint32_t index = 1;
+    for (uint32_t i = 0; i < RANDOM_READS; i++) {
+        index = index * 1664525u + 1013904223u;
+        sum += words[(index >> 8) % wordCount];
+    }
+    int64_t t3 = esp_timer_get_time();
+    uint8_t record[RECORD_SIZE];
+    memset(record, 0x5A, sizeof(record));
+    uint32_t slots = size / RECORD_SIZE;
+    for (uint32_t i = 0; i < RECORD_WRITES; i++) {
+        memcpy(buffer + (i % slots) * RECORD_SIZE, record, RECORD_SIZE);
+    }
+    int64_t t4 = esp_timer_get_time();
+
+    // Bytes per µs is MB/s
+    double streamed = (double)passes * size;
+    out.printf("  %-22s write %6.1f MB/s  read %6.1f MB/s  random read %5.0f ns  record %5.0f ns  (%08lx)\n",
+               label, streamed / (t1 - t0), streamed / (t2 - t1),
+               (t3 - t2) * 1000.0 / RANDOM_READS, (t4 - t3) * 1000.0 / RECORD_WRITES, (unsigned long)sum);
+}
+
+void MemoryPolicy::runBenchmark(Print& out) {
+    struct Case {
+        MemoryClass memoryClass;
+        size_t size;
+        const char* label;
+    };
+    static const Case CASES[] = {
+        {MEM_DMA, 16 * 1024, "dma 16 KB"},
+        {MEM_FAST, 16 * 1024, "fast 16 KB"},
+        {MEM_BULK, 16 * 1024, "bulk 16 KB (cached)"},
+        {MEM_BULK, 256 * 1024, "bulk 256 KB"},
+    };
+
+    out.println("Memory access costs:");
+    for (const Case& c : CASES) {
+        uint8_t* buffer = (uint8_t*)allocate(c.memoryClass, c.size, "benchmark");
+        if (!buffer) {
+            out.printf("  %-22s not available\n", c.label);
+            continue;
+        }
+        measureBuffer(out, c.label, buffer, c.size);
+        release(buffer);
+    }
+}
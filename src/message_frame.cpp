@@ -0,0 +1,160 @@
+#include "message_frame.h"
+#include <string.h>
+
+uint16_t frameCrc16(const uint8_t* data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t frameEncode(uint8_t source, uint16_t seq, const uint8_t* payload, size_t length,
+                   uint8_t* out, size_t outSize) {
+    if (length > 0xFFFF || length + FRAME_OVERHEAD > outSize) {
+        return 0;
+    }
+    out[0] = FRAME_SOF;
+    out[1] = FRAME_VERSION;
+    out[2] = source;
+    out[3] = seq & 0xFF;
+    out[4] = seq >> 8;
+    out[5] = length & 0xFF;
+    out[6] = length >> 8;
+    memcpy(out + FRAME_HEADER_SIZE, payload, length);
+
+    uint16_t crc = frameCrc16(out + 1, FRAME_HEADER_SIZE - 1 + length);
+    out[FRAME_HEADER_SIZE + length] = crc & 0xFF;
+    out[FRAME_HEADER_SIZE + length + 1] = crc >> 8;
+    return length + FRAME_OVERHEAD;
+}
+
+bool frameDecode(const uint8_t* frame, size_t length, FrameHeader& header, const uint8_t** payload) {
+    if (length < FRAME_OVERHEAD || frame[0] != FRAME_SOF || frame[1] != FRAME_VERSION) {
+        return false;
+    }
+    uint16_t payloadLength = frame[5] | (frame[6] << 8);
+    if ((size_t)payloadLength + FRAME_OVERHEAD != length) {
+        return false;
+    }
+    uint16_t crc = frame[FRAME_HEADER_SIZE + payloadLength] | (frame[FRAME_HEADER_SIZE + payloadLength + 1] << 8);
+    if (frameCrc16(frame + 1, FRAME_HEADER_SIZE - 1 + payloadLength) != crc) {
+        return false;
+    }
+    header.source = frame[2];
+    header.seq = frame[3] | (frame[4] << 8);
+    header.length = payloadLength;
+    *payload = frame + FRAME_HEADER_SIZE;
+    return true;
+}
+
+FrameStreamDecoder::FrameStreamDecoder(uint8_t* buffer, size_t size)
+    : buffer(buffer)
+    , size(size)
+    , filled(0)
+    , expected(0)
+    , frameLength(0)
+    , discarded(0) {
+}
+
+FrameStreamDecoder::Result FrameStreamDecoder::push(uint8_t byte) {
+    frameLength = 0;
+    if (filled == 0) {
+        if (byte != FRAME_SOF) {
+            return PASSTHROUGH;
+        }
+        buffer[filled++] = byte;
+        return PENDING;
+    }
+
+    buffer[filled++] = byte;
+    if (filled == 2 && byte != FRAME_VERSION) {
+        filled = 0;
+        discarded++;
+        return byte == FRAME_SOF ? push(byte) : PENDING;
+    }
+    if (filled == FRAME_HEADER_SIZE) {
+        expected = (size_t)(buffer[5] | (buffer[6] << 8)) + FRAME_OVERHEAD;
+        if (expected > size) {
+            filled = 0;
+            expected = 0;
+            discarded++;
+            return PENDING;
+        }
+    }
+    if (filled >= FRAME_HEADER_SIZE && filled == expected) {
+        frameLength = filled;
+        filled = 0;
+        expected = 0;
+        return COMPLETE;
+    }
+    return PENDING;
+}
+
+FrameDuplicateFilter::FrameDuplicateFilter() {
+    clear();
+}
+
+void FrameDuplicateFilter::clear() {
+    for (uint8_t i = 0; i < MAX_SOURCES; i++) {
+        windows[i].used = false;
+    }
+    nextEvict = 0;
+    duplicates = 0;
+}
+
+bool FrameDuplicateFilter::accept(uint8_t source, uint16_t seq) {
+    bool fresh;
+    Window& window = windowFor(source, fresh);
+    if (fresh) {
+        window.newest = seq;
+        window.seen = 1;
+        return true;
+    }
+
+    int16_t ahead = (int16_t)(seq - window.newest);
+    if (ahead > 0) {
+        window.seen = ahead >= 32 ? 1 : (window.seen << ahead) | 1;
+        window.newest = seq;
+        return true;
+    }
+    if (ahead > -32) {
+        uint32_t bit = 1UL << -ahead;
+        if (window.seen & bit) {
+            duplicates++;
+            return false;
+        }
+        window.seen |= bit;
+        return true;
+    }
+
+    // Far behind the window: the source restarted its count
+    window.newest = seq;
+    window.seen = 1;
+    return true;
+}
+
+FrameDuplicateFilter::Window& FrameDuplicateFilter::windowFor(uint8_t source, bool& fresh) {
+    for (uint8_t i = 0; i < MAX_SOURCES; i++) {
+        if (windows[i].used && windows[i].source == source) {
+            fresh = false;
+            return windows[i];
+        }
+    }
+    for (uint8_t i = 0; i < MAX_SOURCES; i++) {
+        if (!windows[i].used) {
+            windows[i].used = true;
+            windows[i].source = source;
+            fresh = true;
+            return windows[i];
+        }
+    }
+    // More sources than windows: recycle round-robin
+    Window& window = windows[nextEvict];
+    nextEvict = (nextEvict + 1) % MAX_SOURCES;
+    window.source = source;
+    fresh = true;
+    return window;
+}
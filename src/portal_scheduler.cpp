@@ -0,0 +1,67 @@
+#include "portal_scheduler.h"
+
+PortalScheduler::PortalScheduler()
+    : nextUs(0)
+    , services(0)
+    , overruns(0)
+    , maxServiceUs(0)
+    , totalServiceUs(0) {
+}
+
+void PortalScheduler::serviced(uint32_t startUs, uint32_t endUs, bool timingActive) {
+    uint32_t tookUs = endUs - startUs;
+    services++;
+    totalServiceUs += tookUs;
+    if (tookUs > maxServiceUs) {
+        maxServiceUs = tookUs;
+    }
+
+    uint32_t interval = timingActive ? RUNNING_INTERVAL_US : IDLE_INTERVAL_US;
+    if (tookUs > SLICE_BUDGET_US) {
+        // Keep the duty cycle: an overrun buys a proportionally longer pause
+        overruns++;
+        interval = (uint32_t)((uint64_t)interval * tookUs / SLICE_BUDGET_US);
+    }
+    nextUs = endUs + interval;
+}
+
+LatencyHistogram::LatencyHistogram() {
+    clear();
+}
+
+void LatencyHistogram::clear() {
+    for (uint8_t i = 0; i <= BUCKETS; i++) {
+        buckets[i] = 0;
+    }
+    count = 0;
+    maxUs = 0;
+    totalUs = 0;
+}
+
+void LatencyHistogram::add(uint32_t us) {
+    uint8_t index = 0;
+    while (index < BUCKETS && us > bucketLimitUs(index)) {
+        index++;
+    }
+    buckets[index]++;
+    count++;
+    totalUs += us;
+    if (us > maxUs) {
+        maxUs = us;
+    }
+}
+
+uint32_t LatencyHistogram::quantileUs(float fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t wanted = (uint32_t)(fraction * count);
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > wanted || seen == count) {
+            return bucketLimitUs(i);
+        }
+    }
+    return maxUs;
+}
@@ -0,0 +1,122 @@
+#include "relay_judge.h"
+
+const char* relayVerdictName(RelayVerdict verdict) {
+    switch (verdict) {
+        case RELAY_OK:          return "ok";
+        case RELAY_EARLY:       return "early";
+        case RELAY_NO_TOUCH:    return "no-touch";
+    }
+    return "ok";
+}
+
+RelayJudge::RelayJudge()
+    : running(false)
+    , startUs(0)
+    , toleranceUs(0)
+    , occupied(false)
+    , occupiedSinceUs(0)
+    , touchWaiting(false)
+    , touchSeen(false)
+    , lastTouchUs(0)
+    , releaseWaiting(false)
+    , releaseUs(0)
+    , exchangeCount(0)
+    , ignoredEdges(0) {
+}
+
+void RelayJudge::begin(uint32_t start, uint32_t tolerance, bool blockOccupied) {
+    running = true;
+    startUs = start;
+    toleranceUs = tolerance;
+    // Whoever is on the block already has been there long enough
+    occupied = blockOccupied;
+    occupiedSinceUs = start - ARM_SETTLE_US;
+    touchWaiting = false;
+    touchSeen = false;
+    releaseWaiting = false;
+    exchangeCount = 0;
+    ignoredEdges = 0;
+}
+
+void RelayJudge::end() {
+    running = false;
+    releaseWaiting = false;
+    touchWaiting = false;
+}
+
+void RelayJudge::addEdge(const RelayEdge& edge) {
+    if (!running) {
+        return;
+    }
+    poll(edge.us);
+    switch (edge.kind) {
+        case RELAY_TOUCH:
+            touch(edge.us);
+            break;
+        case RELAY_BLOCK_OFF:
+            release(edge.us);
+            break;
+        case RELAY_BLOCK_ON:
+            if (!occupied) {
+                occupied = true;
+                occupiedSinceUs = edge.us;
+            }
+            break;
+    }
+}
+
+void RelayJudge::poll(uint32_t nowUs) {
+    if (releaseWaiting && (int32_t)(nowUs - releaseUs) > (int32_t)EARLY_WINDOW_US) {
+        releaseWaiting = false;
+        record(RELAY_NO_TOUCH, 0, releaseUs);
+    }
+}
+
+void RelayJudge::touch(uint32_t us) {
+    if (touchSeen && us - lastTouchUs < TOUCH_DEBOUNCE_US) {
+        ignoredEdges++;
+        return;
+    }
+    touchSeen = true;
+    lastTouchUs = us;
+    if (releaseWaiting) {
+        // The outgoing swimmer was already gone
+        releaseWaiting = false;
+        record(us - releaseUs > toleranceUs ? RELAY_EARLY : RELAY_OK, us, releaseUs);
+    } else {
+        touchWaiting = true;
+    }
+}
+
+void RelayJudge::release(uint32_t us) {
+    bool settled = occupied && us - occupiedSinceUs >= ARM_SETTLE_US;
+    occupied = false;
+    if (!settled) {
+        ignoredEdges++;
+        return;
+    }
+    if (touchWaiting && us - lastTouchUs <= LATE_WINDOW_US) {
+        touchWaiting = false;
+        record(RELAY_OK, lastTouchUs, us);
+        return;
+    }
+    touchWaiting = false;
+    if (!touchSeen && us - startUs <= LEAD_OFF_US) {
+        return; // The lead-off swimmer's start
+    }
+    if (releaseWaiting) {
+        record(RELAY_NO_TOUCH, 0, releaseUs);
+    }
+    releaseWaiting = true;
+    releaseUs = us;
+}
+
+void RelayJudge::record(RelayVerdict verdict, uint32_t touchUs, uint32_t release) {
+    RelayExchange& exchange = exchanges[exchangeCount % HISTORY];
+    exchangeCount++;
+    exchange.number = exchangeCount;
+    exchange.verdict = verdict;
+    exchange.touchUs = touchUs;
+    exchange.releaseUs = release;
+    exchange.marginUs = verdict == RELAY_NO_TOUCH ? 0 : (int32_t)(release - touchUs);
+}
@@ -0,0 +1,167 @@
+#include "split_board.h"
+#include <string.h>
+
+const char* splitPositionName(SplitPosition position) {
+    return position == POSITION_TURN ? "turn" : "start";
+}
+
+SplitPosition splitPositionFromName(const char* name) {
+    return name && strcmp(name, "turn") == 0 ? POSITION_TURN : POSITION_START;
+}
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+// Host builds against glibc before 2.38, which has no strlcpy
+static size_t strlcpy(char* dest, const char* src, size_t size) {
+    size_t length = strlen(src);
+    if (size > 0) {
+        size_t copied = length < size - 1 ? length : size - 1;
+        memcpy(dest, src, copied);
+        dest[copied] = '\0';
+    }
+    return length;
+}
+#endif
+
+static void copyTime(char* dest, const char* time) {
+    strlcpy(dest, time ? time : "", sizeof(SplitRecord::time));
+}
+
+void SplitRegistry::begin(HeatArena& arena) {
+    entries.begin(arena, INITIAL_ENTRIES);
+}
+
+const SplitRecord* SplitRegistry::record(uint8_t lane, SplitPosition position, uint64_t timestamp, const char* time) {
+    uint16_t key = keyOf(lane, position);
+    uint16_t index = lowerBound(key);
+
+    if (index == entries.size() || keyOf(entries[index].lane, entries[index].position) != key) {
+        // New device: keep the array sorted by key
+        SplitRecord* added = entries.size() < MAX_ENTRIES ? entries.insert(index) : nullptr;
+        if (!added) {
+            return nullptr;
+        }
+        added->lane = lane;
+        added->position = position;
+        added->count = 0;
+    }
+
+    SplitRecord& entry = entries[index];
+    entry.timestamp = timestamp;
+    entry.count++;
+    copyTime(entry.time, time);
+    return &entry;
+}
+
+const SplitRecord* SplitRegistry::find(uint8_t lane, SplitPosition position) const {
+    uint16_t key = keyOf(lane, position);
+    uint16_t index = lowerBound(key);
+    if (index < entries.size() && keyOf(entries[index].lane, entries[index].position) == key) {
+        return &entries[index];
+    }
+    return nullptr;
+}
+
+void SplitRegistry::retract(uint8_t lane, SplitPosition position, uint64_t timestamp, const SplitRecord* previous) {
+    uint16_t key = keyOf(lane, position);
+    uint16_t index = lowerBound(key);
+    if (index == entries.size() || keyOf(entries[index].lane, entries[index].position) != key) {
+        return;
+    }
+
+    SplitRecord& entry = entries[index];
+    if (entry.count > 0) {
+        entry.count--;
+    }
+    if (entry.timestamp == timestamp) {
+        entry.timestamp = previous ? previous->timestamp : 0;
+        copyTime(entry.time, previous ? previous->time : "");
+    }
+}
+
+uint16_t SplitRegistry::lowerBound(uint16_t key) const {
+    uint16_t low = 0, high = entries.size();
+    while (low < high) {
+        uint16_t mid = (low + high) / 2;
+        if (keyOf(entries[mid].lane, entries[mid].position) < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+SplitFeed::SplitFeed()
+    : arena(nullptr)
+    , gen(0)
+    , ring(nullptr)
+    , capacity(0)
+    , head(0)
+    , count(0) {
+}
+
+bool SplitFeed::begin(HeatArena& heatArena, uint16_t size) {
+    arena = &heatArena;
+    gen = heatArena.generation();
+    ring = (SplitRecord*)heatArena.allocate(size * sizeof(SplitRecord), alignof(SplitRecord));
+    capacity = ring ? size : 0;
+    clear();
+    return ring != nullptr;
+}
+
+void SplitFeed::insert(const SplitRecord& split) {
+    if (capacity == 0 || !live()) {
+        return;
+    }
+    if (count == capacity) {
+        if (split.timestamp < at(0).timestamp) {
+            return; // Older than everything kept
+        }
+        head = (head + 1) % capacity;
+        count--;
+    }
+
+    // First entry later than the new split; equal times keep arrival order
+    uint16_t low = 0, high = count;
+    while (low < high) {
+        uint16_t mid = (low + high) / 2;
+        if (at(mid).timestamp <= split.timestamp) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    for (uint16_t i = count; i > low; i--) {
+        slot(i) = slot(i - 1);
+    }
+    slot(low) = split;
+    count++;
+}
+
+bool SplitFeed::remove(uint8_t lane, SplitPosition position, uint64_t timestamp) {
+    for (uint16_t i = size(); i-- > 0;) {
+        const SplitRecord& split = at(i);
+        if (split.timestamp == timestamp && split.lane == lane && split.position == position) {
+            for (uint16_t j = i; j + 1 < count; j++) {
+                slot(j) = slot(j + 1);
+            }
+            count--;
+            return true;
+        }
+        if (split.timestamp < timestamp) {
+            break; // Sorted by time: it is not further back
+        }
+    }
+    return false;
+}
+
+const SplitRecord* SplitFeed::latestOf(uint8_t lane, SplitPosition position) const {
+    for (uint16_t i = size(); i-- > 0;) {
+        const SplitRecord& split = at(i);
+        if (split.lane == lane && split.position == position) {
+            return &split;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,170 @@
+#include "split_journal.h"
+#include "rtc_retention.h"
+#include <string.h>
+
+#define SPLIT_JOURNAL_MAGIC 0x534A524E // "SJRN"
+
+SplitJournal::SplitJournal()
+    : store(nullptr)
+    , overwritten(0)
+    , unsettled(0) {
+}
+
+uint16_t SplitJournal::attach(Storage* storage, uint32_t firstId) {
+    store = storage;
+    unsettled = 0;
+    bool intact = store->magic == SPLIT_JOURNAL_MAGIC &&
+                  store->check == rtcChecksum(store, offsetof(Storage, check)) &&
+                  store->oldestId <= store->nextId && store->nextId - store->oldestId <= CAPACITY;
+
+    if (!intact) {
+        // Power-on reset, or never used
+        memset(store, 0, sizeof(Storage));
+        store->magic = SPLIT_JOURNAL_MAGIC;
+        store->nextId = firstId ? firstId : 1;
+        store->oldestId = store->nextId;
+        sealHeader();
+        return 0;
+    }
+
+    // Retained: everything unsettled is due as soon as a link is up
+    uint16_t recovered = 0;
+    for (uint32_t id = store->oldestId; id < store->nextId; id++) {
+        Entry* entry = live(id);
+        if (entry && !entry->isSettled()) {
+            entry->sentMs = 0;
+            seal(*entry);
+            recovered++;
+        }
+    }
+    unsettled = recovered;
+    advanceOldest();
+    return recovered;
+}
+
+const SplitJournal::Entry* SplitJournal::append(uint64_t timestamp, uint64_t heatStart, uint16_t uncertaintyMs,
+                                                uint8_t quality, uint32_t nowMs) {
+    uint32_t id = store->nextId;
+    const Entry* replaced = id >= CAPACITY ? live(id - CAPACITY) : nullptr;
+    if (replaced && !replaced->isSettled()) {
+        unsettled--;
+    }
+    store->nextId++;
+    if (store->nextId - store->oldestId > CAPACITY) {
+        // Full of unsettled splits: the oldest one is given up
+        overwritten++;
+        store->oldestId++;
+    }
+
+    Entry& entry = *slot(id);
+    entry.timestamp = timestamp;
+    entry.heatStart = heatStart;
+    entry.id = id;
+    entry.sentMs = 0;
+    entry.createdMs = nowMs;
+    entry.uncertaintyMs = uncertaintyMs;
+    entry.quality = quality;
+    entry.flags = 0;
+    seal(entry);
+    unsettled++;
+    advanceOldest();
+    return &entry;
+}
+
+const SplitJournal::Entry* SplitJournal::find(uint32_t id) const {
+    return live(id);
+}
+
+const SplitJournal::Entry* SplitJournal::latest() const {
+    for (uint32_t back = 1; back <= CAPACITY && back <= store->nextId; back++) {
+        const Entry* entry = live(store->nextId - back);
+        if (!entry) {
+            return nullptr;
+        }
+        if (!entry->isRetracted()) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+bool SplitJournal::retract(uint32_t id) {
+    Entry* entry = live(id);
+    if (!entry || entry->isRetracted()) {
+        return false;
+    }
+    if (entry->isSettled()) {
+        unsettled++; // Acknowledged split, now an unacknowledged tombstone
+    }
+    entry->flags = (entry->flags | RETRACTED) & ~UNDO_ACKED;
+    entry->sentMs = 0; // Tombstone goes out at once
+    seal(*entry);
+    if (id < store->oldestId) {
+        store->oldestId = id;
+        sealHeader();
+    }
+    return true;
+}
+
+void SplitJournal::acknowledge(uint32_t id, bool undo) {
+    Entry* entry = live(id);
+    if (!entry) {
+        return;
+    }
+    bool wasSettled = entry->isSettled();
+    entry->flags |= undo ? UNDO_ACKED : SPLIT_ACKED;
+    seal(*entry);
+    if (!wasSettled && entry->isSettled()) {
+        unsettled--;
+    }
+    advanceOldest();
+}
+
+const SplitJournal::Entry* SplitJournal::nextDue(uint32_t nowMs) {
+    for (uint32_t id = store->oldestId; id < store->nextId; id++) {
+        const Entry* entry = live(id);
+        if (entry && !entry->isSettled() &&
+            (entry->sentMs == 0 || (int32_t)(nowMs - entry->sentMs) >= (int32_t)RETRANSMIT_MS)) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+void SplitJournal::markSent(uint32_t id, uint32_t nowMs) {
+    Entry* entry = live(id);
+    if (entry) {
+        entry->sentMs = nowMs ? nowMs : 1;
+        seal(*entry);
+    }
+}
+
+SplitJournal::Entry* SplitJournal::live(uint32_t id) const {
+    if (!store || id >= store->nextId || store->nextId - id > CAPACITY) {
+        return nullptr;
+    }
+    Entry* entry = slot(id);
+    if (entry->id != id || entry->check != rtcChecksum(entry, offsetof(Entry, check))) {
+        return nullptr;
+    }
+    return entry;
+}
+
+void SplitJournal::seal(Entry& entry) {
+    entry.check = rtcChecksum(&entry, offsetof(Entry, check));
+}
+
+void SplitJournal::sealHeader() {
+    store->check = rtcChecksum(store, offsetof(Storage, check));
+}
+
+void SplitJournal::advanceOldest() {
+    while (store->oldestId < store->nextId) {
+        const Entry* entry = live(store->oldestId);
+        if (entry && !entry->isSettled()) {
+            break;
+        }
+        store->oldestId++;
+    }
+    sealHeader();
+}
@@ -0,0 +1,67 @@
+#include "sync_retention.h"
+#include "rtc_retention.h"
+#include <esp_attr.h>
+#include <sys/time.h>
+#include <stddef.h>
+
+#define SYNC_RETENTION_MAGIC 0x53594E43 // "SYNC"
+
+struct RetainedSync {
+    uint32_t magic;
+    uint64_t savedRtcUs;
+    ClockSync::Prior prior;
+    uint32_t checksum;
+};
+
+// Not zeroed at boot; validated by magic and checksum instead
+static RTC_NOINIT_ATTR RetainedSync retained;
+
+static uint64_t rtcMicros() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (uint64_t)tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+static uint32_t retainedChecksum(const RetainedSync& r) {
+    return rtcChecksum(&r, offsetof(RetainedSync, checksum));
+}
+
+void syncRetentionSave(const ClockSync& sync, uint32_t localMs) {
+    RetainedSync r;
+    memset(&r, 0, sizeof(r)); // Padding is part of the checksum
+    if (!sync.capture(localMs, r.prior)) {
+        return;
+    }
+    r.magic = SYNC_RETENTION_MAGIC;
+    r.savedRtcUs = rtcMicros();
+    r.checksum = retainedChecksum(r);
+    memcpy(&retained, &r, sizeof(r));
+}
+
+bool syncRetentionRestore(ClockSync& sync, uint32_t localMs) {
+    if (retained.magic != SYNC_RETENTION_MAGIC || retained.checksum != retainedChecksum(retained)) {
+        return false; // Power-on reset, or never saved
+    }
+
+    uint64_t now = rtcMicros();
+    if (now < retained.savedRtcUs) {
+        syncRetentionClear();
+        return false; // RTC timer restarted
+    }
+    uint64_t gapMs = (now - retained.savedRtcUs) / 1000;
+    if (gapMs > SYNC_RETENTION_MAX_GAP_MS) {
+        syncRetentionClear();
+        Serial.println("Retained time sync too old, discarded");
+        return false;
+    }
+
+    sync.restore(retained.prior, localMs, (uint32_t)gapMs, SYNC_RETENTION_GAP_BOUND_PPM);
+    Serial.printf("Time sync restored from RTC memory: %llums gap, +/-%lums, drift %.2fppm\n",
+                  (unsigned long long)gapMs, (unsigned long)sync.getUncertaintyMs(localMs),
+                  sync.getDriftPpm());
+    return true;
+}
+
+void syncRetentionClear() {
+    retained.magic = 0;
+}
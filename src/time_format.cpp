@@ -0,0 +1,17 @@
+#include "time_format.h"
+
+#include <stdio.h>
+
+void formatCentiseconds(uint32_t milliseconds, char* buffer, size_t size) {
+    unsigned minutes = milliseconds / 60000;
+    unsigned seconds = (milliseconds / 1000) % 60;
+    unsigned centiseconds = (milliseconds % 1000) / 10;
+    snprintf(buffer, size, "%02u:%02u:%02u", minutes, seconds, centiseconds);
+}
+
+void formatTenths(uint32_t milliseconds, char* buffer, size_t size) {
+    unsigned minutes = milliseconds / 60000;
+    unsigned seconds = (milliseconds / 1000) % 60;
+    unsigned tenths = (milliseconds % 1000) / 100;
+    snprintf(buffer, size, "%02u:%02u:%u", minutes, seconds, tenths);
+}
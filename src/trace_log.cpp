@@ -0,0 +1,99 @@
+/**
+ * Trace Log Implementation for T-Display S3 Stopwatch
+ */
+
+#include "trace_log.h"
+#include "memory_policy.h"
+#include <esp_timer.h>
+
+TraceLog traceLog;
+
+TraceLog::TraceLog()
+    : records(nullptr)
+    , head(0)
+    , recordCount(0)
+    , deviceName("device") {
+}
+
+bool TraceLog::begin() {
+    if (!records) {
+        records = (TraceRecord*)memoryPolicy.allocate(MEM_BULK, CAPACITY * sizeof(TraceRecord), "trace log");
+    }
+    return records != nullptr;
+}
+
+void TraceLog::setDeviceName(const String& name) {
+    deviceName = name;
+}
+
+void TraceLog::record(TraceEvent event, uint64_t syncMs, int64_t offsetMs, bool synced,
+                      uint64_t startTs, uint32_t arg) {
+    if (!records) {
+        return;
+    }
+    TraceRecord& rec = records[head];
+    rec.localUs = esp_timer_get_time();
+    rec.syncMs = syncMs;
+    rec.startTs = startTs;
+    rec.offsetMs = offsetMs;
+    rec.arg = arg;
+    rec.event = event;
+    rec.synced = synced;
+
+    // Ring buffer: overwrite the oldest record when full
+    head = (head + 1) % CAPACITY;
+    if (recordCount < CAPACITY) {
+        recordCount++;
+    }
+}
+
+void TraceLog::clear() {
+    head = 0;
+    recordCount = 0;
+}
+
+const TraceRecord& TraceLog::at(uint16_t index) const {
+    uint16_t oldest = (head + CAPACITY - recordCount) % CAPACITY;
+    return records[(oldest + index) % CAPACITY];
+}
+
+size_t TraceLog::formatRecord(const TraceRecord& rec, char* buffer, size_t size) const {
+    int written = snprintf(buffer, size,
+        "{\"dev\":\"%s\",\"ev\":\"%s\",\"us\":%llu,\"sync\":%llu,\"off\":%lld,\"synced\":%d,\"start\":%llu,\"arg\":%lu}",
+        deviceName.c_str(), eventName(rec.event),
+        (unsigned long long)rec.localUs, (unsigned long long)rec.syncMs, (long long)rec.offsetMs,
+        rec.synced ? 1 : 0, (unsigned long long)rec.startTs, (unsigned long)rec.arg);
+    if (written < 0) {
+        return 0;
+    }
+    return (size_t)written < size ? (size_t)written : size - 1;
+}
+
+void TraceLog::dump(Print& out) const {
+    char line[192];
+    out.printf("TRACE-BEGIN %s %u\n", deviceName.c_str(), recordCount);
+    for (uint16_t i = 0; i < recordCount; i++) {
+        formatRecord(at(i), line, sizeof(line));
+        out.print("TRACE ");
+        out.println(line);
+    }
+    out.printf("TRACE-END %s\n", deviceName.c_str());
+}
+
+const char* TraceLog::eventName(TraceEvent event) {
+    switch (event) {
+        case TRACE_WS_CONNECTED:    return "ws_connected";
+        case TRACE_WS_DISCONNECTED: return "ws_disconnected";
+        case TRACE_SYNC_SAMPLE:     return "sync_sample";
+        case TRACE_START_SENT:      return "start_sent";
+        case TRACE_START_RECEIVED:  return "start_received";
+        case TRACE_LANE_START:      return "lane_start";
+        case TRACE_SPLIT_BUTTON:    return "split_button";
+        case TRACE_SPLIT_SENT:      return "split_sent";
+        case TRACE_RESET_RECEIVED:  return "reset_received";
+        case TRACE_SPLIT_UNDONE:    return "split_undone";
+        case TRACE_RELAY_TOUCH:     return "relay_touch";
+        case TRACE_RELAY_RELEASE:   return "relay_release";
+    }
+    return "unknown";
+}
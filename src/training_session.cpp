@@ -0,0 +1,173 @@
+#include "training_session.h"
+
+
+TrainingSession::TrainingSession()
+    : swimmerCount(0)
+    , skipMs(0)
+    , lastTouchMs(0)
+    , historyHead(0)
+    , historySize(0) {
+}
+
+void TrainingSession::begin(uint32_t startMs, uint8_t count, uint32_t gapMs, uint32_t expectedLapMs) {
+    if (count > MAX_SWIMMERS) {
+        count = MAX_SWIMMERS;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        swimmers[i].startMs = startMs + i * gapMs;
+        swimmers[i].lastTouchMs = swimmers[i].startMs;
+        swimmers[i].trackMs = swimmers[i].startMs;
+        swimmers[i].lapMs = expectedLapMs ? expectedLapMs : 1;
+        swimmers[i].splits = 0;
+    }
+    swimmerCount = count;
+    skipMs = gapMs * 3 / 4;
+    lastTouchMs = startMs;
+    historyHead = 0;
+    historySize = 0;
+}
+
+void TrainingSession::end() {
+    swimmerCount = 0;
+    historySize = 0;
+}
+
+uint8_t TrainingSession::lapsSince(const Swimmer& swimmer, uint32_t nowMs) const {
+    uint32_t since = nowMs - swimmer.trackMs;
+    uint32_t laps = (since + swimmer.lapMs / 2) / swimmer.lapMs;
+    if (laps < 1) {
+        return 1;
+    }
+    return laps > 255 ? 255 : (uint8_t)laps;
+}
+
+uint32_t TrainingSession::predictedArrivalMs(uint8_t swimmer, uint32_t nowMs) const {
+    const Swimmer& s = swimmers[swimmer];
+    if ((int32_t)(nowMs - s.startMs) < 0) {
+        return s.startMs + s.lapMs;
+    }
+    return s.trackMs + lapsSince(s, nowMs) * s.lapMs;
+}
+
+uint32_t TrainingSession::elapsedMs(uint8_t swimmer, uint32_t nowMs) const {
+    int32_t elapsed = (int32_t)(nowMs - swimmers[swimmer].startMs);
+    return elapsed > 0 ? (uint32_t)elapsed : 0;
+}
+
+const TrainingSplit* TrainingSession::recordSplit(uint32_t nowMs) {
+    int8_t best = -1;
+    uint32_t bestDistance = 0;
+    if (historySize == 0) {
+        // The first touch is the first swimmer off, and counts as one lap:
+        // the expected lap is only a guess, and may be off by more than
+        // half a send-off gap
+        if (swimmerCount > 0 && (int32_t)(nowMs - swimmers[0].startMs) >= 0) {
+            best = 0;
+        }
+    } else {
+        // Touches come round in send-off order, so the swimmer after the
+        // last one to touch is expected next. Each place further on costs
+        // skipMs, as it means that many touches were missed
+        uint8_t expected = (latest(0).swimmer + 1) % swimmerCount;
+        for (uint8_t k = 0; k < swimmerCount; k++) {
+            uint8_t i = (expected + k) % swimmerCount;
+            const Swimmer& s = swimmers[i];
+            // Not sent off yet, or touched too recently to be back already
+            if ((int32_t)(nowMs - s.startMs) < 0 || nowMs - s.lastTouchMs < s.lapMs / 2) {
+                continue;
+            }
+            uint32_t predicted = predictedArrivalMs(i, nowMs);
+            uint32_t distance = (int32_t)(nowMs - predicted) >= 0 ? nowMs - predicted : predicted - nowMs;
+            distance += k * skipMs;
+            if (best < 0 || distance < bestDistance) {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+    }
+    if (best < 0) {
+        return nullptr;
+    }
+
+    Swimmer& s = swimmers[best];
+    uint8_t laps = historySize == 0 ? 1 : lapsSince(s, nowMs);
+    Entry& entry = history[historyHead];
+    entry.previousTouchMs = s.lastTouchMs;
+    entry.previousTrackMs = s.trackMs;
+    entry.previousLapMs = s.lapMs;
+    entry.previousSplits = s.splits;
+    entry.split.swimmer = best;
+    entry.split.number = s.splits + laps;
+    entry.split.elapsedMs = nowMs - s.startMs;
+    uint32_t predicted = s.trackMs + laps * s.lapMs;
+    int32_t margin = (int32_t)(nowMs - predicted);
+    entry.split.marginMs = margin;
+
+    // Follow the swimmer's pace. A first lap replaces the guess; after that
+    // the touch pulls the track half way and the lap an eighth of the way
+    // (per lap), which follows a tiring swimmer without taking in one
+    // touch's noise in full
+    if (s.splits == 0) {
+        s.lapMs = (nowMs - s.startMs) / laps;
+        s.trackMs = nowMs;
+    } else {
+        s.trackMs = predicted + margin / 2;
+        int32_t lap = (int32_t)s.lapMs + margin / (8 * (int32_t)laps);
+        s.lapMs = lap > 1 ? (uint32_t)lap : 1;
+    }
+    s.lastTouchMs = nowMs;
+    s.splits = entry.split.number;
+    lastTouchMs = nowMs;
+
+    // Swimmers yet to touch go at about the measured pace, not the guess
+    for (uint8_t i = 0; i < swimmerCount; i++) {
+        if (swimmers[i].splits == 0) {
+            swimmers[i].lapMs = s.lapMs;
+        }
+    }
+
+    historyHead = (historyHead + 1) % HISTORY;
+    if (historySize < HISTORY) {
+        historySize++;
+    }
+    return &entry.split;
+}
+
+bool TrainingSession::undoLast() {
+    if (historySize == 0) {
+        return false;
+    }
+    historyHead = (historyHead + HISTORY - 1) % HISTORY;
+    historySize--;
+    const Entry& entry = history[historyHead];
+    Swimmer& s = swimmers[entry.split.swimmer];
+    s.lastTouchMs = entry.previousTouchMs;
+    s.trackMs = entry.previousTrackMs;
+    s.lapMs = entry.previousLapMs;
+    s.splits = entry.previousSplits;
+    return true;
+}
+
+int8_t TrainingSession::nextExpected(uint32_t nowMs) const {
+    int8_t next = -1;
+    uint32_t nextAt = 0;
+    for (uint8_t i = 0; i < swimmerCount; i++) {
+        if ((int32_t)(nowMs - swimmers[i].startMs) < 0) {
+            continue;
+        }
+        // Still shown for a quarter lap after they were due
+        uint32_t predicted = predictedArrivalMs(i, nowMs);
+        if ((int32_t)(nowMs - predicted) > (int32_t)(swimmers[i].lapMs / 4)) {
+            predicted += swimmers[i].lapMs;
+        }
+        if (next < 0 || (int32_t)(predicted - nextAt) < 0) {
+            next = i;
+            nextAt = predicted;
+        }
+    }
+    return next;
+}
+
+const TrainingSplit& TrainingSession::latest(uint8_t age) const {
+    return history[(historyHead + HISTORY - 1 - age) % HISTORY].split;
+}
@@ -0,0 +1,102 @@
+#include "transport.h"
+#include <string.h>
+
+FrameTransport::FrameTransport(uint8_t node)
+    : nextSeq(0)
+    , sent(0)
+    , received(0)
+    , rejected(0) {
+    setNode(node);
+}
+
+void FrameTransport::setNode(uint8_t node) {
+    this->node = node;
+    upstream = node == FRAME_NODE_GATEWAY ? FRAME_NODE_ANY : FRAME_NODE_GATEWAY;
+}
+
+size_t FrameTransport::encode(const uint8_t* json, size_t length, uint8_t* frame, size_t frameSize) {
+    size_t size = frameEncode(node, nextSeq, json, length, frame, frameSize);
+    if (size > 0) {
+        nextSeq++;
+        sent++;
+    }
+    return size;
+}
+
+size_t FrameTransport::accept(const uint8_t* frame, size_t length, uint8_t* buffer, size_t size, uint8_t& source) {
+    FrameHeader header;
+    const uint8_t* payload;
+    if (!frameDecode(frame, length, header, &payload)) {
+        rejected++;
+        return 0;
+    }
+
+    // Star: lanes only listen to their upstream, the gateway to every lane
+    bool addressed = upstream == FRAME_NODE_ANY ? header.source != node
+                                                : header.source == upstream;
+    if (!addressed || header.length == 0 || (size_t)header.length + 1 > size) {
+        return 0;
+    }
+    if (!duplicates.accept(header.source, header.seq)) {
+        return 0;
+    }
+
+    memcpy(buffer, payload, header.length);
+    buffer[header.length] = '\0';
+    source = header.source;
+    received++;
+    return header.length;
+}
+
+LinkSelector::LinkSelector()
+    : primaryUp(false)
+    , lastHeardMs(0)
+    , healthy(false)
+    , healthySinceMs(0)
+    , usingFallback(false)
+    , failovers(0) {
+}
+
+void LinkSelector::setPrimaryUp(bool up, uint32_t nowMs) {
+    primaryUp = up;
+    if (up) {
+        lastHeardMs = nowMs;
+    }
+}
+
+void LinkSelector::primaryHeard(uint32_t nowMs) {
+    lastHeardMs = nowMs;
+}
+
+LinkRoute LinkSelector::route(uint32_t nowMs, bool fallbackUp) {
+    // A connected WebSocket that has gone quiet is as good as down: TCP
+    // keeps "sending" into a dead AP until its own timeouts fire
+    bool nowHealthy = primaryUp && nowMs - lastHeardMs < SILENCE_MS;
+    if (nowHealthy && !healthy) {
+        healthySinceMs = nowMs;
+    }
+    healthy = nowHealthy;
+
+    if (usingFallback) {
+        if (healthy && nowMs - healthySinceMs >= RECOVER_MS) {
+            usingFallback = false;
+        }
+    } else if (!healthy && fallbackUp) {
+        usingFallback = true;
+        failovers++;
+    }
+
+    if (usingFallback && fallbackUp) {
+        return ROUTE_FALLBACK;
+    }
+    return primaryUp ? ROUTE_PRIMARY : ROUTE_NONE;
+}
+
+const char* LinkSelector::routeName(LinkRoute route) {
+    switch (route) {
+        case ROUTE_PRIMARY:  return "websocket";
+        case ROUTE_FALLBACK: return "peer";
+        case ROUTE_WIRED:    return "usb";
+        default:             return "none";
+    }
+}
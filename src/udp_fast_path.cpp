@@ -0,0 +1,87 @@
+#include "udp_fast_path.h"
+#include <mbedtls/md.h>
+
+static const char FAST_PATH_MAGIC[4] = {'S', 'W', 'F', '1'};
+static const size_t FAST_PATH_HEADER = sizeof(FAST_PATH_MAGIC) + UdpFastPath::TAG_LENGTH;
+
+UdpFastPath::UdpFastPath()
+    : active(false)
+    , accepted(0)
+    , rejected(0) {
+}
+
+bool UdpFastPath::begin(const String& sharedKey, uint16_t port) {
+    if (sharedKey.length() == 0) {
+        Serial.println("UDP fast path disabled (no key configured)");
+        return false;
+    }
+    key = sharedKey;
+
+    if (!udp.beginMulticast(FAST_PATH_GROUP, port)) {
+        Serial.println("UDP fast path: failed to join multicast group");
+        return false;
+    }
+    active = true;
+    Serial.printf("UDP fast path listening on %s:%d\n", FAST_PATH_GROUP.toString().c_str(), port);
+    return true;
+}
+
+void UdpFastPath::stop() {
+    if (active) {
+        udp.stop();
+        active = false;
+    }
+}
+
+size_t UdpFastPath::receive(uint8_t* buffer, size_t size) {
+    if (!active) {
+        return 0;
+    }
+
+    uint8_t datagram[MAX_DATAGRAM];
+    int packetSize;
+    while ((packetSize = udp.parsePacket()) > 0) {
+        if ((size_t)packetSize > sizeof(datagram)) {
+            udp.flush();
+            rejected++;
+            continue;
+        }
+        size_t length = udp.read(datagram, sizeof(datagram));
+        if (!verify(datagram, length)) {
+            rejected++;
+            continue;
+        }
+
+        size_t bodyLength = length - FAST_PATH_HEADER;
+        if (bodyLength + 1 > size) {
+            rejected++;
+            continue;
+        }
+        memcpy(buffer, datagram + FAST_PATH_HEADER, bodyLength);
+        buffer[bodyLength] = '\0';
+        accepted++;
+        return bodyLength;
+    }
+    return 0;
+}
+
+bool UdpFastPath::verify(const uint8_t* datagram, size_t length) {
+    if (length <= FAST_PATH_HEADER || memcmp(datagram, FAST_PATH_MAGIC, sizeof(FAST_PATH_MAGIC)) != 0) {
+        return false;
+    }
+
+    uint8_t digest[32];
+    const mbedtls_md_info_t* info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    if (mbedtls_md_hmac(info, (const uint8_t*)key.c_str(), key.length(),
+                        datagram + FAST_PATH_HEADER, length - FAST_PATH_HEADER, digest) != 0) {
+        return false;
+    }
+
+    // Constant-time tag comparison
+    const uint8_t* tag = datagram + sizeof(FAST_PATH_MAGIC);
+    uint8_t diff = 0;
+    for (size_t i = 0; i < TAG_LENGTH; i++) {
+        diff |= tag[i] ^ digest[i];
+    }
+    return diff == 0;
+}
@@ -0,0 +1,83 @@
+#include "usb_transport.h"
+
+UsbTransport::UsbTransport(Stream& stream)
+    : stream(stream)
+    , active(false)
+    , lastBridgeMs(0)
+    , bridgeHeard(false)
+    , decoder(rxBuffer, sizeof(rxBuffer))
+    , consoleHead(0)
+    , consoleCount(0) {
+}
+
+void UsbTransport::begin(uint8_t node) {
+    setNode(node);
+    setUpstream(FRAME_NODE_HOST);
+    active = true;
+    Serial.println("USB link: waiting for the PC bridge");
+}
+
+bool UsbTransport::isUp() const {
+    return active && bridgeHeard && millis() - lastBridgeMs < BRIDGE_TIMEOUT;
+}
+
+bool UsbTransport::send(const uint8_t* json, size_t length) {
+    if (!isUp()) {
+        return false;
+    }
+    uint8_t frame[MAX_FRAME_SIZE];
+    size_t size = encode(json, length, frame, sizeof(frame));
+    if (size == 0) {
+        return false;
+    }
+    // One write, so a log line can only land before or after the frame
+    return stream.write(frame, size) == size;
+}
+
+size_t UsbTransport::receive(uint8_t* buffer, size_t size, uint8_t& source) {
+    if (!active) {
+        return 0;
+    }
+    while (stream.available() > 0) {
+        uint8_t byte = stream.read();
+        switch (decoder.push(byte)) {
+            case FrameStreamDecoder::PASSTHROUGH:
+                if (consoleCount < CONSOLE_BUFFER) {
+                    console[(consoleHead + consoleCount) % CONSOLE_BUFFER] = byte;
+                    consoleCount++;
+                }
+                break;
+            case FrameStreamDecoder::COMPLETE: {
+                // Beacons are empty frames: they only keep the link up
+                FrameHeader header;
+                const uint8_t* payload;
+                if (frameDecode(decoder.frame(), decoder.length(), header, &payload) &&
+                    header.source == FRAME_NODE_HOST) {
+                    if (!isUp()) {
+                        Serial.println("USB link: PC bridge attached");
+                    }
+                    bridgeHeard = true;
+                    lastBridgeMs = millis();
+                }
+                size_t length = accept(decoder.frame(), decoder.length(), buffer, size, source);
+                if (length > 0) {
+                    return length;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return 0;
+}
+
+int UsbTransport::readConsole() {
+    if (consoleCount == 0) {
+        return -1;
+    }
+    uint8_t byte = console[consoleHead];
+    consoleHead = (consoleHead + 1) % CONSOLE_BUFFER;
+    consoleCount--;
+    return byte;
+}
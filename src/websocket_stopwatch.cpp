@@ -1,4 +1,27 @@
 #include "websocket_stopwatch.h"
+#include "sync_retention.h"
+#include "memory_policy.h"
+
+// Server traffic the gateway repeats to lanes, and what lanes may send up
+static const uint32_t PEER_DOWNLINK_TYPES = WS_TYPE_BIT(WS_TYPE_START) | WS_TYPE_BIT(WS_TYPE_RESET) |
+                                            WS_TYPE_BIT(WS_TYPE_EVENT_HEAT) | WS_TYPE_BIT(WS_TYPE_SELECT_EVENT) |
+                                            WS_TYPE_BIT(WS_TYPE_CLEAR) | WS_TYPE_BIT(WS_TYPE_SPLIT_ACK);
+static const uint32_t PEER_UPLINK_TYPES = WS_TYPE_BIT(WS_TYPE_SPLIT) | WS_TYPE_BIT(WS_TYPE_STATUS) |
+                                          WS_TYPE_BIT(WS_TYPE_SPLIT_UNDO);
+
+// Split journal in RTC slow memory: survives warm reboot and deep sleep
+static RTC_NOINIT_ATTR SplitJournal::Storage journalStorage;
+
+// Region behind the heat arena (bulk memory, taken once in begin())
+static const size_t HEAT_ARENA_SIZE = 12 * 1024;
+
+static void variantText(JsonVariantConst value, char* text, size_t size) {
+    if (value.is<const char*>()) {
+        strlcpy(text, value.as<const char*>(), size);
+    } else {
+        serializeJson(value, text, size);
+    }
+}
 
 // Static instance pointer for WebSocket callback
 WebSocketStopwatch* wsStopwatchInstance = nullptr;
@@ -15,22 +38,45 @@ WebSocketStopwatch::WebSocketStopwatch()
     , pingMs(-1)
     , bestPingMs(-1)
     , pingSampleCount(0)
-    , serverTimeOffset(0)
-    , timeSync(false)
+    , lastStatusTime(0)
+    , lastReportedQuality(SYNC_NONE)
+    , batteryPercent(LaneReadiness::BATTERY_UNKNOWN)
     , currentState(STOPWATCH_STOPPED)
     , startTimeMs(0)
     , elapsedMs(0)
     , syncStartTime(0)
     , startLocked(false)
+    , eventDistanceM(0)
     , lapCount(0)
     , laneNumber(9)
+    , position(POSITION_START)
+    , undoWindowMs(10000)
+    , splitRetransmits(0)
+    , subscribedTypes(WS_TYPES_ALL)
+    , subscribeAllLanes(true)
+    , droppedFrames(0)
+    , lastSeq(0)
+    , serverEpoch(0)
+    , duplicateFrames(0)
+    , outOfBandSeqNext(0)
+    , peerLink(nullptr)
+    , peerGateway(false)
+    , lastRoute(ROUTE_NONE)
+    , lastPeerUplinkTime(0)
+    , peerForwarded(0)
+    , wiredLink(nullptr)
+    , wiredActive(false)
     , lastDisplayUpdate(0)
     , onStateChanged(nullptr)
     , onLapAdded(nullptr)
+    , onLapUndone(nullptr)
     , onConnectionChanged(nullptr)
     , onTimeSync(nullptr)
+    , onDriftCalibrated(nullptr)
     , onEventHeatChanged(nullptr)
     , onSplitTimeReceived(nullptr)
+    , onLaneStatus(nullptr)
+    , onLanePresence(nullptr)
     , onDisplayClear(nullptr) {
     
     // Set static instance for callback
@@ -38,17 +84,37 @@ WebSocketStopwatch::WebSocketStopwatch()
     
     // Initialize lap array
     for (uint8_t i = 0; i < MAX_LAPS; i++) {
-        laps[i] = {0, 0, 0};
+        laps[i] = {0, 0, 0, 0, SYNC_NONE, 0};
     }
     
-    // Initialize split times array
-    for (uint8_t i = 0; i < MAX_LANES; i++) {
-        splitTimes[i] = {0, 0, "", false};
+    // Ids continue from a retained journal; a cold boot starts at a random
+    // point so it cannot collide with ids the server saw before the power cut
+    journal.attach(&journalStorage, 1 + (esp_random() & 0x0FFFFFFF));
+    
+    for (uint8_t i = 0; i < OUT_OF_BAND_SEQ_SLOTS; i++) {
+        outOfBandSeqs[i] = 0;
     }
     
-    // Initialize event/heat
+    // Initialize event/heat; the split board waits for begin()
     currentEvent = "";
     currentHeat = "";
+    beginHeat();
+    
+    // Only these fields are materialised when a wanted frame is parsed
+    for (size_t i = 0; i < WS_INGRESS_FIELD_COUNT; i++) {
+        ingressFilter[WS_INGRESS_FIELDS[i]] = true;
+    }
+}
+
+bool WebSocketStopwatch::begin() {
+    void* region = memoryPolicy.allocate(MEM_BULK, HEAT_ARENA_SIZE, "heat arena");
+    if (!region) {
+        Serial.println("ERROR: No memory for the heat arena, other devices' splits are not shown");
+        return false;
+    }
+    heatArena.begin(region, HEAT_ARENA_SIZE);
+    beginHeat();
+    return true;
 }
 
 void WebSocketStopwatch::setServerConfig(const String& host, uint16_t port, const String& path, bool ssl) {
@@ -66,6 +132,74 @@ void WebSocketStopwatch::setLaneNumber(uint8_t lane) {
     Serial.printf("Lane number set to: %d\n", laneNumber);
 }
 
+void WebSocketStopwatch::setPosition(SplitPosition pos) {
+    position = pos;
+    Serial.printf("Pool end: %s\n", splitPositionName(position));
+}
+
+void WebSocketStopwatch::setSubscribedTypes(uint32_t typeMask) {
+    subscribedTypes = typeMask & WS_TYPES_ALL;
+    Serial.printf("Subscribed message types: 0x%04lx\n", (unsigned long)subscribedTypes);
+    if (wsConnected || wiredActive) {
+        sendSubscribe();
+    }
+}
+
+void WebSocketStopwatch::enableFastPath(const String& sharedKey) {
+    fastPath.begin(sharedKey);
+}
+
+void WebSocketStopwatch::setPeerLink(Transport* link, bool gateway) {
+    peerLink = link;
+    peerGateway = gateway;
+    Serial.printf("Peer link %s: %s\n", link ? link->name() : "none", gateway ? "gateway" : "lane");
+}
+
+void WebSocketStopwatch::setWiredLink(Transport* link) {
+    wiredLink = link;
+    Serial.printf("Wired link %s\n", link ? link->name() : "none");
+}
+
+void WebSocketStopwatch::setDriftCalibration(float ppm) {
+    clockSync.setCalibration(ppm);
+    Serial.printf("Clock drift calibration loaded: %.2f ppm\n", ppm);
+}
+
+bool WebSocketStopwatch::restoreSyncState() {
+    // Starts in holdover; the first good pong replaces the restored anchor
+    return syncRetentionRestore(clockSync, millis());
+}
+
+void WebSocketStopwatch::restoreSession(uint32_t seq, uint32_t epoch, const String& event, const String& heat) {
+    // The subscribe on connect presents this resume point, so the server
+    // replays only what was broadcast while we slept
+    lastSeq = seq;
+    serverEpoch = epoch;
+    setEventHeat(event.c_str(), heat.c_str());
+    Serial.printf("Session restored: seq=%lu epoch=%lu event=%s heat=%s\n",
+                  (unsigned long)seq, (unsigned long)epoch, currentEvent, currentHeat);
+    if (onEventHeatChanged && event.length()) {
+        onEventHeatChanged(String(currentEvent), String(currentHeat));
+    }
+}
+
+void WebSocketStopwatch::setUndoWindow(uint32_t ms) {
+    undoWindowMs = ms;
+    Serial.printf("Split undo window: %lu ms\n", (unsigned long)ms);
+}
+
+void WebSocketStopwatch::setBatteryPercent(uint8_t percent) {
+    batteryPercent = percent;
+}
+
+void WebSocketStopwatch::setSubscribedLanes(bool allLanes) {
+    subscribeAllLanes = allLanes;
+    Serial.printf("Subscribed lanes: %s\n", allLanes ? "all" : "own lane only");
+    if (wsConnected || wiredActive) {
+        sendSubscribe();
+    }
+}
+
 bool WebSocketStopwatch::connect() {
     Serial.println("Connecting to WebSocket server...");
     
@@ -98,10 +232,40 @@ bool WebSocketStopwatch::isConnected() {
 }
 
 void WebSocketStopwatch::loop() {
+    // Fast path first: a start datagram should not wait behind WebSocket work
+    if (fastPath.isActive()) {
+        uint8_t datagram[UdpFastPath::MAX_DATAGRAM];
+        size_t length;
+        while ((length = fastPath.receive(datagram, sizeof(datagram))) > 0) {
+            handleTextFrame(datagram, length, FROM_FAST_PATH);
+        }
+    }
+    
     webSocket.loop();
     
     unsigned long now = millis();
     
+    if (peerLink) {
+        peerLink->loop(now);
+        uint8_t frame[FrameTransport::MAX_PAYLOAD + 1];
+        uint8_t source;
+        size_t length;
+        while ((length = peerLink->receive(frame, sizeof(frame), source)) > 0) {
+            handlePeerFrame(frame, length);
+        }
+    }
+    
+    if (wiredLink) {
+        wiredLink->loop(now);
+        uint8_t frame[WS_MAX_FRAME_SIZE + 1];
+        uint8_t source;
+        size_t length;
+        while ((length = wiredLink->receive(frame, sizeof(frame), source)) > 0) {
+            handleTextFrame(frame, length, FROM_WIRED);
+        }
+        updateWiredLink();
+    }
+    
     // Handle reconnection if needed
     if (!wsConnected && now - lastReconnectAttempt > RECONNECT_INTERVAL) {
         lastReconnectAttempt = now;
@@ -111,21 +275,33 @@ void WebSocketStopwatch::loop() {
     // Send JSON ping with appropriate interval based on sync state
     unsigned long pingInterval = PING_INTERVAL;
     
-    // Initial rapid ping sequence (5 pings at 500ms intervals) if not synced
-    if (!timeSync && pingSampleCount < 5) {
+    // Initial rapid ping sequence (5 pings at 500ms intervals) after each connect
+    if (pingSampleCount < 5) {
         pingInterval = 500; // 500ms for rapid initial sync
     }
     
-    if (wsConnected && now - lastPingTime > pingInterval) {
+    if ((wsConnected || wiredActive) && now - lastPingTime > pingInterval) {
         lastPingTime = now;
         sendJsonPing();
         
-        if (!timeSync && pingSampleCount < 5) {
+        if (pingSampleCount < 5) {
             Serial.printf("Initial ping %d/5 sent\n", pingSampleCount + 1);
         } else {
             Serial.println("Regular JSON ping sent");
         }
     }
+    
+    // Sync status for the starter: periodically, and at once when the quality changes
+    updateRoute();
+    flushSplitJournal(now);
+    if (wsConnected || wiredActive || isOnPeerLink()) {
+        SyncQuality quality = clockSync.getQuality(now);
+        if (quality != lastReportedQuality || now - lastStatusTime > STATUS_INTERVAL) {
+            lastStatusTime = now;
+            lastReportedQuality = quality;
+            sendStatus();
+        }
+    }
 }
 
 void WebSocketStopwatch::start() {
@@ -133,6 +309,7 @@ void WebSocketStopwatch::start() {
         startTimeMs = millis();
         currentState = STOPWATCH_RUNNING;
         lapCount = 0;
+        recordTrace(TRACE_LANE_START);
         
         Serial.println("Stopwatch started locally");
         
@@ -145,7 +322,7 @@ void WebSocketStopwatch::start() {
 void WebSocketStopwatch::stop() {
     if (currentState == STOPWATCH_RUNNING) {
         // Calculate final elapsed time using synchronized time if available
-        if (syncStartTime > 0 && timeSync) {
+        if (syncStartTime > 0 && clockSync.isSynced()) {
             uint64_t currentSyncTime = getSynchronizedTime();
             elapsedMs = (uint32_t)(currentSyncTime - syncStartTime);
         } else {
@@ -172,7 +349,7 @@ void WebSocketStopwatch::reset() {
     
     // Clear lap data
     for (uint8_t i = 0; i < MAX_LAPS; i++) {
-        laps[i] = {0, 0, 0};
+        laps[i] = {0, 0, 0, 0, SYNC_NONE, 0};
     }
     
     // Clear split times
@@ -186,18 +363,28 @@ void WebSocketStopwatch::reset() {
 }
 
 void WebSocketStopwatch::addLap() {
+    addLap(micros());
+}
+
+void WebSocketStopwatch::addLap(uint32_t touchUs) {
     if (currentState == STOPWATCH_RUNNING && lapCount < MAX_LAPS) {
-        // Get current synchronized time for the split
-        uint64_t currentSyncTime = getSynchronizedTime();
+        uint32_t recordStart = hotPathCycles();
+        recordTrace(TRACE_SPLIT_BUTTON, lapCount + 1);
+        
+        // The split is the touch, not when the loop got to it
+        uint32_t now = millis();
+        uint32_t touchMs = now - (micros() - touchUs) / 1000;
+        uint64_t currentSyncTime = clockSync.toServerTime(touchMs);
+        uint32_t uncertainty = clockSync.getUncertaintyMs(now);
         
         // Calculate elapsed time using synchronized timestamps if available
         uint32_t currentElapsed;
-        if (syncStartTime > 0 && timeSync) {
+        if (syncStartTime > 0 && clockSync.isSynced()) {
             // Use synchronized time calculation
             currentElapsed = (uint32_t)(currentSyncTime - syncStartTime);
         } else {
             // Fallback to local time if sync not available
-            currentElapsed = millis() - startTimeMs;
+            currentElapsed = touchMs - startTimeMs;
         }
         
         uint32_t lapTime = currentElapsed;
@@ -208,14 +395,30 @@ void WebSocketStopwatch::addLap() {
         laps[lapCount].lapTimeMs = lapTime;
         laps[lapCount].totalTimeMs = currentElapsed;
         laps[lapCount].serverTimestamp = currentSyncTime;
+        laps[lapCount].uncertaintyMs = uncertainty > 0xFFFF ? 0xFFFF : uncertainty;
+        laps[lapCount].syncQuality = clockSync.getQuality(now);
+        
+        // Journal first, so the split is resent if this send is lost
+        const SplitJournal::Entry* split = journal.append(currentSyncTime, syncStartTime, laps[lapCount].uncertaintyMs,
+                                                          laps[lapCount].syncQuality, now);
+        laps[lapCount].splitId = split->id;
         
         lapCount++;
+        hotPathProbes[HOT_PATH_SPLIT_RECORD].record(hotPathCycles() - recordStart);
         
         Serial.printf("Lap %d added: %s (Total: %s) - Sync time: %llu\n", 
                       lapCount, formatTime(lapTime).c_str(), formatTime(currentElapsed).c_str(), currentSyncTime);
         
         // Send split time via WebSocket with synchronized timestamp
-        sendSplitTime(currentElapsed);
+        uint32_t sendStart = hotPathCycles();
+        bool sent = sendSplitTime(*split);
+        hotPathProbes[HOT_PATH_SPLIT_SEND].record(hotPathCycles() - sendStart);
+        if (sent) {
+            journal.markSent(split->id, now);
+            recordTrace(TRACE_SPLIT_SENT, lapCount);
+        } else {
+            Serial.println("Split not sent: no link to the server, kept for retransmit");
+        }
         
         if (onLapAdded) {
             onLapAdded(lapCount, lapTime, currentElapsed);
@@ -223,6 +426,70 @@ void WebSocketStopwatch::addLap() {
     }
 }
 
+bool WebSocketStopwatch::undoLastSplit() {
+    uint32_t now = millis();
+    const SplitJournal::Entry* split = journal.latest();
+    
+    // Only this heat's latest split, and only shortly after the touch
+    if (!split || split->heatStart != syncStartTime || undoWindowMs == 0 || now - split->createdMs > undoWindowMs) {
+        Serial.println("Undo refused: no split within the undo window");
+        return false;
+    }
+    uint32_t id = split->id;
+    journal.retract(id);
+    
+    uint8_t undoneLap = 0;
+    if (lapCount > 0 && laps[lapCount - 1].splitId == id) {
+        undoneLap = lapCount;
+        lapCount--;
+        laps[lapCount] = {0, 0, 0, 0, SYNC_NONE, 0};
+    }
+    recordTrace(TRACE_SPLIT_UNDONE, undoneLap);
+    Serial.printf("Split %lu (lap %d) undone\n", (unsigned long)id, undoneLap);
+    
+    flushSplitJournal(now); // Tombstone goes out at once
+    
+    if (onLapUndone && undoneLap > 0) {
+        onLapUndone(undoneLap);
+    }
+    return true;
+}
+
+void WebSocketStopwatch::sendRelayExchange(const RelayExchange& exchange) {
+    // Both raw edges into the trace, so a protest can be checked against them
+    if (exchange.verdict != RELAY_NO_TOUCH) {
+        recordTrace(TRACE_RELAY_TOUCH, exchange.touchUs);
+    }
+    recordTrace(TRACE_RELAY_RELEASE, exchange.releaseUs);
+
+    // The release in server time, from how long ago it was
+    uint32_t now = millis();
+    uint32_t releaseMs = now - (micros() - exchange.releaseUs) / 1000;
+    SyncQuality quality = clockSync.getQuality(now);
+
+    StaticJsonDocument<384> doc;
+    doc["type"] = WS_MSG_RELAY;
+    doc["device"] = traceLog.getDeviceName();
+    doc["start_timestamp"] = syncStartTime;
+    doc["lane"] = laneNumber;
+    doc["exchange"] = exchange.number;
+    doc["verdict"] = relayVerdictName(exchange.verdict);
+    if (exchange.verdict != RELAY_NO_TOUCH) {
+        doc["margin_us"] = exchange.marginUs;
+        doc["touch_us"] = exchange.touchUs;
+    }
+    doc["release_us"] = exchange.releaseUs;
+    doc["timestamp"] = clockSync.toServerTime(releaseMs);
+    doc["sync"] = ClockSync::qualityName(quality);
+
+    String message;
+    serializeJson(doc, message);
+    bool sent = sendRouted(message);
+    Serial.printf("Relay exchange %u: %s, touch %lu us, release %lu us, margin %+ld us (%s)\n", exchange.number,
+                  relayVerdictName(exchange.verdict), (unsigned long)exchange.touchUs,
+                  (unsigned long)exchange.releaseUs, (long)exchange.marginUs, sent ? "sent" : "not sent: no link");
+}
+
 StopwatchState WebSocketStopwatch::getState() {
     return currentState;
 }
@@ -230,7 +497,7 @@ StopwatchState WebSocketStopwatch::getState() {
 uint32_t WebSocketStopwatch::getElapsedTime() {
     if (currentState == STOPWATCH_RUNNING) {
         // Use synchronized time if available
-        if (syncStartTime > 0 && timeSync) {
+        if (syncStartTime > 0 && clockSync.isSynced()) {
             uint64_t currentSyncTime = getSynchronizedTime();
             return (uint32_t)(currentSyncTime - syncStartTime);
         } else {
@@ -250,26 +517,72 @@ const LapData* WebSocketStopwatch::getLaps() {
 }
 
 bool WebSocketStopwatch::hasServerTime() {
-    return timeSync; // Return true if we have time synchronization active
+    return clockSync.isSynced(); // True while locked or in holdover
+}
+
+SyncQuality WebSocketStopwatch::getSyncQuality() {
+    return clockSync.getQuality(millis());
+}
+
+uint32_t WebSocketStopwatch::getSyncUncertaintyMs() {
+    return clockSync.getUncertaintyMs(millis());
 }
 
 String WebSocketStopwatch::getCurrentEvent() {
-    return currentEvent;
+    return String(currentEvent);
 }
 
 String WebSocketStopwatch::getCurrentHeat() {
-    return currentHeat;
+    return String(currentHeat);
 }
 
-const WebSocketStopwatch::SplitTimeInfo* WebSocketStopwatch::getSplitTimes() {
-    return splitTimes;
+uint16_t WebSocketStopwatch::getEventDistance() {
+    return eventDistanceM;
+}
+
+const SplitRegistry& WebSocketStopwatch::getSplitRegistry() {
+    return splitRegistry;
+}
+
+const SplitFeed& WebSocketStopwatch::getSplitFeed() {
+    return splitFeed;
+}
+
+const HeatArena& WebSocketStopwatch::getHeatArena() {
+    return heatArena;
 }
 
 void WebSocketStopwatch::clearSplitTimes() {
-    for (uint8_t i = 0; i < MAX_LANES; i++) {
-        splitTimes[i] = {0, 0, "", false};
+    Serial.printf("Split times cleared (heat used %u of %u arena bytes)\n",
+                  (unsigned)heatArena.used(), (unsigned)heatArena.capacity());
+    beginHeat();
+}
+
+void WebSocketStopwatch::beginHeat() {
+    // The next heat is usually announced before the last one is reset, so
+    // its names are carried over into the fresh arena
+    char event[48], heat[48];
+    strlcpy(event, currentEvent, sizeof(event));
+    strlcpy(heat, currentHeat, sizeof(heat));
+    
+    heatArena.reset();
+    currentEvent = "";
+    currentHeat = "";
+    setEventHeat(event, heat);
+    splitRegistry.begin(heatArena);
+    splitFeed.begin(heatArena);
+}
+
+void WebSocketStopwatch::setEventHeat(const char* event, const char* heat) {
+    // Unchanged names (repeated select-event) take no arena space
+    if (strcmp(event, currentEvent) != 0) {
+        const char* copy = heatArena.copyString(event);
+        currentEvent = copy ? copy : "";
+    }
+    if (strcmp(heat, currentHeat) != 0) {
+        const char* copy = heatArena.copyString(heat);
+        currentHeat = copy ? copy : "";
     }
-    Serial.println("Split times cleared");
 }
 
 void WebSocketStopwatch::clearDisplay() {
@@ -286,6 +599,7 @@ void WebSocketStopwatch::clearDisplay() {
 
 void WebSocketStopwatch::handleRemoteStart(uint64_t serverTime) {
     syncStartTime = serverTime; // Store synchronized start time
+    recordTrace(TRACE_START_RECEIVED);
     if (currentState != STOPWATCH_RUNNING) {
         start();
         Serial.printf("Remote start received with server time: %llu\n", serverTime);
@@ -298,45 +612,143 @@ void WebSocketStopwatch::handleRemoteReset() {
 }
 
 String WebSocketStopwatch::formatTime(uint32_t milliseconds) {
-    uint16_t minutes = milliseconds / 60000;
-    uint8_t seconds = (milliseconds / 1000) % 60;
-    uint8_t centiseconds = (milliseconds % 1000) / 10;
-    
-    char buffer[16];
-    sprintf(buffer, "%02d:%02d:%02d", minutes, seconds, centiseconds);
+    char buffer[TIME_FORMAT_SIZE];
+    formatTime(milliseconds, buffer, sizeof(buffer));
     return String(buffer);
 }
 
-void WebSocketStopwatch::sendSplitTime(uint32_t elapsedTime) {
-    if (!wsConnected) {
-        return;
-    }
-    
-    // Use current synchronized time for split timestamp (not calculated from elapsed)
-    uint64_t splitTimestamp = getSynchronizedTime();
+void WebSocketStopwatch::formatTime(uint32_t milliseconds, char* buffer, size_t size) {
+    formatCentiseconds(milliseconds, buffer, size);
+}
+
+bool WebSocketStopwatch::sendSplitTime(const SplitJournal::Entry& split) {
+    // Synchronized time at the button press (not calculated from elapsed).
+    // (device, start_timestamp, id) identifies the split for de-duplication and undo
+    SyncQuality quality = (SyncQuality)split.quality;
     
-    StaticJsonDocument<300> doc;
+    StaticJsonDocument<384> doc;
     doc["type"] = WS_MSG_SPLIT;
+    doc["device"] = traceLog.getDeviceName();
+    doc["id"] = split.id;
+    doc["start_timestamp"] = split.heatStart;
     doc["lane"] = laneNumber; // Use integer instead of string per new spec
-    doc["timestamp"] = splitTimestamp; // Use current synchronized timestamp
+    doc["position"] = splitPositionName(position);
+    doc["timestamp"] = split.timestamp;
+    doc["sync"] = ClockSync::qualityName(quality);
+    if (quality != SYNC_NONE) {
+        doc["uncertainty_ms"] = split.uncertaintyMs;
+    }
     
     String message;
     serializeJson(doc, message);
-    sendMessage(message);
+    if (!sendRouted(message)) {
+        return false;
+    }
+    
+    Serial.printf("Split time sent for lane %d %s: id=%lu timestamp=%llu (%s, +/-%ums) via %s\n", 
+                  laneNumber, splitPositionName(position), (unsigned long)split.id, split.timestamp,
+                  ClockSync::qualityName(quality), split.uncertaintyMs, LinkSelector::routeName(lastRoute));
+    return true;
+}
+
+bool WebSocketStopwatch::sendSplitUndo(const SplitJournal::Entry& split) {
+    StaticJsonDocument<256> doc;
+    doc["type"] = WS_MSG_SPLIT_UNDO;
+    doc["device"] = traceLog.getDeviceName();
+    doc["id"] = split.id;
+    doc["start_timestamp"] = split.heatStart;
+    doc["lane"] = laneNumber;
+    doc["position"] = splitPositionName(position);
+    doc["timestamp"] = split.timestamp; // Lets other devices find the split to take out
     
-    Serial.printf("Split time sent for lane %d: timestamp=%llu (synchronized)\n", 
-                  laneNumber, splitTimestamp);
+    String message;
+    serializeJson(doc, message);
+    if (!sendRouted(message)) {
+        return false;
+    }
+    Serial.printf("Split undo sent: id=%lu via %s\n", (unsigned long)split.id, LinkSelector::routeName(lastRoute));
+    return true;
+}
+
+void WebSocketStopwatch::flushSplitJournal(uint32_t now) {
+    const SplitJournal::Entry* split;
+    while ((split = journal.nextDue(now)) != nullptr) {
+        bool resend = split->sentMs != 0;
+        if (!(split->isRetracted() ? sendSplitUndo(*split) : sendSplitTime(*split))) {
+            break; // No route; try again next loop
+        }
+        if (resend) {
+            splitRetransmits++;
+        }
+        journal.markSent(split->id, now);
+    }
 }
 
 void WebSocketStopwatch::sendMessage(const String& message) {
+    sendUpstream((const uint8_t*)message.c_str(), message.length());
+}
+
+bool WebSocketStopwatch::sendUpstream(const uint8_t* payload, size_t length) {
+    if (wiredActive) {
+        return wiredLink->send(payload, length);
+    }
     if (wsConnected) {
-        String msg = message;  // Create non-const copy
-        webSocket.sendTXT(msg);
+        return webSocket.sendTXT(payload, length);
+    }
+    return false;
+}
+
+LinkRoute WebSocketStopwatch::updateRoute() {
+    bool fallbackUp = peerLink && !peerGateway && peerLink->isUp();
+    LinkRoute route = linkSelector.route(millis(), fallbackUp);
+    if (wiredActive) {
+        route = ROUTE_WIRED;
+    }
+    if (route != lastRoute) {
+        Serial.printf("Message route: %s -> %s\n", LinkSelector::routeName(lastRoute), LinkSelector::routeName(route));
+        lastRoute = route;
+    }
+    return route;
+}
+
+void WebSocketStopwatch::updateWiredLink() {
+    bool up = wiredLink->isUp();
+    if (up == wiredActive) {
+        return;
+    }
+    wiredActive = up;
+    Serial.printf("Wired link %s\n", up ? "up: traffic moves to USB" : "down");
+    
+    // Round trips over the cable differ from Wi-Fi: measure afresh on
+    // whichever path pings use now
+    bestPingMs = -1;
+    pingSampleCount = 0;
+    lastPingTime = 0;
+    if (up) {
+        sendSubscribe(); // The bridge's WebSocket starts with no subscription
+    } else if (wsConnected) {
+        // No pings went over the WebSocket meanwhile: quiet is not dead
+        linkSelector.primaryHeard(millis());
+    } else {
+        clockSync.setLinkUp(false);
+    }
+    updateRoute();
+}
+
+bool WebSocketStopwatch::sendRouted(const String& message) {
+    switch (updateRoute()) {
+        case ROUTE_WIRED:
+        case ROUTE_PRIMARY:
+            return sendUpstream((const uint8_t*)message.c_str(), message.length());
+        case ROUTE_FALLBACK:
+            return peerLink->send((const uint8_t*)message.c_str(), message.length());
+        default:
+            return false;
     }
 }
 
 void WebSocketStopwatch::sendStart(const String& event, const String& heat) {
-    if (!wsConnected) {
+    if (!wsConnected && !wiredActive) {
         Serial.println("WS not connected - cannot send start");
         return;
     }
@@ -350,11 +762,13 @@ void WebSocketStopwatch::sendStart(const String& event, const String& heat) {
     doc["event"] = event;
     doc["heat"] = heat;
     // Use synchronized time (ms since epoch if server_time reflects epoch)
-    doc["timestamp"] = getSynchronizedTime();
+    uint64_t startTimestamp = getSynchronizedTime();
+    doc["timestamp"] = startTimestamp;
     String message;
     serializeJson(doc, message);
     sendMessage(message);
-    Serial.printf("Starter sent start: event=%s heat=%s ts=%llu\n", event.c_str(), heat.c_str(), (unsigned long long)getSynchronizedTime());
+    recordTrace(TRACE_START_SENT, 0, startTimestamp);
+    Serial.printf("Starter sent start: event=%s heat=%s ts=%llu\n", event.c_str(), heat.c_str(), (unsigned long long)startTimestamp);
     // Lock further starts until we receive a reset from server
     startLocked = true;
 }
@@ -376,6 +790,11 @@ void WebSocketStopwatch::handleWebSocketEvent(WStype_t type, uint8_t* payload, s
         case WStype_DISCONNECTED:
             Serial.println("WebSocket Disconnected!");
             wsConnected = false;
+            linkSelector.setPrimaryUp(false, millis());
+            if (!wiredActive) {
+                clockSync.setLinkUp(false); // Holdover until the next pong
+            }
+            recordTrace(TRACE_WS_DISCONNECTED);
             if (onConnectionChanged) {
                 onConnectionChanged(false);
             }
@@ -384,13 +803,15 @@ void WebSocketStopwatch::handleWebSocketEvent(WStype_t type, uint8_t* payload, s
         case WStype_CONNECTED:
             Serial.printf("WebSocket Connected to: %s\n", payload);
             wsConnected = true;
+            linkSelector.setPrimaryUp(true, millis());
             
-            // Reset synchronization state for fresh measurements on new connection
+            // Fresh round-trip measurements on the new connection; the clock
+            // stays in drift-corrected holdover until the first pong
             bestPingMs = -1;
             pingSampleCount = 0;
-            timeSync = false;
-            serverTimeOffset = 0;
-            Serial.println("Time sync reset for new connection - starting initial ping sequence");
+            Serial.println("Starting initial ping sequence on new connection");
+            recordTrace(TRACE_WS_CONNECTED);
+            sendSubscribe();
             
             // Start initial rapid ping sequence (per new spec)
             lastPingTime = 0; // Force immediate ping
@@ -400,38 +821,10 @@ void WebSocketStopwatch::handleWebSocketEvent(WStype_t type, uint8_t* payload, s
             }
             break;
             
-        case WStype_TEXT: {
-            Serial.printf("WebSocket received: %s\n", payload);
-            
-            StaticJsonDocument<512> doc;
-            DeserializationError error = deserializeJson(doc, payload);
-            
-            if (error) {
-                Serial.printf("JSON parse error: %s\n", error.c_str());
-                return;
-            }
-            
-            const char* msgType = doc["type"];
-            if (strcmp(msgType, WS_MSG_PING) == 0) {
-                handlePingMessage(doc);
-            } else if (strcmp(msgType, WS_MSG_PONG) == 0) {
-                handlePongMessage(doc);
-            } else if (strcmp(msgType, WS_MSG_START) == 0) {
-                handleStartMessage(doc);
-            } else if (strcmp(msgType, WS_MSG_RESET) == 0) {
-                handleResetMessage(doc);
-            } else if (strcmp(msgType, WS_MSG_SPLIT) == 0) {
-                handleSplitMessage(doc);
-            // Both 'event-heat' and 'select-event' message types are handled identically
-            // because they both update the current event and heat information from the server.
-            // If their purposes diverge in the future, separate handling can be implemented.
-            } else if (strcmp(msgType, WS_MSG_EVENT_HEAT) == 0 || strcmp(msgType, WS_MSG_SELECT_EVENT) == 0) {
-                handleEventHeatMessage(doc);
-            } else if (strcmp(msgType, WS_MSG_CLEAR) == 0) {
-                handleClearMessage(doc);
-            }
+        case WStype_TEXT:
+            linkSelector.primaryHeard(millis());
+            handleTextFrame(payload, length, FROM_WEBSOCKET);
             break;
-        }
         
         case WStype_ERROR:
             Serial.printf("WebSocket Error: %s\n", payload);
@@ -442,7 +835,139 @@ void WebSocketStopwatch::handleWebSocketEvent(WStype_t type, uint8_t* payload, s
     }
 }
 
+void WebSocketStopwatch::handlePeerFrame(uint8_t* payload, size_t length) {
+    if (peerGateway) {
+        // A lane without Wi-Fi: forward its message to the server unchanged
+        // (before parsing, which works in place), then show it locally
+        lastPeerUplinkTime = millis();
+        if (sendUpstream(payload, length)) {
+            peerForwarded++;
+        }
+    }
+    handleTextFrame(payload, length, FROM_PEER_LINK);
+}
+
+void WebSocketStopwatch::handleTextFrame(uint8_t* payload, size_t length, FrameSource source) {
+    // Pre-parse stage: size limit and type peek before any JSON work
+    char typeName[WS_MAX_TYPE_LENGTH];
+    WsMessageType msgType;
+    WsIngressResult screened = wsScreenFrame(payload, length, typeName, sizeof(typeName), msgType);
+    if (screened == WS_INGRESS_TOO_LARGE) {
+        droppedFrames++;
+        Serial.printf("Frame dropped: %u bytes exceeds %d\n", (unsigned)length, WS_MAX_FRAME_SIZE);
+        return;
+    }
+    if (screened == WS_INGRESS_NO_TYPE) {
+        droppedFrames++;
+        Serial.printf("Frame dropped: no message type (%u bytes)\n", (unsigned)length);
+        return;
+    }
+    
+    if (!(subscribedTypes & WS_TYPE_BIT(msgType))) {
+        droppedFrames++;
+        return; // Unknown or unsubscribed type, silently ignored
+    }
+    
+    // Only a few types are meaningful over the peer link in each direction
+    if (source == FROM_PEER_LINK &&
+        !((peerGateway ? PEER_UPLINK_TYPES : PEER_DOWNLINK_TYPES) & WS_TYPE_BIT(msgType))) {
+        droppedFrames++;
+        return;
+    }
+    
+    // Gateway: repeat server traffic to lanes that recently fell back to us.
+    // Lanes drop the copies they also get over their own WebSocket by seq
+    if ((source == FROM_WEBSOCKET || source == FROM_WIRED) && peerGateway && peerLink && (PEER_DOWNLINK_TYPES & WS_TYPE_BIT(msgType)) &&
+        lastPeerUplinkTime != 0 && millis() - lastPeerUplinkTime < PEER_RELAY_WINDOW) {
+        peerLink->send(payload, length);
+    }
+    
+    static const char* const SOURCE_NAMES[] = {"WebSocket", "UDP", "Peer", "USB"};
+    Serial.printf("%s received: %s (%u bytes)\n", SOURCE_NAMES[source], typeName, (unsigned)length);
+    
+    StaticJsonDocument<512> doc;
+    DeserializationError error = deserializeJson(doc, payload, length,
+                                                 DeserializationOption::Filter(ingressFilter));
+    
+    if (error) {
+        droppedFrames++;
+        Serial.printf("JSON parse error: %s\n", error.c_str());
+        return;
+    }
+    
+    // Fast path datagrams are limited to start/reset of the server run we are synced to
+    if (source == FROM_FAST_PATH) {
+        uint32_t epoch = doc["epoch"] | 0UL;
+        if ((msgType != WS_TYPE_START && msgType != WS_TYPE_RESET) ||
+            serverEpoch == 0 || epoch != serverEpoch || !doc.containsKey("seq")) {
+            droppedFrames++;
+            return;
+        }
+    }
+    
+    // Replayed or duplicate copies of messages we already applied
+    bool inBand = source == FROM_WEBSOCKET || source == FROM_WIRED;
+    if (msgType != WS_TYPE_SNAPSHOT && !acceptSequence(doc, !inBand)) {
+        return;
+    }
+    
+    switch (msgType) {
+        case WS_TYPE_PING:
+            handlePingMessage(doc);
+            break;
+        case WS_TYPE_PONG:
+            handlePongMessage(doc);
+            break;
+        case WS_TYPE_START:
+            handleStartMessage(doc);
+            break;
+        case WS_TYPE_RESET:
+            handleResetMessage(doc);
+            break;
+        case WS_TYPE_SPLIT:
+            handleSplitMessage(doc);
+            break;
+        // Both 'event-heat' and 'select-event' message types are handled identically
+        // because they both update the current event and heat information from the server.
+        // If their purposes diverge in the future, separate handling can be implemented.
+        case WS_TYPE_EVENT_HEAT:
+        case WS_TYPE_SELECT_EVENT:
+            handleEventHeatMessage(doc);
+            break;
+        case WS_TYPE_CLEAR:
+            handleClearMessage(doc);
+            break;
+        case WS_TYPE_TRACE_DUMP:
+            handleTraceDumpMessage(doc);
+            break;
+        case WS_TYPE_SNAPSHOT:
+            handleSnapshotMessage(doc);
+            break;
+        case WS_TYPE_STATUS:
+            handleStatusMessage(doc);
+            break;
+        case WS_TYPE_PRESENCE:
+            handlePresenceMessage(doc);
+            break;
+        case WS_TYPE_PROBE:
+            handleProbeMessage(doc);
+            break;
+        case WS_TYPE_SPLIT_ACK:
+            handleSplitAckMessage(doc);
+            break;
+        case WS_TYPE_SPLIT_UNDO:
+            handleSplitUndoMessage(doc);
+            break;
+        default:
+            break;
+    }
+}
+
 void WebSocketStopwatch::handleStartMessage(JsonDocument& doc) {
+    // Before the state change, so the lane's lap counter starts with it
+    if (doc.containsKey("distance")) {
+        eventDistanceM = doc["distance"];
+    }
     if (doc.containsKey("timestamp")) {
         uint64_t serverTime = doc["timestamp"].as<uint64_t>();
         handleRemoteStart(serverTime);
@@ -454,6 +979,7 @@ void WebSocketStopwatch::handleStartMessage(JsonDocument& doc) {
 }
 
 void WebSocketStopwatch::handleResetMessage(JsonDocument& doc) {
+    recordTrace(TRACE_RESET_RECEIVED);
     handleRemoteReset();
     // Unlock start after server reset message
     startLocked = false;
@@ -461,34 +987,87 @@ void WebSocketStopwatch::handleResetMessage(JsonDocument& doc) {
 
 void WebSocketStopwatch::handleSplitMessage(JsonDocument& doc) {
     if (doc.containsKey("lane") && doc.containsKey("timestamp")) {
-        uint8_t lane = doc["lane"].as<uint8_t>();
+        int laneValue = doc["lane"] | -1;
+        if (laneValue < 0 || laneValue >= WS_MAX_LANES) {
+            droppedFrames++;
+            return;
+        }
+        uint8_t lane = laneValue;
+        SplitPosition splitPosition = splitPositionFromName(doc["position"] | "start");
         uint64_t timestamp = doc["timestamp"].as<uint64_t>();
-        String timeStr = doc.containsKey("time") ? doc["time"].as<String>() : "00:00:00";
+        const char* timeStr = doc["time"] | "00:00:00";
         
-        if (lane < MAX_LANES) {
-            splitTimes[lane].lane = lane;
-            splitTimes[lane].timestamp = timestamp;
-            splitTimes[lane].formattedTime = timeStr;
-            splitTimes[lane].isValid = true;
-            
-            Serial.printf("Split time received for lane %d: %s\n", lane, timeStr.c_str());
-            
-            if (onSplitTimeReceived) {
-                onSplitTimeReceived(lane, timeStr);
-            }
+        // Honour our own subscription in case the server does not filter
+        if (!subscribeAllLanes && lane != laneNumber) {
+            droppedFrames++;
+            return;
+        }
+        
+        const SplitRecord* split = splitRegistry.record(lane, splitPosition, timestamp, timeStr);
+        if (!split) {
+            droppedFrames++;
+            Serial.printf("Split for lane %d %s dropped: registry full\n", lane, splitPositionName(splitPosition));
+            return;
+        }
+        splitFeed.insert(*split);
+        
+        Serial.printf("Split time received for lane %d %s: %s\n", lane, splitPositionName(splitPosition), timeStr);
+        
+        if (onSplitTimeReceived) {
+            onSplitTimeReceived(lane, splitPosition, String(timeStr));
         }
     }
 }
 
+void WebSocketStopwatch::handleSplitAckMessage(JsonDocument& doc) {
+    // Sent to the connection the split came in on, which for a lane on the
+    // peer link is the starter's: it relays the ack to every lane
+    if (!doc.containsKey("id") || strcmp(doc["device"] | "", traceLog.getDeviceName().c_str()) != 0) {
+        return;
+    }
+    journal.acknowledge(doc["id"].as<uint32_t>(), doc["undo"] | false);
+}
+
+void WebSocketStopwatch::handleSplitUndoMessage(JsonDocument& doc) {
+    // Another device retracted a split we may be showing
+    if (!doc.containsKey("lane") || !doc.containsKey("timestamp")) {
+        return;
+    }
+    uint8_t lane = doc["lane"].as<uint8_t>();
+    SplitPosition splitPosition = splitPositionFromName(doc["position"] | "start");
+    uint64_t timestamp = doc["timestamp"].as<uint64_t>();
+    
+    // Applied once: the feed no longer has it the second time (gateway: the
+    // lane's copy over the peer link, then the server's)
+    if (!splitFeed.remove(lane, splitPosition, timestamp)) {
+        return;
+    }
+    splitRegistry.retract(lane, splitPosition, timestamp, splitFeed.latestOf(lane, splitPosition));
+    Serial.printf("Split undone for lane %d %s\n", lane, splitPositionName(splitPosition));
+    
+    if (onSplitTimeReceived) {
+        const SplitRecord* current = splitRegistry.find(lane, splitPosition);
+        onSplitTimeReceived(lane, splitPosition, String(current ? current->time : ""));
+    }
+}
+
 void WebSocketStopwatch::handleEventHeatMessage(JsonDocument& doc) {
     if (doc.containsKey("event") && doc.containsKey("heat")) {
-        currentEvent = doc["event"].as<String>();
-        currentHeat = doc["heat"].as<String>();
+        // Numbers ("event":1) and strings both arrive; keep the text
+        char event[48], heat[48];
+        variantText(doc["event"], event, sizeof(event));
+        variantText(doc["heat"], heat, sizeof(heat));
+        setEventHeat(event, heat);
+        // Optional: only servers with a heat program send it. Without it the
+        // distance the start (or an earlier announcement) set stays
+        if (doc.containsKey("distance")) {
+            eventDistanceM = doc["distance"];
+        }
         
-        Serial.printf("Event/Heat updated: %s / %s\n", currentEvent.c_str(), currentHeat.c_str());
+        Serial.printf("Event/Heat updated: %s / %s\n", currentEvent, currentHeat);
         
         if (onEventHeatChanged) {
-            onEventHeatChanged(currentEvent, currentHeat);
+            onEventHeatChanged(String(currentEvent), String(currentHeat));
         }
     }
 }
@@ -497,10 +1076,126 @@ void WebSocketStopwatch::handleClearMessage(JsonDocument& doc) {
     clearDisplay();
 }
 
+void WebSocketStopwatch::handleTraceDumpMessage(JsonDocument& doc) {
+    Serial.printf("Trace dump requested - %d records\n", traceLog.count());
+    sendTraceDump();
+}
+
 int WebSocketStopwatch::getPingMs() {
     return pingMs;
 }
 
+uint32_t WebSocketStopwatch::getDroppedFrameCount() {
+    return droppedFrames;
+}
+
+uint32_t WebSocketStopwatch::getLastSequence() {
+    return lastSeq;
+}
+
+uint32_t WebSocketStopwatch::getServerEpoch() {
+    return serverEpoch;
+}
+
+bool WebSocketStopwatch::isOnPeerLink() {
+    return !peerGateway && lastRoute == ROUTE_FALLBACK;
+}
+
+uint16_t WebSocketStopwatch::getUnsettledSplitCount() {
+    return journal.getUnsettledCount();
+}
+
+bool WebSocketStopwatch::isOnWiredLink() {
+    return wiredActive;
+}
+
+bool WebSocketStopwatch::isAwaitingStart() {
+    // The subscribe goes out as soon as either link comes up
+    bool sessionUp = wsConnected || wiredActive || isOnPeerLink();
+    return sessionUp && (subscribedTypes & (WS_TYPE_BIT(WS_TYPE_START) | WS_TYPE_BIT(WS_TYPE_RESET)));
+}
+
+bool WebSocketStopwatch::acceptSequence(JsonDocument& doc, bool outOfBand) {
+    if (!doc.containsKey("seq")) {
+        return true; // Unsequenced (pong, legacy server)
+    }
+    uint32_t seq = doc["seq"].as<uint32_t>();
+    
+    if (outOfBand) {
+        if (seq <= lastSeq || appliedOutOfBand(seq)) {
+            duplicateFrames++;
+            return false;
+        }
+        // Next in line: nothing earlier is missing, so it is safe to advance.
+        // Keeps the resume point current while the WebSocket is down
+        if (seq == lastSeq + 1) {
+            lastSeq = seq;
+            return true;
+        }
+        outOfBandSeqs[outOfBandSeqNext] = seq;
+        outOfBandSeqNext = (outOfBandSeqNext + 1) % OUT_OF_BAND_SEQ_SLOTS;
+        return true;
+    }
+    
+    if (seq <= lastSeq) {
+        duplicateFrames++;
+        Serial.printf("Duplicate message seq %lu ignored (last %lu)\n",
+                      (unsigned long)seq, (unsigned long)lastSeq);
+        return false;
+    }
+    lastSeq = seq;
+    
+    // WebSocket confirmation of a datagram we already acted on
+    if (appliedOutOfBand(seq)) {
+        duplicateFrames++;
+        return false;
+    }
+    return true;
+}
+
+bool WebSocketStopwatch::appliedOutOfBand(uint32_t seq) {
+    for (uint8_t i = 0; i < OUT_OF_BAND_SEQ_SLOTS; i++) {
+        if (outOfBandSeqs[i] == seq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WebSocketStopwatch::handleSnapshotMessage(JsonDocument& doc) {
+    // Sent instead of a replay when the gap is too large or the server restarted
+    lastSeq = doc["seq"] | 0UL;
+    serverEpoch = doc["epoch"] | 0UL;
+    bool running = doc["running"] | false;
+    uint64_t startTimestamp = doc["start_timestamp"] | 0ULL;
+    
+    Serial.printf("Snapshot: seq=%lu running=%d start=%llu\n",
+                  (unsigned long)lastSeq, running, (unsigned long long)startTimestamp);
+    
+    if (running) {
+        if (currentState == STOPWATCH_RUNNING && startTimestamp != syncStartTime) {
+            handleRemoteReset(); // Running on a start we no longer agree with
+        }
+        if (currentState != STOPWATCH_RUNNING) {
+            if (startTimestamp > 0) {
+                handleRemoteStart(startTimestamp);
+            } else {
+                start();
+            }
+        }
+        startLocked = true;
+    } else {
+        if (currentState == STOPWATCH_RUNNING) {
+            handleRemoteReset();
+        }
+        startLocked = false;
+    }
+    
+    if (doc.containsKey("event") && doc.containsKey("heat")) {
+        handleEventHeatMessage(doc);
+    }
+}
+
 void WebSocketStopwatch::sendJsonPing() {
     StaticJsonDocument<128> doc;
     doc["type"] = WS_MSG_PING;
@@ -537,10 +1232,15 @@ void WebSocketStopwatch::handlePongMessage(JsonDocument& doc) {
         // Calculate round-trip time
         pingMs = lastPongTime - clientPingTime;
         
-        // Calculate server time offset using: offset = server_time - client_time - rtt/2
-        int64_t clientTime = lastPongTime;
-        serverTimeOffset = serverTime - clientTime - (pingMs / 2);
-        timeSync = true;
+        // How far holdover drifted, measured against the first sample after it
+        if (clockSync.getQuality(lastPongTime) == SYNC_HOLDOVER) {
+            int64_t error = (int64_t)clockSync.toServerTime(lastPongTime) - (int64_t)(serverTime + pingMs / 2);
+            Serial.printf("Holdover ended: error %lldms (bound %lums)\n",
+                          error, (unsigned long)clockSync.getUncertaintyMs(lastPongTime));
+        }
+        
+        clockSync.addSample(lastPongTime, serverTime, pingMs);
+        syncRetentionSave(clockSync, lastPongTime);
         
         // Track best ping time for more accurate lag compensation
         if (bestPingMs == -1 || pingMs < bestPingMs) {
@@ -548,12 +1248,22 @@ void WebSocketStopwatch::handlePongMessage(JsonDocument& doc) {
             Serial.printf("New best ping: %dms\n", bestPingMs);
         }
         pingSampleCount++;
+        recordTrace(TRACE_SYNC_SAMPLE, pingMs);
+        
+        Serial.printf("Pong received - ping: %dms, best: %dms, offset: %lldms, drift: %.2fppm, samples: %d\n", 
+                     pingMs, bestPingMs, clockSync.getOffsetMs(lastPongTime), clockSync.getDriftPpm(),
+                     pingSampleCount);
         
-        Serial.printf("Pong received - ping: %dms, best: %dms, offset: %lldms, samples: %d\n", 
-                     pingMs, bestPingMs, serverTimeOffset, pingSampleCount);
+        float driftPpm;
+        if (clockSync.consumeCalibrationUpdate(driftPpm)) {
+            Serial.printf("Clock drift calibrated: %.2f ppm (+/-%.2f)\n", driftPpm, clockSync.getDriftBoundPpm());
+            if (onDriftCalibrated) {
+                onDriftCalibrated(driftPpm);
+            }
+        }
         
         if (onTimeSync) {
-            onTimeSync(timeSync);
+            onTimeSync(true);
         }
     } else {
         Serial.println("Invalid pong message format");
@@ -561,8 +1271,185 @@ void WebSocketStopwatch::handlePongMessage(JsonDocument& doc) {
 }
 
 uint64_t WebSocketStopwatch::getSynchronizedTime() {
-    if (timeSync) {
-        return millis() + serverTimeOffset;
+    // Drift-corrected in holdover; local time if never synchronized
+    return clockSync.toServerTime(millis());
+}
+
+void WebSocketStopwatch::sendSubscribe() {
+    StaticJsonDocument<384> doc;
+    doc["type"] = WS_MSG_SUBSCRIBE;
+    
+    JsonArray types = doc.createNestedArray("types");
+    for (uint8_t i = 1; i < WS_TYPE_COUNT; i++) {
+        if (subscribedTypes & WS_TYPE_BIT(i)) {
+            types.add(wsTypeName((WsMessageType)i));
+        }
+    }
+    
+    if (subscribeAllLanes) {
+        doc["lanes"] = "all";
+    } else {
+        doc.createNestedArray("lanes").add(laneNumber);
+    }
+    
+    // Resume point: the server replays newer messages or answers with a snapshot
+    doc["last_seq"] = lastSeq;
+    doc["epoch"] = serverEpoch;
+    
+    String message;
+    serializeJson(doc, message);
+    // Each path is a separate server connection with its own subscription
+    if (wsConnected) {
+        webSocket.sendTXT(message);
+    }
+    if (wiredActive) {
+        wiredLink->send((const uint8_t*)message.c_str(), message.length());
+    }
+    Serial.printf("Subscription sent: %s\n", message.c_str());
+}
+
+void WebSocketStopwatch::sendStatus() {
+    uint32_t now = millis();
+    SyncQuality quality = clockSync.getQuality(now);
+    
+    StaticJsonDocument<256> doc;
+    doc["type"] = WS_MSG_STATUS;
+    doc["device"] = traceLog.getDeviceName();
+    if (!subscribeAllLanes) {
+        doc["lane"] = laneNumber; // Lane devices only; the starter reports without a lane
+        doc["position"] = splitPositionName(position);
+    }
+    doc["sync"] = ClockSync::qualityName(quality);
+    if (quality != SYNC_NONE) {
+        doc["uncertainty_ms"] = clockSync.getUncertaintyMs(now);
+    }
+    doc["rtt"] = pingMs;
+    doc["drift_ppm"] = serialized(String(clockSync.getDriftPpm(), 2));
+    doc["running"] = currentState == STOPWATCH_RUNNING;
+    doc["split_retransmits"] = splitRetransmits;
+    if (batteryPercent != LaneReadiness::BATTERY_UNKNOWN) {
+        doc["battery"] = batteryPercent;
+    }
+    
+    String message;
+    serializeJson(doc, message);
+    sendRouted(message);
+}
+
+void WebSocketStopwatch::handleStatusMessage(JsonDocument& doc) {
+    // Another device's report; only lane devices take part in the readiness
+    // gate, and the grid has one cell per lane: the start end's device
+    int lane = doc["lane"] | -1;
+    if (lane < 0 || lane >= WS_MAX_LANES || splitPositionFromName(doc["position"] | "start") != POSITION_START) {
+        return;
+    }
+    SyncQuality quality = ClockSync::qualityFromName(doc["sync"] | "none");
+    uint32_t uncertainty = doc["uncertainty_ms"] | ClockSync::UNKNOWN_UNCERTAINTY;
+    
+    if (onLaneStatus) {
+        onLaneStatus(lane, quality, uncertainty);
+    }
+}
+
+void WebSocketStopwatch::handlePresenceMessage(JsonDocument& doc) {
+    // The server's roster: one lane, only the fields that changed
+    int lane = doc["lane"] | -1;
+    if (lane < 0 || lane >= WS_MAX_LANES) {
+        return;
+    }
+    PresenceDelta delta = {(uint8_t)lane, 0, true, SYNC_NONE, ClockSync::UNKNOWN_UNCERTAINTY,
+                           LaneReadiness::BATTERY_UNKNOWN};
+    if (doc.containsKey("online")) {
+        delta.fields |= PRESENCE_ONLINE;
+        delta.online = doc["online"];
+    }
+    if (doc.containsKey("sync")) {
+        delta.fields |= PRESENCE_SYNC;
+        delta.quality = ClockSync::qualityFromName(doc["sync"] | "none");
+    }
+    if (doc.containsKey("uncertainty_ms")) {
+        delta.fields |= PRESENCE_UNCERTAINTY;
+        delta.uncertaintyMs = doc["uncertainty_ms"];
+    }
+    if (doc.containsKey("battery")) {
+        delta.fields |= PRESENCE_BATTERY;
+        delta.batteryPercent = doc["battery"];
+    }
+    
+    if (onLanePresence) {
+        onLanePresence(delta);
+    }
+}
+
+void WebSocketStopwatch::handleProbeMessage(JsonDocument& doc) {
+    // Server audit: answer at once with our idea of the current server time.
+    // The server brackets it between its send and receive times
+    uint32_t now = millis();
+    SyncQuality quality = clockSync.getQuality(now);
+    
+    StaticJsonDocument<256> reply;
+    reply["type"] = WS_MSG_PROBE_REPLY;
+    reply["id"] = doc["id"];
+    reply["device"] = traceLog.getDeviceName();
+    reply["time"] = clockSync.toServerTime(now);
+    reply["sync"] = ClockSync::qualityName(quality);
+    if (quality != SYNC_NONE) {
+        reply["uncertainty_ms"] = clockSync.getUncertaintyMs(now);
+    }
+    
+    String message;
+    serializeJson(reply, message);
+    sendMessage(message);
+}
+
+void WebSocketStopwatch::recordTrace(TraceEvent event, uint32_t arg, uint64_t chainTs) {
+    uint32_t now = millis();
+    traceLog.record(event, clockSync.toServerTime(now), clockSync.getOffsetMs(now), clockSync.isSynced(),
+                    chainTs ? chainTs : syncStartTime, arg);
+}
+
+void WebSocketStopwatch::sendTraceDump() {
+    // Records are pre-formatted JSON objects, so chunks are assembled directly
+    // instead of going through a (large) JsonDocument. Each chunk takes as
+    // many records as fit in one frame: the USB bridge refuses anything over
+    // WS_MAX_FRAME_SIZE, and the server's ingress limit is the same
+    static const char CHUNK_END[] = "]}";
+    char line[192];
+    uint16_t total = traceLog.count();
+    String message;
+    message.reserve(WS_MAX_FRAME_SIZE);
+    
+    for (uint16_t first = 0; first < total;) {
+        message = "{\"type\":\"" WS_MSG_TRACE "\",\"device\":\"";
+        message += traceLog.getDeviceName();
+        message += "\",\"first\":";
+        message += first;
+        message += ",\"total\":";
+        message += total;
+        message += ",\"events\":[";
+        uint16_t next = first;
+        for (; next < total; next++) {
+            size_t length = traceLog.formatRecord(traceLog.at(next), line, sizeof(line));
+            size_t separator = next > first ? 1 : 0;
+            if (message.length() + separator + length + sizeof(CHUNK_END) - 1 > WS_MAX_FRAME_SIZE) {
+                break;
+            }
+            if (separator) {
+                message += ',';
+            }
+            message += line;
+        }
+        if (next == first) {
+            Serial.printf("Trace dump stopped: record %u does not fit in a frame\n", first);
+            return;
+        }
+        message += CHUNK_END;
+        
+        // A refused chunk would leave a silent gap; the host asks again instead
+        if (!sendUpstream((const uint8_t*)message.c_str(), message.length())) {
+            Serial.printf("Trace dump stopped: send failed at record %u of %u\n", first, total);
+            return;
+        }
+        first = next;
     }
-    return millis(); // Fallback to local time if not synchronized
 }
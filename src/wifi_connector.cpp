@@ -0,0 +1,114 @@
+#include "wifi_connector.h"
+
+WifiConnector::WifiConnector()
+    : state(WIFI_IDLE)
+    , startPending(false)
+    , useKnownAp(false)
+    , portalAfter(0)
+    , failures(0)
+    , portalLatched(false)
+    , attempts(0)
+    , attemptStartMs(0)
+    , retryAtMs(0)
+    , downSinceMs(0)
+    , lastOutageMs(0)
+    , rng(1) {
+}
+
+const char* WifiConnector::stateName(WifiState state) {
+    switch (state) {
+        case WIFI_CONNECTING: return "connecting";
+        case WIFI_BACKOFF:    return "backoff";
+        case WIFI_CONNECTED:  return "connected";
+        default:              return "idle";
+    }
+}
+
+void WifiConnector::begin(uint32_t nowMs, bool knownAp, uint8_t portalAfterFailures, uint32_t seed) {
+    state = WIFI_CONNECTING;
+    startPending = true;
+    useKnownAp = knownAp;
+    portalAfter = portalAfterFailures;
+    failures = 0;
+    portalLatched = false;
+    attempts = 0;
+    attemptStartMs = nowMs;
+    downSinceMs = nowMs;
+    rng = seed ? seed : 1;
+}
+
+uint32_t WifiConnector::backoffMs() {
+    uint8_t doublings = failures > 6 ? 5 : failures - 1;
+    uint32_t base = BACKOFF_MIN_MS << doublings;
+    if (base > BACKOFF_MAX_MS) {
+        base = BACKOFF_MAX_MS;
+    }
+    rng = rng * 1664525u + 1013904223u;
+    return base + (rng >> 8) % (base / 4 + 1);
+}
+
+WifiAction WifiConnector::update(uint32_t nowMs, bool linkUp) {
+    if (state == WIFI_IDLE) {
+        return WIFI_ACTION_NONE;
+    }
+
+    if (linkUp) {
+        if (state != WIFI_CONNECTED) {
+            state = WIFI_CONNECTED;
+            startPending = false;
+            failures = 0;
+            lastOutageMs = nowMs - downSinceMs;
+        }
+        return WIFI_ACTION_NONE;
+    }
+
+    switch (state) {
+        case WIFI_CONNECTED:
+            // Lost: the driver reconnects by itself first, timed like an attempt
+            state = WIFI_CONNECTING;
+            attemptStartMs = nowMs;
+            downSinceMs = nowMs;
+            return WIFI_ACTION_NONE;
+
+        case WIFI_CONNECTING:
+            if (startPending) {
+                startPending = false;
+                attempts++;
+                attemptStartMs = nowMs;
+                bool knownAp = useKnownAp;
+                useKnownAp = false;
+                return knownAp ? WIFI_ACTION_CONNECT_KNOWN_AP : WIFI_ACTION_CONNECT;
+            }
+            if (nowMs - attemptStartMs < ATTEMPT_MS) {
+                return WIFI_ACTION_NONE;
+            }
+            if (failures < 255) {
+                failures++;
+            }
+            if (portalAfter && failures >= portalAfter) {
+                portalLatched = true;
+            }
+            state = WIFI_BACKOFF;
+            retryAtMs = nowMs + backoffMs();
+            return WIFI_ACTION_ABORT;
+
+        case WIFI_BACKOFF:
+            if ((int32_t)(nowMs - retryAtMs) < 0) {
+                return WIFI_ACTION_NONE;
+            }
+            state = WIFI_CONNECTING;
+            attempts++;
+            attemptStartMs = nowMs;
+            return WIFI_ACTION_CONNECT;
+
+        default:
+            return WIFI_ACTION_NONE;
+    }
+}
+
+uint32_t WifiConnector::getRetryInMs(uint32_t nowMs) const {
+    if (state != WIFI_BACKOFF || (int32_t)(nowMs - retryAtMs) >= 0) {
+        return 0;
+    }
+    return retryAtMs - nowMs;
+}
@@ -0,0 +1,136 @@
+#include "ws_protocol.h"
+#include <string.h>
+
+// Indexed by WsMessageType
+static const char* const WS_TYPE_NAMES[WS_TYPE_COUNT] = {
+    nullptr,
+    WS_MSG_PING,
+    WS_MSG_PONG,
+    WS_MSG_START,
+    WS_MSG_RESET,
+    WS_MSG_SPLIT,
+    WS_MSG_EVENT_HEAT,
+    WS_MSG_SELECT_EVENT,
+    WS_MSG_CLEAR,
+    WS_MSG_TRACE_DUMP,
+    WS_MSG_SNAPSHOT,
+    WS_MSG_STATUS,
+    WS_MSG_PROBE,
+    WS_MSG_SPLIT_UNDO,
+    WS_MSG_SPLIT_ACK,
+    WS_MSG_PRESENCE
+};
+
+const char* const WS_INGRESS_FIELDS[] = {
+    "type", "timestamp", "lane", "position", "time", "event", "heat", "distance",
+    "client_ping_time", "server_time", "seq", "epoch", "running", "start_timestamp",
+    "id", "sync", "uncertainty_ms", "device", "undo", "online", "battery"
+};
+const size_t WS_INGRESS_FIELD_COUNT = sizeof(WS_INGRESS_FIELDS) / sizeof(WS_INGRESS_FIELDS[0]);
+
+static size_t skipWhitespace(const uint8_t* payload, size_t length, size_t i) {
+    while (i < length && (payload[i] == ' ' || payload[i] == '\t' ||
+                          payload[i] == '\r' || payload[i] == '\n')) {
+        i++;
+    }
+    return i;
+}
+
+bool wsPeekType(const uint8_t* payload, size_t length, char* typeOut, size_t typeSize) {
+    if (payload == nullptr || typeOut == nullptr || typeSize == 0) {
+        return false;
+    }
+
+    int depth = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        uint8_t c = payload[i];
+
+        if (c != '"') {
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                depth--;
+            }
+            i++;
+            continue;
+        }
+
+        // Skip over a string, honouring escapes
+        size_t start = ++i;
+        bool escaped = false;
+        while (i < length && (escaped || payload[i] != '"')) {
+            escaped = !escaped && payload[i] == '\\';
+            i++;
+        }
+        if (i >= length) {
+            return false; // Unterminated string
+        }
+        size_t end = i++;
+
+        // Only keys of the top-level object are of interest
+        if (depth != 1) {
+            continue;
+        }
+        size_t next = skipWhitespace(payload, length, i);
+        if (next >= length || payload[next] != ':') {
+            continue; // A string value, not a key
+        }
+        i = next + 1;
+
+        if (end - start != 4 || memcmp(payload + start, "type", 4) != 0) {
+            continue;
+        }
+
+        // Copy the value; escaped or oversized type strings are rejected
+        i = skipWhitespace(payload, length, i);
+        if (i >= length || payload[i] != '"') {
+            return false;
+        }
+        i++;
+        size_t copied = 0;
+        while (i < length && payload[i] != '"') {
+            if (payload[i] == '\\' || copied + 1 >= typeSize) {
+                return false;
+            }
+            typeOut[copied++] = (char)payload[i++];
+        }
+        if (i >= length) {
+            return false;
+        }
+        typeOut[copied] = '\0';
+        return true;
+    }
+
+    return false;
+}
+
+WsMessageType wsClassifyType(const char* type) {
+    if (type == nullptr) {
+        return WS_TYPE_UNKNOWN;
+    }
+    for (uint8_t i = 1; i < WS_TYPE_COUNT; i++) {
+        if (strcmp(type, WS_TYPE_NAMES[i]) == 0) {
+            return (WsMessageType)i;
+        }
+    }
+    return WS_TYPE_UNKNOWN;
+}
+
+const char* wsTypeName(WsMessageType type) {
+    return type < WS_TYPE_COUNT ? WS_TYPE_NAMES[type] : nullptr;
+}
+
+WsIngressResult wsScreenFrame(const uint8_t* payload, size_t length, char* typeOut, size_t typeSize,
+                              WsMessageType& type) {
+    type = WS_TYPE_UNKNOWN;
+    if (length > WS_MAX_FRAME_SIZE) {
+        return WS_INGRESS_TOO_LARGE;
+    }
+    if (!wsPeekType(payload, length, typeOut, typeSize)) {
+        return WS_INGRESS_NO_TYPE;
+    }
+    type = wsClassifyType(typeOut);
+    return WS_INGRESS_OK;
+}
@@ -0,0 +1,317 @@
+// Heat arena soak (include/heat_arena.h), run on the host.
+//
+// Runs 500 heats of a gala through the per-heat data twice. Each heat
+// announces its event and heat names a few times (the server repeats
+// select-event), then 6-10 lanes with a device at each end report 2-8
+// splits each into the split registry and the scoreboard feed, with a
+// display line formatted for every split, and the heat is reset.
+//
+// - heap: the data as it was kept before the arena. Event and heat names
+//   are heap strings, replaced on every announcement (Arduino String
+//   assignment frees and reallocates), the registry grows with realloc,
+//   the feed is one malloc'd ring, and display lines are heap strings.
+// - arena: the firmware's SplitRegistry, SplitFeed and names in one
+//   HeatArena over a fixed region, reset at the end of every heat. Display
+//   lines are still transient heap strings, as DisplayManager takes String.
+//
+// After every heat it samples the allocator (mallinfo2: bytes in use, free
+// chunks) and counts the heap calls made for the heat's data. The display
+// lines are the same in both runs and are not counted.
+//
+//   g++ -O2 -Iinclude src/heat_arena.cpp src/split_board.cpp tools/arena_soak.cpp -o arena_soak
+//   ./arena_soak
+//
+// Exits non-zero if the arena run's heap changes after the first heat, if
+// the arena ever runs out, or if a heat's splits read wrong afterwards.
+
+#include "heat_arena.h"
+#include "split_board.h"
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int HEATS = 500;
+static const size_t ARENA_SIZE = 12 * 1024;     // As in the firmware
+
+struct Rng {
+    uint32_t state;
+
+    uint32_t next(uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    }
+};
+
+struct HeapSample {
+    size_t inUse;
+    size_t freeChunks;
+};
+
+static HeapSample sampleHeap() {
+    struct mallinfo2 info = mallinfo2();
+    return {info.uordblks, info.ordblks};
+}
+
+// Heap calls made by the modelled firmware code
+static uint32_t heapCalls = 0;
+
+static char* heapString(char* old, const char* text) {
+    free(old);
+    heapCalls += old ? 2 : 1;
+    size_t length = strlen(text) + 1;
+    char* copy = (char*)malloc(length);
+    memcpy(copy, text, length);
+    return copy;
+}
+
+static void formatTime(uint32_t milliseconds, char* buffer, size_t size) {
+    snprintf(buffer, size, "%02u:%02u:%02u", (unsigned)(milliseconds / 60000),
+             (unsigned)(milliseconds / 1000 % 60), (unsigned)(milliseconds % 1000 / 10));
+}
+
+// Display line for a split, built and dropped like the String passed to
+// DisplayManager::updateLapTime()
+static void showSplit(uint16_t number, const char* time) {
+    char text[32];
+    snprintf(text, sizeof(text), "Split - %u: %s", (unsigned)number, time);
+    size_t length = strlen(text) + 1;
+    char* line = (char*)malloc(length);
+    memcpy(line, text, length);
+    free(line);
+}
+
+struct Heat {
+    char event[48];
+    char heat[48];
+    uint8_t lanes;
+    uint8_t splits;
+    uint8_t announcements;
+};
+
+static Heat plan(Rng& rng, int index) {
+    static const char* STROKES[] = {"Freestyle", "Backstroke", "Breaststroke", "Butterfly", "Individual Medley"};
+    static const char* DISTANCES[] = {"50m", "100m", "200m", "400m"};
+    Heat heat;
+    snprintf(heat.event, sizeof(heat.event), "Event %d - %s %s %s", index / 8 + 1,
+             DISTANCES[rng.next(4)], STROKES[rng.next(5)], rng.next(2) ? "Women" : "Men");
+    snprintf(heat.heat, sizeof(heat.heat), "Heat %d of 8", index % 8 + 1);
+    heat.lanes = 6 + rng.next(5);
+    heat.splits = 2 + rng.next(7);
+    heat.announcements = 1 + rng.next(3);
+    return heat;
+}
+
+// Registry and feed as they were kept on the heap
+struct HeapBoard {
+    SplitRecord* entries = nullptr;
+    uint16_t count = 0;
+    uint16_t capacity = 0;
+    SplitRecord* ring = nullptr;
+    uint16_t head = 0;
+    uint16_t feedCount = 0;
+
+    void record(uint8_t lane, SplitPosition position, uint64_t timestamp, const char* time) {
+        uint16_t index = 0;
+        while (index < count && (entries[index].lane << 1 | entries[index].position) < (lane << 1 | position)) {
+            index++;
+        }
+        if (index == count || entries[index].lane != lane || entries[index].position != position) {
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 8;
+                entries = (SplitRecord*)realloc(entries, capacity * sizeof(SplitRecord));
+                heapCalls++;
+            }
+            memmove(&entries[index + 1], &entries[index], (count - index) * sizeof(SplitRecord));
+            count++;
+            entries[index].lane = lane;
+            entries[index].position = position;
+            entries[index].count = 0;
+        }
+        entries[index].timestamp = timestamp;
+        entries[index].count++;
+        strncpy(entries[index].time, time, sizeof(entries[index].time) - 1);
+        entries[index].time[sizeof(entries[index].time) - 1] = '\0';
+
+        if (!ring) {
+            ring = (SplitRecord*)malloc(SplitFeed::DEFAULT_CAPACITY * sizeof(SplitRecord));
+            heapCalls++;
+        }
+        ring[(head + feedCount) % SplitFeed::DEFAULT_CAPACITY] = entries[index];
+        if (feedCount < SplitFeed::DEFAULT_CAPACITY) {
+            feedCount++;
+        } else {
+            head = (head + 1) % SplitFeed::DEFAULT_CAPACITY;
+        }
+    }
+
+    void clear() {
+        count = 0;
+        head = 0;
+        feedCount = 0;
+    }
+};
+
+struct Result {
+    HeapSample first;       // After heat 1
+    HeapSample last;
+    HeapSample peak;
+    uint32_t changedHeats;  // Heats after which the heap differed from heat 1
+    uint32_t heapCalls;
+    uint32_t badHeats;
+    size_t arenaHighWater;
+    uint32_t arenaFailed;
+};
+
+static void track(Result& r, int index, const HeapSample& sample) {
+    if (index == 0) {
+        r.first = sample;
+        r.peak = sample;
+    } else if (sample.inUse != r.first.inUse || sample.freeChunks != r.first.freeChunks) {
+        r.changedHeats++;
+    }
+    if (sample.inUse > r.peak.inUse) {
+        r.peak.inUse = sample.inUse;
+    }
+    if (sample.freeChunks > r.peak.freeChunks) {
+        r.peak.freeChunks = sample.freeChunks;
+    }
+    r.last = sample;
+}
+
+static Result runHeap(uint32_t seed) {
+    Rng rng = {seed};
+    Result r = {};
+    HeapBoard board;
+    char* event = nullptr;
+    char* heatName = nullptr;
+    heapCalls = 0;
+
+    for (int index = 0; index < HEATS; index++) {
+        Heat heat = plan(rng, index);
+        for (int i = 0; i < heat.announcements; i++) {
+            event = heapString(event, heat.event);
+            heatName = heapString(heatName, heat.heat);
+        }
+        uint64_t start = 1700000000000ULL + (uint64_t)index * 600000;
+        for (uint8_t split = 1; split <= heat.splits; split++) {
+            for (uint8_t lane = 1; lane <= heat.lanes; lane++) {
+                for (int end = 0; end < 2; end++) {
+                    uint32_t raceMs = split * 30000 + lane * 37 + end * 15000 + rng.next(500);
+                    char time[12];
+                    formatTime(raceMs, time, sizeof(time));
+                    board.record(lane, (SplitPosition)end, start + raceMs, time);
+                    showSplit(split, time);
+                }
+            }
+        }
+        if (board.count != heat.lanes * 2) {
+            r.badHeats++;
+        }
+        board.clear();
+        track(r, index, sampleHeap());
+    }
+
+    r.heapCalls = heapCalls;
+    free(event);
+    free(heatName);
+    free(board.entries);
+    free(board.ring);
+    return r;
+}
+
+static Result runArena(uint32_t seed) {
+    Rng rng = {seed};
+    Result r = {};
+    static uint8_t region[ARENA_SIZE] __attribute__((aligned(8)));
+    HeatArena arena;
+    arena.begin(region, sizeof(region));
+    SplitRegistry registry;
+    SplitFeed feed;
+    const char* event = "";
+    const char* heatName = "";
+    heapCalls = 0;
+
+    for (int index = 0; index < HEATS; index++) {
+        Heat heat = plan(rng, index);
+
+        // WebSocketStopwatch::beginHeat(): reset, then the registry and feed
+        arena.reset();
+        event = "";
+        heatName = "";
+        registry.begin(arena);
+        feed.begin(arena);
+
+        // setEventHeat(): unchanged names are not copied again
+        for (int i = 0; i < heat.announcements; i++) {
+            if (strcmp(event, heat.event) != 0) {
+                event = arena.copyString(heat.event);
+            }
+            if (strcmp(heatName, heat.heat) != 0) {
+                heatName = arena.copyString(heat.heat);
+            }
+        }
+        uint64_t start = 1700000000000ULL + (uint64_t)index * 600000;
+        for (uint8_t split = 1; split <= heat.splits; split++) {
+            for (uint8_t lane = 1; lane <= heat.lanes; lane++) {
+                for (int end = 0; end < 2; end++) {
+                    uint32_t raceMs = split * 30000 + lane * 37 + end * 15000 + rng.next(500);
+                    char time[12];
+                    formatTime(raceMs, time, sizeof(time));
+                    const SplitRecord* kept = registry.record(lane, (SplitPosition)end, start + raceMs, time);
+                    if (kept) {
+                        feed.insert(*kept);
+                    }
+                    showSplit(split, time);
+                }
+            }
+        }
+
+        const SplitRecord* last = registry.find(heat.lanes, POSITION_TURN);
+        uint16_t reported = heat.lanes * 2 * heat.splits;
+        uint16_t kept = reported < SplitFeed::DEFAULT_CAPACITY ? reported : SplitFeed::DEFAULT_CAPACITY;
+        if (registry.size() != heat.lanes * 2 || !last || last->count != heat.splits ||
+            feed.size() != kept || !event || strcmp(event, heat.event) != 0) {
+            r.badHeats++;
+        }
+        track(r, index, sampleHeap());
+    }
+
+    // A heat that has passed reads as empty
+    arena.reset();
+    if (registry.size() != 0 || feed.size() != 0) {
+        r.badHeats++;
+    }
+
+    r.heapCalls = heapCalls;
+    r.arenaHighWater = arena.getHighWater();
+    r.arenaFailed = arena.getFailedCount();
+    return r;
+}
+
+static void report(const char* name, const Result& r) {
+    printf("  %-6s  %7zu / %-5zu  %7zu / %-5zu  %7zu / %-5zu  %13u  %13u  %10u\n", name,
+           r.first.inUse, r.first.freeChunks, r.last.inUse, r.last.freeChunks,
+           r.peak.inUse, r.peak.freeChunks, (unsigned)r.changedHeats, (unsigned)r.heapCalls,
+           (unsigned)r.badHeats);
+}
+
+int main() {
+    Result arena = runArena(42);
+    Result heap = runHeap(42);
+
+    printf("%d heats, 6-10 lanes at both ends, 2-8 splits each\n", HEATS);
+    printf("  %-6s  %15s  %15s  %15s  %13s  %13s  %10s\n", "data", "heat 1 B/chunks",
+           "last B/chunks", "peak B/chunks", "heap changed", "heap calls", "bad heats");
+    report("heap", heap);
+    report("arena", arena);
+    printf("Arena: %zu of %zu bytes at the high water mark, %u failed allocations\n",
+           arena.arenaHighWater, ARENA_SIZE, (unsigned)arena.arenaFailed);
+    printf("Heap calls per heat for its data: %.1f with the heap, %.1f with the arena\n",
+           (double)heap.heapCalls / HEATS, (double)arena.heapCalls / HEATS);
+
+    bool ok = arena.changedHeats == 0 && arena.arenaFailed == 0 && arena.badHeats == 0 && heap.badHeats == 0;
+    printf("%s\n", ok ? "OK: the arena run left the heap as it was after the first heat" : "FAIL");
+    return ok ? 0 : 1;
+}
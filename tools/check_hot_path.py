@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""
+Checks after the link that the firmware's hot path stays in internal RAM.
+
+Functions marked HOT_PATH_ATTR (include/hot_path.h) are put in sections
+named .iram1.hot.N. The check finds them in the object files' symbol
+tables, disassembles the linked .iram0.text and fails if a hot function:
+- is not in IRAM at all,
+- calls a direct target outside IRAM and ROM (call0/4/8/12, j),
+- loads a literal (l32r) pointing into flash code or flash data
+  (DROM, where the compiler puts strings and const tables), or
+- calls through a register it did not load from a literal (callx), which
+  the check cannot follow.
+A hot function may call any IRAM or ROM function; what that function calls
+in turn is its own code's promise (ESP-IDF's IRAM_ATTR), not checked here.
+
+Runs after every PlatformIO link (extra_scripts in platformio.ini). It can
+also be run by hand on a build directory:
+
+  python3 tools/check_hot_path.py --objdump xtensa-esp32s3-elf-objdump \\
+      .pio/build/lilygo-t-display-s3
+"""
+
+import argparse
+import glob
+import os
+import re
+import struct
+import subprocess
+import sys
+
+# ESP32-S3 address map (instruction bus unless noted)
+ALLOWED = [
+    (0x40000000, 0x40060000, "ROM"),
+    (0x40370000, 0x403E0000, "IRAM"),
+    (0x3FC88000, 0x3FD00000, "DRAM"),
+    (0x50000000, 0x50002000, "RTC fast"),
+    (0x60000000, 0x600D1000, "peripheral"),
+]
+FORBIDDEN = [
+    (0x42000000, 0x44000000, "flash code"),
+    (0x3C000000, 0x3E000000, "flash data"),
+]
+
+HOT_SECTION = re.compile(r"^\.iram1\.hot(\.|$)")
+SYMBOL = re.compile(r"^([0-9a-f]+)\s+(\S*)\s+F\s+(\S+)\s+([0-9a-f]+)\s+(.+)$")
+FUNCTION = re.compile(r"^([0-9a-f]{8}) <(.+)>:$")
+INSN = re.compile(r"^\s*([0-9a-f]+):\s+[0-9a-f]+\s+(\S+)\s*(.*)$")
+DIRECT = {"call0", "call4", "call8", "call12", "j"}
+INDIRECT = {"callx0", "callx4", "callx8", "callx12", "jx"}
+
+
+def region(address, regions):
+    for start, end, name in regions:
+        if start <= address < end:
+            return name
+    return None
+
+
+def hot_symbols(objdump_lines):
+    """Function names in .iram1.hot.* sections, from `objdump -t -C` output."""
+    names = set()
+    for line in objdump_lines:
+        match = SYMBOL.match(line.strip())
+        if match and HOT_SECTION.match(match.group(3)):
+            names.add(match.group(5))
+    return names
+
+
+def functions(disassembly_lines):
+    """{name: [(address, mnemonic, operands)]} from `objdump -d -C` output."""
+    out = {}
+    current = None
+    for line in disassembly_lines:
+        head = FUNCTION.match(line.strip())
+        if head:
+            current = out.setdefault(head.group(2), [])
+            continue
+        insn = INSN.match(line)
+        if insn and current is not None:
+            current.append((int(insn.group(1), 16), insn.group(2), insn.group(3)))
+    return out
+
+
+class Image:
+    """Loaded sections of an ELF32 little-endian file, to read literals."""
+
+    def __init__(self, path):
+        with open(path, "rb") as elf:
+            data = elf.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError(f"{path}: not a little-endian ELF32 file")
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        self.sections = []
+        for index in range(shnum):
+            fields = struct.unpack_from("<IIIIIIIIII", data, shoff + index * shentsize)
+            kind, addr, offset, size = fields[1], fields[3], fields[4], fields[5]
+            if addr and kind != 8:  # SHT_NOBITS has no bytes in the file
+                self.sections.append((addr, size, data[offset:offset + size]))
+
+    def word(self, address):
+        for addr, size, body in self.sections:
+            if addr <= address and address + 4 <= addr + size:
+                return struct.unpack_from("<I", body, address - addr)[0]
+        return None
+
+
+def operands(text):
+    """Register and target of 'a8, 40378a04 <name>' (either may be missing)."""
+    parts = [part.strip() for part in text.split(",")]
+    register = parts[0] if parts and re.match(r"^a\d+$", parts[0]) else None
+    target = None
+    for part in parts:
+        match = re.match(r"^([0-9a-f]{8})\b", part)
+        if match:
+            target = int(match.group(1), 16)
+    return register, target
+
+
+def check_function(name, body, literal):
+    """Problems in one hot function; literal(address) reads a word."""
+    problems = []
+    loaded = {}
+    for address, mnemonic, text in body:
+        register, target = operands(text)
+        where = f"{name}+0x{address - body[0][0]:x}"
+        if mnemonic == "l32r" and target is not None:
+            value = literal(target)
+            if value is None:
+                problems.append(f"{where}: literal at {target:08x} not in the image")
+                continue
+            bad = region(value, FORBIDDEN)
+            if bad:
+                problems.append(f"{where}: loads {value:08x} ({bad})")
+            loaded[register] = value
+        elif mnemonic in DIRECT and target is not None:
+            if region(target, ALLOWED) is None:
+                problems.append(f"{where}: {mnemonic} {target:08x} ({region(target, FORBIDDEN) or 'not IRAM/ROM'})")
+        elif mnemonic in INDIRECT:
+            if register not in loaded:
+                problems.append(f"{where}: {mnemonic} {register} through an unknown pointer")
+            elif region(loaded[register], ALLOWED) is None:
+                problems.append(f"{where}: {mnemonic} {loaded[register]:08x} (not IRAM/ROM)")
+        elif mnemonic in ("mov", "mov.n", "or") and register is not None:
+            source = text.split(",")[1].strip() if "," in text else None
+            if source in loaded:
+                loaded[register] = loaded[source]
+            else:
+                loaded.pop(register, None)
+        elif register in loaded and not mnemonic.startswith(("s8i", "s16i", "s32i", "b")):
+            loaded.pop(register)  # Written: no longer the literal
+    return problems
+
+
+def check(hot, disassembly, literal):
+    problems = []
+    for name in sorted(hot):
+        body = disassembly.get(name)
+        if not body:
+            problems.append(f"{name}: not in .iram0.text")
+            continue
+        problems.extend(check_function(name, body, literal))
+    return problems
+
+
+def run(build_dir, objdump, elf=None):
+    objects = glob.glob(os.path.join(build_dir, "src", "**", "*.o"), recursive=True)
+    if not objects:
+        print(f"check_hot_path: no object files in {build_dir}/src")
+        return False
+    symbols = subprocess.run([objdump, "-t", "-C"] + objects, capture_output=True, text=True, check=True)
+    hot = hot_symbols(symbols.stdout.splitlines())
+    elf = elf or os.path.join(build_dir, "firmware.elf")
+    listing = subprocess.run([objdump, "-d", "-C", "-j", ".iram0.text", elf],
+                             capture_output=True, text=True, check=True)
+    image = Image(elf)
+    problems = check(hot, functions(listing.stdout.splitlines()), image.word)
+    for problem in problems:
+        print(f"check_hot_path: {problem}")
+    print(f"check_hot_path: {len(hot)} hot functions, {len(problems)} problems")
+    return not problems
+
+
+def post_link(source, target, env):
+    objdump = env.subst("$OBJCOPY").replace("objcopy", "objdump")
+    if not run(env.subst("$BUILD_DIR"), objdump, str(target[0])):
+        env.Exit(1)
+
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO post-script)
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", post_link)  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+        parser.add_argument("build_dir", help="PlatformIO build directory (.pio/build/<env>)")
+        parser.add_argument("--objdump", default="xtensa-esp32s3-elf-objdump")
+        parser.add_argument("--elf", help="linked image (default: <build_dir>/firmware.elf)")
+        args = parser.parse_args()
+        sys.exit(0 if run(args.build_dir, args.objdump, args.elf) else 1)
@@ -0,0 +1,206 @@
+// Distance event lap counter (include/distance_event.h), run on the host.
+//
+// Races are built from pace profiles a lap counter sees at club meets: an
+// even 800 m with a fast last 100, a negative-split 1500 m, a 1500 m that
+// fades, and an uneven age-group 800 m. Each length's time is the profile's
+// pace plus noise (0.25 s per length, 0.6 s for the age group), and the
+// first length is 1.5 s quicker off the dive. Every race is timed by a
+// device at each end of a 25 m pool, through the firmware's DistanceEvent.
+//
+// At every split the tool checks lengths to go and the bell lap against the
+// race. At half distance, three quarters and the bell it compares the
+// projected finish with the real one, and with two ways of doing it by
+// hand: the average lap so far, and the last lap, times the laps to go.
+//
+//   g++ -O2 -Iinclude src/distance_event.cpp tools/distance_sim.cpp -o distance_sim
+//   ./distance_sim
+//
+// Exits non-zero if a count or bell lap is wrong, if a split costs more
+// later in the race than early on (it should not grow with the lap count),
+// or if, over all profiles together, the projection is not the closest of
+// the three at three quarters. (For a steady swimmer the average lap so far
+// is hard to beat; the projection is for the ones who are not.)
+
+#include "distance_event.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const int RACES = 200;
+static const int POOL_M = 25;
+
+struct Rng {
+    uint64_t state;
+
+    uint32_t next() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (uint32_t)(state >> 33);
+    }
+
+    double uniform() { return (next() + 0.5) / 2147483648.0; }
+
+    double gauss() { return sqrt(-2.0 * log(uniform())) * cos(6.283185307179586 * uniform()); }
+};
+
+struct Profile {
+    const char* name;
+    int distanceM;
+    double startS;      // Pace per length at the start (s)
+    double endS;        // ... and at the finish, reached along the curve
+    double curve;       // 1 = linear, >1 = change comes late
+    double kickS;       // Quicker per length over the last 100 m
+    double noiseS;
+};
+
+static const Profile PROFILES[] = {
+    {"800 m even, fast finish", 800, 15.5, 15.5, 1.0, 0.6, 0.25},
+    {"1500 m negative split", 1500, 17.0, 16.0, 1.0, 0.5, 0.25},
+    {"1500 m fading", 1500, 15.8, 17.5, 2.0, 0.0, 0.25},
+    {"800 m age group", 800, 20.0, 20.5, 1.0, 0.8, 0.60},
+};
+
+// Cumulative time at the end of each length (ms)
+static std::vector<uint32_t> race(Rng& rng, const Profile& profile) {
+    int lengths = profile.distanceM / POOL_M;
+    std::vector<uint32_t> at;
+    double total = 0;
+    for (int i = 0; i < lengths; i++) {
+        double progress = lengths > 1 ? (double)i / (lengths - 1) : 0;
+        double pace = profile.startS + (profile.endS - profile.startS) * pow(progress, profile.curve);
+        if (i == 0) {
+            pace -= 1.5;
+        }
+        if (i >= lengths - 100 / POOL_M) {
+            pace -= profile.kickS;
+        }
+        total += (pace + profile.noiseS * rng.gauss()) * 1000.0;
+        at.push_back((uint32_t)total);
+    }
+    return at;
+}
+
+struct Errors {
+    double sum[3][3] = {};      // [checkpoint][method]: projection, average lap, last lap
+    int count[3] = {};
+};
+
+int main() {
+    Rng rng = {0xd15747ceULL};
+    bool ok = true;
+    uint64_t earlyNs = 0, lateNs = 0, early = 0, late = 0;
+    double threeQuarters[3] = {};
+
+    printf("%d races per profile, a device at each end of a %d m pool\n", RACES, POOL_M);
+    printf("Mean |projected - real finish| (s):\n");
+    printf("  %-26s  %-12s  %10s  %10s  %10s\n", "", "at", "projection", "avg lap", "last lap");
+
+    for (const Profile& profile : PROFILES) {
+        Errors errors;
+        uint32_t wrongCounts = 0, wrongBells = 0;
+        for (int r = 0; r < RACES; r++) {
+            std::vector<uint32_t> at = race(rng, profile);
+            int lengths = (int)at.size();
+            uint32_t finish = at.back();
+            for (int end = 0; end < 2; end++) {
+                bool startEnd = end == 0;
+                DistanceEvent counter;
+                counter.begin(profile.distanceM, POOL_M, startEnd);
+                uint32_t previous = 0;
+                uint32_t lastLap = 0;
+                bool bellSeen = false;
+                // The start end sees lengths 2, 4, ...; the turn end 1, 3, ...
+                for (int done = startEnd ? 2 : 1; done <= lengths; done += 2) {
+                    uint32_t total = at[done - 1];
+                    auto t0 = std::chrono::steady_clock::now();
+                    counter.addSplit(total);
+                    volatile uint32_t projected = counter.getProjectedFinishMs();
+                    volatile bool bell = counter.isBellLap();
+                    auto t1 = std::chrono::steady_clock::now();
+                    (void)projected;
+                    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+                    if (counter.getSplitCount() <= 4) {
+                        earlyNs += ns;
+                        early++;
+                    } else if (counter.getSplitCount() > 24) {
+                        lateNs += ns;
+                        late++;
+                    }
+
+                    int toGo = lengths - done;
+                    if (counter.getLengthsToGo() != toGo) {
+                        wrongCounts++;
+                    }
+                    if (bell != (toGo > 0 && toGo <= 2)) {
+                        wrongBells++;
+                    }
+                    bellSeen = bellSeen || bell;
+                    if (previous) {
+                        lastLap = total - previous;
+                    }
+                    previous = total;
+
+                    // Checkpoints: first split at or past half, three quarters, the bell
+                    int checkpoint = -1;
+                    if (done >= lengths / 2 && done - 2 < lengths / 2) {
+                        checkpoint = 0;
+                    } else if (done >= lengths * 3 / 4 && done - 2 < lengths * 3 / 4) {
+                        checkpoint = 1;
+                    } else if (toGo > 0 && toGo <= 2) {
+                        checkpoint = 2;
+                    }
+                    if (checkpoint >= 0 && lastLap) {
+                        // By hand: per length from the laps so far (not the dive) or the last lap
+                        int firstDone = startEnd ? 2 : 1;
+                        double averagePerLength = (double)(total - at[firstDone - 1]) / (done - firstDone);
+                        double methods[3] = {(double)counter.getProjectedFinishMs(),
+                                             total + averagePerLength * toGo, total + lastLap / 2.0 * toGo};
+                        for (int m = 0; m < 3; m++) {
+                            errors.sum[checkpoint][m] += fabs(methods[m] - finish) / 1000.0;
+                        }
+                        errors.count[checkpoint]++;
+                    }
+                }
+                if (!bellSeen && lengths > 2) {
+                    wrongBells++;
+                }
+                // At the finish end the last split is the finish
+                bool finishEnd = startEnd == (lengths % 2 == 0);
+                if (finishEnd && (!counter.isFinished() || counter.getProjectedFinishMs() != finish)) {
+                    wrongCounts++;
+                }
+            }
+        }
+
+        static const char* CHECKPOINTS[] = {"half", "3/4", "bell"};
+        for (int c = 0; c < 3; c++) {
+            double n = errors.count[c] ? errors.count[c] : 1;
+            printf("  %-26s  %-12s  %10.2f  %10.2f  %10.2f\n", c == 0 ? profile.name : "", CHECKPOINTS[c],
+                   errors.sum[c][0] / n, errors.sum[c][1] / n, errors.sum[c][2] / n);
+        }
+        if (wrongCounts || wrongBells) {
+            printf("  %u wrong counts, %u wrong bell laps\n", wrongCounts, wrongBells);
+            ok = false;
+        }
+        for (int m = 0; m < 3; m++) {
+            threeQuarters[m] += errors.sum[1][m] / (errors.count[1] ? errors.count[1] : 1);
+        }
+    }
+    printf("At 3/4, all profiles: %.2f s projection, %.2f s average lap, %.2f s last lap\n", threeQuarters[0],
+           threeQuarters[1], threeQuarters[2]);
+    if (threeQuarters[0] > threeQuarters[1] || threeQuarters[0] > threeQuarters[2]) {
+        ok = false;
+    }
+
+    double earlyAvg = (double)earlyNs / early, lateAvg = (double)lateNs / late;
+    printf("Per split, with the projection and bell: %.0f ns in splits 1-4, %.0f ns after split 24\n", earlyAvg,
+           lateAvg);
+    if (lateAvg > 2 * earlyAvg + 50) {
+        ok = false;
+    }
+
+    printf("%s\n", ok ? "OK: counts, bell laps and projections within bounds" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,610 @@
+// Micro-benchmarks for the firmware's per-frame and per-message work, on the host.
+//
+// Each benchmark runs one operation in a loop, in batches of at least 10 ms,
+// and reports the fastest batch in ns per operation:
+// - format/*    time strings (src/time_format.cpp): splits, the running and
+//               the stopped stopwatch
+// - dispatch/*  a frame from the server up to its handler: size limit, type
+//               peek and classify, subscription mask (src/ws_protocol.cpp),
+//               one per message type. With -DBENCH_ARDUINOJSON and the
+//               ArduinoJson include path also json/*, the filtered parse
+//               the firmware does next
+// - clock/*     the offset estimator (src/clock_sync.cpp): a ping/pong
+//               sample, and converting a split time with its uncertainty
+// - glyph/*     TFT_eSPI's built-in fonts 1, 2, 4, 6 and 7: one character
+//               into the framebuffer with background, and textWidth()
+// - screen/*    src/display_manager.cpp itself: each DisplayManager screen
+//               and update the firmware makes, the lap sparkline included
+// Drawing goes to the host TFT_eSPI in tools/host, a 320x170 RGB565
+// framebuffer that decodes the library's own font tables the way the
+// library does. delay() returns at once, so the splash screen is its
+// drawing alone.
+//
+// Timings are also given relative to a fixed calibration loop, so results
+// from different machines can be compared. "work" is a deterministic count
+// per operation (bytes, characters, pixels written) over a fixed pass.
+//
+//   g++ -O2 -Iinclude -Itools/host -Ilib/TFT_eSPI src/time_format.cpp src/ws_protocol.cpp
+//       src/clock_sync.cpp src/lap_sparkline.cpp src/display_manager.cpp tools/host/TFT_eSPI.cpp
+//       tools/firmware_bench.cpp -o firmware_bench
+//   ./firmware_bench --baseline tools/bench_baseline.json
+//
+// -Itools/host goes first, so its Arduino.h and TFT_eSPI.h are found
+// instead of the library's.
+//
+// Options: --json FILE writes the results, --baseline FILE compares with
+// them, --threshold PCT (default 30) is the slowdown that counts as a
+// regression, --filter TEXT runs only the benchmarks whose name contains it.
+//
+// Exits non-zero if a benchmark's relative time is more than the threshold
+// over its baseline, or its work differs from the baseline's.
+
+#include "time_format.h"
+#include "ws_protocol.h"
+#include "clock_sync.h"
+#include "display_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifdef BENCH_ARDUINOJSON
+#include <ArduinoJson.h>
+#endif
+
+// Keeps a result alive without the compiler seeing what uses it
+template <typename T>
+static inline void keep(const T& value) {
+    __asm__ __volatile__("" : : "r"(&value) : "memory");
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks: setup() puts the state back to the start, run(i) does
+// operation i and returns its work
+
+struct Bench {
+    const char* name;
+    void (*setup)();
+    uint32_t (*run)(uint32_t i);
+};
+
+static char text[64];
+
+static void noSetup() {}
+
+static uint32_t calibrate(uint32_t i) {
+    uint32_t x = i | 1;
+    for (int k = 0; k < 64; k++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+    keep(x);
+    return 0;
+}
+
+// Split and stopwatch times: one heat's worth, 0 to 20 minutes
+static uint32_t timeAt(uint32_t i) {
+    return (i * 7919u) % 1200000u;
+}
+
+static uint32_t formatSplit(uint32_t i) {
+    formatCentiseconds(timeAt(i), text, sizeof(text));
+    keep(text);
+    return strlen(text);
+}
+
+static uint32_t formatRunning(uint32_t i) {
+    formatTenths(timeAt(i), text, sizeof(text));
+    keep(text);
+    return strlen(text);
+}
+
+// Frames as the stand-in server sends them (tools/standin_server.py)
+struct Frame {
+    const char* name;
+    const char* json;
+};
+
+static const Frame FRAMES[] = {
+    {"ping", R"({"type":"ping","server_time":1700000123456})"},
+    {"pong", R"({"type":"pong","client_ping_time":4123456,"server_time":1700000123456})"},
+    {"start", R"({"type":"start","event":3,"heat":2,"timestamp":1700000123456,"distance":400,"seq":812,"epoch":17})"},
+    {"reset", R"({"type":"reset","seq":813,"epoch":17})"},
+    {"split", R"({"type":"split","device":"lane4-turn","id":17,"lane":4,"position":"turn","timestamp":1700000163456,)"
+              R"("start_timestamp":1700000123456,"sync":"locked","uncertainty_ms":3,"seq":914})"},
+    {"split_ack", R"({"type":"split-ack","device":"lane4-turn","id":17,"undo":false,"seq":915})"},
+    {"event_heat", R"({"type":"event-heat","event":3,"heat":3,"distance":400,"seq":916})"},
+    {"presence", R"({"type":"presence","lane":4,"online":true,"sync":"locked","uncertainty_ms":5,"battery":80,"seq":917})"},
+    // Type last, behind a nested array with "type" keys of its own
+    {"snapshot", R"({"seq":920,"running":true,"event":3,"heat":2,"start_timestamp":1700000123456,"splits":[)"
+                 R"({"type":"split","lane":1,"id":3,"timestamp":1700000151234},)"
+                 R"({"type":"split","lane":2,"id":4,"timestamp":1700000152345},)"
+                 R"({"type":"split","lane":3,"id":5,"timestamp":1700000153456}],"type":"snapshot"})"},
+    {"unknown", R"({"type":"scoreboard","lanes":[1,2,3,4,5,6,7,8],"seq":921})"},
+};
+static const uint8_t FRAME_COUNT = sizeof(FRAMES) / sizeof(FRAMES[0]);
+
+// A lane's subscription (main.cpp): everything but presence
+static const uint32_t LANE_TYPES = WS_TYPES_ALL & ~WS_TYPE_BIT(WS_TYPE_PRESENCE);
+
+static uint32_t dispatch(uint8_t frame) {
+    const uint8_t* payload = (const uint8_t*)FRAMES[frame].json;
+    size_t length = strlen(FRAMES[frame].json);
+    char type[WS_MAX_TYPE_LENGTH];
+    WsMessageType id;
+    if (wsScreenFrame(payload, length, type, sizeof(type), id) != WS_INGRESS_OK) {
+        return 0;
+    }
+    bool handled = LANE_TYPES & WS_TYPE_BIT(id);
+    keep(handled);
+    return length;
+}
+
+template <uint8_t FRAME>
+static uint32_t dispatchFrame(uint32_t) {
+    return dispatch(FRAME);
+}
+
+#ifdef BENCH_ARDUINOJSON
+static StaticJsonDocument<512> ingressFilter;
+
+static void filterSetup() {
+    ingressFilter.clear();
+    for (size_t i = 0; i < WS_INGRESS_FIELD_COUNT; i++) {
+        ingressFilter[WS_INGRESS_FIELDS[i]] = true;
+    }
+}
+
+template <uint8_t FRAME>
+static uint32_t parseFrame(uint32_t) {
+    // The firmware parses in place, so each run gets a fresh copy
+    static uint8_t payload[WS_MAX_FRAME_SIZE];
+    size_t length = strlen(FRAMES[FRAME].json);
+    memcpy(payload, FRAMES[FRAME].json, length);
+    StaticJsonDocument<512> doc;
+    DeserializationError error = deserializeJson(doc, payload, length,
+                                                 DeserializationOption::Filter(ingressFilter));
+    keep(doc);
+    return error ? 0 : doc.size();
+}
+#endif
+
+// Two hours of pings every 5 s: 25 ppm slow crystal, 8-60 ms round trips
+static const uint32_t SAMPLES = 1440;
+static uint32_t sampleLocal[SAMPLES];
+static uint64_t sampleServer[SAMPLES];
+static uint32_t sampleRtt[SAMPLES];
+static ClockSync clockSync;
+
+static void sampleSetup() {
+    uint32_t rng = 12345;
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        rng = rng * 1103515245u + 12345u;
+        uint32_t rtt = 8 + (rng >> 16) % 53;
+        uint32_t local = 1000 + i * 5000;
+        sampleLocal[i] = local;
+        sampleRtt[i] = rtt;
+        sampleServer[i] = 1700000000000ULL + (uint64_t)(local * (1.0 + 25e-6)) + (rng >> 8) % (rtt / 2 + 1);
+    }
+    clockSync.reset();
+}
+
+static uint32_t clockSample(uint32_t i) {
+    uint32_t k = i % SAMPLES;
+    if (k == 0) {
+        clockSync.reset();
+    }
+    clockSync.addSample(sampleLocal[k], sampleServer[k], sampleRtt[k]);
+    return 0;
+}
+
+static void syncedSetup() {
+    sampleSetup();
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        clockSync.addSample(sampleLocal[i], sampleServer[i], sampleRtt[i]);
+    }
+}
+
+// A split a little after the last sample: its server time, quality and bound
+static uint32_t clockSplit(uint32_t i) {
+    uint32_t local = sampleLocal[SAMPLES - 1] + 37 + i % 4000;
+    uint64_t server = clockSync.toServerTime(local);
+    uint32_t uncertainty = clockSync.getUncertaintyMs(local);
+    SyncQuality quality = clockSync.getQuality(local);
+    keep(server);
+    keep(uncertainty);
+    keep(quality);
+    return 0;
+}
+
+// The stopwatch digits and colon, the characters that change every frame
+static const char DIGITS[] = "0123456789:";
+
+static TFT_eSPI tft;
+static DisplayManager display;
+
+static uint64_t drawn(uint64_t before) {
+    return TFT_eSPI::pixelsWritten - before;
+}
+
+static void tftSetup() {
+    tft.setRotation(1);
+}
+
+template <uint8_t FONT>
+static uint32_t glyph(uint32_t i) {
+    uint64_t before = TFT_eSPI::pixelsWritten;
+    tft.setTextColor(TFT_GREEN, TFT_BLACK);
+    tft.drawChar(DIGITS[i % 11], 20, 20, FONT);
+    return drawn(before);
+}
+
+static uint32_t glyphWidth(uint32_t i) {
+    formatTenths(timeAt(i), text, sizeof(text));
+    int width = tft.textWidth(text, 6);
+    keep(width);
+    return strlen(text);
+}
+
+// A lane's screen in a heat, as main.cpp leaves it after the start
+static void laneSetup() {
+    display.init();
+    display.updateWiFiStatus("", true, -58);
+    display.updateWebSocketStatus("", true, 12);
+    display.updateLaneInfo(4);
+    display.updateBatteryDisplay(3.9f, 80);
+    display.setEventHeat("3", "2");
+    display.updateStopwatchDisplay(0, true);
+}
+
+static String splitLine(uint8_t split, uint32_t ms) {
+    char time[TIME_FORMAT_SIZE];
+    formatCentiseconds(ms, time, sizeof(time));
+    return "Split - " + String(split) + ": " + time;
+}
+
+// The running time, 10 times a second, with the event/heat line under it
+static uint32_t screenTick(uint32_t i) {
+    uint64_t before = TFT_eSPI::pixelsWritten;
+    display.updateStopwatchDisplay(timeAt(i), true);
+    return drawn(before);
+}
+
+static uint32_t screenLap(uint32_t i) {
+    uint64_t before = TFT_eSPI::pixelsWritten;
+    display.updateLapTime(1 + i % 2, splitLine(i % 50 + 1, timeAt(i)));
+    return drawn(before);
+}
+
+// The sidebar's ping, after each pong
+static uint32_t screenPing(uint32_t i) {
+    uint64_t before = TFT_eSPI::pixelsWritten;
+    display.updateWebSocketStatus("", true, 5 + i % 40);
+    return drawn(before);
+}
+
+// clearScreen, then the lane's running screen: sidebar, time, splits, event/heat
+static uint32_t screenRunning(uint32_t i) {
+    uint64_t before = TFT_eSPI::pixelsWritten;
+    display.clearScreen();
+    display.updateWiFiStatus("", true, -58);
+    display.updateWebSocketStatus("", true, 12);
+    display.updateLaneInfo(4);
+    display.updateBatteryDisplay(3.9f, 80);
+    display.setEventHeat("3", "2");
+    display.updateStopwatchDisplay(timeAt(i), true);
+    for (uint8_t lap = 0; lap < 3; lap++) {
+        display.updateLapTime(lap + 1, splitLine(lap + 1, timeAt(i + lap)));
+    }
+    return drawn(before);
+}
+
+static void displaySetup() {
+    display.init();
+}
+
+static uint32_t screenSplash(uint32_t) {
+    uint64_t before = TFT_eSPI::pixelsWritten;
+    display.showSplashScreen();
+    return drawn(before);
+}
+
+// The captive portal's instructions. Its title is in font 3, which the
+// device does not load either, so only the font 2 lines draw text
+static uint32_t screenConfig(uint32_t) {
+    uint64_t before = TFT_eSPI::pixelsWritten;
+    display.showConfigPortalInfo("SwimWatch-1A2B", "swim1234");
+    return drawn(before);
+}
+
+// The starter's lane roster: every cell after a refresh, or one lane's
+// state or battery changing
+static uint8_t gridLanes[READINESS_CELLS];
+static LaneState gridStates[READINESS_CELLS];
+static uint8_t gridBattery[READINESS_CELLS];
+
+static void gridSetup() {
+    display.init();
+    for (uint8_t k = 0; k < READINESS_CELLS; k++) {
+        gridLanes[k] = k + 1;
+        gridStates[k] = LANE_READY;
+        gridBattery[k] = k == 7 ? LaneReadiness::BATTERY_UNKNOWN : 90 - k;
+    }
+    display.updateReadinessGrid(gridLanes, gridStates, gridBattery, READINESS_CELLS);
+}
+
+static uint32_t screenGrid(uint32_t i) {
+    uint64_t before = TFT_eSPI::pixelsWritten;
+    for (uint8_t k = 0; k < READINESS_CELLS; k++) {
+        gridStates[k] = (LaneState)((i + k) % 4);
+        gridBattery[k] = (uint8_t)((i * 7 + k * 13) % 101);
+    }
+    display.forceRefresh();
+    display.updateReadinessGrid(gridLanes, gridStates, gridBattery, READINESS_CELLS);
+    return drawn(before);
+}
+
+static uint32_t screenGridCell(uint32_t i) {
+    uint64_t before = TFT_eSPI::pixelsWritten;
+    uint8_t k = i % READINESS_CELLS;
+    gridStates[k] = (LaneState)((gridStates[k] + 1) % 4);
+    display.updateReadinessGrid(gridLanes, gridStates, gridBattery, READINESS_CELLS);
+    return drawn(before);
+}
+
+// The lap sparkline on a new lap, over a 1500 m (60 laps), then a new heat
+struct Lap {
+    uint32_t lapTimeMs;
+};
+static Lap sparkLaps[60];
+
+static void sparkSetup() {
+    display.init();
+    for (uint8_t i = 0; i < 60; i++) {
+        sparkLaps[i].lapTimeMs = i == 0 ? 14000 : 17000 + (i * 37) % 600 + (i == 40 ? 17000 : 0);
+    }
+}
+
+static uint32_t screenSparkline(uint32_t i) {
+    uint64_t before = TFT_eSPI::pixelsWritten;
+    display.updateLapSparkline(sparkLaps, (uint8_t)(i % 61));
+    return drawn(before);
+}
+
+static const Bench BENCHES[] = {
+    {"calibration", noSetup, calibrate},
+    {"format/centiseconds", noSetup, formatSplit},
+    {"format/tenths", noSetup, formatRunning},
+    {"dispatch/ping", noSetup, dispatchFrame<0>},
+    {"dispatch/pong", noSetup, dispatchFrame<1>},
+    {"dispatch/start", noSetup, dispatchFrame<2>},
+    {"dispatch/reset", noSetup, dispatchFrame<3>},
+    {"dispatch/split", noSetup, dispatchFrame<4>},
+    {"dispatch/split_ack", noSetup, dispatchFrame<5>},
+    {"dispatch/event_heat", noSetup, dispatchFrame<6>},
+    {"dispatch/presence", noSetup, dispatchFrame<7>},
+    {"dispatch/snapshot", noSetup, dispatchFrame<8>},
+    {"dispatch/unknown", noSetup, dispatchFrame<9>},
+#ifdef BENCH_ARDUINOJSON
+    {"json/pong", filterSetup, parseFrame<1>},
+    {"json/start", filterSetup, parseFrame<2>},
+    {"json/split", filterSetup, parseFrame<4>},
+    {"json/split_ack", filterSetup, parseFrame<5>},
+    {"json/presence", filterSetup, parseFrame<7>},
+    {"json/snapshot", filterSetup, parseFrame<8>},
+#endif
+    {"clock/sample", sampleSetup, clockSample},
+    {"clock/split_time", syncedSetup, clockSplit},
+    {"glyph/font1", tftSetup, glyph<1>},
+    {"glyph/font2", tftSetup, glyph<2>},
+    {"glyph/font4", tftSetup, glyph<4>},
+    {"glyph/font6", tftSetup, glyph<6>},
+    {"glyph/font7", tftSetup, glyph<7>},
+    {"glyph/text_width", noSetup, glyphWidth},
+    {"screen/stopwatch_tick", laneSetup, screenTick},
+    {"screen/lap_line", laneSetup, screenLap},
+    {"screen/ping", laneSetup, screenPing},
+    {"screen/running", laneSetup, screenRunning},
+    {"screen/splash", displaySetup, screenSplash},
+    {"screen/config_portal", displaySetup, screenConfig},
+    {"screen/readiness_grid", gridSetup, screenGrid},
+    {"screen/readiness_cell", gridSetup, screenGridCell},
+    {"screen/sparkline_lap", sparkSetup, screenSparkline},
+};
+static const size_t BENCH_COUNT = sizeof(BENCHES) / sizeof(BENCHES[0]);
+
+// ---------------------------------------------------------------------------
+
+struct Result {
+    std::string name;
+    double ns;
+    double relative;
+    double work;
+};
+
+static const uint32_t WORK_PASS = 1024;
+static const int ROUNDS = 3;
+static const int BATCHES = 5;
+static const int RETRIES = 2;
+static const double MIN_BATCH_NS = 10e6;
+
+static double timeBatch(const Bench& bench, uint32_t iterations) {
+    bench.setup();
+    uint64_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        sink += bench.run(i);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    keep(sink);
+    return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+static uint32_t batchSize(const Bench& bench) {
+    uint32_t iterations = 256;
+    while (timeBatch(bench, iterations) < MIN_BATCH_NS && iterations < (1u << 28)) {
+        iterations *= 2;
+    }
+    return iterations;
+}
+
+// Batches of the benchmark alternate with batches of the calibration loop,
+// so a clock change during the run moves both. The fastest batch of each
+// round counts, and the median of the rounds is the result
+static Result measure(const Bench& bench, const Bench& calibration, uint32_t calibrationSize) {
+    uint32_t iterations = batchSize(bench);
+    Result rounds[ROUNDS];
+    for (int round = 0; round < ROUNDS; round++) {
+        double best = 0, bestCalibration = 0;
+        for (int b = 0; b < BATCHES; b++) {
+            double ns = timeBatch(bench, iterations) / iterations;
+            double calibrationNs = timeBatch(calibration, calibrationSize) / calibrationSize;
+            best = b == 0 || ns < best ? ns : best;
+            bestCalibration = b == 0 || calibrationNs < bestCalibration ? calibrationNs : bestCalibration;
+        }
+        rounds[round] = {bench.name, best, best / bestCalibration, 0};
+    }
+    std::sort(rounds, rounds + ROUNDS, [](const Result& a, const Result& b) { return a.relative < b.relative; });
+    Result result = rounds[ROUNDS / 2];
+
+    bench.setup();
+    uint64_t work = 0;
+    for (uint32_t i = 0; i < WORK_PASS; i++) {
+        work += bench.run(i);
+    }
+    result.work = (double)work / WORK_PASS;
+    return result;
+}
+
+struct Baseline {
+    std::string name;
+    double relative;
+    double work;
+};
+
+// Reads back a file this tool wrote: one benchmark per line
+static bool readBaseline(const char* path, std::vector<Baseline>& out) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        const char* name = strstr(line, "\"name\": \"");
+        const char* relative = strstr(line, "\"relative\": ");
+        const char* work = strstr(line, "\"work\": ");
+        if (!name || !relative || !work) {
+            continue;
+        }
+        name += 9;
+        const char* end = strchr(name, '"');
+        if (!end) {
+            continue;
+        }
+        out.push_back({std::string(name, end - name), atof(relative + 12), atof(work + 8)});
+    }
+    fclose(file);
+    return true;
+}
+
+static bool writeJson(const char* path, double calibrationNs, const std::vector<Result>& results) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "{\n  \"tool\": \"firmware_bench\",\n  \"calibration_ns\": %.3f,\n  \"benchmarks\": [\n", calibrationNs);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"ns\": %.2f, \"relative\": %.4f, \"work\": %.4f}%s\n", r.name.c_str(),
+                r.ns, r.relative, r.work, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    const char* filter = nullptr;
+    double threshold = 30;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+            jsonPath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--baseline") == 0) {
+            baselinePath = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--threshold") == 0) {
+            threshold = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--filter") == 0) {
+            filter = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--json FILE] [--baseline FILE] [--threshold PCT] [--filter TEXT]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Baseline> baseline;
+    if (baselinePath && !readBaseline(baselinePath, baseline)) {
+        fprintf(stderr, "Cannot read %s\n", baselinePath);
+        return 2;
+    }
+
+    uint32_t calibrationSize = batchSize(BENCHES[0]);
+    Result calibration = measure(BENCHES[0], BENCHES[0], calibrationSize);
+    std::vector<Result> results = {calibration};
+    printf("  %-24s  %10s  %9s  %9s  %s\n", "", "ns/op", "relative", "work", baselinePath ? "vs baseline" : "");
+    printf("  %-24s  %10.1f  %9.3f  %9.1f\n", calibration.name.c_str(), calibration.ns, 1.0, 0.0);
+    int regressions = 0;
+    for (size_t b = 1; b < BENCH_COUNT; b++) {
+        if (filter && !strstr(BENCHES[b].name, filter)) {
+            continue;
+        }
+        Result r = measure(BENCHES[b], BENCHES[0], calibrationSize);
+        const Baseline* base = nullptr;
+        for (const Baseline& candidate : baseline) {
+            if (candidate.name == r.name) {
+                base = &candidate;
+            }
+        }
+        // A slow run is measured again before it counts: one busy moment on the
+        // machine should not fail the comparison
+        for (int retry = 0; base && retry < RETRIES && r.relative > base->relative * (1 + threshold / 100); retry++) {
+            Result again = measure(BENCHES[b], BENCHES[0], calibrationSize);
+            r = again.relative < r.relative ? again : r;
+        }
+        results.push_back(r);
+
+        printf("  %-24s  %10.1f  %9.3f  %9.1f", r.name.c_str(), r.ns, r.relative, r.work);
+        if (baselinePath && !base) {
+            printf("  (no baseline)");
+        } else if (base) {
+            double change = 100.0 * (r.relative / base->relative - 1);
+            printf("  %+6.1f%%", change);
+            if (fabs(r.work - base->work) > 0.0005) { // One unit more in the pass is 0.001
+                printf("  WORK CHANGED (was %.1f)", base->work);
+                regressions++;
+            } else if (change > threshold) {
+                printf("  REGRESSION");
+                regressions++;
+            } else if (change < -threshold) {
+                printf("  faster: refresh the baseline");
+            }
+        }
+        printf("\n");
+    }
+
+    if (jsonPath && !writeJson(jsonPath, calibration.ns, results)) {
+        fprintf(stderr, "Cannot write %s\n", jsonPath);
+        return 2;
+    }
+    if (baselinePath) {
+        printf("%s\n", regressions ? "FAIL: slower than the baseline, or different work" : "OK: within the baseline");
+    }
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+// Holdover simulation for ClockSync (include/clock_sync.h), run on the host.
+//
+// A device with a known crystal error syncs against a server over a link
+// with jittery, asymmetric round trips, then loses the link for ten minutes.
+// For each crystal error the tool reports the final time error with drift
+// correction, the error the old frozen-offset behaviour would have had, and
+// the uncertainty the device would have tagged its split with.
+//
+// A second table covers reboots and deep sleep: the estimate is captured at
+// the last pong, the device is off for a while, and the tool reports how
+// long after boot the time is known to within 25 ms and 10 ms, with and
+// without the retained state (src/sync_retention.cpp), averaged over links.
+//
+//   g++ -O2 -Iinclude src/clock_sync.cpp tools/holdover_sim.cpp -o holdover_sim
+//   ./holdover_sim
+//
+// Exits non-zero if any error exceeds the reported uncertainty.
+
+#include "clock_sync.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const uint32_t PING_INTERVAL_MS = 5000;
+static const uint32_t OUTAGE_MS = 10 * 60 * 1000;
+static const uint64_t SERVER_EPOCH_MS = 1700000000000ULL;
+
+// Reboot model: Wi-Fi association plus TLS handshake before the first ping,
+// and an RTC slow clock that is off by RTC_PPM (bounded as in sync_retention.h)
+static const uint32_t CONNECT_MS = 3000;
+static const double RTC_PPM = 300.0;
+static const float GAP_BOUND_PPM = 500.0f;
+static const uint32_t TARGETS_MS[] = {25, 10};
+static const uint32_t WATCH_MS = 60000;
+static const int REBOOT_RUNS = 200;
+
+struct Link {
+    uint32_t state;
+
+    // Deterministic uniform [0, 1)
+    double next() {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / 16777216.0;
+    }
+};
+
+struct Device {
+    double ppm;         // Crystal error: positive runs fast
+    double bootMs;      // Real time at boot
+
+    uint32_t millisAt(double realMs) const {
+        return (uint32_t)((realMs - bootMs) * (1.0 + ppm * 1e-6));
+    }
+};
+
+// One ping/pong at real time t: the server stamps its reply somewhere inside the round trip
+static void exchange(ClockSync& sync, const Device& device, Link& link, double t) {
+    double rtt = 8.0 + link.next() * 30.0;
+    if (link.next() < 0.1) {
+        rtt += 150.0; // Occasional retransmit
+    }
+    double serverStamp = t + rtt * (0.3 + 0.4 * link.next());
+    uint32_t sent = device.millisAt(t);
+    uint32_t received = device.millisAt(t + rtt);
+    sync.addSample(received, SERVER_EPOCH_MS + (uint64_t)serverStamp, received - sent);
+}
+
+struct Result {
+    double errorMs;
+    double frozenErrorMs;
+    uint32_t uncertaintyMs;
+    SyncQuality quality;
+    float fittedPpm;
+};
+
+// lockedMs of pings, then the outage; storedPpm is NAN for an uncalibrated boot
+static Result run(double ppm, uint32_t lockedMs, float storedPpm, uint32_t seed) {
+    ClockSync sync;
+    if (!isnan(storedPpm)) {
+        sync.setCalibration(storedPpm);
+    }
+    Device device = {ppm, 1000.0};
+    Link link = {seed};
+
+    double t = device.bootMs + 2000.0;
+    double end = t + lockedMs;
+    for (; t < end; t += PING_INTERVAL_MS) {
+        exchange(sync, device, link, t);
+    }
+
+    // Offset as it stood when the link dropped, without drift correction
+    int64_t frozenOffset = sync.getOffsetMs(device.millisAt(t));
+    sync.setLinkUp(false);
+    t += OUTAGE_MS;
+
+    uint32_t local = device.millisAt(t);
+    double truth = (double)SERVER_EPOCH_MS + t;
+    Result result;
+    result.errorMs = (double)sync.toServerTime(local) - truth;
+    result.frozenErrorMs = (double)((int64_t)local + frozenOffset) - truth;
+    result.uncertaintyMs = sync.getUncertaintyMs(local);
+    result.quality = sync.getQuality(local);
+    result.fittedPpm = sync.getDriftPpm();
+    return result;
+}
+
+struct RebootResult {
+    uint32_t boundAtBoot;       // UNKNOWN_UNCERTAINTY without a prior
+    double accurateAfterMs[2];  // Time after boot until the bound is within each target (WATCH_MS: never)
+    double worstRatio;          // Largest error / bound seen after boot
+};
+
+static RebootResult runReboot(bool retain, uint32_t gapMs, uint32_t seed) {
+    // First session: long enough to learn the drift, captured after the last pong
+    ClockSync before;
+    Device device = {20.0, 1000.0};
+    Link link = {seed};
+    double t = device.bootMs + 2000.0;
+    double end = t + 30 * 60 * 1000;
+    for (; t < end; t += PING_INTERVAL_MS) {
+        exchange(before, device, link, t);
+    }
+    ClockSync::Prior prior;
+    before.capture(device.millisAt(t), prior);
+
+    // millis() restarts from zero; the RTC timer measures the gap
+    Device rebooted = {device.ppm, t + gapMs};
+    ClockSync after;
+    if (retain) {
+        after.restore(prior, 0, (uint32_t)(gapMs * (1.0 + RTC_PPM * 1e-6)), GAP_BOUND_PPM);
+    }
+
+    RebootResult result = {after.getUncertaintyMs(0), {WATCH_MS, WATCH_MS}, 0.0};
+    double nextPing = rebooted.bootMs + CONNECT_MS;
+    int pings = 0;
+    for (double now = rebooted.bootMs; now < rebooted.bootMs + WATCH_MS; now += 100.0) {
+        if (now >= nextPing) {
+            exchange(after, rebooted, link, now);
+            nextPing += ++pings < 5 ? 500 : PING_INTERVAL_MS; // Initial rapid burst
+        }
+        uint32_t local = rebooted.millisAt(now);
+        uint32_t bound = after.getUncertaintyMs(local);
+        if (bound == ClockSync::UNKNOWN_UNCERTAINTY) {
+            continue;
+        }
+        double error = fabs((double)after.toServerTime(local) - ((double)SERVER_EPOCH_MS + now));
+        result.worstRatio = fmax(result.worstRatio, error / bound);
+        for (int i = 0; i < 2; i++) {
+            if (result.accurateAfterMs[i] == WATCH_MS && bound <= TARGETS_MS[i]) {
+                result.accurateAfterMs[i] = now - rebooted.bootMs;
+            }
+        }
+    }
+    return result;
+}
+
+int main() {
+    static const double PPMS[] = {-40.0, -20.0, -5.0, 0.0, 5.0, 20.0, 40.0};
+    struct Case {
+        const char* name;
+        uint32_t lockedMs;
+        bool stored;
+    };
+    static const Case CASES[] = {
+        {"30 min locked, learned", 30 * 60 * 1000, false},
+        {"2 min locked, stored calibration", 2 * 60 * 1000, true},
+        {"2 min locked, uncalibrated", 2 * 60 * 1000, false},
+    };
+
+    bool bounded = true;
+    for (const Case& c : CASES) {
+        printf("%s, then %u min outage\n", c.name, (unsigned)(OUTAGE_MS / 60000));
+        printf("  crystal ppm  fitted ppm  error ms  frozen ms  uncertainty ms  quality\n");
+        for (double ppm : PPMS) {
+            // A stored calibration is the previous session's estimate, off by a little
+            float stored = c.stored ? (float)(-ppm + 0.8) : NAN;
+            Result r = run(ppm, c.lockedMs, stored, 12345u + (uint32_t)(ppm * 10 + 1000));
+            bool ok = fabs(r.errorMs) <= r.uncertaintyMs;
+            bounded = bounded && ok;
+            printf("  %11.1f  %10.2f  %8.1f  %9.1f  %14u  %s%s\n", ppm, r.fittedPpm, r.errorMs,
+                   r.frozenErrorMs, (unsigned)r.uncertaintyMs, ClockSync::qualityName(r.quality),
+                   ok ? "" : "  OUT OF BOUND");
+        }
+        printf("\n");
+    }
+
+    static const uint32_t GAPS[] = {5000, 60000, 10 * 60 * 1000};
+    printf("Reboot / deep sleep, first ping %u ms after boot, mean of %d links\n",
+           (unsigned)CONNECT_MS, REBOOT_RUNS);
+    printf("  gap s  retained  bound at boot ms  within %u ms after  within %u ms after  worst error/bound\n",
+           (unsigned)TARGETS_MS[0], (unsigned)TARGETS_MS[1]);
+    for (uint32_t gap : GAPS) {
+        for (int retain = 0; retain < 2; retain++) {
+            double after[2] = {0, 0};
+            double boundAtBoot = 0, worst = 0;
+            for (int run = 0; run < REBOOT_RUNS; run++) {
+                RebootResult r = runReboot(retain != 0, gap, 777u + gap + run * 7919u);
+                after[0] += r.accurateAfterMs[0] / REBOOT_RUNS;
+                after[1] += r.accurateAfterMs[1] / REBOOT_RUNS;
+                boundAtBoot += (double)r.boundAtBoot / REBOOT_RUNS;
+                worst = fmax(worst, r.worstRatio);
+            }
+            bool ok = worst <= 1.0;
+            bounded = bounded && ok;
+            char boundText[16];
+            if (!retain) {
+                snprintf(boundText, sizeof(boundText), "unknown");
+            } else {
+                snprintf(boundText, sizeof(boundText), "%.0f", boundAtBoot);
+            }
+            printf("  %5u  %8s  %16s  %15.0f ms  %15.0f ms  %17.2f%s\n", (unsigned)(gap / 1000),
+                   retain ? "yes" : "no", boundText, after[0], after[1], worst, ok ? "" : "  OUT OF BOUND");
+        }
+    }
+    return bounded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+// Host stand-in for the parts of the Arduino core the display code uses:
+// String, Serial and delay(). Lets src/display_manager.cpp build on the
+// host (see tools/firmware_bench.cpp).
+//
+// String keeps Arduino's interface (numbers format in base 10, length() is
+// unsigned, indexOf returns -1 when not found) on top of std::string.
+// Serial prints nothing and delay() returns at once, so a benchmark times
+// the drawing alone.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+class String {
+public:
+    String(const char* text = "") : text(text ? text : "") {}
+    explicit String(char c) : text(1, c) {}
+    explicit String(unsigned char value) : text(std::to_string(value)) {}
+    explicit String(int value) : text(std::to_string(value)) {}
+    explicit String(unsigned int value) : text(std::to_string(value)) {}
+    explicit String(long value) : text(std::to_string(value)) {}
+    explicit String(unsigned long value) : text(std::to_string(value)) {}
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    bool isEmpty() const { return text.empty(); }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t at = text.find(c, from);
+        return at == std::string::npos ? -1 : (int)at;
+    }
+
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) {
+            unsigned int swap = from;
+            from = to;
+            to = swap;
+        }
+        if (from >= length()) {
+            return String();
+        }
+        return String(text.substr(from, to - from).c_str());
+    }
+
+    String& operator+=(const String& other) {
+        text += other.text;
+        return *this;
+    }
+    String& operator+=(const char* other) {
+        text += other ? other : "";
+        return *this;
+    }
+
+    bool operator==(const String& other) const { return text == other.text; }
+    bool operator!=(const String& other) const { return text != other.text; }
+    bool operator==(const char* other) const { return text == (other ? other : ""); }
+    bool operator!=(const char* other) const { return !(*this == other); }
+
+private:
+    std::string text;
+};
+
+inline String operator+(const String& a, const String& b) {
+    String sum(a);
+    sum += b;
+    return sum;
+}
+
+inline String operator+(const String& a, const char* b) {
+    String sum(a);
+    sum += b;
+    return sum;
+}
+
+inline String operator+(const char* a, const String& b) {
+    String sum(a);
+    sum += b;
+    return sum;
+}
+
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    void print(const char*) {}
+    void print(const String&) {}
+    void println(const char* = "") {}
+    void println(const String&) {}
+    void printf(const char*, ...) {}
+};
+
+inline HostSerial Serial;
+
+inline void delay(uint32_t) {}
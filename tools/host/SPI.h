@@ -0,0 +1,4 @@
+#pragma once
+
+// Host stand-in: the display code includes SPI.h, but only TFT_eSPI
+// (tools/host/TFT_eSPI.h) talks to the panel.
@@ -0,0 +1,259 @@
+#include "TFT_eSPI.h"
+
+#include <algorithm>
+#include <string.h>
+
+// The library's font tables, as the device links them
+#define PROGMEM
+#include <Fonts/glcdfont.c>
+#include <Fonts/Font16.h>
+#include <Fonts/Font32rle.h>
+#include <Fonts/Font64rle.h>
+#include <Fonts/Font7srle.h>
+
+namespace {
+
+struct FontInfo {
+    const unsigned char* const* chars;
+    const unsigned char* widths;
+    uint8_t height;
+    uint8_t baseline;
+};
+
+// Indexed by font number, as TFT_eSPI's fontdata (3, 5 and 8 not loaded)
+const FontInfo FONTS[9] = {
+    {nullptr, nullptr, 0, 0},
+    {nullptr, nullptr, 8, 7},
+    {chrtbl_f16, widtbl_f16, chr_hgt_f16, baseline_f16},
+    {nullptr, nullptr, 0, 0},
+    {chrtbl_f32, widtbl_f32, chr_hgt_f32, baseline_f32},
+    {nullptr, nullptr, 0, 0},
+    {chrtbl_f64, widtbl_f64, chr_hgt_f64, baseline_f64},
+    {chrtbl_f7s, widtbl_f7s, chr_hgt_f7s, baseline_f7s},
+    {nullptr, nullptr, 0, 0},
+};
+
+} // namespace
+
+uint64_t TFT_eSPI::pixelsWritten = 0;
+
+TFT_eSPI::TFT_eSPI()
+    : screenWidth(TFT_WIDTH)
+    , screenHeight(TFT_HEIGHT)
+    , textFont(1)
+    , textDatum(TL_DATUM)
+    , textColor(TFT_WHITE)
+    , textBackground(TFT_WHITE)
+    , windowX(0)
+    , windowW(1)
+    , windowEnd(0)
+    , col(0)
+    , row(0) {
+    memset(pixels, 0, sizeof(pixels));
+}
+
+void TFT_eSPI::setRotation(uint8_t rotation) {
+    bool landscape = rotation & 1;
+    screenWidth = landscape ? TFT_HEIGHT : TFT_WIDTH;
+    screenHeight = landscape ? TFT_WIDTH : TFT_HEIGHT;
+}
+
+uint16_t TFT_eSPI::pixel(int32_t x, int32_t y) const {
+    if (x < 0 || y < 0 || x >= screenWidth || y >= screenHeight) {
+        return 0;
+    }
+    return pixels[y * screenWidth + x];
+}
+
+void TFT_eSPI::fillScreen(uint32_t color) {
+    fillRect(0, 0, screenWidth, screenHeight, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    int32_t x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+    int32_t x1 = x + w > screenWidth ? screenWidth : x + w;
+    int32_t y1 = y + h > screenHeight ? screenHeight : y + h;
+    if (x1 <= x0 || y1 <= y0) {
+        return;
+    }
+    for (int32_t r = y0; r < y1; r++) {
+        std::fill_n(pixels + r * screenWidth + x0, x1 - x0, (uint16_t)color);
+    }
+    pixelsWritten += (uint64_t)(x1 - x0) * (y1 - y0);
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+    fillRect(x, y + r, w, h - r - r, color);
+    fillCircleHelper(x + r, y + h - r - 1, r, 1, w - r - r - 1, color);
+    fillCircleHelper(x + r, y + r, r, 2, w - r - r - 1, color);
+}
+
+void TFT_eSPI::fillCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t corner, int32_t delta, uint32_t color) {
+    int32_t f = 1 - r;
+    int32_t ddF_x = 1;
+    int32_t ddF_y = -r - r;
+    int32_t y = 0;
+
+    delta++;
+    while (y < r) {
+        if (f >= 0) {
+            if (corner & 0x1) drawFastHLine(x0 - y, y0 + r, y + y + delta, color);
+            if (corner & 0x2) drawFastHLine(x0 - y, y0 - r, y + y + delta, color);
+            r--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        y++;
+        ddF_x += 2;
+        f += ddF_x;
+        if (corner & 0x1) drawFastHLine(x0 - r, y0 + y, r + r + delta, color);
+        if (corner & 0x2) drawFastHLine(x0 - r, y0 - y, r + r + delta, color);
+    }
+}
+
+int16_t TFT_eSPI::textWidth(const char* text, uint8_t font) const {
+    if (font == 1) {
+        return 6 * strlen(text);
+    }
+    const unsigned char* widths = font < 9 ? FONTS[font].widths : nullptr;
+    if (!widths) {
+        return 0;
+    }
+    int16_t width = 0;
+    for (; *text; text++) {
+        uint8_t c = *text;
+        width += widths[c > 31 && c < 128 ? c - 32 : 0]; // Anything else is a space
+    }
+    return width;
+}
+
+int16_t TFT_eSPI::fontHeight(uint8_t font) const {
+    return font < 9 ? FONTS[font].height : 0;
+}
+
+int16_t TFT_eSPI::drawString(const char* text, int32_t x, int32_t y, uint8_t font) {
+    int32_t width = textWidth(text, font);
+    int32_t height = font == 1 ? 8 : fontHeight(font);
+    int32_t baseline = font == 1 ? 0 : (font < 9 ? FONTS[font].baseline : 0);
+
+    switch (textDatum) {
+        case TC_DATUM: x -= width / 2; break;
+        case TR_DATUM: x -= width; break;
+        case ML_DATUM: y -= height / 2; break;
+        case MC_DATUM: x -= width / 2; y -= height / 2; break;
+        case MR_DATUM: x -= width; y -= height / 2; break;
+        case BL_DATUM: y -= height; break;
+        case BC_DATUM: x -= width / 2; y -= height; break;
+        case BR_DATUM: x -= width; y -= height; break;
+        case L_BASELINE: y -= baseline; break;
+        case C_BASELINE: x -= width / 2; y -= baseline; break;
+        case R_BASELINE: x -= width; y -= baseline; break;
+    }
+
+    int16_t sum = 0;
+    for (; *text; text++) {
+        sum += drawChar((uint8_t)*text, x + sum, y, font);
+    }
+    return sum;
+}
+
+int16_t TFT_eSPI::drawChar(uint16_t c, int32_t x, int32_t y, uint8_t font) {
+    if (!c) {
+        return 0;
+    }
+    if (font == 1) {
+        if (c >= 32) {
+            drawGlcd(c, x, y);
+        }
+        return 6;
+    }
+    if (font > 8 || c < 32 || c > 127 || !FONTS[font].chars) {
+        return 0;
+    }
+
+    const unsigned char* data = FONTS[font].chars[c - 32];
+    int32_t width = FONTS[font].widths[c - 32];
+    int32_t height = FONTS[font].height;
+    bool fill = textColor != textBackground;
+    setWindow(x, y, width, height);
+    if (font == 2) {
+        int32_t bytes = (width + 6) / 8;
+        for (int32_t i = 0; i < height; i++) {
+            int32_t left = width;
+            for (int32_t k = 0; k < bytes; k++) {
+                uint8_t line = data[bytes * i + k];
+                for (uint8_t mask = 0x80; mask && left; mask >>= 1, left--) {
+                    if (line & mask) {
+                        push(textColor);
+                    } else if (fill) {
+                        push(textBackground);
+                    } else {
+                        skip();
+                    }
+                }
+            }
+            if (left) {
+                fill ? push(textBackground) : skip();
+            }
+        }
+    } else {
+        // Run-length: bit 7 set is a run of foreground, the rest its length - 1
+        for (int32_t left = width * height; left > 0;) {
+            uint8_t line = *data++;
+            uint8_t run = (line & 0x7F) + 1;
+            bool foreground = line & 0x80;
+            for (uint8_t k = 0; k < run; k++) {
+                if (foreground) {
+                    push(textColor);
+                } else if (fill) {
+                    push(textBackground);
+                } else {
+                    skip();
+                }
+            }
+            left -= run;
+        }
+    }
+    return width;
+}
+
+void TFT_eSPI::drawGlcd(uint16_t c, int32_t x, int32_t y) {
+    bool fill = textColor != textBackground;
+    setWindow(x, y, 6, 8);
+    const unsigned char* column = font + c * 5;
+    for (uint8_t mask = 1; mask; mask <<= 1) {
+        for (int k = 0; k < 5; k++) {
+            if (column[k] & mask) {
+                push(textColor);
+            } else if (fill) {
+                push(textBackground);
+            } else {
+                skip();
+            }
+        }
+        fill ? push(textBackground) : skip();
+    }
+}
+
+void TFT_eSPI::setWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+    windowX = x;
+    windowW = w > 0 ? w : 1;
+    windowEnd = y + h;
+    col = x;
+    row = y;
+}
+
+void TFT_eSPI::push(uint16_t color) {
+    if (row < windowEnd && col >= 0 && col < screenWidth && row >= 0 && row < screenHeight) {
+        pixels[row * screenWidth + col] = color;
+        pixelsWritten++;
+    }
+    skip();
+}
+
+void TFT_eSPI::skip() {
+    if (++col == windowX + windowW) {
+        col = windowX;
+        row++;
+    }
+}
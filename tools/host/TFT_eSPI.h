@@ -0,0 +1,109 @@
+#pragma once
+
+// Host stand-in for the TFT_eSPI calls the display code makes, drawing into
+// an RGB565 framebuffer instead of the T-Display S3's ST7789 panel. Lets
+// src/display_manager.cpp build on the host (see tools/firmware_bench.cpp);
+// put -Itools/host before -Ilib/TFT_eSPI so this header is the one found.
+//
+// Text goes through the library's own font tables (lib/TFT_eSPI/Fonts) the
+// way TFT_eSPI draws them with textsize 1: the GLCD font 1 and the bitmap
+// font 2 a pixel at a time into the glyph's window, the RLE fonts 4, 6 and
+// 7 in runs, and with fg == bg only the foreground pixels. Fonts 3, 5 and 8
+// are not loaded on the device either, so they draw nothing. Datums and
+// fillRoundRect's corners follow lib/TFT_eSPI/TFT_eSPI.cpp.
+//
+// pixelsWritten counts every pixel stored, over all instances, as a
+// measure of the work a screen update does.
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#define TFT_WIDTH 170
+#define TFT_HEIGHT 320
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define CL_DATUM 3
+#define MC_DATUM 4
+#define CC_DATUM 4
+#define MR_DATUM 5
+#define CR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+#define L_BASELINE 9
+#define C_BASELINE 10
+#define R_BASELINE 11
+
+#define TFT_BLACK 0x0000
+#define TFT_DARKGREY 0x7BEF
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+
+class TFT_eSPI {
+public:
+    TFT_eSPI();
+
+    void init() {}
+    void setRotation(uint8_t rotation);
+    void writecommand(uint8_t) {}
+    int16_t width() const { return screenWidth; }
+    int16_t height() const { return screenHeight; }
+
+    void fillScreen(uint32_t color);
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { fillRect(x, y, w, 1, color); }
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { fillRect(x, y, 1, h, color); }
+
+    void setTextFont(uint8_t font) { textFont = font; }
+    void setTextColor(uint16_t color) { textColor = textBackground = color; }
+    void setTextColor(uint16_t color, uint16_t background) {
+        textColor = color;
+        textBackground = background;
+    }
+    void setTextDatum(uint8_t datum) { textDatum = datum; }
+
+    int16_t textWidth(const char* text, uint8_t font) const;
+    int16_t textWidth(const char* text) const { return textWidth(text, textFont); }
+    int16_t textWidth(const String& text) const { return textWidth(text.c_str(), textFont); }
+    int16_t fontHeight(uint8_t font) const;
+    int16_t fontHeight() const { return fontHeight(textFont); }
+
+    int16_t drawChar(uint16_t c, int32_t x, int32_t y, uint8_t font);
+    int16_t drawChar(uint16_t c, int32_t x, int32_t y) { return drawChar(c, x, y, textFont); }
+    int16_t drawString(const char* text, int32_t x, int32_t y, uint8_t font);
+    int16_t drawString(const char* text, int32_t x, int32_t y) { return drawString(text, x, y, textFont); }
+    int16_t drawString(const String& text, int32_t x, int32_t y) { return drawString(text.c_str(), x, y, textFont); }
+
+    // Host only
+    uint16_t pixel(int32_t x, int32_t y) const;
+    static uint64_t pixelsWritten;
+
+private:
+    uint16_t pixels[TFT_WIDTH * TFT_HEIGHT];
+    int16_t screenWidth;
+    int16_t screenHeight;
+
+    uint8_t textFont;
+    uint8_t textDatum;
+    uint16_t textColor;
+    uint16_t textBackground;
+
+    // Window being filled row by row, as the panel's address window
+    int32_t windowX, windowW, windowEnd;
+    int32_t col, row;
+
+    void setWindow(int32_t x, int32_t y, int32_t w, int32_t h);
+    void push(uint16_t color);
+    void skip();
+    void drawGlcd(uint16_t c, int32_t x, int32_t y);
+    void fillCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t corner, int32_t delta, uint32_t color);
+};
@@ -0,0 +1,301 @@
+// Split journal simulation (include/split_journal.h), run on the host.
+//
+// A lane device records a split every 1-3 s, and a fifth of them are false
+// touches that it undoes 0.2-6 s later. Splits and tombstones go to a
+// server over a link that loses, duplicates and delays messages. The delay
+// can exceed the 2 s retransmit interval, so copies overtake each other:
+// a retransmitted split often reaches the server after the undo that
+// retracted it. The server applies the same rules as tools/standin_server.py:
+// keyed by (device, start_timestamp, id), a split is taken once, and an
+// undo leaves a tombstone that a later copy of the split cannot overturn.
+// Every message is acknowledged back over the same lossy link.
+//
+// Halfway through, the device reboots: a new journal attaches to the
+// retained storage with the local clock starting again at zero, while
+// messages sent before the reboot are still in flight.
+//
+//   g++ -O2 -Iinclude src/split_journal.cpp tools/journal_sim.cpp -o journal_sim
+//   ./journal_sim
+//
+// Exits non-zero if the server's final splits differ from what the device
+// kept, if anything is left unacknowledged, if the journal's unsettled
+// count ever differs from a walk of the ring, or if no late split ever
+// arrived after its tombstone (the race was not exercised).
+
+#include "split_journal.h"
+
+#include <map>
+#include <stdio.h>
+#include <string.h>
+#include <tuple>
+#include <vector>
+
+static const uint32_t END_MS = 300000;          // Touches stop here; then the journal drains
+static const uint32_t DRAIN_MS = 120000;
+static const uint32_t REBOOT_AT_MS = 150000;
+static const uint32_t HEAT_MS = 60000;          // New start_timestamp every heat
+static const uint32_t UNDO_WINDOW_MS = 10000;
+static const int RUNS = 200;
+
+struct Rng {
+    uint32_t state;
+
+    uint32_t next(uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    }
+};
+
+struct Faults {
+    uint32_t minDelayMs;
+    uint32_t maxDelayMs;
+    uint32_t lossPct;
+    uint32_t dupPct;
+};
+
+enum MsgKind { MSG_SPLIT, MSG_UNDO, MSG_ACK_SPLIT, MSG_ACK_UNDO };
+
+struct Msg {
+    uint32_t deliverAt;
+    MsgKind kind;
+    uint32_t id;
+    uint64_t heatStart;
+};
+
+struct Link {
+    Faults faults;
+    Rng* rng;
+    std::vector<Msg> queue;
+
+    void send(uint32_t now, MsgKind kind, uint32_t id, uint64_t heatStart) {
+        int copies = rng->next(100) < faults.dupPct ? 2 : 1;
+        for (int i = 0; i < copies; i++) {
+            if (rng->next(100) < faults.lossPct) {
+                continue;
+            }
+            uint32_t delay = faults.minDelayMs + rng->next(faults.maxDelayMs - faults.minDelayMs + 1);
+            queue.push_back({now + delay, kind, id, heatStart});
+        }
+    }
+
+    // Messages due by now, in delivery order
+    std::vector<Msg> receive(uint32_t now) {
+        std::vector<Msg> due, rest;
+        for (const Msg& msg : queue) {
+            (msg.deliverAt <= now ? due : rest).push_back(msg);
+        }
+        queue.swap(rest);
+        for (size_t i = 1; i < due.size(); i++) {
+            for (size_t j = i; j > 0 && due[j].deliverAt < due[j - 1].deliverAt; j--) {
+                std::swap(due[j], due[j - 1]);
+            }
+        }
+        return due;
+    }
+};
+
+// Mirror of the stand-in server's split table
+struct Server {
+    enum State { SPLIT, UNDONE };
+    std::map<std::tuple<uint64_t, uint32_t>, State> splits;
+    uint32_t duplicates = 0;
+    uint32_t lateSplits = 0;        // Split copies that arrived after their tombstone
+    uint32_t undoBeforeSplit = 0;   // Tombstones for splits not seen yet
+
+    void apply(const Msg& msg, uint32_t now, Link& toDevice) {
+        auto key = std::make_tuple(msg.heatStart, msg.id);
+        auto it = splits.find(key);
+        if (msg.kind == MSG_SPLIT) {
+            toDevice.send(now, MSG_ACK_SPLIT, msg.id, msg.heatStart);
+            if (it == splits.end()) {
+                splits[key] = SPLIT;
+            } else {
+                duplicates++;
+                if (it->second == UNDONE) {
+                    lateSplits++;
+                }
+            }
+        } else {
+            toDevice.send(now, MSG_ACK_UNDO, msg.id, msg.heatStart);
+            if (it == splits.end()) {
+                undoBeforeSplit++;
+            }
+            splits[key] = UNDONE;
+        }
+    }
+};
+
+struct Result {
+    uint32_t splits;
+    uint32_t undone;
+    uint32_t sends;
+    uint32_t retransmits;
+    uint32_t duplicates;
+    uint32_t lateSplits;
+    uint32_t undoBeforeSplit;
+    uint32_t mismatches;
+    uint32_t unsettled;
+    uint32_t countDrift;        // Steps where the kept count differs from the ring
+};
+
+// Unsettled entries found by walking the ring, to check the kept count
+static uint16_t scanUnsettled(const SplitJournal& journal, const SplitJournal::Storage& storage) {
+    uint16_t count = 0;
+    for (uint32_t back = 1; back <= SplitJournal::CAPACITY && back <= storage.nextId; back++) {
+        const SplitJournal::Entry* entry = journal.find(storage.nextId - back);
+        if (entry && !entry->isSettled()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// The firmware's flushSplitJournal(), against the simulated link
+static void flush(SplitJournal& journal, uint32_t localNow, uint32_t now, Link& toServer, Result& r) {
+    const SplitJournal::Entry* entry;
+    while ((entry = journal.nextDue(localNow)) != nullptr) {
+        if (entry->sentMs != 0) {
+            r.retransmits++;
+        }
+        toServer.send(now, entry->isRetracted() ? MSG_UNDO : MSG_SPLIT, entry->id, entry->heatStart);
+        r.sends++;
+        journal.markSent(entry->id, localNow);
+    }
+}
+
+static Result simulate(uint32_t seed, const Faults& faults) {
+    Rng rng = {seed};
+    Link toServer = {faults, &rng, {}};
+    Link toDevice = {faults, &rng, {}};
+    Server server;
+    Result r = {};
+
+    static SplitJournal::Storage storage;
+    memset(&storage, 0xA5, sizeof(storage)); // Power-on RTC memory: garbage
+    SplitJournal journal;
+    journal.attach(&storage, 1 + rng.next(0x0FFFFFFF));
+
+    std::map<std::tuple<uint64_t, uint32_t>, bool> intent; // key -> retracted
+    uint32_t bootAt = 0;
+    bool rebooted = false;
+    uint32_t nextTouch = 1000;
+    uint32_t undoAt = 0;
+    uint32_t undoId = 0;
+
+    for (uint32_t now = 0; now < END_MS + DRAIN_MS; now += 10) {
+        uint32_t localNow = now - bootAt;
+        uint64_t heatStart = 1700000000000ULL + (now / HEAT_MS) * HEAT_MS;
+
+        if (!rebooted && now >= REBOOT_AT_MS) {
+            // Warm reboot: RAM is gone, RTC memory and in-flight messages are not
+            rebooted = true;
+            bootAt = now;
+            localNow = 0;
+            undoAt = 0;
+            journal = SplitJournal();
+            journal.attach(&storage, 1 + rng.next(0x0FFFFFFF));
+        }
+
+        if (now < END_MS && now >= nextTouch) {
+            nextTouch = now + 1000 + rng.next(2000);
+            const SplitJournal::Entry* entry = journal.append(heatStart + 100, heatStart, 5, 2, localNow);
+            intent[std::make_tuple(entry->heatStart, entry->id)] = false;
+            r.splits++;
+            if (rng.next(100) < 20) {
+                undoAt = now + 200 + rng.next(5800);
+                undoId = entry->id;
+            }
+            flush(journal, localNow, now, toServer, r);
+        }
+
+        // undoLastSplit(): only the latest split of this heat, within the window
+        if (undoAt != 0 && now >= undoAt) {
+            undoAt = 0;
+            const SplitJournal::Entry* latest = journal.latest();
+            if (latest && latest->id == undoId && latest->heatStart == heatStart &&
+                localNow - latest->createdMs <= UNDO_WINDOW_MS && journal.retract(undoId)) {
+                intent[std::make_tuple(latest->heatStart, undoId)] = true;
+                r.undone++;
+                flush(journal, localNow, now, toServer, r);
+            }
+        }
+
+        for (const Msg& msg : toServer.receive(now)) {
+            server.apply(msg, now, toDevice);
+        }
+        for (const Msg& msg : toDevice.receive(now)) {
+            journal.acknowledge(msg.id, msg.kind == MSG_ACK_UNDO);
+        }
+        flush(journal, localNow, now, toServer, r);
+        if (now % 500 == 0 && journal.getUnsettledCount() != scanUnsettled(journal, storage)) {
+            r.countDrift++;
+        }
+    }
+
+    for (const auto& kept : intent) {
+        auto it = server.splits.find(kept.first);
+        bool serverRetracted = it != server.splits.end() && it->second == Server::UNDONE;
+        if (it == server.splits.end() || serverRetracted != kept.second) {
+            r.mismatches++;
+        }
+    }
+    r.unsettled = journal.getUnsettledCount();
+    r.duplicates = server.duplicates;
+    r.lateSplits = server.lateSplits;
+    r.undoBeforeSplit = server.undoBeforeSplit;
+    return r;
+}
+
+int main() {
+    struct Case {
+        const char* name;
+        Faults faults;
+    };
+    static const Case CASES[] = {
+        {"clean, 10-40 ms", {10, 40, 0, 0}},
+        {"10% loss, 5% dup, 10-3000 ms", {10, 3000, 10, 5}},
+        {"30% loss, 20% dup, 10-6000 ms", {10, 6000, 30, 20}},
+    };
+
+    printf("Split every 1-3 s, 20%% undone 0.2-6 s later, reboot at %u s; %d runs per case\n",
+           (unsigned)(REBOOT_AT_MS / 1000), RUNS);
+    printf("  %-30s  splits  undone  sends/split  retransmits  server dups  late splits  undo first"
+           "  mismatches  unsettled\n", "link");
+
+    bool ok = true;
+    uint32_t lateTotal = 0;
+    for (const Case& c : CASES) {
+        Result total = {};
+        for (int run = 0; run < RUNS; run++) {
+            Result r = simulate(7000u + run * 13u, c.faults);
+            total.splits += r.splits;
+            total.undone += r.undone;
+            total.sends += r.sends;
+            total.retransmits += r.retransmits;
+            total.duplicates += r.duplicates;
+            total.lateSplits += r.lateSplits;
+            total.undoBeforeSplit += r.undoBeforeSplit;
+            total.mismatches += r.mismatches;
+            total.unsettled += r.unsettled;
+            total.countDrift += r.countDrift;
+        }
+        lateTotal += total.lateSplits;
+        bool caseOk = total.mismatches == 0 && total.unsettled == 0 && total.countDrift == 0;
+        ok = ok && caseOk;
+        printf("  %-30s  %6u  %6u  %11.2f  %11u  %11u  %11u  %10u  %10u  %9u%s\n", c.name,
+               (unsigned)total.splits, (unsigned)total.undone, (double)total.sends / total.splits,
+               (unsigned)total.retransmits, (unsigned)total.duplicates, (unsigned)total.lateSplits,
+               (unsigned)total.undoBeforeSplit, (unsigned)total.mismatches, (unsigned)total.unsettled,
+               caseOk ? "" : "  FAIL");
+        if (total.countDrift) {
+            printf("  %-30s  unsettled count off from the ring in %u steps\n", "", (unsigned)total.countDrift);
+        }
+    }
+
+    if (lateTotal == 0) {
+        printf("FAIL: no split copy arrived after its tombstone\n");
+        ok = false;
+    }
+    printf("%s\n", ok ? "OK: server state matches the device in every run" : "FAIL");
+    return ok ? 0 : 1;
+}
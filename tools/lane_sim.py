@@ -0,0 +1,931 @@
+#!/usr/bin/env python3
+"""
+Pool simulator: N simulated lane devices plus a scoreboard against an
+in-process stand-in server (tools/standin_server.py).
+
+Scenarios:
+  fanout   Splits from every lane, with and without subscriptions. Reports
+           frames/bytes delivered per lane device, estimated Wi-Fi airtime
+           and host-side JSON parse time as a proxy for device CPU.
+  resume   Lanes drop off just before the start and reconnect: some within
+           the replay history, some after it overflowed (snapshot). Checks
+           every lane ends up running on the right start time, and shows
+           what happens to devices without resume.
+  udp-start Start delivery spread across lanes with the WebSocket fan-out
+           only versus the signed multicast fast path. Per-client TLS record
+           writes are modelled with --tls-write-ms.
+  gate     Lanes report sync status to the starter, which applies the
+           readiness gate (a mirror of src/lane_readiness.cpp): all ready,
+           one lane degraded, recovered, one lane gone quiet. Then a server
+           audit with one lane whose clock is worse than it claims.
+  usb      A lane on a pty pair behind tools/usb_bridge.py: frames between
+           log lines, a stray SOF byte and a corrupted frame on the port.
+           Checks the bridge beacon, subscribe/split/start delivery and log
+           passthrough, and compares ping round trips over the cable with a
+           lane on the WebSocket directly.
+  undo     A lane undoes a split while a retransmit of it is still on the
+           way, then sends an undo ahead of the split it retracts. Checks
+           the server acknowledges every copy, the scoreboard sees each
+           split and tombstone once, and late splits stay retracted.
+  presence Lanes drop off and come back, lose and regain sync, run their
+           batteries down and go quiet, while a starter keeps the server's
+           lane roster (a mirror of the firmware's roster and grid). Checks
+           every change costs the starter one message and at most one grid
+           cell, and compares with the status relay.
+
+Usage: lane_sim.py <scenario> [--lanes 10] [--splits 8] [--interval 0.05]
+"""
+
+import argparse
+import asyncio
+import hashlib
+import hmac
+import json
+import os
+import random
+import socket
+import statistics
+import struct
+import time
+import tty
+from collections import deque
+
+from websockets.asyncio.client import connect
+from websockets.asyncio.server import serve
+
+from standin_server import (FAST_PATH_GROUP, FAST_PATH_MAGIC, FAST_PATH_TAG_LENGTH,
+                            PRESENCE_BATTERY_STEP, PRESENCE_UNCERTAINTY_STEP_MS, FastPath, Hub,
+                            now_ms)
+from usb_bridge import FRAME_NODE_HOST, DeviceBridge, FrameStream, decode_frame, encode_frame
+
+# Per-frame overhead on the air: WS header + TLS record + TCP/IP + 802.11 MAC/LLC
+FRAME_OVERHEAD_BYTES = 4 + 29 + 40 + 36
+PHY_RATE_MBPS = 24.0
+FRAME_FIXED_US = 20 + 44 + 50  # Preamble, ACK, DIFS/backoff
+
+
+def airtime_us(frames, payload_bytes):
+    return frames * FRAME_FIXED_US + (payload_bytes + frames * FRAME_OVERHEAD_BYTES) * 8 / PHY_RATE_MBPS
+
+
+class SimDevice:
+    """Minimal device: optional subscription, counts and parses what it receives."""
+
+    def __init__(self, name, lane=None, subscribe=True, resume=True, presence=False):
+        self.name = name
+        self.lane = lane
+        self.subscribe = subscribe
+        self.resume = resume
+        self.presence = presence  # Starter: takes the server's lane roster instead of status
+        # Mirrors the firmware's stopwatch/resume state
+        self.last_seq = 0
+        self.epoch = 0
+        self.running = False
+        self.start_ts = 0
+        self.duplicates = 0
+        self.fast_seqs = deque(maxlen=4)
+        self.started_at = None  # perf_counter() when the stopwatch started
+        self.udp = None
+        self.frames = 0
+        self.bytes = 0
+        self.parse_s = 0.0
+        self.useful = 0
+        # Sync status as the firmware would report it, and the true clock error
+        self.sync = "locked"
+        self.uncertainty_ms = 5
+        self.clock_error_ms = 0.0
+        self.battery = None
+        self.readiness = None  # LaneReadiness mirror on the starter
+        self.roster = None     # Presence roster mirror on the starter
+        self.ws = None
+        self.task = None
+
+    def subscription(self):
+        if self.lane is None:
+            msg = {"type": "subscribe", "types": ["start", "reset", "split", "split-undo", "event-heat",
+                                                  "select-event", "clear", "status", "probe"],
+                   "lanes": "all"}
+            if self.presence:
+                msg["types"].append("presence")
+        else:
+            msg = {"type": "subscribe", "types": ["start", "reset", "event-heat", "select-event",
+                                                  "clear", "probe"], "lanes": [self.lane]}
+        if self.resume:
+            msg.update(last_seq=self.last_seq, epoch=self.epoch)
+        return msg
+
+    async def open(self, uri):
+        self.ws = await connect(uri)
+        if self.subscribe:
+            await self.ws.send(json.dumps(self.subscription()))
+        self.task = asyncio.create_task(self.receive())
+
+    def open_fast_path(self, key, port):
+        self.udp_key = key
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT, 1)
+        sock.bind(("", port))
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP,
+                        struct.pack("4s4s", socket.inet_aton(FAST_PATH_GROUP),
+                                    socket.inet_aton("127.0.0.1")))
+        sock.setblocking(False)
+        self.udp = sock
+        asyncio.get_running_loop().add_reader(sock.fileno(), self.receive_datagram)
+
+    def receive_datagram(self):
+        try:
+            data = self.udp.recv(2048)
+        except BlockingIOError:
+            return
+        header = len(FAST_PATH_MAGIC) + FAST_PATH_TAG_LENGTH
+        body = data[header:]
+        tag = hmac.new(self.udp_key, body, hashlib.sha256).digest()[:FAST_PATH_TAG_LENGTH]
+        if not data.startswith(FAST_PATH_MAGIC) or not hmac.compare_digest(tag, data[4:header]):
+            return
+        msg = json.loads(body)
+        if self.epoch and msg.get("epoch") == self.epoch and msg.get("type") in ("start", "reset"):
+            self.apply(msg, fast=True)
+
+    async def receive(self):
+        try:
+            async for raw in self.ws:
+                began = time.perf_counter()
+                msg = json.loads(raw)
+                self.parse_s += time.perf_counter() - began
+                self.frames += 1
+                self.bytes += len(raw)
+                if self.is_useful(msg):
+                    self.useful += 1
+                self.apply(msg)
+        except Exception:
+            pass
+
+    def accept(self, msg, fast):
+        if "seq" not in msg:
+            return True
+        seq = msg["seq"]
+        if fast:
+            if seq <= self.last_seq or seq in self.fast_seqs:
+                self.duplicates += 1
+                return False
+            self.fast_seqs.append(seq)
+            return True
+        if seq <= self.last_seq:
+            self.duplicates += 1
+            return False
+        self.last_seq = seq
+        if seq in self.fast_seqs:
+            self.duplicates += 1
+            return False
+        return True
+
+    def apply(self, msg, fast=False):
+        kind = msg.get("type")
+        if kind == "probe":
+            asyncio.create_task(self.send({"type": "probe-reply", "id": msg.get("id"),
+                                           "device": self.name, "time": self.clock(),
+                                           "sync": self.sync,
+                                           "uncertainty_ms": self.uncertainty_ms}))
+            return
+        if kind == "presence":
+            if self.roster is not None:
+                self.roster.apply(msg)
+            return
+        if kind == "status":
+            if self.readiness is not None and "lane" in msg:
+                self.readiness.update(msg["lane"], msg.get("sync"), msg.get("uncertainty_ms"))
+            return
+        if kind == "snapshot":
+            self.last_seq, self.epoch = msg["seq"], msg["epoch"]
+            self.running = msg["running"]
+            self.start_ts = msg["start_timestamp"] if self.running else 0
+            return
+        if not self.accept(msg, fast):
+            return
+        if kind == "start" and not self.running:
+            self.running, self.start_ts = True, msg.get("timestamp", 0)
+            self.started_at = time.perf_counter()
+        elif kind == "reset":
+            self.running, self.start_ts = False, 0
+
+    def clock(self):
+        return int(time.time() * 1000.0 + self.clock_error_ms)
+
+    async def report(self):
+        msg = {"type": "status", "device": self.name, "lane": self.lane, "sync": self.sync,
+               "uncertainty_ms": self.uncertainty_ms, "running": self.running}
+        if self.battery is not None:
+            msg["battery"] = self.battery
+        await self.send(msg)
+
+    def is_useful(self, msg):
+        if msg.get("type") != "split":
+            return True
+        return self.lane is None or msg.get("lane") == self.lane
+
+    async def send(self, msg):
+        await self.ws.send(json.dumps(msg, separators=(",", ":")))
+
+    async def close(self):
+        if self.udp is not None:
+            asyncio.get_running_loop().remove_reader(self.udp.fileno())
+            self.udp.close()
+            self.udp = None
+        await self.ws.close()
+        if self.task:
+            await self.task
+
+
+async def with_server(body, **hub_args):
+    hub = Hub(**hub_args)
+    async with serve(hub.serve_client, "127.0.0.1", 0) as server:
+        port = server.sockets[0].getsockname()[1]
+        return await body(hub, "ws://127.0.0.1:%d/ws" % port)
+
+
+async def fanout_run(lanes, splits, interval, subscribe):
+    async def body(hub, uri):
+        devices = [SimDevice("lane%d" % i, lane=i, subscribe=subscribe) for i in range(lanes)]
+        scoreboard = SimDevice("scoreboard", subscribe=subscribe)
+        for device in devices + [scoreboard]:
+            await device.open(uri)
+        await asyncio.sleep(0.1)
+
+        await hub.start("1", "1", now_ms())
+        for _ in range(splits):
+            for device in devices:
+                await device.send({"type": "split", "lane": device.lane, "timestamp": now_ms()})
+            await asyncio.sleep(interval)
+        await hub.reset()
+        await asyncio.sleep(0.2)
+
+        for device in devices + [scoreboard]:
+            await device.close()
+        return devices, scoreboard
+
+    return await with_server(body)
+
+
+def report_fanout(label, devices, scoreboard):
+    frames = sum(d.frames for d in devices)
+    size = sum(d.bytes for d in devices)
+    useful = sum(d.useful for d in devices)
+    parse_us = sum(d.parse_s for d in devices) * 1e6
+    print("%-14s lane frames %5d (useful %4d)  bytes %7d  airtime %8.0f us  parse %7.0f us"
+          "  | scoreboard frames %d" % (label, frames, useful, size,
+                                         airtime_us(frames, size), parse_us, scoreboard.frames))
+    return frames, size, parse_us
+
+
+async def scenario_fanout(args):
+    legacy = await fanout_run(args.lanes, args.splits, args.interval, subscribe=False)
+    filtered = await fanout_run(args.lanes, args.splits, args.interval, subscribe=True)
+    print("%d lanes, %d splits per lane" % (args.lanes, args.splits))
+    f0, b0, p0 = report_fanout("no subscribe", *legacy)
+    f1, b1, p1 = report_fanout("subscribe", *filtered)
+    if f0:
+        print("saved: %.0f%% frames, %.0f%% airtime, %.0f%% parse time on lane devices" % (
+            100.0 * (f0 - f1) / f0,
+            100.0 * (1 - airtime_us(f1, b1) / airtime_us(f0, b0)),
+            100.0 * (1 - p1 / p0) if p0 else 0.0))
+
+
+async def resume_run(lanes, resume):
+    async def body(hub, uri):
+        devices = [SimDevice("lane%d" % i, lane=i, resume=resume) for i in range(lanes)]
+        for device in devices:
+            await device.open(uri)
+        await asyncio.sleep(0.1)
+
+        # A previous heat that everybody saw
+        await hub.start("1", "1", now_ms())
+        await asyncio.sleep(0.05)
+        await hub.reset()
+        await asyncio.sleep(0.05)
+
+        # The last four lanes drop off, then the next heat starts
+        dropped = devices[-4:]
+        for device in dropped:
+            await device.close()
+        await hub.set_event_heat("1", "2")
+        await hub.start("1", "2", now_ms())
+        await asyncio.sleep(0.05)
+
+        # Two reconnect while the gap is still in the history (replay)
+        for device in dropped[:2]:
+            await device.open(uri)
+        await asyncio.sleep(0.1)
+
+        # Enough traffic to push the start out of the history, then the rest (snapshot)
+        for i in range(hub.history.maxlen):
+            await devices[i % (lanes - 4)].send({"type": "split", "lane": i % (lanes - 4),
+                                                 "timestamp": now_ms()})
+        await asyncio.sleep(0.1)
+        for device in dropped[2:]:
+            await device.open(uri)
+        await asyncio.sleep(0.2)
+
+        ok = [d.running and d.start_ts == hub.start_ts for d in devices]
+        for device in devices:
+            await device.close()
+        return ok, hub.replayed, hub.snapshots, sum(d.duplicates for d in devices)
+
+    return await with_server(body)
+
+
+async def scenario_resume(args):
+    for resume in (False, True):
+        ok, replayed, snapshots, duplicates = await resume_run(args.lanes, resume)
+        wrong = [i for i, good in enumerate(ok) if not good]
+        print("%-10s lanes in correct state %d/%d%s  (replayed %d, snapshots %d, duplicates %d)" % (
+            "resume" if resume else "no resume", len(ok) - len(wrong), len(ok),
+            "  wrong: %s" % wrong if wrong else "", replayed, snapshots, duplicates))
+        if resume and wrong:
+            raise SystemExit("resume scenario failed")
+
+
+async def udp_start_run(lanes, rounds, tls_write_ms, key):
+    fast_path = FastPath(key, interface="127.0.0.1") if key else None
+
+    async def body(hub, uri):
+        devices = [SimDevice("lane%d" % i, lane=i) for i in range(lanes)]
+        for device in devices:
+            await device.open(uri)
+            if key:
+                device.open_fast_path(key, fast_path.target[1])
+        await asyncio.sleep(0.2)
+
+        spreads, latencies = [], []
+        for _ in range(rounds):
+            for device in devices:
+                device.started_at = None
+            began = time.perf_counter()
+            await hub.start("1", "1", now_ms())
+            await asyncio.sleep(0.1 + lanes * tls_write_ms / 1000.0)
+            times = [d.started_at for d in devices if d.started_at is not None]
+            if len(times) == lanes:
+                spreads.append((max(times) - min(times)) * 1000)
+                latencies.append((max(times) - began) * 1000)
+            await hub.reset()
+            await asyncio.sleep(0.1 + lanes * tls_write_ms / 1000.0)
+
+        duplicates = sum(d.duplicates for d in devices)
+        for device in devices:
+            await device.close()
+        return spreads, latencies, duplicates
+
+    return await with_server(body, fast_path=fast_path, send_delay_s=tls_write_ms / 1000.0)
+
+
+async def scenario_udp_start(args):
+    print("%d lanes, %d starts, %.1f ms per TLS record write" % (
+        args.lanes, args.rounds, args.tls_write_ms))
+    for label, key in (("websocket", None), ("udp + ws", b"sim-key")):
+        spreads, latencies, duplicates = await udp_start_run(args.lanes, args.rounds,
+                                                             args.tls_write_ms, key)
+        if not spreads:
+            raise SystemExit("%s: no complete start round" % label)
+        print("%-10s start spread mean %6.2f ms  max %6.2f ms  | last lane latency max %6.2f ms"
+              "  (duplicates dropped %d)" % (label, statistics.mean(spreads), max(spreads),
+                                             max(latencies), duplicates))
+
+
+class Readiness:
+    """src/lane_readiness.cpp and the starter's gate, with shorter timeouts."""
+
+    def __init__(self, stale_after, forget_after):
+        self.stale_after = stale_after
+        self.forget_after = forget_after
+        self.lanes = {}
+
+    def update(self, lane, sync, uncertainty_ms):
+        self.lanes[lane] = (time.monotonic(), sync, uncertainty_ms)
+
+    def state(self, lane, threshold_ms):
+        if lane not in self.lanes:
+            return "absent"
+        reported, sync, bound = self.lanes[lane]
+        age = time.monotonic() - reported
+        if age >= self.forget_after:
+            return "absent"
+        if age >= self.stale_after:
+            return "stale"
+        if sync == "none" or bound is None or bound > threshold_ms:
+            return "degraded"
+        return "ready"
+
+    def not_ready(self, threshold_ms):
+        return sorted(lane for lane in self.lanes
+                      if self.state(lane, threshold_ms) in ("degraded", "stale"))
+
+
+async def gate_run(lanes, threshold_ms, stale_after):
+    async def body(hub, uri):
+        devices = [SimDevice("lane%d" % i, lane=i) for i in range(lanes)]
+        starter = SimDevice("starter")
+        starter.readiness = Readiness(stale_after, stale_after * 3)
+        for device in devices + [starter]:
+            await device.open(uri)
+        await asyncio.sleep(0.1)
+
+        async def report(active):
+            for device in active:
+                await device.report()
+            await asyncio.sleep(0.1)
+
+        checks = []
+
+        def expect(label, wanted):
+            got = starter.readiness.not_ready(threshold_ms)
+            checks.append((label, got == wanted, got))
+
+        for i, device in enumerate(devices):
+            device.clock_error_ms = (i % 5) - 2.0  # Within the claimed +/-5 ms
+        await report(devices)
+        expect("all lanes locked", [])
+
+        devices[2].sync, devices[2].uncertainty_ms = "holdover", threshold_ms + 25
+        await report(devices)
+        expect("lane 2 in holdover beyond the threshold", [2])
+
+        devices[2].sync, devices[2].uncertainty_ms = "locked", 6
+        await report(devices)
+        expect("lane 2 locked again", [])
+
+        quiet = devices[4]
+        await asyncio.sleep(stale_after * 0.6)
+        await report([d for d in devices if d is not quiet])
+        await asyncio.sleep(stale_after * 0.6)
+        await report([d for d in devices if d is not quiet])
+        expect("lane 4 stopped reporting", [4])
+
+        # Audit: lane 5 claims +/-5 ms but is actually 40 ms off
+        devices[5].clock_error_ms = 40.0
+        results, dispersion = await hub.audit()
+        flagged = sorted(r["device"] for r in results if not r["consistent"])
+        checks.append(("audit flags lane5 only", flagged == ["lane5"], flagged))
+
+        for device in devices + [starter]:
+            await device.close()
+        return checks, results, dispersion
+
+    return await with_server(body)
+
+
+async def scenario_gate(args):
+    checks, results, dispersion = await gate_run(args.lanes, args.gate_ms, args.stale_after)
+    print("%d lanes, gate threshold %d ms" % (args.lanes, args.gate_ms))
+    for label, ok, got in checks:
+        print("%-4s %-42s not ready/flagged: %s" % ("PASS" if ok else "FAIL", label, got))
+    print("audit dispersion %.1f ms, worst window +/-%.1f ms" % (
+        dispersion, max(r["window_ms"] for r in results)))
+    if not all(ok for _, ok, _ in checks):
+        raise SystemExit("gate scenario failed")
+
+
+class Roster:
+    """The starter's presence roster (src/lane_readiness.cpp) and its grid, one cell per lane."""
+
+    CELL_PIXELS = 48 * 45   # One cell of src/display_manager.cpp's grid
+    GRID_PIXELS = 240 * 90
+
+    def __init__(self, threshold_ms):
+        self.threshold_ms = threshold_ms
+        self.lanes = {}
+        self.drawn = {}       # Lane -> (state, battery) as drawn
+        self.messages = 0
+        self.cells_drawn = 0
+
+    def apply(self, msg):
+        entry = self.lanes.setdefault(msg["lane"], {"online": True, "sync": "none",
+                                                    "uncertainty_ms": None, "battery": None})
+        for key in entry:
+            if key in msg:
+                entry[key] = msg[key]
+        if entry["sync"] == "none":
+            entry["uncertainty_ms"] = None
+        self.messages += 1
+        for lane in self.lanes:
+            cell = (self.state(lane), self.lanes[lane]["battery"])
+            if self.drawn.get(lane) != cell:
+                self.drawn[lane] = cell
+                self.cells_drawn += 1
+
+    def state(self, lane):
+        entry = self.lanes[lane]
+        if not entry["online"]:
+            return "stale"
+        if entry["sync"] == "none" or entry["uncertainty_ms"] is None or entry["uncertainty_ms"] > self.threshold_ms:
+            return "degraded"
+        return "ready"
+
+
+def presence_truth(device, online):
+    """What the roster should hold for a lane: the server's rounding of its last report."""
+    step = PRESENCE_UNCERTAINTY_STEP_MS
+    return {"online": online, "sync": device.sync,
+            "uncertainty_ms": -(-device.uncertainty_ms // step) * step if device.sync != "none" else None,
+            "battery": device.battery // PRESENCE_BATTERY_STEP * PRESENCE_BATTERY_STEP}
+
+
+async def presence_run(lanes, threshold_ms, events, seed):
+    async def body(hub, uri):
+        rng = random.Random(seed)
+        hub.presence.stale_s = 0.3
+        devices = [SimDevice("lane%d" % i, lane=i) for i in range(lanes)]
+        for device in devices:
+            device.battery = 85
+            device.uncertainty_ms = 4
+        starter = SimDevice("starter", presence=True)
+        starter.roster = Roster(threshold_ms)
+        legacy = SimDevice("legacy-starter")  # Same pool, status relay only
+        for device in [starter, legacy] + devices:
+            await device.open(uri)
+        online = set(range(lanes))
+        phases, checks = [], []
+
+        async def phase(label, action, changes):
+            frames, size, cells = starter.frames, starter.bytes, starter.roster.cells_drawn
+            legacy_frames, legacy_bytes = legacy.frames, legacy.bytes
+            per_change = []
+            for step in action:
+                before = (starter.frames, starter.bytes, starter.roster.cells_drawn)
+                await step()
+                await asyncio.sleep(0.02)
+                per_change.append((starter.frames - before[0], starter.bytes - before[1],
+                                   starter.roster.cells_drawn - before[2]))
+            phases.append((label, changes, starter.frames - frames, starter.bytes - size,
+                           starter.roster.cells_drawn - cells, legacy.frames - legacy_frames,
+                           legacy.bytes - legacy_bytes))
+            return per_change
+
+        def matches():
+            return all(starter.roster.lanes.get(d.lane) == presence_truth(d, d.lane in online) for d in devices)
+
+        async def report_all():
+            for device in devices:
+                if device.lane in online:
+                    await device.report()
+
+        initial = await phase("first reports", [report_all], lanes)
+        checks.append(("one message per lane", initial[0][0] == lanes, initial[0][0]))
+        checks.append(("roster after first reports", matches(), None))
+
+        def jitter():
+            for device in devices:
+                device.uncertainty_ms = rng.randint(1, PRESENCE_UNCERTAINTY_STEP_MS)
+                device.battery = device.battery // 10 * 10 + rng.randint(2, 8)
+            return report_all()
+
+        steady = await phase("steady reports x5", [jitter] * 5, 0)
+        checks.append(("steady reports send nothing", sum(f for f, _, _ in steady) == 0,
+                       sum(f for f, _, _ in steady)))
+
+        # One lane at a time: every change is one message and at most one cell
+        def flap(device, kind):
+            async def step():
+                if kind == "drop":
+                    online.discard(device.lane)
+                    await device.close()
+                elif kind == "back":
+                    online.add(device.lane)
+                    await device.open(uri)
+                    await device.report()
+                else:
+                    if kind == "holdover":
+                        device.sync, device.uncertainty_ms = "holdover", threshold_ms + 30
+                    elif kind == "lock":
+                        device.sync, device.uncertainty_ms = "locked", 4
+                    elif kind == "battery":
+                        device.battery = max(5, device.battery - PRESENCE_BATTERY_STEP)
+                    await device.report()
+            return step
+
+        async def random_flap():
+            device = rng.choice(devices)
+            if device.lane not in online:
+                kind = "back"
+            elif device.sync == "holdover":
+                kind = rng.choice(["lock", "drop"])
+            else:
+                kind = rng.choice(["drop", "holdover", "battery"])
+            await flap(device, kind)()
+
+        flapping = await phase("one lane flapping", [random_flap] * events, events)
+        worst = max(flapping)
+        checks.append(("one message per change", all(f == 1 for f, _, _ in flapping),
+                       sorted(set(f for f, _, _ in flapping))))
+        checks.append(("at most one cell per change", all(c <= 1 for _, _, c in flapping),
+                       sorted(set(c for _, _, c in flapping))))
+        checks.append(("roster after flapping", matches(), None))
+
+        # Every lane at once: still one message and one cell each
+        for device in devices:
+            if device.lane not in online:
+                await flap(device, "back")()
+            await flap(device, "lock")()
+        await asyncio.sleep(0.05)
+        all_lanes = await phase("all lanes to holdover", [lambda: asyncio.gather(
+            *(flap(d, "holdover")() for d in devices))], lanes)
+        checks.append(("all lanes: one message each", all_lanes[0][0] == lanes, all_lanes[0][0]))
+        await phase("all lanes locked", [lambda: asyncio.gather(
+            *(flap(d, "lock")() for d in devices))], lanes)
+
+        # A lane whose connection stays up but whose reports stop
+        quiet = devices[lanes // 2]
+
+        async def go_quiet():
+            await asyncio.sleep(hub.presence.stale_s + 0.1)
+            for device in devices:
+                if device is not quiet:
+                    await device.report()
+            await asyncio.sleep(0.05)  # Reports handled first
+            online.discard(quiet.lane)
+            await hub.sweep_presence()
+
+        stale = await phase("one lane quiet", [go_quiet], 1)
+        checks.append(("quiet lane goes offline", stale[0][0] == 1 and matches(), stale[0][0]))
+
+        # The starter reconnects and gets the whole roster once
+        await starter.close()
+        starter.roster = Roster(threshold_ms)
+        await starter.open(uri)
+        await asyncio.sleep(0.05)
+        checks.append(("starter reconnect: whole roster", starter.roster.messages == lanes and matches(),
+                       starter.roster.messages))
+
+        for device in [starter, legacy] + devices:
+            if device.lane is None or device.lane in online or device is quiet:
+                await device.close()
+        return phases, checks, worst
+
+    return await with_server(body)
+
+
+async def scenario_presence(args):
+    phases, checks, worst = await presence_run(args.lanes, args.gate_ms, args.events, args.seed)
+    print("%d lanes, gate threshold %d ms" % (args.lanes, args.gate_ms))
+    print("%-22s %7s  %6s %6s %6s %8s  | %13s %6s" % ("", "changes", "frames", "bytes", "cells",
+                                                     "pixels", "status relay", "bytes"))
+    for label, changes, frames, size, cells, legacy_frames, legacy_bytes in phases:
+        print("%-22s %7d  %6d %6d %6d %8d  | %13d %6d" % (label, changes, frames, size, cells,
+                                                          cells * Roster.CELL_PIXELS, legacy_frames,
+                                                          legacy_bytes))
+    print("worst single change: %d frame, %d bytes, %d cell (%d px; whole grid %d px)" % (
+        worst[0], worst[1], worst[2], worst[2] * Roster.CELL_PIXELS, Roster.GRID_PIXELS))
+    for label, ok, got in checks:
+        print("%-4s %-34s %s" % ("PASS" if ok else "FAIL", label, "" if got is None else got))
+    if not all(ok for _, ok, _ in checks):
+        raise SystemExit("presence scenario failed")
+
+
+class UsbSimDevice:
+    """Device end of the USB link (a mirror of src/usb_transport.cpp) on a pty master."""
+
+    def __init__(self, fd, lane):
+        self.fd = fd
+        self.lane = lane
+        self.stream = FrameStream()
+        self.seq = 0
+        self.beacons = 0
+        self.bridge_up = asyncio.Event()
+        self.messages = asyncio.Queue()
+        loop = asyncio.get_running_loop()
+        loop.add_reader(fd, self.on_readable)
+
+    def on_readable(self):
+        try:
+            data = os.read(self.fd, 4096)
+        except OSError:
+            return
+        for kind, chunk in self.stream.feed(data):
+            if kind != "frame":
+                continue
+            decoded = decode_frame(chunk)
+            if decoded is None or decoded[0] != FRAME_NODE_HOST:
+                continue
+            if not decoded[2]:
+                self.beacons += 1
+                self.bridge_up.set()
+            else:
+                self.messages.put_nowait(json.loads(decoded[2]))
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def log(self, line):
+        self.write(line.encode() + b"\r\n")
+
+    def frame(self, msg):
+        payload = json.dumps(msg, separators=(",", ":")).encode()
+        frame = encode_frame(self.lane, self.seq, payload)
+        self.seq = (self.seq + 1) & 0xFFFF
+        return frame
+
+    def send(self, msg):
+        self.write(self.frame(msg))
+
+    async def expect(self, kind, timeout=1.0):
+        deadline = time.monotonic() + timeout
+        while True:
+            msg = await asyncio.wait_for(self.messages.get(), max(0.0, deadline - time.monotonic()))
+            if msg.get("type") == kind:
+                return msg
+
+    def close(self):
+        asyncio.get_running_loop().remove_reader(self.fd)
+
+
+async def ping_rtts(send, expect, count):
+    rtts = []
+    for _ in range(count):
+        await send({"type": "ping", "time": time.perf_counter() * 1000.0})
+        pong = await expect("pong")
+        rtts.append(time.perf_counter() * 1000.0 - pong["client_ping_time"])
+    return rtts
+
+
+async def usb_run(pings):
+    async def body(hub, uri):
+        master, slave = os.openpty()
+        tty.setraw(slave)
+        os.set_blocking(master, False)
+        os.set_blocking(slave, False)
+        log_lines = []
+        bridge = DeviceBridge("pty", uri, fd=slave, log=log_lines.append)
+        bridge_task = asyncio.create_task(bridge.run())
+        device = UsbSimDevice(master, lane=3)
+        starter = SimDevice("starter")
+        splits = []
+        starter.apply = lambda msg, fast=False: msg.get("type") == "split" and splits.append(msg)
+        await starter.open(uri)
+        checks = []
+
+        device.log("boot: lane 3, usb link waiting for the PC bridge")
+        try:
+            await asyncio.wait_for(device.bridge_up.wait(), 3.0)
+        except asyncio.TimeoutError:
+            pass
+        checks.append(("bridge beacon seen", device.bridge_up.is_set(), device.beacons))
+
+        device.send({"type": "subscribe", "types": ["start", "reset", "event-heat", "probe"],
+                     "lanes": [3], "last_seq": 0, "epoch": 0})
+        await asyncio.sleep(0.1)
+        checks.append(("subscribe cached by the bridge", bridge.subscribe is not None,
+                       bridge.subscribe is not None))
+
+        async def device_ping(msg):
+            device.send(msg)
+        usb_rtts = await ping_rtts(device_ping, device.expect, pings)
+
+        # Port noise: a stray SOF in the log, then a frame with a flipped bit
+        device.write(b"log with a stray \xa5 byte\r\n")
+        bad = bytearray(device.frame({"type": "split", "lane": 3, "timestamp": 1}))
+        bad[10] ^= 0x01
+        device.write(bytes(bad))
+        device.log("after noise")
+        device.send({"type": "split", "lane": 3, "timestamp": now_ms()})
+        await asyncio.sleep(0.2)
+        checks.append(("corrupted frame rejected", bridge.rejected == 1, bridge.rejected))
+        checks.append(("one split reached the starter", len(splits) == 1, len(splits)))
+        checks.append(("log lines passed through",
+                       any(line.startswith("boot: lane 3") for line in log_lines) and
+                       "after noise" in log_lines, len(log_lines)))
+
+        await hub.start("1", "2", now_ms())
+        try:
+            start = await device.expect("start")
+        except asyncio.TimeoutError:
+            start = None
+        checks.append(("start reached the device over USB", start is not None,
+                       start and start.get("seq")))
+
+        # The same pings from a lane on the WebSocket directly, for comparison
+        direct = SimDevice("lane4", lane=4)
+        replies = asyncio.Queue()
+        direct.apply = lambda msg, fast=False: replies.put_nowait(msg)
+        await direct.open(uri)
+
+        async def direct_expect(kind):
+            while True:
+                msg = await asyncio.wait_for(replies.get(), 1.0)
+                if msg.get("type") == kind:
+                    return msg
+        ws_rtts = await ping_rtts(direct.send, direct_expect, pings)
+
+        bridge_task.cancel()
+        device.close()
+        await direct.close()
+        await starter.close()
+        os.close(master)
+        os.close(slave)
+        return checks, usb_rtts, ws_rtts, bridge, log_lines
+
+    return await with_server(body)
+
+
+async def scenario_usb(args):
+    checks, usb_rtts, ws_rtts, bridge, log_lines = await usb_run(args.pings)
+    for label, ok, got in checks:
+        print("%-4s %-36s %s" % ("PASS" if ok else "FAIL", label, got))
+    for label, rtts in (("usb bridge", usb_rtts), ("websocket", ws_rtts)):
+        print("%-10s ping rtt median %.2f ms, max %.2f ms (%d pings)" % (
+            label, statistics.median(rtts), max(rtts), len(rtts)))
+    print("bridge: %d frames to server, %d to device, %d rejected, %d discarded, %d log lines" % (
+        bridge.to_server, bridge.to_device, bridge.rejected, bridge.stream.discarded, len(log_lines)))
+    if not all(ok for _, ok, _ in checks):
+        raise SystemExit("usb scenario failed")
+
+
+async def undo_run():
+    async def body(hub, uri):
+        lane = SimDevice("lane3", lane=3)
+        scoreboard = SimDevice("scoreboard")
+        acks, shown = [], []
+        lane_apply, board_apply = lane.apply, scoreboard.apply
+        lane.apply = lambda msg, fast=False: (
+            acks.append((msg["id"], msg["undo"])) if msg.get("type") == "split-ack" else lane_apply(msg, fast))
+        scoreboard.apply = lambda msg, fast=False: (
+            shown.append((msg["type"], msg.get("id"))) if msg.get("type") in ("split", "split-undo")
+            else board_apply(msg, fast))
+        for device in (lane, scoreboard):
+            await device.open(uri)
+        await asyncio.sleep(0.1)
+        await hub.start("1", "1", now_ms())
+        start_ts = hub.start_ts
+
+        def split(kind, split_id):
+            return {"type": kind, "device": lane.name, "id": split_id, "start_timestamp": start_ts,
+                    "lane": 3, "position": "start", "timestamp": start_ts + 1000 * split_id}
+
+        # Split 1: undone, with the retransmit landing after the tombstone
+        await lane.send(split("split", 1))
+        await lane.send(split("split-undo", 1))
+        await lane.send(split("split", 1))
+        await lane.send(split("split-undo", 1))
+        # Split 2: the tombstone overtakes the split
+        await lane.send(split("split-undo", 2))
+        await lane.send(split("split", 2))
+        # Split 3 stays, sent twice
+        await lane.send(split("split", 3))
+        await lane.send(split("split", 3))
+        await asyncio.sleep(0.2)
+
+        checks = [
+            ("every copy acknowledged", acks == [(1, False), (1, True), (1, False), (1, True),
+                                                 (2, True), (2, False), (3, False), (3, False)], acks),
+            ("scoreboard: split, undo, split once", shown == [("split", 1), ("split-undo", 1),
+                                                             ("split", 3)], shown),
+            ("server table", {k[2]: v for k, v in hub.splits.items()} == {1: "undone", 2: "undone",
+                                                                          3: "split"}, hub.splits),
+        ]
+        for device in (lane, scoreboard):
+            await device.close()
+        return checks
+
+    return await with_server(body)
+
+
+async def scenario_undo(args):
+    checks = await undo_run()
+    for label, ok, got in checks:
+        print("%-4s %-36s %s" % ("PASS" if ok else "FAIL", label, got))
+    if not all(ok for _, ok, _ in checks):
+        raise SystemExit("undo scenario failed")
+
+
+SCENARIOS = {
+    "fanout": scenario_fanout,
+    "resume": scenario_resume,
+    "udp-start": scenario_udp_start,
+    "gate": scenario_gate,
+    "usb": scenario_usb,
+    "undo": scenario_undo,
+    "presence": scenario_presence,
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("scenario", choices=sorted(SCENARIOS))
+    parser.add_argument("--lanes", type=int, default=10)
+    parser.add_argument("--splits", type=int, default=8)
+    parser.add_argument("--interval", type=float, default=0.05,
+                        help="seconds between split rounds (15 s in a real race)")
+    parser.add_argument("--rounds", type=int, default=10, help="starts per run (udp-start)")
+    parser.add_argument("--tls-write-ms", type=float, default=2.0,
+                        help="modelled cost of one TLS record write on the server (udp-start)")
+    parser.add_argument("--gate-ms", type=int, default=20, help="readiness threshold (gate)")
+    parser.add_argument("--pings", type=int, default=20, help="round trips per path (usb)")
+    parser.add_argument("--events", type=int, default=60, help="single-lane changes (presence)")
+    parser.add_argument("--seed", type=int, default=7, help="random seed (presence)")
+    parser.add_argument("--stale-after", type=float, default=0.5,
+                        help="seconds without a status before a lane is stale (gate; 25 s on devices)")
+    args = parser.parse_args()
+    asyncio.run(SCENARIOS[args.scenario](args))
+
+
+if __name__ == "__main__":
+    main()
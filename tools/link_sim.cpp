@@ -0,0 +1,364 @@
+// Link failover simulation for the peer link (include/transport.h), run on the host.
+//
+// A lane sends a split every second. It pings the server every 5 s over
+// its WebSocket, and the pong is what keeps LinkSelector on the primary
+// path. At FAIL_AT_MS the access point dies for the lane only. The lane's
+// LinkSelector notices the silence and moves its traffic to the loopback
+// peer link. The starter (gateway) forwards that traffic to the server over
+// its own WebSocket. At RECOVER_AT_MS the access point returns. The
+// WebSocket reconnects, and traffic moves back after the recovery hold.
+//
+// The peer link drops, duplicates and corrupts frames at the rates below.
+// Because the framing, CRC and duplicate filter are the firmware's own
+// sources, the tool also checks that the server never sees a duplicate or
+// a damaged message.
+//
+//   g++ -O2 -Iinclude src/message_frame.cpp src/transport.cpp src/loopback_transport.cpp tools/link_sim.cpp -o link_sim
+//   ./link_sim
+//
+// A second part feeds FrameStreamDecoder a serial stream as the USB link
+// sees it: log lines, stray SOF bytes, frames with flipped bits and
+// truncated frames. It checks that every intact frame comes out and that
+// no damaged frame passes its CRC.
+//
+// Exits non-zero if a duplicate or corrupted message reaches the server,
+// or if the stream check fails.
+
+#include "loopback_transport.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint32_t SPLIT_INTERVAL_MS = 1000;
+static const uint32_t PING_INTERVAL_MS = 5000;
+static const uint32_t FAIL_AT_MS = 60000;
+static const uint32_t RECOVER_AT_MS = 120000;
+static const uint32_t END_MS = 180000;
+static const uint32_t WS_RECONNECT_MS = 5000;       // WebSocketsClient reconnect interval
+static const uint32_t WS_DETECT_MS = 15000 + 2 * 3000; // enableHeartbeat(15000, 3000, 2)
+static const uint32_t RELAY_START_AT_MS = 90000;    // A start sent by the server during the outage
+static const int RUNS = 50;
+static const int MAX_SPLITS = END_MS / SPLIT_INTERVAL_MS + 1;
+
+struct Rng {
+    uint32_t state;
+
+    uint32_t next(uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    }
+};
+
+// WebSocket to the server: 8-40 ms one way, nothing gets through while the AP is down
+struct WsLink {
+    static const int SLOTS = 64;
+    uint32_t deliverAt[SLOTS];
+    int ids[SLOTS];
+    int count;
+
+    void send(Rng& rng, uint32_t now, int id) {
+        if (count < SLOTS) {
+            deliverAt[count] = now + 8 + rng.next(33);
+            ids[count] = id;
+            count++;
+        }
+    }
+
+    // Pop the next message due by now, -1 if none
+    int receive(uint32_t now) {
+        for (int i = 0; i < count; i++) {
+            if ((int32_t)(now - deliverAt[i]) >= 0) {
+                int id = ids[i];
+                memmove(&deliverAt[i], &deliverAt[i + 1], (count - i - 1) * sizeof(uint32_t));
+                memmove(&ids[i], &ids[i + 1], (count - i - 1) * sizeof(int));
+                count--;
+                return id;
+            }
+        }
+        return -1;
+    }
+};
+
+struct Stats {
+    double switchMs;            // AP loss until the selector chose the peer link
+    double failoverMs;          // AP loss until the first split arrived via the gateway
+    double backMs;              // AP return until traffic was back on the WebSocket
+    int lost;                   // Splits sent into the dead WebSocket before the switch
+    int delivered;
+    int sent;
+    double wsLatencySum, peerLatencySum, wsLatencyMax, peerLatencyMax;
+    int wsCount, peerCount;
+    double relayLatencyMs;      // Server start to the lane over the gateway
+    uint32_t framesRejected, framesDuplicated;
+    int serverDuplicates, serverCorrupt;
+};
+
+static Stats simulate(uint32_t seed, const LoopbackMedium::Faults& faults) {
+    uint32_t now = 0;
+    Rng rng = {seed};
+    LoopbackMedium medium(&now, seed * 7919u + 1);
+    medium.setFaults(faults);
+    LoopbackTransport lane(medium, 3);
+    LoopbackTransport gateway(medium, FRAME_NODE_GATEWAY);
+    LinkSelector selector;
+    WsLink laneWs = {}, gatewayWs = {};
+
+    Stats stats = {};
+    uint32_t sentAt[MAX_SPLITS];
+    bool received[MAX_SPLITS] = {};
+    bool wsUp = true, apUp = true;
+    uint32_t wsDownAt = 0, reconnectAt = 0, pongDueAt = 0;
+    bool switched = false, failedOver = false, back = false;
+    uint32_t relayStartSentAt = 0;
+    bool relayStartSeen = false;
+    selector.setPrimaryUp(true, now);
+
+    for (; now < END_MS; now++) {
+        if (now == FAIL_AT_MS) {
+            apUp = false;
+            wsDownAt = now + WS_DETECT_MS;
+        }
+        if (now == RECOVER_AT_MS) {
+            apUp = true;
+        }
+        // Heartbeat timeout closes the dead socket; reconnects once the AP is back
+        if (wsUp && !apUp && now >= wsDownAt) {
+            wsUp = false;
+            selector.setPrimaryUp(false, now);
+        }
+        if (!wsUp && apUp && reconnectAt == 0) {
+            reconnectAt = now + WS_RECONNECT_MS;
+        }
+        if (!wsUp && reconnectAt != 0 && now >= reconnectAt) {
+            wsUp = true;
+            reconnectAt = 0;
+            pongDueAt = now + 20; // Initial ping burst
+            selector.setPrimaryUp(true, now);
+        }
+
+        // Ping/pong keeps the primary marked as heard
+        if (wsUp && now % PING_INTERVAL_MS == 0) {
+            pongDueAt = now + 20 + rng.next(40);
+        }
+        if (pongDueAt != 0 && now >= pongDueAt) {
+            if (wsUp && apUp) {
+                selector.primaryHeard(now);
+            }
+            pongDueAt = 0;
+        }
+
+        LinkRoute route = selector.route(now, lane.isUp());
+        if (!switched && !apUp && route == ROUTE_FALLBACK) {
+            switched = true;
+            stats.switchMs = now - FAIL_AT_MS;
+        }
+        if (switched && !back && apUp && route == ROUTE_PRIMARY) {
+            back = true;
+            stats.backMs = now - RECOVER_AT_MS;
+        }
+
+        // Lane split
+        if (now % SPLIT_INTERVAL_MS == 0) {
+            int id = now / SPLIT_INTERVAL_MS;
+            sentAt[id] = now;
+            stats.sent++;
+            if (route == ROUTE_PRIMARY) {
+                if (apUp) {
+                    laneWs.send(rng, now, id);
+                } else {
+                    stats.lost++;
+                }
+            } else if (route == ROUTE_FALLBACK) {
+                char json[64];
+                int length = snprintf(json, sizeof(json), "{\"type\":\"split\",\"lane\":3,\"id\":%d}", id);
+                lane.send((const uint8_t*)json, length);
+            }
+        }
+
+        // Gateway: forward lane frames to the server over its own WebSocket
+        uint8_t buffer[FrameTransport::MAX_PAYLOAD + 1];
+        uint8_t source;
+        size_t length;
+        while ((length = gateway.receive(buffer, sizeof(buffer), source)) > 0) {
+            int id;
+            if (sscanf((const char*)buffer, "{\"type\":\"split\",\"lane\":3,\"id\":%d}", &id) != 1 ||
+                id < 0 || id >= MAX_SPLITS) {
+                stats.serverCorrupt++;
+                continue;
+            }
+            gatewayWs.send(rng, now, id + MAX_SPLITS); // Tagged: arrived via the peer link
+        }
+
+        // Server relays a start during the outage: to the gateway, then over the peer link
+        if (now == RELAY_START_AT_MS) {
+            relayStartSentAt = now;
+            gatewayWs.send(rng, now, -2);
+        }
+        while ((length = lane.receive(buffer, sizeof(buffer), source)) > 0) {
+            if (!relayStartSeen && strstr((const char*)buffer, "\"start\"") != nullptr) {
+                relayStartSeen = true;
+                stats.relayLatencyMs = now - relayStartSentAt;
+            }
+        }
+
+        // Server side
+        WsLink* links[] = {&laneWs, &gatewayWs};
+        for (WsLink* ws : links) {
+            int tagged;
+            while ((tagged = ws->receive(now)) != -1) {
+                if (tagged == -2) {
+                    // Reached the gateway: repeat to the lanes
+                    const char* start = "{\"type\":\"start\",\"seq\":41}";
+                    gateway.send((const uint8_t*)start, strlen(start));
+                    continue;
+                }
+                bool viaPeer = tagged >= MAX_SPLITS;
+                int id = viaPeer ? tagged - MAX_SPLITS : tagged;
+                if (received[id]) {
+                    stats.serverDuplicates++;
+                    continue;
+                }
+                received[id] = true;
+                stats.delivered++;
+                double latency = now - sentAt[id];
+                if (viaPeer) {
+                    if (!failedOver) {
+                        failedOver = true;
+                        stats.failoverMs = now - FAIL_AT_MS;
+                    }
+                    stats.peerLatencySum += latency;
+                    stats.peerLatencyMax = fmax(stats.peerLatencyMax, latency);
+                    stats.peerCount++;
+                } else {
+                    stats.wsLatencySum += latency;
+                    stats.wsLatencyMax = fmax(stats.wsLatencyMax, latency);
+                    stats.wsCount++;
+                }
+            }
+        }
+    }
+    stats.framesRejected = gateway.getRejectedCount() + lane.getRejectedCount();
+    stats.framesDuplicated = gateway.getDuplicateCount() + lane.getDuplicateCount();
+    return stats;
+}
+
+static bool streamCheck(uint32_t seed) {
+    static const int FRAMES = 2000;
+    static const char* const LOG_LINES[] = {
+        "Pong received - ping: 3ms, best: 2ms\r\n",
+        "WebSocket received: start (96 bytes)\r\n",
+        "stray \xA5 in a log line\r\n",
+        "\xA5\x01 stray SOF and version\r\n",
+    };
+
+    uint8_t rx[256];
+    FrameStreamDecoder decoder(rx, sizeof(rx));
+    int intact = 0, decoded = 0, damagedPassed = 0, textBytes = 0;
+    uint32_t rng = seed;
+    auto next = [&rng]() { rng = rng * 1103515245u + 12345u; return (rng >> 16) & 0x7FFF; };
+
+    uint8_t stream[512];
+    for (int i = 0; i < FRAMES; i++) {
+        size_t length = 0;
+        const char* line = LOG_LINES[next() % 4];
+        memcpy(stream, line, strlen(line));
+        length = strlen(line);
+
+        char json[64];
+        int jsonLength = snprintf(json, sizeof(json), "{\"type\":\"split\",\"lane\":3,\"n\":%d}", i);
+        size_t frameLength = frameEncode(3, (uint16_t)i, (const uint8_t*)json, jsonLength,
+                                         stream + length, sizeof(stream) - length);
+        uint32_t fault = next() % 100;
+        bool damaged = fault < 10;
+        if (fault < 5) {
+            stream[length + 1 + next() % (frameLength - 1)] ^= 1 << (next() % 8);
+        } else if (fault < 10) {
+            frameLength = 1 + next() % (frameLength - 1);   // Cut short by a reset
+        } else {
+            intact++;
+        }
+        length += frameLength;
+
+        for (size_t j = 0; j < length; j++) {
+            FrameStreamDecoder::Result result = decoder.push(stream[j]);
+            if (result == FrameStreamDecoder::PASSTHROUGH) {
+                textBytes++;
+            } else if (result == FrameStreamDecoder::COMPLETE) {
+                FrameHeader header;
+                const uint8_t* payload;
+                if (frameDecode(decoder.frame(), decoder.length(), header, &payload)) {
+                    decoded++;
+                    if (header.seq != (uint16_t)i || damaged) {
+                        damagedPassed++;
+                    }
+                }
+            }
+        }
+    }
+
+    bool ok = damagedPassed == 0 && decoded >= intact * 95 / 100;
+    printf("\nUSB stream: %d frames between log lines, %d intact, %d decoded, %d damaged passed, "
+           "%u candidates discarded, %d text bytes%s\n",
+           FRAMES, intact, decoded, damagedPassed, (unsigned)decoder.getDiscardedCount(), textBytes,
+           ok ? "" : "  STREAM CHECK FAILED");
+    return ok;
+}
+
+int main() {
+    struct Case {
+        const char* name;
+        LoopbackMedium::Faults faults;
+    };
+    static const Case CASES[] = {
+        {"clean peer link", {2, 3, 0, 0, 0}},
+        {"2% loss, 5% dup, 1% corrupt", {2, 3, 2, 5, 1}},
+        {"10% loss, 20% dup, 5% corrupt", {2, 6, 10, 20, 5}},
+    };
+
+    printf("AP lost for the lane at %u s, back at %u s; split every %u ms; mean of %d runs\n",
+           (unsigned)(FAIL_AT_MS / 1000), (unsigned)(RECOVER_AT_MS / 1000), (unsigned)SPLIT_INTERVAL_MS, RUNS);
+    printf("  %-30s  switch ms  failover ms  back ms  lost  delivered  ws lat mean/max  peer lat mean/max"
+           "  relay ms  rejected  dup dropped\n", "peer link");
+
+    bool clean = true;
+    for (const Case& c : CASES) {
+        Stats total = {};
+        double wsMax = 0, peerMax = 0;
+        for (int run = 0; run < RUNS; run++) {
+            Stats s = simulate(1000u + run * 31u, c.faults);
+            total.switchMs += s.switchMs / RUNS;
+            total.failoverMs += s.failoverMs / RUNS;
+            total.backMs += s.backMs / RUNS;
+            total.lost += s.lost;
+            total.delivered += s.delivered;
+            total.sent += s.sent;
+            total.wsLatencySum += s.wsLatencySum;
+            total.wsCount += s.wsCount;
+            total.peerLatencySum += s.peerLatencySum;
+            total.peerCount += s.peerCount;
+            total.relayLatencyMs += s.relayLatencyMs / RUNS;
+            total.framesRejected += s.framesRejected;
+            total.framesDuplicated += s.framesDuplicated;
+            total.serverDuplicates += s.serverDuplicates;
+            total.serverCorrupt += s.serverCorrupt;
+            wsMax = fmax(wsMax, s.wsLatencyMax);
+            peerMax = fmax(peerMax, s.peerLatencyMax);
+        }
+        bool ok = total.serverDuplicates == 0 && total.serverCorrupt == 0;
+        clean = clean && ok;
+        printf("  %-30s  %9.0f  %11.0f  %7.0f  %4.1f  %5.1f/%3d  %7.1f/%5.0f  %9.1f/%5.0f  %8.1f  %8u  %11u%s\n",
+               c.name, total.switchMs, total.failoverMs, total.backMs, (double)total.lost / RUNS,
+               (double)total.delivered / RUNS, total.sent / RUNS,
+               total.wsCount ? total.wsLatencySum / total.wsCount : 0.0, wsMax,
+               total.peerCount ? total.peerLatencySum / total.peerCount : 0.0, peerMax,
+               total.relayLatencyMs, (unsigned)total.framesRejected, (unsigned)total.framesDuplicated,
+               ok ? "" : "  DUPLICATE OR CORRUPT DELIVERY");
+    }
+    printf("\nlost: splits sent into the silent WebSocket before the switch (LinkSelector::SILENCE_MS %u ms)\n",
+           (unsigned)LinkSelector::SILENCE_MS);
+
+    clean = streamCheck(7) && clean;
+    return clean ? EXIT_SUCCESS : EXIT_FAILURE;
+}
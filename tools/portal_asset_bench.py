@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""
+Captive portal load test: a pool deck of phones joining device hotspots.
+
+Each phone does what a phone does on joining a hotspot. It requests the OS
+probe URLs, gets redirected to the portal, loads the form and the form's
+/settings and /scan requests, and then later opens the portal again. Time to
+first paint is taken from the first probe until the form's last byte (the
+CSS is inline, so the page can be drawn then). The second visit sends the
+ETag back when the server gave one.
+
+Without --url the phones run against a stand-in for the device, once as
+the firmware served the portal before and once as it serves it now:
+
+  before  form sent uncompressed on every load, no ETag, each probe
+          redirect with a text body
+  now     form gzipped at build time (tools/portal_assets.py), ETag
+          revalidation (304), empty redirect body
+
+The stand-in answers one request at a time, as the device's WebServer
+does. Each request costs --request-ms, and the body goes out at
+--link-kbps. Both are estimates for the ESP32 soft AP, so compare the two
+runs with each other rather than with a device. With --url the phones run
+against a real device in setup mode (join its hotspot first).
+
+Usage: portal_asset_bench.py [--phones 10] [--visits 2] [--url http://192.168.4.1]
+"""
+
+import argparse
+import gzip
+import hashlib
+import http.client
+import http.server
+import os
+import statistics
+import threading
+import time
+import urllib.parse
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PROBES = ["/generate_204", "/hotspot-detect.html", "/connecttest.txt", "/canonical.html"]
+
+
+def load_form():
+    with open(os.path.join(ROOT, "portal", "config.html"), encoding="utf-8") as page:
+        raw = page.read()
+    minified = "\n".join(line.strip() for line in raw.splitlines() if line.strip()) + "\n"
+    packed = gzip.compress(minified.encode(), compresslevel=9, mtime=0)
+    return raw.encode(), packed, '"%s"' % hashlib.sha1(packed).hexdigest()[:12]
+
+
+class StandIn(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.0"   # One request per connection, as WebServer answers
+    mode = "now"
+    request_s = 0.003
+    link_bps = 1_000_000
+    form_raw = form_gz = etag = None
+    counter = {"requests": 0, "bytes": 0}
+
+    def log_message(self, *args):
+        pass
+
+    def reply(self, code, headers, body=b""):
+        time.sleep(self.request_s + len(body) * 8 / self.link_bps)
+        self.send_response(code)
+        for name, value in headers:
+            self.send_header(name, value)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+        self.counter["requests"] += 1
+        self.counter["bytes"] += len(body)
+
+    def do_GET(self):
+        path = urllib.parse.urlsplit(self.path).path
+        now = self.mode == "now"
+        if path == "/":
+            if now and self.headers.get("If-None-Match") == self.etag:
+                self.reply(304, [("ETag", self.etag)])
+            elif now:
+                self.reply(200, [("Content-Type", "text/html"), ("Content-Encoding", "gzip"),
+                                 ("Cache-Control", "no-cache"), ("ETag", self.etag)], self.form_gz)
+            else:
+                self.reply(200, [("Content-Type", "text/html")], self.form_raw)
+        elif path == "/settings":
+            self.reply(200, [("Content-Type", "application/json")], b'{"ssid":"","server":"scherm.azckamp.nl"}')
+        elif path == "/scan" and now:
+            self.reply(200, [("Content-Type", "application/json")],
+                       b'{"done":true,"networks":[{"ssid":"Pool","rssi":-52,"secure":true}]}')
+        else:
+            body = b"" if now else b"Redirecting to setup page"
+            self.reply(302, [("Location", "http://192.168.4.1/"), ("Content-Type", "text/plain")], body)
+
+
+def get(host, port, path, headers=None):
+    connection = http.client.HTTPConnection(host, port, timeout=30)
+    try:
+        connection.request("GET", path, headers=headers or {})
+        response = connection.getresponse()
+        body = response.read()
+        return response.status, dict(response.getheaders()), body
+    finally:
+        connection.close()
+
+
+def phone(host, port, visits, paints, errors, lock):
+    etag = None
+    for visit in range(visits):
+        started = time.monotonic()
+        try:
+            for probe in PROBES:
+                get(host, port, probe)
+            headers = {"Accept-Encoding": "gzip"}
+            if etag:
+                headers["If-None-Match"] = etag
+            status, response_headers, _ = get(host, port, "/", headers)
+            painted = time.monotonic() - started
+            etag = response_headers.get("ETag", etag)
+            get(host, port, "/settings")
+            get(host, port, "/scan")
+            with lock:
+                paints[visit].append(painted)
+        except (OSError, http.client.HTTPException):
+            with lock:
+                errors.append(visit)
+
+
+def run_phones(host, port, count, visits):
+    paints = [[] for _ in range(visits)]
+    errors, lock = [], threading.Lock()
+    threads = [threading.Thread(target=phone, args=(host, port, visits, paints, errors, lock))
+               for _ in range(count)]
+    started = time.monotonic()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return time.monotonic() - started, paints, len(errors)
+
+
+def report(label, elapsed, paints, errors, requests, sent):
+    line = f"  {label:7} {requests / elapsed:7.1f} req/s  {elapsed:6.2f} s"
+    for visit, times in enumerate(paints):
+        if times:
+            line += (f"  visit {visit + 1}: paint p50 {statistics.median(times) * 1000:6.0f} ms"
+                     f" max {max(times) * 1000:6.0f} ms")
+    line += f"  {sent / 1024:6.1f} KB sent"
+    if errors:
+        line += f"  {errors} errors"
+    print(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--phones", type=int, default=10)
+    parser.add_argument("--visits", type=int, default=2)
+    parser.add_argument("--request-ms", type=float, default=3.0, help="stand-in cost per request")
+    parser.add_argument("--link-kbps", type=float, default=1000.0, help="stand-in body rate in kbit/s")
+    parser.add_argument("--url", help="run against a device instead, e.g. http://192.168.4.1")
+    args = parser.parse_args()
+
+    print(f"{args.phones} phones, {args.visits} visits each, {len(PROBES)} probes per visit")
+    if args.url:
+        target = urllib.parse.urlsplit(args.url)
+        elapsed, paints, errors = run_phones(target.hostname, target.port or 80, args.phones, args.visits)
+        requests = args.phones * args.visits * (len(PROBES) + 3)
+        report("device", elapsed, paints, errors, requests, 0)
+        return
+
+    StandIn.form_raw, StandIn.form_gz, StandIn.etag = load_form()
+    StandIn.request_s = args.request_ms / 1000
+    StandIn.link_bps = args.link_kbps * 1000
+    print(f"Stand-in: {args.request_ms:g} ms per request, {args.link_kbps:g} kbit/s; "
+          f"form {len(StandIn.form_raw)} bytes, {len(StandIn.form_gz)} gzipped")
+    for mode in ("before", "now"):
+        StandIn.mode = mode
+        StandIn.counter = {"requests": 0, "bytes": 0}
+        server = http.server.HTTPServer(("127.0.0.1", 0), StandIn)
+        serving = threading.Thread(target=server.serve_forever, daemon=True)
+        serving.start()
+        elapsed, paints, errors = run_phones("127.0.0.1", server.server_address[1], args.phones, args.visits)
+        server.shutdown()
+        server.server_close()
+        report(mode, elapsed, paints, errors, StandIn.counter["requests"], StandIn.counter["bytes"])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+Builds include/portal_assets.h from the portal pages in portal/.
+
+Each page has its indentation and blank lines stripped, is gzipped at level
+9 with a fixed timestamp (so the output only changes with the page), and
+becomes a byte array the captive portal sends as it is, with
+Content-Encoding: gzip. The ETag is a hash of the compressed bytes, so a
+browser's cached copy goes stale when the firmware brings a new page.
+
+Runs before every PlatformIO build (extra_scripts in platformio.ini), and
+only rewrites the header when a page changed. It can also be run by hand:
+
+  python3 tools/portal_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+
+# (file in portal/, C name)
+PAGES = [
+    ("config.html", "CONFIG_HTML"),
+    ("success.html", "SUCCESS_HTML"),
+    ("busy.html", "BUSY_HTML"),
+]
+
+
+def minify(text):
+    lines = (line.strip() for line in text.splitlines())
+    return "\n".join(line for line in lines if line) + "\n"
+
+
+def compress(data):
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def build_header(root):
+    out = [
+        "// Generated by tools/portal_assets.py from portal/*.html. Do not edit;",
+        "// edit the page and rebuild (or run the script).",
+        "",
+        "#pragma once",
+        "",
+        "#include <pgmspace.h>",
+        "#include <stddef.h>",
+        "#include <stdint.h>",
+        "",
+    ]
+    for filename, name in PAGES:
+        with open(os.path.join(root, "portal", filename), encoding="utf-8") as page:
+            raw = page.read().encode("utf-8")
+        packed = compress(minify(raw.decode("utf-8")).encode("utf-8"))
+        etag = hashlib.sha1(packed).hexdigest()[:12]
+        out.append(f"// portal/{filename}: {len(raw)} bytes, {len(packed)} gzipped")
+        out.append(f'#define {name}_ETAG "\\"{etag}\\""')
+        out.append(f"const size_t {name}_GZ_LEN = {len(packed)};")
+        out.append(f"const uint8_t {name}_GZ[] PROGMEM = {{")
+        for start in range(0, len(packed), 16):
+            out.append("    " + ", ".join(f"0x{b:02x}" for b in packed[start:start + 16]) + ",")
+        out.append("};")
+        out.append("")
+    return "\n".join(out)
+
+
+def generate(root):
+    target = os.path.join(root, "include", "portal_assets.h")
+    header = build_header(root)
+    try:
+        with open(target, encoding="utf-8") as current:
+            if current.read() == header:
+                return False
+    except FileNotFoundError:
+        pass
+    with open(target, "w", encoding="utf-8") as output:
+        output.write(header)
+    print("portal_assets: wrote include/portal_assets.h")
+    return True
+
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO pre-script)
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+Load client for a device's maintenance portal.
+
+Measures what the portal costs the timing path on real hardware. Two
+windows of the same length run back to back. The first is idle, with only
+a /metrics read at each end. The second requests /status, /metrics and /
+in turn at --rate per second. Press the lap button (or run splits from the
+stand-in server) through both windows, with the heat running.
+
+From the device's /metrics it reports, for each window, the change in:
+  stopwatch_split_latency_us   lap press (ISR) to split recorded
+  stopwatch_loop_busy_us       one main loop pass, without its delay
+  stopwatch_portal_*           portal turns, slice overruns, time spent
+and, for the loaded window, the client's own response times and errors.
+
+Usage: portal_load.py http://192.168.1.53 [--rate 10] [--duration 60]
+"""
+
+import argparse
+import re
+import threading
+import time
+import urllib.error
+import urllib.request
+
+PATHS = ["/status", "/metrics", "/"]
+SAMPLE = re.compile(r'^(\w+?)(?:_bucket\{le="([^"]+)"\})? (\S+)$')
+
+
+def fetch(url, timeout):
+    started = time.monotonic()
+    with urllib.request.urlopen(url, timeout=timeout) as response:
+        body = response.read()
+    return time.monotonic() - started, body
+
+
+def read_metrics(base, timeout):
+    _, body = fetch(base + "/metrics", timeout)
+    metrics, buckets = {}, {}
+    for line in body.decode().splitlines():
+        match = SAMPLE.match(line)
+        if not match:
+            continue
+        name, le, value = match.groups()
+        if le is None:
+            metrics[name] = float(value)
+        else:
+            buckets.setdefault(name, []).append((float("inf") if le == "+Inf" else float(le), float(value)))
+    return metrics, buckets
+
+
+def histogram_delta(before, after, name):
+    """Count, mean and the bucket bound holding the 99th percentile, over a window"""
+    count = after[0].get(name + "_count", 0) - before[0].get(name + "_count", 0)
+    total = after[0].get(name + "_sum", 0) - before[0].get(name + "_sum", 0)
+    if count <= 0:
+        return 0, 0.0, 0.0
+    earlier = dict(before[1].get(name, []))
+    p99 = float("inf")
+    for le, cumulative in after[1].get(name, []):
+        if cumulative - earlier.get(le, 0) >= 0.99 * count:
+            p99 = le
+            break
+    return int(count), total / count, p99
+
+
+def run_load(base, rate, duration, timeout):
+    """Open loop: a request every 1/rate s, each on its own thread"""
+    results, lock, threads = [], threading.Lock(), []
+
+    def one(path):
+        try:
+            elapsed, _ = fetch(base + path, timeout)
+            outcome = (path, elapsed, None)
+        except (urllib.error.URLError, OSError) as error:
+            outcome = (path, None, str(error))
+        with lock:
+            results.append(outcome)
+
+    start = time.monotonic()
+    for index in range(int(rate * duration)):
+        delay = start + index / rate - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        thread = threading.Thread(target=one, args=(PATHS[index % len(PATHS)],), daemon=True)
+        thread.start()
+        threads.append(thread)
+    for thread in threads:
+        thread.join(timeout + 1)
+    return results
+
+
+def report_window(label, before, after, seconds):
+    print(f"{label} ({seconds:.0f} s)")
+    for name in ("stopwatch_split_latency_us", "stopwatch_loop_busy_us"):
+        count, mean, p99 = histogram_delta(before, after, name)
+        p99_text = "-" if count == 0 else ("> 32768" if p99 == float("inf") else f"<= {p99:.0f}")
+        print(f"  {name:28} n={count:<6} mean {mean / 1000:7.2f} ms  p99 {p99_text} us")
+    for name in ("stopwatch_portal_services_total", "stopwatch_portal_overruns_total",
+                 "stopwatch_portal_service_us_total"):
+        print(f"  {name:36} +{after[0].get(name, 0) - before[0].get(name, 0):.0f}")
+    print(f"  {'stopwatch_portal_service_max_us':36} {after[0].get('stopwatch_portal_service_max_us', 0):.0f} (since boot)")
+    print(f"  {'stopwatch_loop_busy_max_us':36} {after[0].get('stopwatch_loop_busy_max_us', 0):.0f} (since boot)")
+    if not after[0].get("stopwatch_timing_active"):
+        print("  note: no heat running at the end of the window")
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[int(fraction * (len(ordered) - 1))] if ordered else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("url", help="device base URL, e.g. http://192.168.1.53")
+    parser.add_argument("--rate", type=float, default=10.0, help="requests per second in the loaded window")
+    parser.add_argument("--duration", type=float, default=60.0, help="length of each window in seconds")
+    parser.add_argument("--timeout", type=float, default=5.0, help="client timeout per request in seconds")
+    args = parser.parse_args()
+    base = args.url.rstrip("/")
+
+    print(f"Idle window: press the lap button for {args.duration:.0f} s")
+    idle_before = read_metrics(base, args.timeout)
+    time.sleep(args.duration)
+    idle_after = read_metrics(base, args.timeout)
+
+    print(f"Loaded window: {args.rate:g} requests/s, keep pressing")
+    results = run_load(base, args.rate, args.duration, args.timeout)
+    loaded_after = read_metrics(base, args.timeout)
+
+    print()
+    report_window("Idle", idle_before, idle_after, args.duration)
+    report_window("Loaded", idle_after, loaded_after, args.duration)
+
+    print("Client")
+    for path in PATHS:
+        times = [elapsed for p, elapsed, _ in results if p == path and elapsed is not None]
+        errors = sum(1 for p, _, error in results if p == path and error)
+        print(f"  {path:9} ok {len(times):5}  errors {errors:4}  "
+              f"p50 {percentile(times, 0.5) * 1000:7.1f} ms  p99 {percentile(times, 0.99) * 1000:7.1f} ms")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,194 @@
+// Maintenance portal vs. split latency (include/portal_scheduler.h), run on the host.
+//
+// A lane device times a heat while a host client loads its maintenance
+// portal. The main loop is modelled pass by pass, as in normalMode():
+// button events first, then 0.3-0.9 ms of other work, then the portal, then
+// delay(10). A split is recorded when the pass after the press reaches the
+// button handler, so its latency is the rest of the pass it landed in plus
+// the delay. One WebServer::handleClient() call answers at most one request,
+// and this model prices the requests:
+//
+//   /status 2 ms, /metrics 3 ms, /settings 2 ms, the setup form 25 ms and
+//   the short page served instead of it during a heat 1 ms; one request in
+//   20 comes from a slow client and takes 15 ms more
+//
+// The client asks for /status, /metrics and / in turn, at 2-30 requests per
+// second, and gives up on a request after 5 s. Each load runs three ways:
+// without a portal, with the portal serviced on every pass (the way the
+// setup portal ran before), and through the firmware's PortalScheduler.
+// For each, the tool reports split latency percentiles, the longest loop
+// pass, and what the client got: responses per second, median wait and
+// timeouts.
+//
+//   g++ -O2 -Iinclude src/portal_scheduler.cpp tools/portal_slice_sim.cpp -o portal_slice_sim
+//   ./portal_slice_sim
+//
+// Exits non-zero if the scheduled portal delays a split by more than one
+// in-heat request beyond the loop without a portal, or if its p99 is not
+// below that of the portal serviced on every pass.
+
+#include "portal_scheduler.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+static const uint32_t RUN_US = 600000000;       // 10 min of heat
+static const uint32_t LOOP_DELAY_US = 10000;    // delay(10)
+static const uint32_t PRESS_GAP_MIN_US = 300000; // Lap debounce
+static const uint32_t CLIENT_TIMEOUT_US = 5000000;
+static const uint32_t SLOW_CLIENT_US = 15000;
+static const uint32_t IDLE_POLL_US = 40;        // handleClient() and DNS with nothing waiting
+
+enum PortalMode {
+    PORTAL_NONE,
+    PORTAL_EVERY_PASS,
+    PORTAL_SCHEDULED
+};
+
+struct Rng {
+    uint32_t state;
+
+    uint32_t next(uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    }
+
+    // Exponential gap for a Poisson process (mean in µs)
+    uint32_t gap(uint32_t meanUs) {
+        uint32_t u = next(1000000) + 1;
+        double x = -((double)meanUs) * log(u / 1000000.0);
+        return x < 1 ? 1 : (uint32_t)x;
+    }
+};
+
+struct Request {
+    uint32_t arrivalUs;
+    uint8_t page;   // 0 /status, 1 /metrics, 2 /
+    bool slow;
+};
+
+struct Result {
+    std::vector<uint32_t> splitUs;
+    std::vector<uint32_t> waitUs;
+    uint32_t loopMaxUs = 0;
+    uint32_t served = 0;
+    uint32_t timeouts = 0;
+    uint32_t serviceMaxUs = 0;
+};
+
+static uint32_t requestCostUs(const Request& request, bool heatRunning, bool shortPageInHeat) {
+    static const uint32_t PAGE_US[] = {2000, 3000, 25000};
+    uint32_t cost = PAGE_US[request.page];
+    if (request.page == 2 && heatRunning && shortPageInHeat) {
+        cost = 1000;
+    }
+    return cost + (request.slow ? SLOW_CLIENT_US : 0);
+}
+
+static Result simulate(PortalMode mode, uint32_t requestsPerS, uint32_t seed) {
+    Rng rng = {seed};
+    Result result;
+    PortalScheduler scheduler;
+    std::vector<Request> queue;
+    size_t head = 0;
+    uint8_t nextPage = 0;
+
+    uint32_t nextArrivalUs = requestsPerS ? rng.gap(1000000 / requestsPerS) : RUN_US;
+    uint32_t nextPressUs = PRESS_GAP_MIN_US + rng.gap(300000);
+    std::vector<uint32_t> pending;  // Presses not yet seen by the loop
+
+    uint32_t now = 0;
+    while (now < RUN_US) {
+        // Button events: everything pressed up to now becomes a split
+        while (nextPressUs <= now) {
+            pending.push_back(nextPressUs);
+            nextPressUs += PRESS_GAP_MIN_US + rng.gap(300000);
+        }
+        for (uint32_t pressUs : pending) {
+            result.splitUs.push_back(now - pressUs);
+        }
+        pending.clear();
+
+        uint32_t passStart = now;
+        now += 300 + rng.next(600);
+
+        if (mode != PORTAL_NONE && (mode == PORTAL_EVERY_PASS || scheduler.due(now))) {
+            // The client's requests up to now are waiting for the server
+            while (nextArrivalUs <= now) {
+                Request request = {nextArrivalUs, nextPage, rng.next(20) == 0};
+                nextPage = (nextPage + 1) % 3;
+                queue.push_back(request);
+                nextArrivalUs += rng.gap(1000000 / requestsPerS);
+            }
+            while (head < queue.size() && now - queue[head].arrivalUs > CLIENT_TIMEOUT_US) {
+                result.timeouts++;
+                head++;
+            }
+
+            uint32_t startUs = now;
+            if (head < queue.size()) {
+                const Request& request = queue[head++];
+                now += requestCostUs(request, true, mode == PORTAL_SCHEDULED);
+                result.served++;
+                result.waitUs.push_back(now - request.arrivalUs);
+            } else {
+                now += IDLE_POLL_US;
+            }
+            result.serviceMaxUs = std::max(result.serviceMaxUs, now - startUs);
+            if (mode == PORTAL_SCHEDULED) {
+                scheduler.serviced(startUs, now, true);
+            }
+        }
+
+        result.loopMaxUs = std::max(result.loopMaxUs, now - passStart);
+        now += LOOP_DELAY_US;
+    }
+    return result;
+}
+
+static uint32_t percentile(std::vector<uint32_t>& values, double fraction) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(fraction * (values.size() - 1));
+    return values[index];
+}
+
+int main() {
+    static const uint32_t LOADS[] = {0, 2, 10, 30};
+    static const char* MODE_NAMES[] = {"no portal", "every pass", "scheduled"};
+    bool ok = true;
+
+    printf("Heat running, 10 min, lap presses about 1.7/s; split latency is press to split recorded\n");
+    printf("  %5s  %-10s  %8s  %8s  %8s  %9s  %8s  %9s  %8s\n", "req/s", "portal", "p50 ms", "p99 ms",
+           "max ms", "pass max", "served/s", "wait p50", "timeouts");
+
+    for (uint32_t load : LOADS) {
+        Result results[3];
+        for (int mode = PORTAL_NONE; mode <= PORTAL_SCHEDULED; mode++) {
+            Result& r = results[mode];
+            r = simulate((PortalMode)mode, load, 12345u + load);
+            printf("  %5u  %-10s  %8.2f  %8.2f  %8.2f  %7.2f ms  %8.2f  %6.0f ms  %8u\n", (unsigned)load,
+                   MODE_NAMES[mode], percentile(r.splitUs, 0.5) / 1000.0, percentile(r.splitUs, 0.99) / 1000.0,
+                   percentile(r.splitUs, 1.0) / 1000.0, r.loopMaxUs / 1000.0, r.served / (RUN_US / 1e6),
+                   percentile(r.waitUs, 0.5) / 1000.0, (unsigned)r.timeouts);
+        }
+
+        // One in-heat request (the slowest: /metrics from a slow client) beyond the bare loop
+        uint32_t bound = percentile(results[PORTAL_NONE].splitUs, 1.0) + 3000 + SLOW_CLIENT_US;
+        uint32_t scheduledMax = percentile(results[PORTAL_SCHEDULED].splitUs, 1.0);
+        uint32_t scheduledP99 = percentile(results[PORTAL_SCHEDULED].splitUs, 0.99);
+        uint32_t everyPassP99 = percentile(results[PORTAL_EVERY_PASS].splitUs, 0.99);
+        if (scheduledMax > bound || (load > 0 && scheduledP99 >= everyPassP99)) {
+            printf("  FAIL: scheduled max %.2f ms (bound %.2f ms), p99 %.2f ms vs %.2f ms every pass\n",
+                   scheduledMax / 1000.0, bound / 1000.0, scheduledP99 / 1000.0, everyPassP99 / 1000.0);
+            ok = false;
+        }
+    }
+
+    printf("%s\n", ok ? "OK: the scheduled portal adds at most one in-heat request to a split" : "FAIL");
+    return ok ? 0 : 1;
+}
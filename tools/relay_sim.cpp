@@ -0,0 +1,209 @@
+// Relay takeoff judge (include/relay_judge.h), run on the host.
+//
+// Each heat is a 4-leg relay seen by the start end's device: the touch pad
+// edges (turn touches at this end included) and the block switch. The
+// lead-off swimmer starts from the block. Before each exchange the next
+// swimmer steps up 3-15 s ahead of the touch, and leaves at a margin drawn
+// from club relays: most 0.05-0.6 s after the touch, one in ten early (up
+// to 0.3 s before it), some right at the 30 ms tolerance. The edges are
+// then made the way the hardware makes them: the switch bounces up to four
+// times within 8 ms on release and within 20 ms on stepping up, the pad
+// chatters up to twice within 50 ms, and every edge is stamped 2-15 us
+// late (one in 100 by 60 us, another interrupt running first). One touch
+// in 50 is too soft for the pad, which leaves its release without a touch.
+// The sorted edge stream goes through the firmware's RelayJudge.
+//
+// Each exchange's verdict and margin are compared with the truth.
+//
+//   g++ -O2 -Iinclude src/relay_judge.cpp tools/relay_sim.cpp -o relay_sim
+//   ./relay_sim
+//
+// Exits non-zero on a missing, extra or wrongly judged exchange (margins
+// within 100 us of the tolerance may go either way), or a margin more than
+// 100 us off.
+
+#include "relay_judge.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const int HEATS = 2000;
+static const int LEGS = 4;
+static const uint32_t TOLERANCE_US = 30000;
+static const uint32_t MISS_ONE_IN = 50;
+
+struct Rng {
+    uint64_t state;
+
+    uint32_t next() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (uint32_t)(state >> 33);
+    }
+
+    double uniform() { return (next() + 0.5) / 2147483648.0; }
+
+    double range(double lo, double hi) { return lo + (hi - lo) * uniform(); }
+};
+
+struct Race {
+    const char* name;
+    int legM;
+    int poolM;
+    double legS;        // Typical leg time
+};
+
+static const Race RACES[] = {
+    {"4x50 m, 50 m pool", 50, 50, 30.0},
+    {"4x100 m, 25 m pool", 100, 25, 65.0},
+    {"4x100 m, 50 m pool", 100, 50, 65.0},
+    {"4x200 m, 25 m pool", 200, 25, 140.0},
+};
+
+struct Truth {
+    bool touched;       // The pad registered the touch
+    double marginUs;
+};
+
+struct Tally {
+    uint64_t exchanges = 0;
+    uint64_t wrong = 0;         // Missing, extra or wrong verdict
+    uint64_t early = 0;
+    uint64_t noTouch = 0;
+    double worstErrorUs = 0;
+    uint64_t edges = 0;
+    uint64_t edgeNs = 0;
+};
+
+// Stamped the way the interrupt sees it
+static uint32_t stamp(Rng& rng, double us) {
+    double late = rng.next() % 100 == 0 ? 60.0 : rng.range(2.0, 15.0);
+    return (uint32_t)(int64_t)(us + late);
+}
+
+static void bounce(Rng& rng, std::vector<RelayEdge>& edges, double atUs, RelayEdgeKind settled, double withinUs) {
+    // Up to four extra edges, ending in the settled state
+    int extra = (rng.next() % 3) * 2;
+    RelayEdgeKind other = settled == RELAY_BLOCK_OFF ? RELAY_BLOCK_ON : RELAY_BLOCK_OFF;
+    double t = atUs;
+    edges.push_back({stamp(rng, t), settled});
+    for (int i = 0; i < extra; i++) {
+        t += rng.range(100.0, withinUs / extra);
+        edges.push_back({stamp(rng, t), i % 2 == 0 ? other : settled});
+    }
+}
+
+static void heat(Rng& rng, const Race& race, uint32_t baseUs, Tally& tally) {
+    std::vector<RelayEdge> edges;
+    std::vector<Truth> truth;
+    double startUs = baseUs;
+    double t = startUs;
+
+    // Lead-off: on the block at the start, leaves at the signal
+    bounce(rng, edges, startUs + rng.range(600e3, 900e3), RELAY_BLOCK_OFF, 8000);
+
+    for (int leg = 1; leg <= LEGS; leg++) {
+        double legUs = race.legS * 1e6 * rng.range(0.95, 1.05);
+        int lengths = race.legM / race.poolM;
+        // Turn touches at this end (every second length), then the finish of the leg
+        for (int length = 2; length < lengths; length += 2) {
+            double turn = t + legUs * length / lengths;
+            edges.push_back({stamp(rng, turn), RELAY_TOUCH});
+        }
+        double touchUs = t + legUs;
+        bool touched = rng.next() % MISS_ONE_IN != 0;
+        if (touched) {
+            edges.push_back({stamp(rng, touchUs), RELAY_TOUCH});
+            int chatter = rng.next() % 3;
+            for (int i = 0; i < chatter; i++) {
+                edges.push_back({stamp(rng, touchUs + rng.range(1e3, 50e3)), RELAY_TOUCH});
+            }
+        }
+        if (leg == LEGS) {
+            break;
+        }
+        // The next swimmer steps up, then leaves
+        bounce(rng, edges, touchUs - rng.range(3e6, 15e6), RELAY_BLOCK_ON, 20000);
+        double margin;
+        uint32_t kind = rng.next() % 20;
+        if (kind < 2) {
+            margin = rng.range(-300e3, -40e3);
+        } else if (kind < 4) {
+            margin = rng.range(-60e3, 0);
+        } else {
+            margin = rng.range(50e3, 600e3);
+        }
+        bounce(rng, edges, touchUs + margin, RELAY_BLOCK_OFF, 8000);
+        truth.push_back({touched, margin});
+        t = touchUs;
+    }
+    std::stable_sort(edges.begin(), edges.end(),
+                     [&](const RelayEdge& a, const RelayEdge& b) { return (int32_t)(a.us - b.us) < 0; });
+
+    RelayJudge judge;
+    judge.begin((uint32_t)startUs, TOLERANCE_US, true);
+    for (const RelayEdge& edge : edges) {
+        auto t0 = std::chrono::steady_clock::now();
+        judge.addEdge(edge);
+        auto t1 = std::chrono::steady_clock::now();
+        tally.edgeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        tally.edges++;
+    }
+    judge.poll(edges.back().us + 2 * RelayJudge::EARLY_WINDOW_US);
+
+    // The firmware's verdicts
+    tally.exchanges += truth.size();
+    if (judge.getExchangeCount() != truth.size()) {
+        tally.wrong += truth.size();
+    } else {
+        for (size_t i = 0; i < truth.size(); i++) {
+            const RelayExchange& exchange = judge.getExchange(i + 1);
+            const Truth& real = truth[i];
+            if (!real.touched) {
+                tally.noTouch++;
+                tally.wrong += exchange.verdict != RELAY_NO_TOUCH;
+                continue;
+            }
+            double error = fabs(exchange.marginUs - real.marginUs);
+            tally.worstErrorUs = std::max(tally.worstErrorUs, error);
+            bool early = real.marginUs < -(double)TOLERANCE_US;
+            tally.early += early;
+            bool borderline = fabs(real.marginUs + TOLERANCE_US) <= 100;
+            if (exchange.verdict == RELAY_NO_TOUCH || error > 100 ||
+                (!borderline && (exchange.verdict == RELAY_EARLY) != early)) {
+                tally.wrong++;
+            }
+        }
+    }
+}
+
+int main() {
+    Rng rng = {0x4e1a7ULL};
+    bool ok = true;
+    Tally total;
+
+    printf("%d heats per race, tolerance %u ms, 1 touch in %u too soft for the pad\n", HEATS,
+           (unsigned)(TOLERANCE_US / 1000), (unsigned)MISS_ONE_IN);
+    printf("  %-20s  %9s  %6s  %8s  %7s  %11s\n", "", "exchanges", "early", "no touch", "wrong",
+           "worst error");
+    for (const Race& race : RACES) {
+        Tally tally;
+        for (int i = 0; i < HEATS; i++) {
+            // Start anywhere on the micros() clock, wrap included
+            heat(rng, race, rng.next() * 2u, tally);
+        }
+        printf("  %-20s  %9llu  %6llu  %8llu  %7llu  %8.0f us\n", race.name,
+               (unsigned long long)tally.exchanges, (unsigned long long)tally.early,
+               (unsigned long long)tally.noTouch, (unsigned long long)tally.wrong, tally.worstErrorUs);
+        ok = ok && tally.wrong == 0 && tally.worstErrorUs <= 100;
+        total.edges += tally.edges;
+        total.edgeNs += tally.edgeNs;
+    }
+    printf("Per edge: %.0f ns\n", (double)total.edgeNs / total.edges);
+
+    printf("%s\n", ok ? "OK: every exchange paired and judged" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+// Lap pace sparkline (include/lap_sparkline.h), rendered on the host.
+//
+// The widget draws into a 320x170 RGB565 framebuffer at the device's
+// position (the bottom strip of the lane display). The race is a 1500 m
+// split at every length of a 25 m pool, 60 laps: a 14 s dive length, then
+// 17 s lengths with noise that fade by 0.6 s and pick up 1 s over the last
+// 100 m. Lap 41 is a missed touch (two lengths in one split), which forces
+// a rescale. Lap 20 is undone and touched again. The same laps are also
+// run for a 90-lap heat (the stopwatch's maximum), where the widget fills
+// up and starts again from the newest half.
+//
+// After every update the framebuffer is compared with a from-scratch render
+// of the same laps at the widget's scale. The tool counts fillRect calls
+// and pixels written per lap, and compares them with redrawing the whole
+// widget for every lap.
+//
+//   g++ -O2 -Iinclude src/lap_sparkline.cpp tools/sparkline_bench.cpp -o sparkline_bench
+//   ./sparkline_bench
+//
+// Exits non-zero if the framebuffer ever differs from the reference, if
+// the 1500 m writes more than a quarter of the pixels of full redraws, or
+// if it rescales more than 6 times.
+
+#include "lap_sparkline.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static const int FB_WIDTH = 320;
+static const int FB_HEIGHT = 170;
+static const int16_t WIDGET_X = 0;
+static const int16_t WIDGET_Y = 142;
+static const int16_t WIDGET_W = 240;
+static const int16_t WIDGET_H = 26;
+
+struct Rng {
+    uint64_t state;
+
+    uint32_t next() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (uint32_t)(state >> 33);
+    }
+
+    double uniform() { return (next() + 0.5) / 2147483648.0; }
+
+    double gauss() { return sqrt(-2.0 * log(uniform())) * cos(6.283185307179586 * uniform()); }
+};
+
+// Same layout as the firmware's LapData: the widget reads lapTimeMs in place
+struct Lap {
+    uint32_t lapTimeMs;
+    uint32_t totalTimeMs;
+    uint64_t serverTimestamp;
+    uint16_t uncertaintyMs;
+    uint8_t syncQuality;
+    uint32_t splitId;
+};
+
+class FrameBuffer : public SparkCanvas {
+public:
+    uint16_t pixels[FB_WIDTH * FB_HEIGHT];
+    uint32_t calls = 0;
+    uint64_t written = 0;
+
+    FrameBuffer() { clear(); }
+
+    void clear() { memset(pixels, 0, sizeof(pixels)); }
+
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+        calls++;
+        for (int16_t row = y; row < y + h; row++) {
+            for (int16_t col = x; col < x + w; col++) {
+                if (row >= 0 && row < FB_HEIGHT && col >= 0 && col < FB_WIDTH) {
+                    pixels[row * FB_WIDTH + col] = color;
+                    written++;
+                }
+            }
+        }
+    }
+};
+
+// What the widget should show: laps first..count-1 at its current scale
+static void reference(FrameBuffer& fb, const LapSparkline& widget, const Lap* laps, uint8_t count) {
+    fb.clear();
+    uint8_t first = count - widget.getColumns();
+    for (uint8_t i = first; i < count; i++) {
+        uint16_t color = i == 0 ? LapSparkline::COLOR_DIVE
+                       : i == count - 1 ? LapSparkline::COLOR_NEWEST : LapSparkline::COLOR_BAR;
+        uint8_t h = widget.barHeight(laps[i].lapTimeMs);
+        fb.fillRect(WIDGET_X + (i - first) * LapSparkline::COLUMN_PITCH, WIDGET_Y + WIDGET_H - h,
+                    LapSparkline::COLUMN_PITCH - 1, h, color);
+    }
+}
+
+// The whole widget for every lap: clear, then every bar
+static uint64_t fullRedrawPixels(uint8_t count, const LapSparkline& widget, const Lap* laps) {
+    FrameBuffer fb;
+    fb.fillRect(WIDGET_X, WIDGET_Y, WIDGET_W, WIDGET_H, 0);
+    uint8_t first = count - widget.getColumns();
+    for (uint8_t i = first; i < count; i++) {
+        uint8_t h = widget.barHeight(laps[i].lapTimeMs);
+        fb.fillRect(0, WIDGET_Y + WIDGET_H - h, LapSparkline::COLUMN_PITCH - 1, h, 0);
+    }
+    return fb.written;
+}
+
+static std::vector<Lap> race(Rng& rng, int laps) {
+    std::vector<Lap> out;
+    uint32_t total = 0;
+    for (int i = 0; i < laps; i++) {
+        double s = i == 0 ? 14.0 : 17.0 + 0.6 * i / laps + 0.25 * rng.gauss();
+        if (i >= laps - 4) {
+            s -= 1.0;
+        }
+        if (i == 40) {
+            s *= 2; // Missed touch: two lengths in one split
+        }
+        uint32_t ms = (uint32_t)(s * 1000);
+        total += ms;
+        out.push_back({ms, total, 0, 0, 0, (uint32_t)i + 1});
+    }
+    return out;
+}
+
+struct Result {
+    bool matches = true;
+    uint64_t pixels = 0;
+    uint64_t fullPixels = 0;
+    uint32_t calls = 0;
+    uint32_t worstCalls = 0;
+    uint64_t worstPixels = 0;
+    uint64_t ns = 0;
+    uint32_t updates = 0;
+    uint16_t rescales = 0;
+};
+
+static void step(LapSparkline& widget, FrameBuffer& fb, FrameBuffer& expected, const Lap* laps, uint8_t count,
+                 Result& result) {
+    uint32_t calls = fb.calls;
+    uint64_t written = fb.written;
+    auto t0 = std::chrono::steady_clock::now();
+    widget.update(fb, laps, count);
+    auto t1 = std::chrono::steady_clock::now();
+    result.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    result.updates++;
+    uint32_t stepCalls = fb.calls - calls;
+    uint64_t stepPixels = fb.written - written;
+    result.calls += stepCalls;
+    result.pixels += stepPixels;
+    result.worstCalls = stepCalls > result.worstCalls ? stepCalls : result.worstCalls;
+    result.worstPixels = stepPixels > result.worstPixels ? stepPixels : result.worstPixels;
+    result.fullPixels += fullRedrawPixels(count, widget, laps);
+
+    reference(expected, widget, laps, count);
+    if (memcmp(fb.pixels, expected.pixels, sizeof(fb.pixels)) != 0) {
+        if (result.matches) {
+            printf("  framebuffer differs from the reference at %u laps\n", count);
+        }
+        result.matches = false;
+    }
+}
+
+static Result run(Rng& rng, int laps) {
+    static FrameBuffer fb, expected;
+    fb.clear();
+    std::vector<Lap> heat = race(rng, laps);
+    LapSparkline widget;
+    widget.begin(WIDGET_X, WIDGET_Y, WIDGET_W, WIDGET_H);
+    Result result;
+    for (int count = 1; count <= laps; count++) {
+        step(widget, fb, expected, heat.data(), count, result);
+        if (count == 20) {
+            // Undo and touch again
+            step(widget, fb, expected, heat.data(), count - 1, result);
+            step(widget, fb, expected, heat.data(), count, result);
+        }
+    }
+    result.rescales = widget.getRescales();
+    // Next heat: the widget clears
+    step(widget, fb, expected, heat.data(), 0, result);
+    return result;
+}
+
+static void print(const char* name, const Result& r) {
+    printf("  %-16s  %7u  %8.1f  %6u  %9.0f  %9llu  %10.0f  %7.1f%%  %4u  %6.0f ns\n", name, r.updates,
+           (double)r.calls / r.updates, r.worstCalls, (double)r.pixels / r.updates,
+           (unsigned long long)r.worstPixels, (double)r.fullPixels / r.updates, 100.0 * r.pixels / r.fullPixels,
+           r.rescales, (double)r.ns / r.updates);
+}
+
+int main() {
+    Rng rng = {0x5a4c1e5ULL};
+    printf("Widget %dx%d at y=%d, %u px per column\n", WIDGET_W, WIDGET_H, WIDGET_Y, LapSparkline::COLUMN_PITCH);
+    printf("  %-16s  %7s  %8s  %6s  %9s  %9s  %10s  %8s  %4s  %9s\n", "", "updates", "rects", "worst",
+           "pixels", "worst", "full redraw", "of full", "resc", "per update");
+    Result r1500 = run(rng, 60);
+    print("1500 m, 60 laps", r1500);
+    Result r90 = run(rng, 90);
+    print("90 laps", r90);
+
+    bool ok = r1500.matches && r90.matches && r1500.pixels * 4 <= r1500.fullPixels && r1500.rescales <= 6;
+    printf("%s\n", ok ? "OK: incremental rendering matches the reference" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,546 @@
+#!/usr/bin/env python3
+"""
+Local stand-in for the SwimWatch WebSocket server.
+
+Speaks the device protocol (see src/main.cpp header) well enough to run a
+pool of lane devices and a starter on a laptop without the production
+server:
+  - ping -> pong with server_time (ms since epoch)
+  - start / reset / split / event-heat relayed to connected devices
+  - subscribe: per-connection type and lane filter applied to the fan-out
+  - every broadcast carries "seq"; a subscribe with "last_seq"/"epoch" gets
+    the missed messages replayed from a short history, or a compact snapshot
+    when the gap is too large or the device saw another server run
+  - with --udp-key: start/reset are also sent as one signed multicast
+    datagram (same seq) ahead of the WebSocket fan-out
+  - split / split-undo: acknowledged to the sender with split-ack, keyed by
+    (device, start_timestamp, id) and applied once: a retransmitted split is
+    only acknowledged again, and an undo leaves a tombstone, so a copy of
+    the split that arrives after it stays retracted
+  - status: per-device sync reports relayed to subscribers (the starter's
+    readiness grid), without seq and not kept for replay
+  - presence: the lane roster kept from those reports and the connections.
+    A client that subscribes to "presence" gets every lane once, then one
+    message per change with only the fields that changed, and no status
+    relay. A lane goes offline when its connection closes or its reports
+    stop for 25 s
+  - relay: a lane's judged relay exchange, broadcast to clients that
+    subscribe to it (a referee's PC); early takeoffs are printed
+  - audit: probes every device for its synchronized time and brackets the
+    answer between send and receive, giving each device's actual offset
+    error and the dispersion across the pool
+
+Every message in and out is appended to the log as one JSON line with "t"
+(server ms) and "dir", which tools/trace_merge.py reads as the server track.
+
+Console commands (with --console): start [event heat], reset,
+event <event> <heat> [distance], clear, trace, stats, audit, roster
+
+The event's distance in metres, when given, goes out as "distance" with
+start, event-heat and snapshot (the lanes' distance event lap counter).
+
+Requires: pip install "websockets>=13"
+"""
+
+import argparse
+import asyncio
+import hashlib
+import hmac
+import json
+import socket
+import sys
+import time
+from collections import deque
+
+from websockets.asyncio.server import serve
+from websockets.exceptions import ConnectionClosed
+
+# Message types addressed to one lane; filtered by the subscriber's lane list
+LANE_ADDRESSED = {"split", "split-undo", "relay"}
+
+# Lane roster (see include/lane_readiness.h): uncertainty rounded up and
+# battery rounded to steps, so report-to-report jitter is not a change
+PRESENCE_STALE_S = 25.0
+PRESENCE_UNCERTAINTY_STEP_MS = 5
+PRESENCE_BATTERY_STEP = 10
+
+# Broadcasts kept for replay on resume; older gaps get a snapshot instead
+HISTORY_LENGTH = 64
+
+# Fast path datagrams (see include/udp_fast_path.h)
+FAST_PATH_GROUP = "239.255.47.1"
+FAST_PATH_PORT = 47000
+FAST_PATH_MAGIC = b"SWF1"
+FAST_PATH_TAG_LENGTH = 16
+
+
+def now_ms():
+    return int(time.time() * 1000)
+
+
+def format_time(ms):
+    ms = max(0, int(ms))
+    return "%02d:%02d:%02d" % (ms // 60000, (ms // 1000) % 60, (ms % 1000) // 10)
+
+
+def sign_datagram(key, msg):
+    body = json.dumps(msg, separators=(",", ":")).encode()
+    tag = hmac.new(key, body, hashlib.sha256).digest()[:FAST_PATH_TAG_LENGTH]
+    return FAST_PATH_MAGIC + tag + body
+
+
+class FastPath:
+    """Signed start/reset datagrams to the lane multicast group."""
+
+    def __init__(self, key, group=FAST_PATH_GROUP, port=FAST_PATH_PORT, interface="0.0.0.0"):
+        self.key = key.encode() if isinstance(key, str) else key
+        self.target = (group, port)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 1)
+        self.sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+        if interface != "0.0.0.0":
+            self.sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_IF, socket.inet_aton(interface))
+        self.sent = 0
+
+    def send(self, msg):
+        self.sock.sendto(sign_datagram(self.key, msg), self.target)
+        self.sent += 1
+
+
+class Presence:
+    """Per-lane roster: what the starter shows, and the delta for each change."""
+
+    def __init__(self, stale_s=PRESENCE_STALE_S):
+        self.stale_s = stale_s
+        self.lanes = {}      # lane -> {"online", "sync", "uncertainty_ms", "battery"}
+        self.reported = {}   # lane -> time.monotonic() of its last report
+
+    @staticmethod
+    def fields(status):
+        sync = status.get("sync", "none")
+        bound = status.get("uncertainty_ms")
+        battery = status.get("battery")
+        step = PRESENCE_UNCERTAINTY_STEP_MS
+        return {"online": True, "sync": sync,
+                "uncertainty_ms": -(-int(bound) // step) * step if sync != "none" and bound is not None else None,
+                "battery": int(battery) // PRESENCE_BATTERY_STEP * PRESENCE_BATTERY_STEP
+                if battery is not None else None}
+
+    def message(self, lane, fields):
+        msg = {"type": "presence", "lane": lane}
+        msg.update((k, v) for k, v in fields.items() if v is not None)
+        return msg
+
+    def update(self, lane, fields):
+        """Applies fields; returns the presence delta, or None if nothing shows a change."""
+        known = self.lanes.setdefault(lane, {})
+        changed = {k: v for k, v in fields.items() if known.get(k) != v}
+        known.update(changed)
+        # A field that went away (uncertainty when sync is lost) needs no message
+        if not any(v is not None for v in changed.values()):
+            return None
+        return self.message(lane, changed)
+
+    def report(self, lane, status):
+        self.reported[lane] = time.monotonic()
+        return self.update(lane, self.fields(status))
+
+    def offline(self, lane):
+        return self.update(lane, {"online": False}) if lane in self.lanes else None
+
+    def stale(self):
+        """Lanes still online whose reports stopped."""
+        now = time.monotonic()
+        return [lane for lane, fields in self.lanes.items()
+                if fields.get("online") and now - self.reported.get(lane, now) >= self.stale_s]
+
+    def roster(self):
+        return [self.message(lane, fields) for lane, fields in sorted(self.lanes.items())]
+
+
+class Client:
+    def __init__(self, ws, name):
+        self.ws = ws
+        self.name = name
+        self.types = None   # None: legacy client, receives everything
+        self.lanes = None   # None: all lanes
+        self.awaiting_resume = False  # Live fan-out held until the replay is done
+        self.status = None  # Last sync status report
+        self.presence_lane = None  # Lane whose roster entry this connection keeps online
+        self.probe = None   # (probe id, future) while an audit waits for this client
+        self.sent_frames = 0
+        self.sent_bytes = 0
+
+    def wants(self, msg):
+        if self.types is not None and msg["type"] not in self.types:
+            return False
+        if msg["type"] == "status" and self.types is not None and "presence" in self.types:
+            return False  # Has the roster instead
+        if msg["type"] in LANE_ADDRESSED and self.lanes is not None:
+            return msg.get("lane") in self.lanes
+        return True
+
+
+class Hub:
+    def __init__(self, log=None, history_length=HISTORY_LENGTH, fast_path=None, send_delay_s=0.0):
+        self.clients = set()
+        self.log = log
+        self.fast_path = fast_path
+        self.send_delay_s = send_delay_s  # Simulated per-client TLS record write cost
+        self.next_client = 1
+        self.running = False
+        self.start_ts = 0
+        self.event = "1"
+        self.heat = "1"
+        self.distance = 0   # Metres, 0 = not in the program
+        self.epoch = int(time.time()) & 0x7FFFFFFF  # Identifies this server run
+        self.seq = 0
+        self.reset_seq = 0
+        self.history = deque(maxlen=history_length)
+        self.replayed = 0
+        self.snapshots = 0
+        self.probe_id = 0
+        self.splits = {}  # (device, start_timestamp, id) -> "split" or "undone"
+        self.duplicate_splits = 0
+        self.presence = Presence()
+
+    # ----- transport -----
+
+    def log_entry(self, direction, msg, client=None):
+        if self.log is None:
+            return
+        entry = {"t": now_ms(), "dir": direction}
+        if client is not None:
+            entry["peer"] = client.name
+        entry.update(msg)
+        self.log.write(json.dumps(entry, separators=(",", ":")) + "\n")
+        self.log.flush()
+
+    async def send(self, client, msg):
+        data = json.dumps(msg, separators=(",", ":"))
+        if self.send_delay_s:
+            await asyncio.sleep(self.send_delay_s)
+        try:
+            await client.ws.send(data)
+        except ConnectionClosed:
+            return
+        client.sent_frames += 1
+        client.sent_bytes += len(data)
+
+    async def broadcast(self, msg, exclude=None, fast=False):
+        self.seq += 1
+        msg = dict(msg, seq=self.seq)
+        self.history.append(msg)
+        if fast and self.fast_path is not None:
+            self.fast_path.send(dict(msg, epoch=self.epoch))
+            self.log_entry("udp", msg)
+        self.log_entry("out", msg)
+        for client in list(self.clients):
+            if client is not exclude and not client.awaiting_resume and client.wants(msg):
+                await self.send(client, msg)
+
+    async def relay(self, msg, exclude=None):
+        """Ephemeral fan-out: no seq, not kept for replay."""
+        self.log_entry("out", msg)
+        for client in list(self.clients):
+            if client is not exclude and not client.awaiting_resume and client.wants(msg):
+                await self.send(client, msg)
+
+    # ----- protocol -----
+
+    async def handle(self, client, msg):
+        kind = msg.get("type")
+        if kind != "ping":
+            self.log_entry("in", msg, client)
+
+        if kind == "ping":
+            await self.send(client, {"type": "pong", "client_ping_time": msg.get("time"),
+                                     "server_time": now_ms()})
+        elif kind == "subscribe":
+            types = msg.get("types")
+            lanes = msg.get("lanes")
+            client.types = set(types) if isinstance(types, list) else None
+            client.lanes = set(lanes) if isinstance(lanes, list) else None
+            if "last_seq" in msg:
+                await self.resume(client, int(msg["last_seq"]), int(msg.get("epoch", 0)))
+            if client.types is not None and "presence" in client.types:
+                for entry in self.presence.roster():
+                    await self.send(client, entry)
+        elif kind == "start":
+            await self.start(msg.get("event", self.event), msg.get("heat", self.heat),
+                             msg.get("timestamp"))
+        elif kind == "reset":
+            await self.reset()
+        elif kind == "status":
+            client.status = msg
+            # One roster entry per lane: the start end's device, as on the starter
+            lane = msg.get("lane")
+            if lane is not None and msg.get("position", "start") == "start":
+                client.presence_lane = lane
+                await self.publish_presence(self.presence.report(lane, msg))
+            await self.relay(msg, exclude=client)
+        elif kind == "probe-reply":
+            if client.probe is not None and client.probe[0] == msg.get("id"):
+                future = client.probe[1]
+                if not future.done():
+                    future.set_result((time.time() * 1000.0, msg))
+        elif kind == "split":
+            key = await self.acknowledge(client, msg, undo=False)
+            if key is not None:
+                if key in self.splits:
+                    # Retransmit, or a copy that arrived after its undo
+                    self.duplicate_splits += 1
+                    return
+                self.splits[key] = "split"
+            lane = msg.get("lane")
+            timestamp = msg.get("timestamp", now_ms())
+            split = {"type": "split", "lane": lane, "timestamp": timestamp,
+                     "time": format_time(timestamp - self.start_ts)}
+            for key in ("device", "id", "position", "sync", "uncertainty_ms"):
+                if key in msg:
+                    split[key] = msg[key]
+            await self.broadcast(split, exclude=client)
+        elif kind == "split-undo":
+            key = await self.acknowledge(client, msg, undo=True)
+            if key is None:
+                return
+            previous = self.splits.get(key)
+            self.splits[key] = "undone"  # Tombstone, also if the split never arrived
+            if previous == "split":
+                undo = {"type": "split-undo"}
+                for key in ("device", "id", "lane", "position", "timestamp"):
+                    if key in msg:
+                        undo[key] = msg[key]
+                await self.broadcast(undo, exclude=client)
+        elif kind == "relay":
+            if msg.get("verdict") != "ok":
+                print("relay: lane %s exchange %s %s%s" % (
+                    msg.get("lane"), msg.get("exchange"), msg.get("verdict"),
+                    " by %.3f s" % (-msg["margin_us"] / 1e6) if "margin_us" in msg else ""))
+            await self.broadcast(msg, exclude=client)
+
+    async def publish_presence(self, delta):
+        if delta is not None:
+            await self.relay(delta)
+
+    async def lane_gone(self, client):
+        lane = client.presence_lane
+        if lane is None or any(c.presence_lane == lane for c in self.clients):
+            return
+        await self.publish_presence(self.presence.offline(lane))
+
+    async def sweep_presence(self):
+        """Lanes whose connection is open but whose reports stopped."""
+        for lane in self.presence.stale():
+            await self.publish_presence(self.presence.offline(lane))
+
+    async def acknowledge(self, client, msg, undo):
+        """Acks a split or undo that carries an id; returns its key (None: legacy split)."""
+        if "id" not in msg or "device" not in msg:
+            return None
+        await self.send(client, {"type": "split-ack", "device": msg["device"], "id": msg["id"],
+                                 "undo": undo})
+        return (msg["device"], msg.get("start_timestamp", 0), msg["id"])
+
+    async def start(self, event=None, heat=None, timestamp=None):
+        if self.running:
+            return
+        self.event = str(event or self.event)
+        self.heat = str(heat or self.heat)
+        self.start_ts = int(timestamp or now_ms())
+        self.running = True
+        await self.broadcast(self.with_distance({"type": "start", "event": self.event, "heat": self.heat,
+                                                 "timestamp": self.start_ts}), fast=True)
+
+    async def reset(self):
+        self.running = False
+        await self.broadcast({"type": "reset", "timestamp": now_ms()}, fast=True)
+        self.reset_seq = self.seq
+
+    def with_distance(self, msg):
+        if self.distance:
+            msg["distance"] = self.distance
+        return msg
+
+    def snapshot(self):
+        return self.with_distance({"type": "snapshot", "seq": self.seq, "epoch": self.epoch,
+                                   "running": self.running, "start_timestamp": self.start_ts if self.running else 0,
+                                   "event": self.event, "heat": self.heat, "reset_seq": self.reset_seq})
+
+    async def resume(self, client, last_seq, epoch):
+        client.awaiting_resume = True
+        oldest = self.history[0]["seq"] if self.history else self.seq + 1
+        replayable = (epoch == self.epoch and last_seq > 0 and last_seq <= self.seq
+                      and last_seq >= oldest - 1)
+        if replayable:
+            sent_seq = last_seq
+        else:
+            self.snapshots += 1
+            sent_seq = self.seq
+            await self.send(client, self.snapshot())
+
+        # Broadcasts made while replaying are in the history too; keep going
+        # until caught up so the device never sees a live seq before a replayed one
+        while True:
+            pending = [msg for msg in self.history if msg["seq"] > sent_seq]
+            if not pending:
+                break
+            for msg in pending:
+                sent_seq = msg["seq"]
+                if client.wants(msg):
+                    self.replayed += 1
+                    await self.send(client, msg)
+        client.awaiting_resume = False
+
+    async def audit(self, timeout=1.0):
+        """Probe every device; returns (per-device results, dispersion in ms)."""
+        self.probe_id += 1
+        loop = asyncio.get_running_loop()
+        pending = []
+        for client in list(self.clients):
+            future = loop.create_future()
+            client.probe = (self.probe_id, future)
+            sent_at = time.time() * 1000.0
+            await self.send(client, {"type": "probe", "id": self.probe_id})
+            pending.append((client, sent_at, future))
+
+        results = []
+        for client, sent_at, future in pending:
+            try:
+                received_at, reply = await asyncio.wait_for(future, timeout)
+            except asyncio.TimeoutError:
+                continue
+            finally:
+                client.probe = None
+            # The device read its clock somewhere between our send and receive
+            window = (received_at - sent_at) / 2.0
+            error = reply.get("time", 0) - (sent_at + window)
+            bound = reply.get("uncertainty_ms")
+            results.append({"device": reply.get("device", client.name), "error_ms": round(error, 1),
+                            "window_ms": round(window, 1), "sync": reply.get("sync"),
+                            "uncertainty_ms": bound,
+                            "consistent": bound is not None and abs(error) <= bound + window})
+
+        errors = [r["error_ms"] for r in results if r["sync"] != "none"]
+        dispersion = round(max(errors) - min(errors), 1) if errors else None
+        self.log_entry("audit", {"probe": self.probe_id, "dispersion_ms": dispersion,
+                                 "devices": results})
+        return results, dispersion
+
+    async def set_event_heat(self, event, heat, distance=0):
+        self.event, self.heat, self.distance = str(event), str(heat), int(distance)
+        await self.broadcast(self.with_distance({"type": "event-heat", "event": self.event, "heat": self.heat}))
+
+    async def serve_client(self, ws):
+        client = Client(ws, "c%d" % self.next_client)
+        self.next_client += 1
+        self.clients.add(client)
+        try:
+            async for raw in ws:
+                try:
+                    msg = json.loads(raw)
+                except ValueError:
+                    continue
+                if isinstance(msg, dict):
+                    await self.handle(client, msg)
+        except ConnectionClosed:
+            pass
+        finally:
+            self.clients.discard(client)
+            await self.lane_gone(client)
+
+    def stats(self):
+        return [(c.name, c.sent_frames, c.sent_bytes) for c in self.clients]
+
+
+async def console(hub):
+    loop = asyncio.get_running_loop()
+    while True:
+        line = await loop.run_in_executor(None, sys.stdin.readline)
+        if not line:
+            return
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "start":
+            await hub.start(*(words[1:3]))
+        elif words[0] == "reset":
+            await hub.reset()
+        elif words[0] == "event" and len(words) in (3, 4) and all(w.isdigit() for w in words[3:]):
+            await hub.set_event_heat(*words[1:4])
+        elif words[0] == "clear":
+            await hub.broadcast({"type": "clear"})
+        elif words[0] == "trace":
+            await hub.broadcast({"type": "trace-dump"})
+        elif words[0] == "stats":
+            for name, frames, size in hub.stats():
+                print("%s: %d frames, %d bytes" % (name, frames, size))
+        elif words[0] == "audit":
+            print_audit(*(await hub.audit()))
+        elif words[0] == "roster":
+            for entry in hub.presence.roster():
+                print(json.dumps(entry, separators=(",", ":")))
+        else:
+            print("commands: start [event heat] | reset | event E H [distance] | clear | trace | stats | audit"
+                  " | roster")
+
+
+def print_audit(results, dispersion):
+    for r in sorted(results, key=lambda r: r["device"]):
+        bound = "+/-%s" % r["uncertainty_ms"] if r["uncertainty_ms"] is not None else "unknown"
+        print("%-10s error %7.1f ms (window +/-%.1f)  claims %-8s %-10s%s" % (
+            r["device"], r["error_ms"], r["window_ms"], r["sync"], bound,
+            "" if r["consistent"] else "  INCONSISTENT"))
+    print("dispersion: %s ms across %d devices" % (dispersion, len(results)))
+
+
+async def periodic_audit(hub, interval):
+    while True:
+        await asyncio.sleep(interval)
+        results, dispersion = await hub.audit()
+        bad = [r["device"] for r in results if not r["consistent"]]
+        print("audit: dispersion %s ms%s" % (dispersion, ", inconsistent: %s" % bad if bad else ""))
+
+
+async def presence_sweeper(hub, interval=5.0):
+    while True:
+        await asyncio.sleep(interval)
+        await hub.sweep_presence()
+
+
+async def run(args):
+    log = open(args.log, "a", encoding="utf-8") if args.log else None
+    fast_path = FastPath(args.udp_key, interface=args.udp_interface) if args.udp_key else None
+    hub = Hub(log, fast_path=fast_path)
+    async with serve(hub.serve_client, args.host, args.port):
+        print("stand-in server on ws://%s:%d/ws" % (args.host, args.port))
+        asyncio.create_task(presence_sweeper(hub))
+        if args.audit_interval:
+            asyncio.create_task(periodic_audit(hub, args.audit_interval))
+        if args.console:
+            await console(hub)
+        else:
+            await asyncio.Future()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--log", help="append JSON-lines message log here")
+    parser.add_argument("--console", action="store_true", help="read commands from stdin")
+    parser.add_argument("--udp-key", help="shared key: also send start/reset as signed multicast")
+    parser.add_argument("--udp-interface", default="0.0.0.0",
+                        help="local address of the interface facing the lanes")
+    parser.add_argument("--audit-interval", type=float, default=0,
+                        help="seconds between automatic sync audits (logged; 0 = off)")
+    args = parser.parse_args()
+    try:
+        asyncio.run(run(args))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
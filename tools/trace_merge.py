@@ -0,0 +1,253 @@
+#!/usr/bin/env python3
+"""
+Merge SwimWatch device traces and server logs into one Chrome trace.
+
+Inputs (any mix, one file per argument):
+  - Serial captures containing "TRACE {...}" lines (serial command 't')
+  - Saved WebSocket "trace" messages, one JSON object per line
+  - Server logs: one JSON object per line with "t" (server time in ms),
+    "type" and optionally "dir", "lane", "timestamp"
+
+Device records are placed on the server timeline using the offset estimate
+recorded with each event (server = local_ms + offset). Records taken before
+the first sync sample use the nearest later estimate.
+
+The output loads in chrome://tracing and https://ui.perfetto.dev. Each lane
+gets a flow arrow: start sent -> server start -> start received ->
+lane start -> first split.
+
+Usage: trace_merge.py -o pool.json starter.log lane1.log lane2.log server.log
+       trace_merge.py --self-test
+"""
+
+import argparse
+import bisect
+import json
+import os
+import sys
+import tempfile
+from collections import defaultdict
+
+SLICE_US = 100  # Drawn width of an instant event
+
+
+def parse_file(path, devices, server):
+    with open(path, encoding="utf-8", errors="replace") as handle:
+        for line in handle:
+            line = line.strip()
+            if not line:
+                continue
+            if line.startswith("TRACE "):
+                rec = json.loads(line[len("TRACE "):])
+                devices[rec["dev"]].append(rec)
+                continue
+            if not line.startswith("{"):
+                continue  # Other serial output
+            try:
+                obj = json.loads(line)
+            except json.JSONDecodeError:
+                continue
+            if obj.get("type") == "trace" and "events" in obj:
+                for rec in obj["events"]:
+                    devices[rec["dev"]].append(rec)
+            elif "t" in obj and "type" in obj:
+                server.append(obj)
+
+
+def align_device(records):
+    """Return records sorted by local time with an aligned 'server_ms' field."""
+    # Duplicates occur when the same dump is captured twice
+    unique = {(r["us"], r["ev"], r["arg"]): r for r in records}
+    ordered = sorted(unique.values(), key=lambda r: r["us"])
+    synced_us = [r["us"] for r in ordered if r["synced"]]
+    synced_off = [r["off"] for r in ordered if r["synced"]]
+
+    for rec in ordered:
+        if rec["synced"]:
+            offset = rec["off"]
+        elif synced_us:
+            i = bisect.bisect_left(synced_us, rec["us"])
+            offset = synced_off[min(i, len(synced_off) - 1)]
+        else:
+            offset = None
+        rec["aligned"] = offset is not None
+        rec["server_ms"] = rec["us"] / 1000.0 + (offset or 0)
+    return ordered
+
+
+def build_trace(devices, server):
+    events = []
+    pids = {}
+
+    def pid_for(name):
+        if name not in pids:
+            pids[name] = len(pids) + 1
+            events.append({"ph": "M", "name": "process_name", "pid": pids[name],
+                           "args": {"name": name}})
+        return pids[name]
+
+    aligned = {dev: align_device(recs) for dev, recs in sorted(devices.items())}
+    all_ms = [r["server_ms"] for recs in aligned.values() for r in recs]
+    all_ms += [s["t"] for s in server]
+    if not all_ms:
+        return {"traceEvents": []}
+    origin = min(all_ms)
+
+    def ts(ms):
+        return round((ms - origin) * 1000.0, 1)
+
+    # chain id -> list of (ts, pid, device, step)
+    chains = defaultdict(list)
+
+    for dev, recs in aligned.items():
+        pid = pid_for(dev)
+        first_split = set()
+        for rec in recs:
+            event_ts = ts(rec["server_ms"])
+            events.append({
+                "ph": "X", "name": rec["ev"], "cat": "device", "pid": pid, "tid": 1,
+                "ts": event_ts, "dur": SLICE_US,
+                "args": {"local_us": rec["us"], "sync_ms": rec["sync"], "offset_ms": rec["off"],
+                         "synced": bool(rec["synced"]), "aligned": rec["aligned"],
+                         "arg": rec["arg"], "start": rec["start"]},
+            })
+            chain = rec["start"]
+            if not chain:
+                continue
+            if rec["ev"] in ("start_sent", "start_received", "lane_start"):
+                chains[chain].append((event_ts, pid, dev, rec["ev"]))
+            elif rec["ev"] == "split_sent" and chain not in first_split:
+                first_split.add(chain)
+                chains[chain].append((event_ts, pid, dev, rec["ev"]))
+
+    if server:
+        pid = pid_for("server")
+        for entry in sorted(server, key=lambda s: s["t"]):
+            name = entry["type"] + ("/" + entry["dir"] if "dir" in entry else "")
+            event_ts = ts(entry["t"])
+            events.append({"ph": "X", "name": name, "cat": "server", "pid": pid, "tid": 1,
+                           "ts": event_ts, "dur": SLICE_US, "args": entry})
+            if entry["type"] == "start" and entry.get("timestamp"):
+                chains[entry["timestamp"]].append((event_ts, pid, "server", name))
+
+    # One flow per lane: shared steps (starter, server) followed by the lane's own steps
+    for chain, steps in chains.items():
+        shared = [s for s in steps if s[2] == "server" or s[3] == "start_sent"]
+        lanes = sorted({s[2] for s in steps} - {s[2] for s in shared})
+        for lane in lanes:
+            path = sorted(shared + [s for s in steps if s[2] == lane])
+            if len(path) < 2:
+                continue
+            flow_id = "%s/%s" % (chain, lane)
+            for i, (step_ts, pid, _, _) in enumerate(path):
+                phase = "s" if i == 0 else ("f" if i == len(path) - 1 else "t")
+                flow = {"ph": phase, "name": "start-chain", "cat": "flow", "id": flow_id,
+                        "pid": pid, "tid": 1, "ts": step_ts}
+                if phase != "s":
+                    flow["bp"] = "e"
+                events.append(flow)
+
+    return {"traceEvents": events, "displayTimeUnit": "ms",
+            "otherData": {"origin_server_ms": origin}}
+
+
+def self_test():
+    """Merge a starter, a lane and a server log on a real epoch-ms clock.
+
+    The offsets are about 1.76e12 ms, far outside 32 bits: a device that
+    truncated them would land weeks away from the server's entries.
+    """
+    base = 1759996400000  # Server time of the lane's first sync sample
+    record = ('TRACE {"dev":"%s","ev":"%s","us":%d,"sync":%d,"off":%d,'
+              '"synced":%d,"start":%d,"arg":0}')
+    # Starter booted 90 s and the lane 60 s before the sample
+    starter_off, lane_off = base - 90000, base - 60000
+    start_ts = base + 1000
+    logs = {
+        "starter.log": [
+            "boot banner, not a trace line",
+            record % ("starter", "sync_sample", 90000000, base, starter_off, 1, 0),
+            record % ("starter", "start_sent", 90998000, base + 998, starter_off, 1, start_ts),
+        ],
+        "lane.log": [
+            record % ("lane1", "ws_connected", 59000000, 0, 0, 0, 0),
+            record % ("lane1", "sync_sample", 60000000, base, lane_off, 1, 0),
+            record % ("lane1", "start_received", 61012000, base + 1012, lane_off, 1, start_ts),
+            record % ("lane1", "lane_start", 61013000, base + 1013, lane_off, 1, start_ts),
+            record % ("lane1", "split_sent", 91013000, base + 31013, lane_off, 1, start_ts),
+        ],
+        "server.log": [
+            json.dumps({"t": base + 1000, "type": "start", "dir": "in", "timestamp": start_ts}),
+            json.dumps({"t": base + 1005, "type": "start", "dir": "out", "timestamp": start_ts}),
+        ],
+    }
+    devices = defaultdict(list)
+    server = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for name, lines in logs.items():
+            path = os.path.join(tmp, name)
+            with open(path, "w", encoding="utf-8") as handle:
+                handle.write("\n".join(lines) + "\n")
+            parse_file(path, devices, server)
+    trace = build_trace(devices, server)
+
+    failures = []
+    origin = trace["otherData"]["origin_server_ms"]
+    if origin != base - 1000:
+        failures.append("origin %s, expected the lane's unsynced connect at %d" % (origin, base - 1000))
+    slices = {(e["pid"], e["name"]): e["ts"] for e in trace["traceEvents"] if e["ph"] == "X"}
+    names = {e["pid"]: e["args"]["name"] for e in trace["traceEvents"] if e["ph"] == "M"}
+    by_name = {(names[pid], name): ts for (pid, name), ts in slices.items()}
+    expected = {
+        ("starter", "start_sent"): 1998,
+        ("server", "start/in"): 2000,
+        ("server", "start/out"): 2005,
+        ("lane1", "ws_connected"): 0,
+        ("lane1", "start_received"): 2012,
+        ("lane1", "lane_start"): 2013,
+        ("lane1", "split_sent"): 32013,
+    }
+    for key, ms in expected.items():
+        got = by_name.get(key)
+        if got is None or abs(got - ms * 1000.0) > 1:
+            failures.append("%s/%s at %s us, expected %d" % (key[0], key[1], got, ms * 1000))
+    flows = [e for e in trace["traceEvents"] if e.get("cat") == "flow"]
+    if len(flows) != 6:  # start_sent, server in/out, received, lane start, first split
+        failures.append("%d flow steps, expected 6" % len(flows))
+
+    for failure in failures:
+        print("FAIL: " + failure, file=sys.stderr)
+    print("self-test: %s" % ("FAIL" if failures else "OK"), file=sys.stderr)
+    return 1 if failures else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("inputs", nargs="*", help="device captures and server logs")
+    parser.add_argument("-o", "--output", default="-", help="output file (default stdout)")
+    parser.add_argument("--self-test", action="store_true",
+                        help="merge built-in epoch-ms logs and check the alignment")
+    args = parser.parse_args()
+    if args.self_test:
+        sys.exit(self_test())
+    if not args.inputs:
+        parser.error("no input files")
+
+    devices = defaultdict(list)
+    server = []
+    for path in args.inputs:
+        parse_file(path, devices, server)
+
+    trace = build_trace(devices, server)
+    if args.output == "-":
+        json.dump(trace, sys.stdout)
+    else:
+        with open(args.output, "w", encoding="utf-8") as handle:
+            json.dump(trace, handle)
+    print("%d devices, %d server entries, %d trace events" %
+          (len(devices), len(server), len(trace["traceEvents"])), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
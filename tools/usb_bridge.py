@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+"""
+USB bridge: connects stopwatch devices on USB serial ports to the WebSocket
+server, for a timing PC that has the devices on a cable instead of Wi-Fi.
+
+Each port gets its own WebSocket to the server, so the server sees an
+ordinary device connection. The device frames its JSON messages
+(include/message_frame.h) between its log lines on the same port:
+  - frames from the device are checked (CRC) and sent to the server as text
+  - server messages go back to the device as frames from node 0xFD (host)
+  - everything outside a frame is device log output, printed with the port
+    name in front
+  - while the WebSocket is connected an empty frame goes out every second;
+    the device treats the cable as up while these arrive and moves all
+    traffic, time sync included, to it (back to Wi-Fi within 3 s of the
+    bridge stopping)
+  - the device's last subscribe is kept and sent again when the WebSocket
+    reconnects, so the server replays what was missed even if the device
+    never noticed the outage
+
+Usage: usb_bridge.py /dev/ttyACM0 [/dev/ttyACM1 ...] [--server ws://127.0.0.1:8080/ws]
+
+Requires: pip install "websockets>=13"
+"""
+
+import argparse
+import asyncio
+import json
+import os
+import sys
+import termios
+import tty
+
+from websockets.asyncio.client import connect
+from websockets.exceptions import ConnectionClosed
+
+FRAME_SOF = 0xA5
+FRAME_VERSION = 1
+FRAME_HEADER_SIZE = 7
+FRAME_OVERHEAD = 9
+FRAME_NODE_HOST = 0xFD
+
+# WS_MAX_FRAME_SIZE in include/ws_protocol.h
+MAX_PAYLOAD = 1024
+
+BEACON_INTERVAL = 1.0
+RECONNECT_INTERVAL = 2.0
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC16-CCITT as in frameCrc16()."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def encode_frame(source, seq, payload):
+    body = bytes([FRAME_VERSION, source, seq & 0xFF, (seq >> 8) & 0xFF,
+                  len(payload) & 0xFF, len(payload) >> 8]) + payload
+    crc = crc16(body)
+    return bytes([FRAME_SOF]) + body + bytes([crc & 0xFF, crc >> 8])
+
+
+def decode_frame(frame):
+    """(source, seq, payload) for a valid frame, None otherwise."""
+    if len(frame) < FRAME_OVERHEAD or frame[0] != FRAME_SOF or frame[1] != FRAME_VERSION:
+        return None
+    length = frame[5] | (frame[6] << 8)
+    if length + FRAME_OVERHEAD != len(frame):
+        return None
+    end = FRAME_HEADER_SIZE + length
+    if crc16(frame[1:end]) != frame[end] | (frame[end + 1] << 8):
+        return None
+    return frame[2], frame[3] | (frame[4] << 8), bytes(frame[FRAME_HEADER_SIZE:end])
+
+
+class FrameStream:
+    """Mirror of FrameStreamDecoder: splits a byte stream into frames and text."""
+
+    def __init__(self, size=MAX_PAYLOAD + FRAME_OVERHEAD):
+        self.size = size
+        self.buffer = bytearray()
+        self.expected = 0
+        self.discarded = 0
+
+    def feed(self, data):
+        """Yields ("frame", bytes) for frame candidates and ("text", bytes) for the rest."""
+        text = bytearray()
+        for byte in data:
+            result = self.push(byte)
+            if result == "passthrough":
+                text.append(byte)
+            elif result is not None:
+                if text:
+                    yield "text", bytes(text)
+                    text.clear()
+                yield "frame", result
+        if text:
+            yield "text", bytes(text)
+
+    def push(self, byte):
+        if not self.buffer:
+            if byte != FRAME_SOF:
+                return "passthrough"
+            self.buffer.append(byte)
+            return None
+        self.buffer.append(byte)
+        if len(self.buffer) == 2 and byte != FRAME_VERSION:
+            self.buffer.clear()
+            self.discarded += 1
+            return self.push(byte) if byte == FRAME_SOF else None
+        if len(self.buffer) == FRAME_HEADER_SIZE:
+            self.expected = (self.buffer[5] | (self.buffer[6] << 8)) + FRAME_OVERHEAD
+            if self.expected > self.size:
+                self.buffer.clear()
+                self.discarded += 1
+                return None
+        if len(self.buffer) >= FRAME_HEADER_SIZE and len(self.buffer) == self.expected:
+            frame = bytes(self.buffer)
+            self.buffer.clear()
+            return frame
+        return None
+
+
+def open_port(path, baud=115200):
+    """Raw, non-blocking file descriptor for a serial port or pty."""
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, "B%d" % baud, termios.B115200)
+    attrs[4] = attrs[5] = speed  # USB-CDC ignores it; real UARTs do not
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+class DeviceBridge:
+    """One device port and its WebSocket to the server."""
+
+    def __init__(self, port, uri, fd=None, log=None):
+        self.port = port
+        self.uri = uri
+        self.fd = fd if fd is not None else open_port(port)
+        self.log = log or (lambda line: print("[%s] %s" % (self.port, line), flush=True))
+        self.stream = FrameStream()
+        self.ws = None
+        self.seq = 0
+        self.subscribe = None
+        self.line = bytearray()
+        self.incoming = asyncio.Queue()
+        # Counters
+        self.to_server = 0
+        self.to_device = 0
+        self.rejected = 0
+        self.dropped = 0
+
+    async def run(self):
+        loop = asyncio.get_running_loop()
+        loop.add_reader(self.fd, self.on_readable)
+        tasks = [asyncio.create_task(self.device_pump()), asyncio.create_task(self.beacon())]
+        try:
+            while True:
+                try:
+                    async with connect(self.uri) as ws:
+                        self.ws = ws
+                        self.log("bridge: connected to %s" % self.uri)
+                        if self.subscribe is not None:
+                            await ws.send(self.subscribe)
+                        async for text in ws:
+                            self.write_frame(text.encode() if isinstance(text, str) else text)
+                except (OSError, ConnectionClosed) as error:
+                    self.log("bridge: server link down (%s)" % error)
+                finally:
+                    self.ws = None
+                await asyncio.sleep(RECONNECT_INTERVAL)
+        finally:
+            loop.remove_reader(self.fd)
+            for task in tasks:
+                task.cancel()
+
+    def on_readable(self):
+        try:
+            data = os.read(self.fd, 4096)
+        except (BlockingIOError, InterruptedError):
+            return
+        except OSError:
+            data = b""
+        if not data:
+            # Device unplugged (EIO on a pty whose other end closed)
+            asyncio.get_running_loop().remove_reader(self.fd)
+            self.log("bridge: port closed")
+            return
+        self.incoming.put_nowait(data)
+
+    async def device_pump(self):
+        while True:
+            data = await self.incoming.get()
+            for kind, chunk in self.stream.feed(data):
+                if kind == "text":
+                    self.on_text(chunk)
+                else:
+                    await self.on_frame(chunk)
+
+    def on_text(self, chunk):
+        self.line += chunk
+        while b"\n" in self.line:
+            line, _, rest = self.line.partition(b"\n")
+            self.line = bytearray(rest)
+            self.log(line.rstrip(b"\r").decode("utf-8", "replace"))
+
+    async def on_frame(self, frame):
+        decoded = decode_frame(frame)
+        if decoded is None:
+            self.rejected += 1
+            return
+        _, _, payload = decoded
+        if not payload:
+            return
+        text = payload.decode("utf-8", "replace")
+        try:
+            if json.loads(text).get("type") == "subscribe":
+                self.subscribe = text
+        except ValueError:
+            pass
+        if self.ws is None:
+            self.dropped += 1
+            return
+        try:
+            await self.ws.send(text)
+            self.to_server += 1
+        except ConnectionClosed:
+            self.dropped += 1
+
+    def write_frame(self, payload):
+        frame = encode_frame(FRAME_NODE_HOST, self.seq, payload)
+        self.seq = (self.seq + 1) & 0xFFFF
+        view = memoryview(frame)
+        while view:
+            try:
+                view = view[os.write(self.fd, view):]
+            except BlockingIOError:
+                termios.tcdrain(self.fd)
+            except OSError:
+                return
+        if payload:
+            self.to_device += 1
+
+    async def beacon(self):
+        while True:
+            if self.ws is not None:
+                self.write_frame(b"")
+            await asyncio.sleep(BEACON_INTERVAL)
+
+
+async def run(args):
+    bridges = [DeviceBridge(port, args.server) for port in args.ports]
+    await asyncio.gather(*(bridge.run() for bridge in bridges))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("ports", nargs="+", help="device serial ports")
+    parser.add_argument("--server", default="ws://127.0.0.1:8080/ws")
+    args = parser.parse_args()
+    try:
+        asyncio.run(run(args))
+    except KeyboardInterrupt:
+        sys.exit(0)
+
+
+if __name__ == "__main__":
+    main()
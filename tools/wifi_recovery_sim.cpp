@@ -0,0 +1,190 @@
+// Wi-Fi recovery simulation (include/wifi_connector.h), run on the host.
+//
+// A lane device boots while its access point is down, as after a venue
+// power blip when the AP takes longer to come back than the lanes do. The
+// firmware's WifiConnector runs against a model of the radio: an attempt
+// associates 1.5-4 s after it starts or after the AP comes back, whichever
+// is later (0.5-1 s on the known channel after a DORMANT wake), as long as
+// that is still within the attempt. An aborted attempt stops the radio
+// until the next one.
+//
+// For each outage length it reports how long after the AP came back the
+// lane was connected, the attempts it took, and how often the AP+STA portal
+// opened along the way. For comparison, it also shows what the old boot did:
+// one blocking 10 s attempt, and then the setup portal until someone
+// reconfigured the lane.
+//
+// Two more tables cover the same outage after a DORMANT wake, and in the
+// middle of a session with the link already up.
+//
+//   g++ -O2 -Iinclude src/wifi_connector.cpp tools/wifi_recovery_sim.cpp -o wifi_recovery_sim
+//   ./wifi_recovery_sim
+//
+// Exits non-zero if a run does not reconnect, or takes longer after the AP
+// is back than the longest backoff plus one association.
+
+#include "wifi_connector.h"
+
+#include <stdio.h>
+
+static const uint32_t STEP_MS = 10;
+static const uint32_t END_MS = 20 * 60000;
+static const uint32_t PORTAL_AFTER = 6;     // "portal_after" default
+static const int RUNS = 200;
+static const uint32_t ASSOC_MAX_MS = 4000;
+
+struct Rng {
+    uint32_t state;
+
+    uint32_t next(uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    }
+};
+
+struct Run {
+    bool connected;
+    uint32_t recoveryMs;    // Connected, counted from the AP's return
+    uint32_t attempts;
+    bool portal;
+};
+
+// Radio model: an attempt (or the driver's own reconnect after a loss)
+// that is in progress when the AP is up completes after an association delay
+struct Radio {
+    bool trying = false;
+    bool linkUp = false;
+    uint32_t tryStartMs = 0;
+    uint32_t assocMs = 0;
+
+    void attempt(uint32_t now, uint32_t delay) {
+        trying = true;
+        tryStartMs = now;
+        assocMs = delay;
+    }
+
+    void step(uint32_t now, bool apUp, uint32_t apUpAt) {
+        if (!apUp) {
+            linkUp = false;
+            return;
+        }
+        if (trying && !linkUp) {
+            uint32_t from = tryStartMs > apUpAt ? tryStartMs : apUpAt;
+            if (now >= from + assocMs) {
+                linkUp = true;
+                trying = false;
+            }
+        }
+    }
+};
+
+static Run simulate(uint32_t seed, uint32_t downFromMs, uint32_t outageMs, bool knownAp) {
+    Rng rng = {seed};
+    WifiConnector connector;
+    Radio radio;
+    Run run = {false, 0, 0, false};
+    uint32_t apUpAt = downFromMs + outageMs;
+    bool sessionStarted = downFromMs == 0;
+
+    connector.begin(0, knownAp, PORTAL_AFTER, seed * 2654435761u);
+    if (!sessionStarted) {
+        // Already connected before the outage
+        radio.linkUp = true;
+    }
+
+    for (uint32_t now = 0; now < END_MS; now += STEP_MS) {
+        bool apUp = now < downFromMs || now >= apUpAt;
+        bool wasUp = radio.linkUp;
+        radio.step(now, apUp, now < downFromMs ? 0 : apUpAt);
+        if (wasUp && !radio.linkUp) {
+            // Driver's own reconnect, as WiFi auto-reconnect does
+            radio.attempt(now, 1500 + rng.next(2500));
+        }
+
+        WifiAction action = connector.update(now, radio.linkUp);
+        if (action == WIFI_ACTION_CONNECT) {
+            radio.attempt(now, 1500 + rng.next(2500));
+        } else if (action == WIFI_ACTION_CONNECT_KNOWN_AP) {
+            radio.attempt(now, 500 + rng.next(500));
+        } else if (action == WIFI_ACTION_ABORT) {
+            radio.trying = false;
+        }
+        run.portal = run.portal || connector.portalDue();
+
+        if (now >= apUpAt && connector.isConnected()) {
+            run.connected = true;
+            run.recoveryMs = now - apUpAt;
+            run.attempts = connector.getAttempts();
+            break;
+        }
+    }
+    return run;
+}
+
+struct Summary {
+    uint32_t failed;
+    uint64_t recoveryTotal;
+    uint32_t recoveryMax;
+    uint32_t attemptsTotal;
+    uint32_t portals;
+};
+
+static Summary summarize(uint32_t downFromMs, uint32_t outageMs, bool knownAp) {
+    Summary s = {0, 0, 0, 0, 0};
+    for (int i = 0; i < RUNS; i++) {
+        Run run = simulate(1000u + i * 7919u, downFromMs, outageMs, knownAp);
+        if (!run.connected) {
+            s.failed++;
+            continue;
+        }
+        s.recoveryTotal += run.recoveryMs;
+        if (run.recoveryMs > s.recoveryMax) {
+            s.recoveryMax = run.recoveryMs;
+        }
+        s.attemptsTotal += run.attempts;
+        s.portals += run.portal ? 1 : 0;
+    }
+    return s;
+}
+
+// One table row; false if a run failed or recovered too slowly
+static bool row(uint32_t downFromMs, uint32_t outageS, bool knownAp, const char* oldBoot) {
+    // Longest backoff with jitter, then one association
+    const uint32_t bound = WifiConnector::BACKOFF_MAX_MS + WifiConnector::BACKOFF_MAX_MS / 4 + ASSOC_MAX_MS + STEP_MS;
+    Summary s = summarize(downFromMs, outageS * 1000, knownAp);
+    bool ok = s.failed == 0 && s.recoveryMax <= bound;
+    uint32_t connected = RUNS - s.failed;
+    printf("  %6u s  %-20s  %11.1f s  %10.1f s  %8.1f  %7.0f%%%s\n", (unsigned)outageS, oldBoot,
+           connected ? s.recoveryTotal / 1000.0 / connected : 0.0, s.recoveryMax / 1000.0,
+           connected ? (double)s.attemptsTotal / connected : 0.0, 100.0 * s.portals / RUNS, ok ? "" : "  FAIL");
+    return ok;
+}
+
+int main() {
+    static const uint32_t BOOT_OUTAGES_S[] = {0, 5, 15, 30, 60, 120, 300, 600};
+    static const uint32_t WAKE_OUTAGES_S[] = {0, 30};
+    static const uint32_t SESSION_OUTAGES_S[] = {5, 30, 120};
+    bool ok = true;
+
+    printf("AP down at boot, %d runs per outage; portal after %u failed attempts\n", RUNS, (unsigned)PORTAL_AFTER);
+    printf("  %8s  %-20s  %13s  %12s  %8s  %8s\n", "outage", "old boot", "recovery mean", "recovery max",
+           "attempts", "portal");
+    for (uint32_t outageS : BOOT_OUTAGES_S) {
+        // Old boot: one blocking attempt of 10 s, then setup mode for good
+        bool oldRecovers = outageS * 1000 + ASSOC_MAX_MS <= 10000;
+        ok = row(0, outageS, false, oldRecovers ? "connects" : "setup portal, stuck") && ok;
+    }
+
+    printf("After a DORMANT wake (known AP first)\n");
+    for (uint32_t outageS : WAKE_OUTAGES_S) {
+        ok = row(0, outageS, true, "") && ok;
+    }
+
+    printf("AP down mid-session (link up for the first 60 s)\n");
+    for (uint32_t outageS : SESSION_OUTAGES_S) {
+        ok = row(60000, outageS, false, "") && ok;
+    }
+
+    printf("%s\n", ok ? "OK: every run reconnected within the longest backoff plus one association" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,301 @@
+// Fuzz target for the WebSocket ingress path (src/ws_protocol.cpp), run on the host.
+//
+// Every input is one frame as the firmware receives it: the pre-parse stage
+// (size limit, type peek, classify) and then, for frames that pass it, the
+// filtered deserializeJson() into the 512-byte document of
+// WebSocketStopwatch::handleTextFrame(), with the same ingress filter
+// (WS_INGRESS_FIELDS). The frame sits in a heap buffer of exactly its size
+// and is parsed in place, as on the device, so AddressSanitizer reports any
+// read past its end. Each input checks that:
+// - a frame over WS_MAX_FRAME_SIZE is rejected before anything reads it
+// - a peeked type is NUL-terminated, shorter than WS_MAX_TYPE_LENGTH, and
+//   classifies to the id whose name it is
+// - the parse allocates nothing and stays within the document's capacity
+// - the parsed document only holds top-level fields of the filter
+//
+// With libFuzzer (clang):
+//   clang++ -g -O1 -fsanitize=fuzzer,address,undefined -DWS_FUZZ_LIBFUZZER -Iinclude
+//       -I.pio/libdeps/lilygo-t-display-s3/ArduinoJson/src src/ws_protocol.cpp
+//       tools/ws_ingress_fuzz.cpp -o ws_ingress_fuzz
+//   ./ws_ingress_fuzz -max_len=2048
+//
+// As a plain host driver (any compiler), on its own mutations of the frames
+// the stand-in server sends, and on any files or directories given:
+//   g++ -g -O1 -fsanitize=address,undefined -Iinclude
+//       -I.pio/libdeps/lilygo-t-display-s3/ArduinoJson/src src/ws_protocol.cpp
+//       tools/ws_ingress_fuzz.cpp -o ws_ingress_fuzz
+//   ./ws_ingress_fuzz [--runs N] [FILE|DIR...]
+//
+// -DWS_FUZZ_PEEK_ONLY leaves out the parse, for a build without ArduinoJson.
+// The driver exits non-zero on the first input that breaks a check, after
+// writing it to ws_ingress_crash.bin.
+
+#include "ws_protocol.h"
+
+#include <dirent.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifndef WS_FUZZ_PEEK_ONLY
+#include <ArduinoJson.h>
+#endif
+
+// Heap allocations made while an input is on the ingress path
+static bool counting = false;
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    if (counting) {
+        allocations++;
+    }
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+static const uint8_t* currentInput = nullptr;
+static size_t currentSize = 0;
+
+static void fail(const char* what) {
+    fprintf(stderr, "ws_ingress_fuzz: %s (%u byte input)\n", what, (unsigned)currentSize);
+    FILE* out = fopen("ws_ingress_crash.bin", "wb");
+    if (out) {
+        fwrite(currentInput, 1, currentSize, out);
+        fclose(out);
+    }
+    abort();
+}
+
+#define CHECK(condition, what) \
+    do { \
+        if (!(condition)) fail(what); \
+    } while (0)
+
+#ifndef WS_FUZZ_PEEK_ONLY
+static StaticJsonDocument<384> ingressFilter;  // As in WebSocketStopwatch
+
+static bool ingressField(const char* key) {
+    for (size_t i = 0; i < WS_INGRESS_FIELD_COUNT; i++) {
+        if (strcmp(key, WS_INGRESS_FIELDS[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void checkParse(uint8_t* frame, size_t size) {
+    StaticJsonDocument<512> doc;
+    counting = true;
+    allocations = 0;
+    DeserializationError error = deserializeJson(doc, frame, size, DeserializationOption::Filter(ingressFilter));
+    counting = false;
+    CHECK(allocations == 0, "parse allocated on the heap");
+    CHECK(doc.memoryUsage() <= doc.capacity(), "document over its capacity");
+    if (error || !doc.is<JsonObject>()) {
+        return;
+    }
+    for (JsonPair field : doc.as<JsonObject>()) {
+        CHECK(ingressField(field.key().c_str()), "field outside the ingress filter kept");
+    }
+}
+#endif
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    currentInput = data;
+    currentSize = size;
+
+    // Exactly sized and writable: the firmware parses its receive buffer in place
+    uint8_t* frame = (uint8_t*)malloc(size ? size : 1);
+    if (size) {
+        memcpy(frame, data, size);
+    }
+
+    char type[WS_MAX_TYPE_LENGTH];
+    memset(type, 0x5A, sizeof(type));
+    WsMessageType id;
+    counting = true;
+    allocations = 0;
+    WsIngressResult result = wsScreenFrame(frame, size, type, sizeof(type), id);
+    counting = false;
+    CHECK(allocations == 0, "pre-parse allocated on the heap");
+
+    if (size > WS_MAX_FRAME_SIZE) {
+        CHECK(result == WS_INGRESS_TOO_LARGE, "oversized frame not rejected");
+        CHECK(memcmp(frame, data, size) == 0, "oversized frame modified");
+    } else {
+        CHECK(result != WS_INGRESS_TOO_LARGE, "frame within the limit rejected as too large");
+    }
+
+    if (result == WS_INGRESS_OK) {
+        CHECK(memchr(type, '\0', sizeof(type)) != nullptr, "type not NUL-terminated");
+        CHECK(id < WS_TYPE_COUNT, "type id out of range");
+        const char* name = wsTypeName(id);
+        CHECK(id == WS_TYPE_UNKNOWN ? name == nullptr : strcmp(name, type) == 0,
+              "type id does not name the peeked type");
+        CHECK(wsClassifyType(type) == id, "classify not stable");
+#ifndef WS_FUZZ_PEEK_ONLY
+        checkParse(frame, size);
+#endif
+    } else {
+        CHECK(id == WS_TYPE_UNKNOWN, "rejected frame has a type");
+    }
+
+    free(frame);
+    return 0;
+}
+
+#ifndef WS_FUZZ_LIBFUZZER
+struct Rng {
+    uint32_t state;
+
+    uint32_t next(uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    }
+};
+
+// Frames as the stand-in server sends them (tools/standin_server.py)
+static const char* const SEEDS[] = {
+    R"({"type":"ping","server_time":1700000123456})",
+    R"({"type":"pong","client_ping_time":4123456,"server_time":1700000123456})",
+    R"({"type":"start","event":3,"heat":2,"timestamp":1700000123456,"distance":400,"seq":812,"epoch":17})",
+    R"({"type":"reset","seq":813,"epoch":17})",
+    R"({"type":"split","device":"lane4-turn","id":17,"lane":4,"position":"turn","timestamp":1700000163456,)"
+    R"("start_timestamp":1700000123456,"sync":"locked","uncertainty_ms":3,"seq":914})",
+    R"({"type":"split-ack","device":"lane4-turn","id":17,"undo":false,"seq":915})",
+    R"({"type":"split-undo","device":"lane4-turn","id":17,"seq":916})",
+    R"({"type":"event-heat","event":3,"heat":3,"distance":400,"seq":917})",
+    R"({"type":"presence","lane":4,"online":true,"sync":"locked","uncertainty_ms":5,"battery":80,"seq":918})",
+    R"({"seq":920,"running":true,"splits":[{"type":"split","lane":1,"id":3}],"type":"snapshot"})",
+    R"({"type":"trace-dump"})",
+    R"({"type":"scoreboard","lanes":[1,2,3,4,5,6,7,8],"seq":921})",
+};
+static const size_t SEED_COUNT = sizeof(SEEDS) / sizeof(SEEDS[0]);
+
+// Pieces that tend to matter to a JSON scanner
+static const char* const TOKENS[] = {
+    "\"", "\\", "\\\"", "{", "}", "[", "]", ":", ",", "\"type\"", "\"type\":", "\"type\":\"split\"",
+    "null", "true", "1e999", "-0", "\\u0000", "\xff", " ", "\n",
+};
+static const size_t TOKEN_COUNT = sizeof(TOKENS) / sizeof(TOKENS[0]);
+
+static void mutate(std::string& frame, Rng& rng) {
+    int edits = 1 + rng.next(8);
+    for (int i = 0; i < edits; i++) {
+        size_t at = frame.empty() ? 0 : rng.next(frame.size() + 1);
+        switch (rng.next(8)) {
+            case 0:  // Flip a bit
+                if (at < frame.size()) frame[at] ^= (char)(1 << rng.next(8));
+                break;
+            case 1:  // Random byte
+                if (at < frame.size()) frame[at] = (char)rng.next(256);
+                break;
+            case 2:  // Truncate
+                frame.resize(at);
+                break;
+            case 3:  // Delete a run
+                if (at < frame.size()) frame.erase(at, 1 + rng.next(16));
+                break;
+            case 4:  // Insert a token
+                frame.insert(at, TOKENS[rng.next(TOKEN_COUNT)]);
+                break;
+            case 5:  // Splice in part of another frame
+            {
+                const char* other = SEEDS[rng.next(SEED_COUNT)];
+                size_t from = rng.next(strlen(other));
+                frame.insert(at, other + from, rng.next(strlen(other) - from) + 1);
+                break;
+            }
+            case 6:  // Deep nesting
+                frame.insert(at, std::string(1 + rng.next(64), rng.next(2) ? '{' : '['));
+                break;
+            case 7:  // Around the size limit
+                frame.resize(WS_MAX_FRAME_SIZE - 8 + rng.next(24), ' ');
+                break;
+        }
+    }
+}
+
+static void runFile(const std::string& path) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in) {
+        return;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        data.insert(data.end(), chunk, chunk + got);
+    }
+    fclose(in);
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+}
+
+static int runPath(const char* path) {
+    DIR* dir = opendir(path);
+    if (!dir) {
+        runFile(path);
+        return 1;
+    }
+    int files = 0;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            runFile(std::string(path) + "/" + entry->d_name);
+            files++;
+        }
+    }
+    closedir(dir);
+    return files;
+}
+
+int main(int argc, char** argv) {
+    long runs = 200000;
+    int files = 0;
+#ifndef WS_FUZZ_PEEK_ONLY
+    for (size_t i = 0; i < WS_INGRESS_FIELD_COUNT; i++) {
+        ingressFilter[WS_INGRESS_FIELDS[i]] = true;
+    }
+#endif
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--runs") == 0) {
+            runs = atol(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [--runs N] [FILE|DIR...]\n", argv[0]);
+            return 2;
+        } else {
+            files += runPath(argv[i]);
+        }
+    }
+
+    for (size_t i = 0; i < SEED_COUNT; i++) {
+        LLVMFuzzerTestOneInput((const uint8_t*)SEEDS[i], strlen(SEEDS[i]));
+    }
+    std::string oversized(WS_MAX_FRAME_SIZE + 1, ' ');
+    oversized.replace(0, strlen(SEEDS[0]), SEEDS[0]);
+    LLVMFuzzerTestOneInput((const uint8_t*)oversized.data(), oversized.size());
+
+    Rng rng = {12345};
+    for (long run = 0; run < runs; run++) {
+        std::string frame = SEEDS[rng.next(SEED_COUNT)];
+        mutate(frame, rng);
+        LLVMFuzzerTestOneInput((const uint8_t*)frame.data(), frame.size());
+    }
+
+    printf("ws_ingress_fuzz: %ld mutated frames, %d files, no failures\n", runs, files);
+    return 0;
+}
+#endif